@@ -0,0 +1,131 @@
+#include "benchmark/benchmark.h"
+
+#include "core/io/AsyncFile.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace APE;
+
+namespace {
+
+/*
+* Every file under res/, the benches run from the repository root
+*/
+struct ResTree {
+	std::vector<std::filesystem::path> paths;
+	size_t total_bytes = 0;
+
+	ResTree()
+	{
+		std::error_code ec;
+		for (auto& entry : std::filesystem::recursive_directory_iterator("res", ec)) {
+			if (!entry.is_regular_file(ec)) continue;
+			paths.push_back(entry.path());
+			total_bytes += static_cast<size_t>(entry.file_size(ec));
+		}
+	}
+
+	// Best effort, clean pages only and not every file system obeys
+	void dropCache() const
+	{
+#ifdef __linux__
+		for (auto& path : paths) {
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) continue;
+			(void)posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+			close(fd);
+		}
+#endif
+	}
+};
+
+[[nodiscard]] const ResTree& resTree()
+{
+	static ResTree s_tree;
+	return s_tree;
+}
+
+[[nodiscard]] bool prepare(benchmark::State& state, const ResTree& tree)
+{
+	if (tree.paths.empty()) {
+		state.SkipWithError("No files under res/, run from the repository root");
+		return false;
+	}
+	state.SetLabel(state.range(0) ? "cold" : "warm");
+	return true;
+}
+
+IO::Task<size_t> readTree(IO::Service& service, std::vector<std::filesystem::path> paths)
+{
+	size_t num_bytes = 0;
+	for (auto& result : co_await service.readFiles(std::move(paths))) {
+		num_bytes += result.bytes.size();
+	}
+	co_return num_bytes;
+}
+
+};	// end of namespace
+
+// What the loaders do today, one blocking read after another
+static void BM_ReadTreeBlocking(benchmark::State& state)
+{
+	const auto& tree = resTree();
+	if (!prepare(state, tree)) return;
+
+	for (auto _ : state) {
+		if (state.range(0)) {
+			state.PauseTiming();
+			tree.dropCache();
+			state.ResumeTiming();
+		}
+
+		size_t num_bytes = 0;
+		for (auto& path : tree.paths) {
+			std::ifstream is(path, std::ios::binary | std::ios::ate);
+			std::vector<char> bytes(static_cast<size_t>(is.tellg()));
+			is.seekg(0);
+			is.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+			num_bytes += bytes.size();
+		}
+		benchmark::DoNotOptimize(num_bytes);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * tree.total_bytes));
+}
+BENCHMARK(BM_ReadTreeBlocking)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+template <IO::Service::Backend BACKEND>
+static void BM_ReadTreeAsync(benchmark::State& state)
+{
+	const auto& tree = resTree();
+	if (!prepare(state, tree)) return;
+
+	IO::Service service(BACKEND);
+	if (service.backend() != BACKEND) {
+		state.SkipWithError("Backend unavailable");
+		return;
+	}
+
+	for (auto _ : state) {
+		if (state.range(0)) {
+			state.PauseTiming();
+			tree.dropCache();
+			state.ResumeTiming();
+		}
+
+		size_t num_bytes = readTree(service, tree.paths).get();
+		benchmark::DoNotOptimize(num_bytes);
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * tree.total_bytes));
+}
+BENCHMARK(BM_ReadTreeAsync<IO::Service::Backend::IoUring>)
+	->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ReadTreeAsync<IO::Service::Backend::ThreadPool>)
+	->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
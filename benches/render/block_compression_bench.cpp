@@ -0,0 +1,59 @@
+#include "benchmark/benchmark.h"
+
+#include "core/render/BlockCompression.h"
+
+#include <random>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+namespace {
+
+constexpr Uint32 SIZE = 1024;
+
+[[nodiscard]] std::vector<std::byte> noisyGradient()
+{
+	std::mt19937 rng(3);
+	std::uniform_int_distribution<int> noise(-8, 8);
+	std::vector<std::byte> pixels(SIZE * SIZE * 4);
+	for (Uint32 i = 0; i < SIZE * SIZE; ++i) {
+		Uint32 x = i % SIZE, y = i / SIZE;
+		int base[4] = {
+			static_cast<int>(x / 4),
+			static_cast<int>(y / 4),
+			static_cast<int>((x + y) / 8),
+			static_cast<int>(255 - y / 4)
+		};
+		for (int c = 0; c < 4; ++c) {
+			pixels[i * 4 + c] = static_cast<std::byte>(std::clamp(base[c] + noise(rng), 0, 255));
+		}
+	}
+	return pixels;
+}
+
+};	// end of namespace
+
+/*
+* Compresses one 1024x1024 level per iteration on the global pool,
+* throughput is reported as source texels per second
+*/
+static void BM_BlockCompress(benchmark::State& state)
+{
+	auto format = static_cast<TextureFormat>(state.range(0));
+	auto pixels = noisyGradient();
+
+	for (auto _ : state) {
+		auto blocks = BC::compress(format, pixels.data(), SIZE, SIZE);
+		benchmark::DoNotOptimize(blocks.data());
+	}
+	state.SetItemsProcessed(state.iterations() * SIZE * SIZE);
+	state.SetBytesProcessed(state.iterations() * SIZE * SIZE * 4);
+}
+BENCHMARK(BM_BlockCompress)
+	->Arg(static_cast<int>(TextureFormat::BC1_RGBA))
+	->Arg(static_cast<int>(TextureFormat::BC3_RGBA))
+	->Arg(static_cast<int>(TextureFormat::BC5_RG))
+	->Arg(static_cast<int>(TextureFormat::BC7_RGBA))
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
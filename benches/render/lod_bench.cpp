@@ -0,0 +1,93 @@
+#include "benchmark/benchmark.h"
+
+#include "core/render/Lod.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+namespace {
+
+struct Grid {
+	std::vector<TextureVertex> vertices;
+	std::vector<Uint32> indices;
+};
+
+// Rolling heightfield, a stand in for a dense scanned or sculpted mesh
+[[nodiscard]] Grid heightfield(Uint32 cells)
+{
+	Grid grid;
+	for (Uint32 z = 0; z <= cells; ++z) {
+		for (Uint32 x = 0; x <= cells; ++x) {
+			grid.vertices.push_back({
+				.pos = glm::vec3(float(x), std::sin(x * 0.05f) * std::cos(z * 0.07f) * 4.f, float(z)),
+				.normal = glm::vec3(0.f, 1.f, 0.f),
+				.uv = glm::vec2(0.f),
+			});
+		}
+	}
+	for (Uint32 z = 0; z < cells; ++z) {
+		for (Uint32 x = 0; x < cells; ++x) {
+			Uint32 a = z * (cells + 1) + x;
+			Uint32 b = a + cells + 1;
+			grid.indices.insert(grid.indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+		}
+	}
+	return grid;
+}
+
+};	// end of namespace
+
+// One level at half the triangles, the size is cells per side
+static void BM_Simplify(benchmark::State& state)
+{
+	auto grid = heightfield(static_cast<Uint32>(state.range(0)));
+
+	for (auto _ : state) {
+		auto lod = Lod::simplify(grid.vertices, grid.indices, grid.indices.size() / 2, 1e3f);
+		benchmark::DoNotOptimize(lod.data());
+	}
+	state.SetItemsProcessed(state.iterations() * grid.indices.size() / 3);
+}
+BENCHMARK(BM_Simplify)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+
+// The default chain as built at import
+static void BM_GenerateChain(benchmark::State& state)
+{
+	auto grid = heightfield(256);
+	float radius = 256.f * 0.75f;
+
+	size_t num_indices = 0;
+	for (auto _ : state) {
+		auto chain = Lod::generate(grid.vertices, grid.indices, radius);
+		num_indices = chain.indices.size();
+		benchmark::DoNotOptimize(chain.indices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * grid.indices.size() / 3);
+	state.counters["lod_indices"] = static_cast<double>(num_indices);
+}
+BENCHMARK(BM_GenerateChain)->Unit(benchmark::kMillisecond);
+
+// Per draw selection cost
+static void BM_Select(benchmark::State& state)
+{
+	std::vector<MeshLod> lods = {
+		{ .index_offset = 0, .index_count = 3000, .error = 0.002f },
+		{ .index_offset = 3000, .index_count = 1500, .error = 0.01f },
+		{ .index_offset = 4500, .index_count = 700, .error = 0.04f },
+	};
+	float scale = Lod::projectionScale(45.f, 1080.f);
+	Physics::Collisions::Sphere sphere(glm::vec3(0.f), 2.f);
+
+	Uint32 level = 0;
+	float distance = 1.f;
+	for (auto _ : state) {
+		distance = (distance > 500.f) ? 1.f : distance * 1.01f;
+		float radius = Lod::projectedRadius(sphere, glm::vec3(0.f, 0.f, distance + 2.f), scale);
+		level = Lod::select(lods, radius, level);
+		benchmark::DoNotOptimize(level);
+	}
+}
+BENCHMARK(BM_Select);
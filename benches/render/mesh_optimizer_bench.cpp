@@ -0,0 +1,120 @@
+#include "benchmark/benchmark.h"
+
+#include "core/render/MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+namespace {
+
+constexpr Uint32 CELLS = 256;
+
+struct Grid {
+	std::vector<TextureVertex> vertices;
+	std::vector<Uint32> indices;
+};
+
+// Welded grid with its triangles shuffled, the worst case for the cache
+[[nodiscard]] Grid shuffledGrid()
+{
+	Grid grid;
+	for (Uint32 y = 0; y <= CELLS; ++y) {
+		for (Uint32 x = 0; x <= CELLS; ++x) {
+			grid.vertices.push_back({
+				.pos = glm::vec3(float(x), std::sin(x * 0.1f) * std::cos(y * 0.1f), float(y)),
+				.normal = glm::vec3(0.f, 1.f, 0.f),
+				.uv = glm::vec2(float(x) / CELLS, float(y) / CELLS),
+			});
+		}
+	}
+
+	std::vector<std::array<Uint32, 3>> tris;
+	for (Uint32 y = 0; y < CELLS; ++y) {
+		for (Uint32 x = 0; x < CELLS; ++x) {
+			Uint32 a = y * (CELLS + 1) + x;
+			tris.push_back({ a, a + 1, a + CELLS + 2 });
+			tris.push_back({ a, a + CELLS + 2, a + CELLS + 1 });
+		}
+	}
+	std::mt19937 rng(9);
+	std::shuffle(tris.begin(), tris.end(), rng);
+	for (auto& tri : tris) {
+		grid.indices.insert(grid.indices.end(), tri.begin(), tri.end());
+	}
+	return grid;
+}
+
+};	// end of namespace
+
+static void BM_Weld(benchmark::State& state)
+{
+	auto grid = shuffledGrid();
+
+	// Unwelded copy, three vertices per triangle
+	std::vector<TextureVertex> vertices;
+	std::vector<Uint32> indices;
+	for (Uint32 index : grid.indices) {
+		indices.push_back(static_cast<Uint32>(vertices.size()));
+		vertices.push_back(grid.vertices[index]);
+	}
+
+	for (auto _ : state) {
+		auto v = vertices;
+		auto i = indices;
+		benchmark::DoNotOptimize(MeshOpt::weld(v, i));
+	}
+	state.SetItemsProcessed(state.iterations() * vertices.size());
+}
+BENCHMARK(BM_Weld)->Unit(benchmark::kMillisecond);
+
+static void BM_VertexCache(benchmark::State& state)
+{
+	auto grid = shuffledGrid();
+
+	for (auto _ : state) {
+		auto indices = grid.indices;
+		MeshOpt::optimizeVertexCache(indices, grid.vertices.size());
+		benchmark::DoNotOptimize(indices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * grid.indices.size() / 3);
+	state.counters["acmr_before"] = MeshOpt::analyze(grid.indices, grid.vertices.size()).acmr;
+
+	MeshOpt::optimizeVertexCache(grid.indices, grid.vertices.size());
+	state.counters["acmr_after"] = MeshOpt::analyze(grid.indices, grid.vertices.size()).acmr;
+}
+BENCHMARK(BM_VertexCache)->Unit(benchmark::kMillisecond);
+
+static void BM_Overdraw(benchmark::State& state)
+{
+	auto grid = shuffledGrid();
+	MeshOpt::optimizeVertexCache(grid.indices, grid.vertices.size());
+
+	for (auto _ : state) {
+		auto indices = grid.indices;
+		MeshOpt::optimizeOverdraw(indices, grid.vertices);
+		benchmark::DoNotOptimize(indices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * grid.indices.size() / 3);
+}
+BENCHMARK(BM_Overdraw)->Unit(benchmark::kMillisecond);
+
+// Every pass, as run at import
+static void BM_Optimize(benchmark::State& state)
+{
+	auto grid = shuffledGrid();
+
+	for (auto _ : state) {
+		auto vertices = grid.vertices;
+		auto indices = grid.indices;
+		auto report = MeshOpt::optimize(vertices, indices);
+		benchmark::DoNotOptimize(report);
+	}
+	state.SetItemsProcessed(state.iterations() * grid.indices.size() / 3);
+}
+BENCHMARK(BM_Optimize)->Unit(benchmark::kMillisecond);
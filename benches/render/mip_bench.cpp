@@ -0,0 +1,92 @@
+#include "benchmark/benchmark.h"
+
+#include "core/render/MipGenerator.h"
+#include "util/ThreadPool.h"
+
+#include <random>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+namespace {
+
+constexpr Uint32 SIZE = 1024;
+
+[[nodiscard]] std::vector<std::byte> noise()
+{
+	std::mt19937 rng(5);
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::vector<std::byte> pixels(SIZE * SIZE * 4);
+	for (auto& val : pixels) val = static_cast<std::byte>(byte(rng));
+	return pixels;
+}
+
+[[nodiscard]] Mip::Settings settings(int variant)
+{
+	// 1 to 4 are what Image::setPixels picks through settingsFor
+	switch (variant) {
+	case 0: return { .filter = Mip::Filter::Box, .b_srgb = false, .b_normal_map = false };
+	case 1: return { .filter = Mip::Filter::Box, .b_srgb = true, .b_normal_map = false };
+	case 2: return { .filter = Mip::Filter::Kaiser, .b_srgb = true, .b_normal_map = false };
+	case 3: return { .filter = Mip::Filter::Kaiser, .b_srgb = false, .b_normal_map = true };
+	default: return { .filter = Mip::Filter::Box, .b_srgb = false, .b_normal_map = true };
+	}
+}
+
+};	// end of namespace
+
+/*
+* Full chain for one 1024x1024 image,
+* 0 = box linear, 1 = box sRGB, 2 = Kaiser sRGB, 3 = Kaiser normal map,
+* 4 = box normal map
+*/
+static void BM_MipChain(benchmark::State& state)
+{
+	auto pixels = noise();
+	auto mip_settings = settings(static_cast<int>(state.range(0)));
+
+	for (auto _ : state) {
+		auto chain = Mip::generate(SIZE, SIZE, pixels.data(), mip_settings);
+		benchmark::DoNotOptimize(chain.pixels.data());
+	}
+	state.SetItemsProcessed(state.iterations() * SIZE * SIZE);
+}
+BENCHMARK(BM_MipChain)->DenseRange(0, 4)->Unit(benchmark::kMillisecond);
+
+// Eight images at once, one per job on the global pool
+static void BM_MipChainBatch(benchmark::State& state)
+{
+	auto pixels = noise();
+	auto mip_settings = settings(static_cast<int>(state.range(0)));
+	constexpr size_t NUM_IMAGES = 8;
+
+	for (auto _ : state) {
+		std::vector<Mip::Chain> chains(NUM_IMAGES);
+		ThreadPool::global().parallelFor(NUM_IMAGES, [&](size_t i) {
+			chains[i] = Mip::generate(SIZE, SIZE, pixels.data(), mip_settings);
+		});
+		benchmark::DoNotOptimize(chains.data());
+	}
+	state.SetItemsProcessed(state.iterations() * NUM_IMAGES * SIZE * SIZE);
+}
+BENCHMARK(BM_MipChainBatch)->DenseRange(0, 4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// The first level of the float filter, scalar against SSE2, variants as above
+template <bool SIMD>
+static void BM_MipFilter(benchmark::State& state)
+{
+	auto pixels = noise();
+	auto mip_settings = settings(static_cast<int>(state.range(0)));
+	Image::MipLevel src { SIZE, SIZE, SIZE * SIZE * 4, pixels.data() };
+	std::vector<std::byte> dst(SIZE / 2 * SIZE / 2 * 4);
+
+	for (auto _ : state) {
+		if constexpr (SIMD) Mip::detail::filterSimd(src, dst.data(), SIZE / 2, SIZE / 2, mip_settings);
+		else Mip::detail::filterScalar(src, dst.data(), SIZE / 2, SIZE / 2, mip_settings);
+		benchmark::DoNotOptimize(dst.data());
+	}
+	state.SetItemsProcessed(state.iterations() * SIZE * SIZE);
+}
+BENCHMARK(BM_MipFilter<false>)->DenseRange(1, 4)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MipFilter<true>)->DenseRange(1, 4)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,90 @@
+#include "benchmark/benchmark.h"
+
+#include "core/render/Image.h"
+#include "core/render/TextureCooker.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+namespace {
+
+const std::filesystem::path SHIP_TEXTURES = "res/models/ship/textures";
+
+[[nodiscard]] std::vector<std::filesystem::path> shipTextures()
+{
+	std::vector<std::filesystem::path> paths;
+	std::error_code ec;
+	for (auto& entry : std::filesystem::directory_iterator(SHIP_TEXTURES, ec)) {
+		if (entry.is_regular_file()) paths.push_back(entry.path());
+	}
+	std::sort(paths.begin(), paths.end());
+	return paths;
+}
+
+};	// end of namespace
+
+/*
+* Loads every ship texture per iteration, run from the repository root
+*/
+static void BM_TextureDecodeSource(benchmark::State& state)
+{
+	auto paths = shipTextures();
+	if (paths.empty()) {
+		state.SkipWithError("res/models/ship/textures not found");
+		return;
+	}
+
+	size_t num_bytes = 0;
+	for (auto _ : state) {
+		for (auto& path : paths) {
+			int width, height, num_channels;
+			unsigned char* data = stbi_load(path.string().c_str(), &width, &height, &num_channels, 4);
+			benchmark::DoNotOptimize(data);
+			num_bytes += size_t(width) * height * 4;
+			stbi_image_free(data);
+		}
+	}
+	state.SetBytesProcessed(num_bytes);
+}
+BENCHMARK(BM_TextureDecodeSource)->Unit(benchmark::kMillisecond);
+
+static void BM_TextureLoadCooked(benchmark::State& state)
+{
+	auto paths = shipTextures();
+	if (paths.empty()) {
+		state.SkipWithError("res/models/ship/textures not found");
+		return;
+	}
+
+	// Cooking happens once, outside the timed loop
+	for (auto& path : paths) {
+		TextureCooker::cook(path);
+	}
+
+	size_t num_bytes = 0;
+	for (auto _ : state) {
+		for (auto& path : paths) {
+			Image image(path);
+			auto& levels = image.getMipLevels();
+
+			// Touch every page, as the upload memcpy would
+			for (auto& level : levels) {
+				uint32_t sum = 0;
+				for (size_t i = 0; i < level.size_bytes; i += 4096) {
+					sum += static_cast<uint32_t>(level.data[i]);
+				}
+				benchmark::DoNotOptimize(sum);
+			}
+			num_bytes += image.getSizeBytes();
+		}
+	}
+	state.SetBytesProcessed(num_bytes);
+}
+BENCHMARK(BM_TextureLoadCooked)->Unit(benchmark::kMillisecond);
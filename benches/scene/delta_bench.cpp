@@ -0,0 +1,109 @@
+#include "benchmark/benchmark.h"
+
+#include "core/scene/SnapshotDelta.h"
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+using namespace APE;
+
+namespace {
+
+constexpr size_t NUM_ENTITIES = 10'000;
+
+/*
+* 10k Transforms orbiting the origin, every entity moves every tick
+*/
+struct MovingWorld {
+	ECS::Registry registry;
+	std::vector<ECS::EntityHandle> entities;
+	float time = 0.f;
+
+	MovingWorld()
+	{
+		for (size_t i = 0; i < NUM_ENTITIES; ++i) {
+			auto ent = registry.createEntity();
+			registry.emplaceComponent<TransformComponent>(ent,
+				glm::vec3(static_cast<float>(i % 100), 0.f, static_cast<float>(i / 100))
+			);
+			entities.push_back(ent);
+		}
+	}
+
+	void step()
+	{
+		constexpr float dt = 1.f / 60.f;
+		time += dt;
+		for (size_t i = 0; i < entities.size(); ++i) {
+			auto& trans = registry.getComponent<TransformComponent>(entities[i]);
+			float phase = time + static_cast<float>(i) * 0.01f;
+			trans.position.x += std::cos(phase) * dt;
+			trans.position.z += std::sin(phase) * dt;
+			trans.position.y = std::sin(phase * 2.f);
+		}
+	}
+};
+
+};	// end of namespace
+
+static void BM_DeltaEncode(benchmark::State& state)
+{
+	MovingWorld world;
+	DeltaEncoder encoder;
+	(void)encoder.encode(world.registry);
+
+	size_t total_bytes = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		world.step();
+		state.ResumeTiming();
+
+		auto packet = encoder.encode(world.registry);
+		total_bytes += packet.size();
+		benchmark::DoNotOptimize(packet.data());
+	}
+
+	double ticks = static_cast<double>(state.iterations());
+	state.counters["bytes_per_tick"] = static_cast<double>(total_bytes) / ticks;
+	state.counters["bytes_per_entity"] = static_cast<double>(total_bytes) / (ticks * NUM_ENTITIES);
+}
+BENCHMARK(BM_DeltaEncode)->Unit(benchmark::kMicrosecond);
+
+static void BM_DeltaDecode(benchmark::State& state)
+{
+	MovingWorld world;
+	ECS::Registry mirror;
+	DeltaEncoder encoder;
+	DeltaDecoder decoder;
+	(void)decoder.apply(encoder.encode(world.registry), mirror);
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		world.step();
+		auto packet = encoder.encode(world.registry);
+		state.ResumeTiming();
+
+		bool b_applied = decoder.apply(packet, mirror);
+		benchmark::DoNotOptimize(b_applied);
+	}
+}
+BENCHMARK(BM_DeltaDecode)->Unit(benchmark::kMicrosecond);
+
+static void BM_DeltaKeyframe(benchmark::State& state)
+{
+	MovingWorld world;
+	DeltaEncoder encoder;
+
+	size_t total_bytes = 0;
+	for (auto _ : state) {
+		encoder.forceKeyframe();
+		auto packet = encoder.encode(world.registry);
+		total_bytes += packet.size();
+		benchmark::DoNotOptimize(packet.data());
+	}
+
+	state.counters["bytes_per_tick"] =
+		static_cast<double>(total_bytes) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_DeltaKeyframe)->Unit(benchmark::kMicrosecond);
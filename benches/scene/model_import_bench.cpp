@@ -0,0 +1,69 @@
+#include "benchmark/benchmark.h"
+
+#include "core/scene/AssetManager.h"
+#include "core/scene/ModelCache.h"
+#include "core/scene/ModelLoader.h"
+#include "util/ThreadPool.h"
+
+#include <filesystem>
+#include <limits>
+
+using namespace APE;
+
+namespace {
+
+// The benches run from the repository root
+const std::filesystem::path SHIP_PATH = "res/models/ship/source/full_scene.fbx";
+
+/*
+* Imports the ship from scratch every iteration: no cached meshes, and no
+* textures left over from the previous import
+*/
+void importShip(benchmark::State& state, ThreadPool& pool)
+{
+	if (!std::filesystem::exists(SHIP_PATH)) {
+		state.SkipWithError("No ship model, run from the repository root");
+		return;
+	}
+
+	std::filesystem::path cache_dir = std::filesystem::temp_directory_path() / "model_import_bench";
+	std::filesystem::path old_cache_dir = ModelCache::directory();
+	ModelCache::setDirectory(cache_dir);
+	AssetManager::setBudget(AssetClass::Texture, 0);
+
+	size_t num_meshes = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::filesystem::remove_all(cache_dir);
+		(void)AssetManager::trim();
+		state.ResumeTiming();
+
+		auto model = ModelLoader::importModel(AssetKey { SHIP_PATH }, pool);
+		num_meshes = model->meshes.size();
+		benchmark::DoNotOptimize(model);
+	}
+	state.counters["meshes"] = static_cast<double>(num_meshes);
+
+	AssetManager::setBudget(AssetClass::Texture, std::numeric_limits<size_t>::max());
+	(void)AssetManager::trim();
+	ModelCache::setDirectory(old_cache_dir);
+	std::filesystem::remove_all(cache_dir);
+}
+
+};	// end of namespace
+
+// Materials and meshes one after another. Runs as the only worker's job,
+// so the helper parallelFor queues only starts once every index is claimed.
+static void BM_ImportShipSerial(benchmark::State& state)
+{
+	ThreadPool pool(1);
+	pool.submit([&]() { importShip(state, pool); }).get();
+}
+BENCHMARK(BM_ImportShipSerial)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// What load() does, materials and meshes spread over the global pool
+static void BM_ImportShipParallel(benchmark::State& state)
+{
+	importShip(state, ThreadPool::global());
+}
+BENCHMARK(BM_ImportShipParallel)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,68 @@
+
+cbuffer Camera : register(b0, space1)
+{
+	float3 uCameraPos;
+};
+
+cbuffer ModelViewProj : register(b1, space1)
+{
+	float4x4 uModel;
+	float4x4 uView;
+	float4x4 uProj;
+};
+
+// Mesh bounds the positions were quantized against
+cbuffer Quantization : register(b2, space1)
+{
+	float4 uCenter;
+	float4 uExtent;
+};
+
+// CompactVertex, normalized ints and halfs arrive as floats
+struct Input
+{
+	float4 Position : TEXCOORD0;
+	float2 Normal : TEXCOORD1;
+	float2 UV : TEXCOORD2;
+};
+
+struct Output
+{
+	float4 Position : SV_Position;
+	float3 Normal : TEXCOORD0;
+	float2 UV : TEXCOORD1;
+	float3 ViewDirection : TEXCOORD2;
+	float3 FragPos : TEXCOORD3;
+};
+
+// Unfold the octahedron, see VertexQuant::octDecode
+float3 octDecode(float2 oct)
+{
+	float3 n = float3(oct, 1.0f - abs(oct.x) - abs(oct.y));
+	float fold = saturate(-n.z);
+	n.xy += (n.xy >= 0.0f) ? -fold : fold;
+	return normalize(n);
+}
+
+Output main(Input input)
+{
+	Output output;
+
+	float3 position = uCenter.xyz + input.Position.xyz * uExtent.xyz;
+
+	// Calculate position with MVP matrix
+	float4 worldPos = mul(float4(position, 1.0f), uModel);
+	output.FragPos = worldPos.xyz;
+	output.ViewDirection = normalize(uCameraPos.xyz - worldPos.xyz);
+
+	float4 viewPos = mul(worldPos, uView);
+	output.Position = mul(viewPos, uProj);
+
+	// Pass normal
+	output.Normal = octDecode(input.Normal);
+
+	// Pass UV coords
+	output.UV = input.UV;
+
+	return output;
+}
@@ -1,6 +1,10 @@
 #include "core/Engine.h"
+#include "core/scene/AssetManager.h"
+#include "core/scene/AssetPack.h"
+#include "core/scene/SceneBinary.h"
 #include "core/scene/Serialize.h"
 #include "util/Logger.h"
+#include "util/ThreadPool.h"
 
 #include <SDL3/SDL_mouse.h>
 #include <SDL3/SDL_oldnames.h>
@@ -12,6 +16,8 @@
 
 #include <filesystem>
 #include <chrono>
+#include <system_error>
+#include <utility>
 
 namespace APE {
 
@@ -22,6 +28,13 @@ void Engine::init(
 {
 	APE_INFO("Launching Engine!");
 
+	// Shipped builds read every asset out of one archive, loose files
+	// under res/ still load when there is none
+	std::error_code ec;
+	if (std::filesystem::is_regular_file(AssetPack::DEFAULT_PATH, ec)) {
+		AssetPack::mount(AssetPack::DEFAULT_PATH);
+	}
+
 	// Initialize w/ default app settings
 	s_quit = false;
 	s_framerate = 60.f;
@@ -79,6 +92,15 @@ void Engine::pollEvents() noexcept
 
 void Engine::stepGameloop() noexcept
 {
+	// Finished background loads replace the world before anything reads it
+	swapPendingWorld();
+
+	// Completion callbacks of async asset loads may touch the world
+	AssetManager::dispatchCallbacks();
+
+	// Assets dropped by the last frame may now be evicted
+	(void)AssetManager::trim();
+
 	// Poll User Input
 	pollEvents();
 
@@ -88,6 +110,17 @@ void Engine::stepGameloop() noexcept
 	}
 	s_input.flush();
 
+	// Stream world cells around the camera
+	if (s_partition) {
+		s_partition->update(s_world, { s_camera->getPosition() });
+	}
+
+	// Refresh scene bounds for this frame's queries
+	s_world.updateSpatialIndex();
+
+	// Frame boundary for saves, the world is done changing until next update
+	s_saver.update(s_world);
+
 	// Draw to Screen
 	s_renderer->beginDrawing();
 
@@ -136,16 +169,160 @@ void Engine::run() noexcept
 
 void Engine::saveScene(std::filesystem::path save_path, Scene& world) noexcept
 {
+	if (SceneBinary::isBinaryScene(save_path)) {
+		SceneBinary::save(save_path, world);
+		return;
+	}
 	Serialize::saveScene(save_path, world);
 }
 
+void Engine::saveSceneAsync(std::filesystem::path save_path) noexcept
+{
+	s_saver.requestSave(std::move(save_path));
+}
+
+void Engine::setAutosave(
+	std::filesystem::path save_path,
+	Timing::seconds interval) noexcept
+{
+	s_saver.setAutosave(std::move(save_path), interval);
+}
+
+bool Engine::isSavingScene() noexcept
+{
+	return s_saver.isSaving();
+}
+
+const SceneSaveMetrics& Engine::sceneSaveMetrics() noexcept
+{
+	return s_saver.metrics();
+}
+
 bool Engine::loadScene(std::filesystem::path load_path, Scene& world) noexcept
 {
-	if (load_path.extension() == ".json") {
-		world = Serialize::loadScene(load_path);
-		return true;
+	bool b_binary = SceneBinary::isBinaryScene(load_path);
+	if (!b_binary && load_path.extension() != ".json") {
+		return false;
+	}
+
+	// Stage binary loads so a corrupt file leaves the current scene intact
+	Scene staged;
+	if (b_binary && !SceneBinary::load(load_path, staged)) {
+		return false;
+	}
+
+	// Streamed cells belong to the scene being replaced
+	if (&world == &s_world) {
+		s_partition.reset();
+	}
+
+	world = b_binary ? std::move(staged) : Serialize::loadScene(load_path);
+	return true;
+}
+
+bool Engine::loadSceneAsync(std::filesystem::path load_path) noexcept
+{
+	bool b_binary = SceneBinary::isBinaryScene(load_path);
+	if (!b_binary && load_path.extension() != ".json") {
+		return false;
 	}
-	return false;
+
+	if (isLoadingScene()) {
+		APE_WARN("Engine::loadSceneAsync() Already loading a scene, ignoring {}.",
+			load_path.string()
+		);
+		return false;
+	}
+
+	s_load_progress.reset();
+	s_pending_world = ThreadPool::global().submit(
+		[load_path, b_binary]() -> std::unique_ptr<Scene> {
+			try {
+				auto staged = std::make_unique<Scene>();
+				if (!b_binary) {
+					Serialize::loadScene(load_path, *staged, &s_load_progress);
+				}
+				else if (!SceneBinary::load(load_path, *staged, &s_load_progress)) {
+					return nullptr;
+				}
+
+				// Build bounds and the spatial index off the main thread too
+				s_load_progress.stage = SceneLoadProgress::Stage::Finalizing;
+				staged->updateSpatialIndex();
+
+				s_load_progress.stage = SceneLoadProgress::Stage::Done;
+				return staged;
+			}
+			catch (const std::exception& e) {
+				APE_ERROR("Engine::loadSceneAsync() Failed to load {}: {}",
+					load_path.string(),
+					e.what()
+				);
+				s_load_progress.stage = SceneLoadProgress::Stage::Failed;
+				return nullptr;
+			}
+		}
+	);
+	return true;
+}
+
+bool Engine::isLoadingScene() noexcept
+{
+	return s_pending_world.valid();
+}
+
+const SceneLoadProgress& Engine::sceneLoadProgress() noexcept
+{
+	return s_load_progress;
+}
+
+void Engine::swapPendingWorld() noexcept
+{
+	if (!s_pending_world.valid()) return;
+
+	auto status = s_pending_world.wait_for(std::chrono::seconds(0));
+	if (status != std::future_status::ready) return;
+
+	std::unique_ptr<Scene> staged = s_pending_world.get();
+	if (!staged) return;
+
+	// Streamed cells belong to the scene being replaced
+	s_partition.reset();
+
+	s_world = std::move(*staged);
+	APE_INFO("Swapped in new scene with {} entities.",
+		s_world.registry.numEntities()
+	);
+}
+
+bool Engine::streamWorld(
+	std::filesystem::path partition_dir,
+	PartitionSettings settings) noexcept
+{
+	stopStreaming();
+
+	s_partition = std::make_unique<WorldPartition>(partition_dir, settings);
+	if (s_partition->numCells() == 0) {
+		APE_ERROR("Engine::streamWorld() Failed: no cells in {}.",
+			partition_dir.string()
+		);
+		s_partition.reset();
+		return false;
+	}
+	return true;
+}
+
+void Engine::stopStreaming() noexcept
+{
+	if (!s_partition) return;
+
+	s_partition->unloadAll(s_world);
+	s_partition.reset();
+}
+
+WorldPartition* Engine::partition() noexcept
+{
+	return s_partition.get();
 }
 
 Render::Renderer* Engine::renderer() noexcept
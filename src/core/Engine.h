@@ -3,6 +3,9 @@
 #include "core/Application.h"
 #include "core/input/Input.h"
 #include "core/scene/Scene.h"
+#include "core/scene/SceneLoadProgress.h"
+#include "core/scene/SceneSaver.h"
+#include "core/scene/WorldPartition.h"
 #include "core/render/Camera.h"
 #include "core/render/Context.h"
 #include "core/render/Renderer.h"
@@ -12,6 +15,7 @@
 #include <SDL3/SDL_events.h>
 
 #include <filesystem>
+#include <future>
 #include <memory>
 #include <string_view>
 
@@ -24,6 +28,14 @@ private:
 	static inline std::vector<std::unique_ptr<Application>> s_layers;
 	static inline Input::State s_input;
 	static inline Scene s_world;
+	static inline std::unique_ptr<WorldPartition> s_partition;
+
+	// Scene being loaded in the background, swapped in between frames
+	static inline std::future<std::unique_ptr<Scene>> s_pending_world;
+	static inline SceneLoadProgress s_load_progress;
+
+	// Background saves, snapshotted at the end of a frame
+	static inline SceneSaver s_saver;
 
 	// Rendering
 	//
@@ -65,6 +77,34 @@ public:
 		std::filesystem::path load_path,
 		Scene& world) noexcept;
 
+	// Snapshot the world at the end of this frame and write it on a worker
+	static void saveSceneAsync(std::filesystem::path save_path) noexcept;
+
+	// Periodically save the world in the background, zero turns it off
+	static void setAutosave(
+		std::filesystem::path save_path,
+		Timing::seconds interval) noexcept;
+
+	[[nodiscard]] static bool isSavingScene() noexcept;
+
+	[[nodiscard]] static const SceneSaveMetrics& sceneSaveMetrics() noexcept;
+
+	// Parse on a worker and replace the world at the next frame boundary
+	static bool loadSceneAsync(std::filesystem::path load_path) noexcept;
+
+	[[nodiscard]] static bool isLoadingScene() noexcept;
+
+	[[nodiscard]] static const SceneLoadProgress& sceneLoadProgress() noexcept;
+
+	// Stream cells of a partitioned world in around the camera
+	static bool streamWorld(
+		std::filesystem::path partition_dir,
+		PartitionSettings settings = {}) noexcept;
+
+	static void stopStreaming() noexcept;
+
+	[[nodiscard]] static WorldPartition* partition() noexcept;
+
 
 	// Graphics Functions
 	[[nodiscard]] static Render::Renderer* renderer() noexcept;
@@ -95,6 +135,9 @@ public:
 	[[nodiscard]] static Timing::seconds getLastFrameTimeSec() noexcept;
 
 	[[nodiscard]] static Timing::millis getLastFrameTimeMS() noexcept;
+
+private:
+	static void swapPendingWorld() noexcept;
 };
 
 };	// end of namespace
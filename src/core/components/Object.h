@@ -1,6 +1,9 @@
 #pragma once
 
 #include "core/ecs/Registry.h"
+#include "physics/collisions/Colliders.h"
+#include "physics/collisions/Collisions.h"
+#include "util/StringId.h"
 
 #include <glm/glm.hpp>
 #include <glm/fwd.hpp>
@@ -9,8 +12,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/matrix_decompose.hpp>
 
-#include <string>
-#include <string_view>
+#include <algorithm>
 #include <vector>
 
 namespace APE {
@@ -19,9 +21,9 @@ struct HierarchyComponent {
 	static constexpr const char* Name = "Hierarchy";
 	ECS::EntityHandle parent;
 	std::vector<ECS::EntityHandle> children;
-	std::string tag;
+	StringId tag;
 
-	HierarchyComponent(std::string_view tag = "") noexcept
+	HierarchyComponent(StringId tag = {}) noexcept
 		: parent(-1)
 		, tag(tag)
 	{
@@ -78,5 +80,60 @@ struct TransformComponent {
 	}
 };
 
+/*
+* Cached world space bounds of an entity
+* Bounds are only recomputed when the world matrix passed to refresh() changes.
+*/
+struct WorldBoundsComponent {
+	static constexpr const char* Name = "World Bounds";
+	Physics::Collisions::AABB local;
+	Physics::Collisions::Sphere local_sphere;
+	Physics::Collisions::AABB world;
+	Physics::Collisions::Sphere world_sphere;
+	glm::mat4 world_mat;
+	bool b_valid;
+
+	WorldBoundsComponent(
+		const Physics::Collisions::AABB& local = {},
+		const Physics::Collisions::Sphere& local_sphere = {}) noexcept
+		: local(local)
+		, local_sphere(local_sphere)
+		, world_mat(1.f)
+		, b_valid(false)
+	{
+
+	}
+
+	// Force a recompute on the next refresh
+	void invalidate() noexcept
+	{
+		b_valid = false;
+	}
+
+	// Returns true if the world bounds were recomputed
+	bool refresh(const glm::mat4& model_mat) noexcept
+	{
+		if (b_valid && model_mat == world_mat) {
+			return false;
+		}
+
+		world_mat = model_mat;
+		world = Physics::Collisions::transformAABB(local, model_mat);
+
+		glm::vec3 scale(
+			glm::length(glm::vec3(model_mat[0])),
+			glm::length(glm::vec3(model_mat[1])),
+			glm::length(glm::vec3(model_mat[2]))
+		);
+		world_sphere = Physics::Collisions::Sphere(
+			glm::vec3(model_mat * glm::vec4(local_sphere.center, 1.f)),
+			local_sphere.radius * std::max(std::max(scale.x, scale.y), scale.z)
+		);
+
+		b_valid = true;
+		return true;
+	}
+};
+
 };	// end of namespace
 
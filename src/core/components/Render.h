@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/scene/AssetHandle.h"
+#include "core/scene/AssetManager.h"
 #include "core/render/Model.h"
 #include "core/render/Image.h"
 #include "core/scene/ImageLoader.h"
@@ -11,13 +12,17 @@ namespace APE::Render {
 
 struct MeshComponent {
 	static constexpr const char* Name = "Mesh";
-	AssetHandle<Model> model_handle;
+	// Keeps the model resident while the component exists
+	LiveAssetId model_id;
 	size_t mesh_index;
 
+	// Level drawn last frame, kept by the renderer and not saved
+	Uint32 lod_level = 0;
+
 	MeshComponent(
-		AssetHandle<Model> model_handle = {}, 
+		AssetId model_id = {},
 		size_t mesh_index = 0) noexcept
-		: model_handle(model_handle)
+		: model_id(model_id)
 		, mesh_index(mesh_index)
 	{
 
@@ -26,11 +31,11 @@ struct MeshComponent {
 
 struct MaterialComponent {
 	static constexpr const char* Name = "Material";
-	AssetHandle<Image> texture_handle;
+	LiveAssetId texture_id;
 
 	MaterialComponent(
-		AssetHandle<Image> texture_handle = ImageLoader::defaultImage()) noexcept
-		: texture_handle(texture_handle)
+		AssetId texture_id = ImageLoader::defaultImage().id) noexcept
+		: texture_id(texture_id)
 	{
 
 	}
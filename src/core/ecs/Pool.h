@@ -150,6 +150,33 @@ public:
 		return m_dense.back();
 	}
 
+	// Append components for entities not yet in the set as one block copy
+	void emplaceBulk(
+		const EntityID* ids,
+		const T* comps,
+		size_t count) noexcept
+	{
+		size_t base = m_dense.size();
+		m_sparse.reserve(m_sparse.size() + count);
+		for (size_t i = 0; i < count; ++i) {
+			APE_CHECK(!contains(ids[i]),
+				"Pool::emplaceBulk() Failed: set already contains entity {}'s component.",
+				ids[i]
+			);
+			m_sparse[ids[i]] = base + i;
+		}
+
+		m_dense.insert(m_dense.end(), comps, comps + count);
+		m_denseToID.insert(m_denseToID.end(), ids, ids + count);
+	}
+
+	void reserve(size_t capacity) noexcept
+	{
+		m_sparse.reserve(capacity);
+		m_dense.reserve(capacity);
+		m_denseToID.reserve(capacity);
+	}
+
 	template <typename... Args>
 	T& tryEmplace(EntityID id, Args&&... args) noexcept
 	{
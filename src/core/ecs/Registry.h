@@ -2,6 +2,7 @@
 
 #include "core/ecs/Pool.h"
 
+#include <atomic>
 #include <bitset>
 #include <cstdint>
 #include <tuple>
@@ -54,8 +55,9 @@ class Registry {
 		Bitmask component_mask;
 	};
 
-	inline static TypeID s_type_counter = 0;
-	inline static EntityID s_entity_counter = 0;
+	// Shared by every registry, including ones filled on loader threads
+	inline static std::atomic<TypeID> s_type_counter = 0;
+	inline static std::atomic<EntityID> s_entity_counter = 0;
 
 	Pool<EntityID, Entity> m_entities;
 	std::unordered_map<TypeID, std::unique_ptr<IPool>> m_pools;
@@ -226,15 +228,32 @@ public:
 		return EntityHandle { ent_id };
 	}
 
+	// Create a block of entities with contiguous ids, returns the first id
+	[[nodiscard]] EntityID createEntities(size_t count) noexcept
+	{
+		EntityID first = s_entity_counter.fetch_add(count);
+		m_entities.reserve(m_entities.size() + count);
+		for (EntityID id = first; id < first + count; ++id) {
+			m_entities.emplace(id, id, 0x0);
+		}
+		return first;
+	}
+
 	bool destroyEntity(EntityHandle ent) noexcept
 	{
-		if (!m_entities.remove(ent.id)) {
+		if (!isValid(ent)) {
 			APE_WARN("Tried to destroy untracked entity {}.", ent.id);
 			return false;
 		}
 
+		// Mask bits are type ids, so only touch pools the entity is in
+		Bitmask mask = m_entities.get(ent.id).component_mask;
+		(void)m_entities.remove(ent.id);
+
 		for (auto& [ type_id, pool ] : m_pools) {
-			pool->remove(ent.id);
+			if (mask.test(type_id)) {
+				pool->remove(ent.id);
+			}
 		}
 		return true;
 	}
@@ -262,6 +281,21 @@ public:
 		}
 	}
 
+	// Bulk copy components onto existing entities, ids must be unique
+	template <typename Component>
+	void emplaceComponents(
+		const EntityID* ids,
+		const Component* comps,
+		size_t count) noexcept
+	{
+		for (size_t i = 0; i < count; ++i) {
+			maskEntity<Component>({ ids[i] });
+		}
+
+		auto& pool = getPool<Component>();
+		pool.emplaceBulk(ids, comps, count);
+	}
+
 	template <typename Component, typename... Args>
 	Component& replaceComponent(EntityHandle ent, Args&&... args) noexcept
 	{
@@ -448,6 +482,26 @@ public:
 	}
 
 
+	/*
+	* Snapshots
+	*/
+	// Replace this registry with a copy of another's entities and only the
+	// listed pools, cheap enough to take once per frame for saving
+	template <typename... Components>
+	void copyFrom(const Registry& other) noexcept
+	{
+		m_entities = other.m_entities;
+		m_pools.clear();
+		(copyPool<Components>(other), ...);
+
+		// Drop mask bits for pools that weren't copied
+		Bitmask copied = (Bitmask() | ... | typeBitmask<Components>());
+		for (auto [id, ent] : m_entities) {
+			ent.component_mask &= copied;
+		}
+	}
+
+
 	/*
 	* Potential Future Additions
 	*/
@@ -467,15 +521,6 @@ private:
 		return s_entity_counter++;
 	}
 
-	[[nodiscard]] static Bitmask nextTypeBitmask() noexcept
-	{
-		static Bitmask curr_mask = 0x1;
-
-		Bitmask res = curr_mask;
-		curr_mask <<= 1;
-		return res;
-	}
-
 	template <typename Component>
 	[[nodiscard]] static TypeID typeID() noexcept
 	{
@@ -486,10 +531,30 @@ private:
 	template <typename Component>
 	[[nodiscard]] static Bitmask typeBitmask() noexcept
 	{
-		static const Bitmask mask = nextTypeBitmask();
+		// Derived from the type id so concurrent first use can't race
+		static const Bitmask mask = []() {
+			TypeID id = typeID<Component>();
+			APE_CHECK((id < MAX_NUM_COMPONENTS),
+				"Registry::typeBitmask() Failed: exceeded {} component types.",
+				MAX_NUM_COMPONENTS
+			);
+			return Bitmask().set(id);
+		}();
 		return mask;
 	}
 
+	template <typename Component>
+	void copyPool(const Registry& other) noexcept
+	{
+		TypeID type_id = typeID<Component>();
+		auto it = other.m_pools.find(type_id);
+		if (it == other.m_pools.end()) return;
+
+		m_pools[type_id] = std::make_unique<CPool<Component>>(
+			*static_cast<const CPool<Component>*>(it->second.get())
+		);
+	}
+
 	template <typename Component>
 	void maskEntity(const EntityHandle& ent) noexcept
 	{
@@ -0,0 +1,457 @@
+#include "core/io/AsyncFile.h"
+#include "util/Logger.h"
+#include "util/ThreadPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#ifdef APE_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace APE::IO {
+
+#ifdef APE_HAS_IO_URING
+
+namespace {
+
+constexpr unsigned RING_ENTRIES = 256;
+
+// sqe.len is 32 bits, larger files take several reads
+constexpr size_t MAX_READ = size_t(1) << 30;
+
+// Wakes the completion thread on shutdown
+constexpr uint64_t STOP_TAG = 0;
+
+[[nodiscard]] int ringSetup(unsigned entries, io_uring_params* params) noexcept
+{
+	return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+[[nodiscard]] int ringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) noexcept
+{
+	return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+[[nodiscard]] int ringRegister(int fd, unsigned opcode, const void* arg, unsigned num_args) noexcept
+{
+	return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, num_args));
+}
+
+template <typename T>
+[[nodiscard]] T* at(void* base, uint32_t offset) noexcept
+{
+	return reinterpret_cast<T*>(static_cast<std::byte*>(base) + offset);
+}
+
+};	// end of namespace
+
+/*
+* Submission and completion queues shared with the kernel
+* Submitters fill entries under a mutex and hand them over in one
+* io_uring_enter. A single thread reaps completions, continuing short
+* reads and passing finished requests to the thread pool.
+*/
+struct Service::Ring {
+	int fd = -1;
+	void* sq_ptr = nullptr;
+	void* cq_ptr = nullptr;
+	size_t sq_size = 0;
+	size_t cq_size = 0;
+	io_uring_sqe* sqes = nullptr;
+	size_t sqes_size = 0;
+
+	unsigned* sq_tail = nullptr;
+	unsigned* sq_mask = nullptr;
+	unsigned* sq_array = nullptr;
+	unsigned* cq_head = nullptr;
+	unsigned* cq_tail = nullptr;
+	unsigned* cq_mask = nullptr;
+	io_uring_cqe* cqes = nullptr;
+
+	std::mutex sq_mutex;
+	unsigned unsubmitted = 0;
+	bool b_buffers = false;
+
+	// One per queue entry, in flight reads never outnumber the queue
+	std::counting_semaphore<RING_ENTRIES> slots { RING_ENTRIES };
+	std::thread reaper;
+
+	~Ring() noexcept
+	{
+		if (reaper.joinable()) {
+			{
+				std::lock_guard lock(sq_mutex);
+				io_uring_sqe& sqe = nextSqe();
+				sqe.opcode = IORING_OP_NOP;
+				sqe.user_data = STOP_TAG;
+			}
+			flush();
+			reaper.join();
+		}
+
+		if (sqes) munmap(sqes, sqes_size);
+		if (cq_ptr && cq_ptr != sq_ptr) munmap(cq_ptr, cq_size);
+		if (sq_ptr) munmap(sq_ptr, sq_size);
+		if (fd >= 0) close(fd);
+	}
+
+	bool init() noexcept
+	{
+		io_uring_params params {};
+		fd = ringSetup(RING_ENTRIES, &params);
+		if (fd < 0) return false;
+
+		sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		bool b_single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+		if (b_single_mmap) sq_size = cq_size = std::max(sq_size, cq_size);
+
+		sq_ptr = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+		if (sq_ptr == MAP_FAILED) {
+			sq_ptr = nullptr;
+			return false;
+		}
+		cq_ptr = b_single_mmap ? sq_ptr : mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if (cq_ptr == MAP_FAILED) {
+			cq_ptr = nullptr;
+			return false;
+		}
+
+		sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		void* sqes_ptr = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+		if (sqes_ptr == MAP_FAILED) return false;
+		sqes = static_cast<io_uring_sqe*>(sqes_ptr);
+
+		sq_tail = at<unsigned>(sq_ptr, params.sq_off.tail);
+		sq_mask = at<unsigned>(sq_ptr, params.sq_off.ring_mask);
+		sq_array = at<unsigned>(sq_ptr, params.sq_off.array);
+		cq_head = at<unsigned>(cq_ptr, params.cq_off.head);
+		cq_tail = at<unsigned>(cq_ptr, params.cq_off.tail);
+		cq_mask = at<unsigned>(cq_ptr, params.cq_off.ring_mask);
+		cqes = at<io_uring_cqe>(cq_ptr, params.cq_off.cqes);
+
+		reaper = std::thread([this]() { reap(); });
+		return true;
+	}
+
+	// Under sq_mutex, the kernel consumes every entry on enter so the
+	// tail is never more than a queue ahead
+	io_uring_sqe& nextSqe() noexcept
+	{
+		unsigned tail = *sq_tail;
+		unsigned index = tail & *sq_mask;
+		io_uring_sqe& sqe = sqes[index];
+		std::memset(&sqe, 0, sizeof(sqe));
+		sq_array[index] = index;
+		std::atomic_ref(*sq_tail).store(tail + 1, std::memory_order_release);
+		++unsubmitted;
+		return sqe;
+	}
+
+	void flush() noexcept
+	{
+		std::lock_guard lock(sq_mutex);
+		while (unsubmitted > 0) {
+			int submitted = ringEnter(fd, unsubmitted, 0, 0);
+			if (submitted < 0) {
+				if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+					std::this_thread::yield();
+					continue;
+				}
+				APE_FATAL("IO::Service io_uring_enter failed - {}", std::strerror(errno));
+				return;
+			}
+			unsubmitted -= static_cast<unsigned>(submitted);
+		}
+	}
+
+	// Reads the rest of the request from where the last read stopped
+	void queueRead(Service::Request& request) noexcept
+	{
+		std::lock_guard lock(sq_mutex);
+		io_uring_sqe& sqe = nextSqe();
+		size_t num_read = request.result.num_bytes;
+		std::byte* dst = request.target.empty()
+			? request.result.bytes.data() + num_read
+			: request.target.data() + num_read;
+
+		sqe.fd = request.fd;
+		sqe.off = request.offset + num_read;
+		sqe.addr = reinterpret_cast<uint64_t>(dst);
+		sqe.len = static_cast<uint32_t>(std::min(request.size - num_read, MAX_READ));
+		sqe.user_data = reinterpret_cast<uint64_t>(&request);
+		if (request.buffer_index >= 0 && b_buffers) {
+			sqe.opcode = IORING_OP_READ_FIXED;
+			sqe.buf_index = static_cast<uint16_t>(request.buffer_index);
+		}
+		else {
+			sqe.opcode = IORING_OP_READ;
+		}
+	}
+
+	void reap() noexcept
+	{
+		bool b_stop = false;
+		while (!b_stop) {
+			unsigned head = *cq_head;
+			unsigned tail = std::atomic_ref(*cq_tail).load(std::memory_order_acquire);
+			if (head == tail) {
+				(void)ringEnter(fd, 0, 1, IORING_ENTER_GETEVENTS);
+				continue;
+			}
+
+			std::vector<std::pair<Service::Request*, int>> completed;
+			for (; head != tail; ++head) {
+				io_uring_cqe& cqe = cqes[head & *cq_mask];
+				if (cqe.user_data == STOP_TAG) {
+					b_stop = true;
+					continue;
+				}
+				completed.emplace_back(reinterpret_cast<Service::Request*>(cqe.user_data), cqe.res);
+			}
+			std::atomic_ref(*cq_head).store(head, std::memory_order_release);
+
+			// Requests were handed over through the kernel, which the
+			// language knows nothing about. Every one was queued under
+			// this mutex, taking it orders their writes before our reads.
+			{
+				std::lock_guard lock(sq_mutex);
+			}
+
+			bool b_queued = false;
+			for (auto [request, res] : completed) {
+				if (res > 0) request->result.num_bytes += static_cast<size_t>(res);
+
+				// Short reads keep their slot and go again
+				if (res > 0 && request->result.num_bytes < request->size) {
+					queueRead(*request);
+					b_queued = true;
+					continue;
+				}
+
+				// A file truncated since fstat ends early, which the
+				// blocking backend reports as EIO too
+				if (res < 0) request->result.error = -res;
+				else if (request->result.num_bytes < request->size) request->result.error = EIO;
+				finish(*request);
+			}
+			if (b_queued) flush();
+		}
+	}
+
+	void finish(Service::Request& request) noexcept
+	{
+		close(request.fd);
+		request.fd = -1;
+		if (request.target.empty()) {
+			request.result.bytes.resize(request.result.num_bytes);
+		}
+		slots.release();
+
+		// Decoding runs on the pool while this thread keeps reaping
+		(void)ThreadPool::global().submit([&request]() { request.on_done(); });
+	}
+};
+
+#else
+
+struct Service::Ring {
+	bool b_buffers = false;
+};
+
+#endif
+
+Service::Service(Backend backend) noexcept
+	: m_backend(Backend::ThreadPool)
+{
+#ifdef APE_HAS_IO_URING
+	if (backend != Backend::ThreadPool) {
+		auto ring = std::make_unique<Ring>();
+		if (ring->init()) {
+			m_ring = std::move(ring);
+			m_backend = Backend::IoUring;
+		}
+		else {
+			APE_WARN("IO::Service io_uring unavailable, reading on the thread pool.");
+		}
+	}
+#else
+	if (backend == Backend::IoUring) {
+		APE_WARN("IO::Service Built without io_uring, reading on the thread pool.");
+	}
+#endif
+}
+
+Service::~Service() noexcept = default;
+
+Service& Service::global() noexcept
+{
+	static Service s_service;
+	return s_service;
+}
+
+bool Service::registerBuffers(std::span<const std::span<std::byte>> buffers) noexcept
+{
+#ifdef APE_HAS_IO_URING
+	if (!m_ring) return true;
+
+	std::vector<iovec> iovecs;
+	for (auto& buffer : buffers) {
+		iovecs.push_back(iovec { .iov_base = buffer.data(), .iov_len = buffer.size() });
+	}
+
+	std::lock_guard lock(m_ring->sq_mutex);
+	if (m_ring->b_buffers) {
+		(void)ringRegister(m_ring->fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+		m_ring->b_buffers = false;
+	}
+	if (iovecs.empty()) return true;
+
+	if (ringRegister(m_ring->fd, IORING_REGISTER_BUFFERS, iovecs.data(), static_cast<unsigned>(iovecs.size())) < 0) {
+		// Usually RLIMIT_MEMLOCK, plain reads still work
+		APE_WARN("IO::Service::registerBuffers() Failed - {}", std::strerror(errno));
+		return false;
+	}
+	m_ring->b_buffers = true;
+	return true;
+#else
+	(void)buffers;
+	return true;
+#endif
+}
+
+Service::ReadOp Service::readFile(std::filesystem::path path) noexcept
+{
+	return ReadOp(*this, Request { .path = std::move(path) });
+}
+
+Service::BatchOp Service::readFiles(std::vector<std::filesystem::path> paths) noexcept
+{
+	std::vector<Request> requests;
+	requests.reserve(paths.size());
+	for (auto& path : paths) {
+		requests.push_back(Request { .path = std::move(path) });
+	}
+	return BatchOp(*this, std::move(requests));
+}
+
+Service::ReadOp Service::readInto(
+	std::filesystem::path path,
+	std::span<std::byte> target,
+	uint64_t offset,
+	int buffer_index) noexcept
+{
+	return ReadOp(*this, Request {
+		.path = std::move(path),
+		.target = target,
+		.offset = offset,
+		.buffer_index = buffer_index,
+	});
+}
+
+void Service::submit(std::span<Request* const> requests) noexcept
+{
+	if (m_ring) {
+		submitRing(requests);
+		return;
+	}
+
+	for (Request* request : requests) {
+		(void)ThreadPool::global().submit([request]() {
+			readBlocking(*request);
+			request->on_done();
+		});
+	}
+}
+
+void Service::submitRing(std::span<Request* const> requests) noexcept
+{
+#ifdef APE_HAS_IO_URING
+	for (Request* request : requests) {
+		// Opening stays blocking, it's the reads that batch
+		request->fd = open(request->path.c_str(), O_RDONLY | O_CLOEXEC);
+		struct stat st;
+		if (request->fd < 0 || fstat(request->fd, &st) != 0) {
+			request->result.error = errno;
+			if (request->fd >= 0) close(request->fd);
+			request->fd = -1;
+			request->on_done();
+			continue;
+		}
+
+		uint64_t file_size = static_cast<uint64_t>(st.st_size);
+		uint64_t available = request->offset < file_size ? file_size - request->offset : 0;
+		if (request->target.empty()) {
+			request->size = static_cast<size_t>(available);
+			request->result.bytes.resize(request->size);
+		}
+		else {
+			request->size = static_cast<size_t>(std::min<uint64_t>(available, request->target.size()));
+		}
+
+		if (request->size == 0) {
+			close(request->fd);
+			request->fd = -1;
+			request->on_done();
+			continue;
+		}
+
+		// A full queue is flushed before waiting for a slot, so the reads
+		// holding the slots can finish
+		if (!m_ring->slots.try_acquire()) {
+			m_ring->flush();
+			m_ring->slots.acquire();
+		}
+		m_ring->queueRead(*request);
+	}
+	m_ring->flush();
+#else
+	(void)requests;
+#endif
+}
+
+void Service::readBlocking(Request& request) noexcept
+{
+	std::ifstream is(request.path, std::ios::binary | std::ios::ate);
+	if (!is) {
+		std::error_code ec;
+		request.result.error = std::filesystem::exists(request.path, ec) ? EIO : ENOENT;
+		return;
+	}
+
+	uint64_t file_size = static_cast<uint64_t>(is.tellg());
+	uint64_t available = request.offset < file_size ? file_size - request.offset : 0;
+	std::span<std::byte> dst = request.target;
+	if (dst.empty()) {
+		request.result.bytes.resize(static_cast<size_t>(available));
+		dst = request.result.bytes;
+	}
+	else {
+		dst = dst.first(static_cast<size_t>(std::min<uint64_t>(available, dst.size())));
+	}
+
+	is.seekg(static_cast<std::streamoff>(request.offset));
+	is.read(reinterpret_cast<char*>(dst.data()), static_cast<std::streamsize>(dst.size()));
+	request.result.num_bytes = static_cast<size_t>(is.gcount());
+	if (request.result.num_bytes != dst.size()) {
+		request.result.error = EIO;
+	}
+	if (request.target.empty()) {
+		request.result.bytes.resize(request.result.num_bytes);
+	}
+}
+
+};	// end of namespace
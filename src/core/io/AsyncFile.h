@@ -0,0 +1,320 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <semaphore>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace APE::IO {
+
+struct ReadResult {
+	// Whole file reads, readInto fills the caller's buffer instead
+	std::vector<std::byte> bytes;
+	size_t num_bytes = 0;
+	// errno style, 0 on success
+	int error = 0;
+
+	[[nodiscard]] explicit operator bool() const noexcept
+	{
+		return error == 0;
+	}
+};
+
+/*
+* Lazy coroutine returned by anything that co_awaits file reads
+* Starts when awaited, or when get() blocks on it. Continuations run on
+* whichever thread finished the read, usually a thread pool worker.
+*/
+template <typename T>
+class Task {
+public:
+	struct promise_type {
+		std::optional<T> value;
+		std::coroutine_handle<> continuation;
+		std::binary_semaphore* done = nullptr;
+
+		Task get_return_object() noexcept
+		{
+			return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		auto final_suspend() noexcept
+		{
+			struct Final {
+				bool await_ready() noexcept
+				{
+					return false;
+				}
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+				{
+					auto& promise = handle.promise();
+					if (promise.continuation) return promise.continuation;
+					if (promise.done) promise.done->release();
+					return std::noop_coroutine();
+				}
+
+				void await_resume() noexcept
+				{
+
+				}
+			};
+			return Final {};
+		}
+
+		void return_value(T val) noexcept
+		{
+			value = std::move(val);
+		}
+
+		void unhandled_exception() noexcept
+		{
+			std::terminate();
+		}
+	};
+
+private:
+	std::coroutine_handle<promise_type> m_handle;
+
+	explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+		: m_handle(handle)
+	{
+
+	}
+
+public:
+	Task(const Task& other) = delete;
+	Task& operator=(const Task& other) = delete;
+
+	Task(Task&& other) noexcept
+		: m_handle(std::exchange(other.m_handle, nullptr))
+	{
+
+	}
+
+	Task& operator=(Task&& other) noexcept
+	{
+		if (this != &other) {
+			if (m_handle) m_handle.destroy();
+			m_handle = std::exchange(other.m_handle, nullptr);
+		}
+		return *this;
+	}
+
+	~Task() noexcept
+	{
+		if (m_handle) m_handle.destroy();
+	}
+
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+	{
+		m_handle.promise().continuation = continuation;
+		return m_handle;
+	}
+
+	T await_resume() noexcept
+	{
+		return std::move(*m_handle.promise().value);
+	}
+
+	// Blocks the calling thread, not for use on a thread pool worker the
+	// reads might need
+	[[nodiscard]] T get() noexcept
+	{
+		std::binary_semaphore done(0);
+		m_handle.promise().done = &done;
+		m_handle.resume();
+		done.acquire();
+		return std::move(*m_handle.promise().value);
+	}
+};
+
+/*
+* Asynchronous file reads
+* On Linux builds with APE_HAS_IO_URING, reads go through an io_uring: a
+* batch of reads is one system call, and a completion thread hands
+* finished reads to the thread pool, so decoding one file overlaps reading
+* the next. Anywhere else, or if the kernel refuses a ring, every read is
+* a blocking job on the thread pool.
+*/
+class Service {
+public:
+	enum class Backend {
+		Auto,
+		IoUring,
+		ThreadPool,
+	};
+
+	// One read in flight, lives in the awaiting coroutine's frame
+	struct Request {
+		std::filesystem::path path;
+		// readInto's target, whole file reads fill result.bytes
+		std::span<std::byte> target;
+		uint64_t offset = 0;
+		// Registered buffer the target lies in, -1 for none
+		int buffer_index = -1;
+		ReadResult result;
+		std::function<void()> on_done;
+
+		// Backend state
+		int fd = -1;
+		size_t size = 0;
+	};
+
+	class ReadOp;
+	class BatchOp;
+
+private:
+	struct Ring;
+
+	Backend m_backend;
+	std::unique_ptr<Ring> m_ring;
+
+public:
+	explicit Service(Backend backend = Backend::Auto) noexcept;
+	~Service() noexcept;
+
+	Service(const Service& other) = delete;
+	Service& operator=(const Service& other) = delete;
+
+	[[nodiscard]] static Service& global() noexcept;
+
+	// IoUring or ThreadPool, Auto resolves at construction
+	[[nodiscard]] Backend backend() const noexcept
+	{
+		return m_backend;
+	}
+
+	// Pins buffers for readInto with a buffer index, which saves the
+	// kernel mapping them on every read. Replaces earlier buffers, so call
+	// it while nothing is in flight.
+	bool registerBuffers(std::span<const std::span<std::byte>> buffers) noexcept;
+
+	[[nodiscard]] ReadOp readFile(std::filesystem::path path) noexcept;
+
+	// One submission for every read, results in path order
+	[[nodiscard]] BatchOp readFiles(std::vector<std::filesystem::path> paths) noexcept;
+
+	// Up to target.size() bytes from offset
+	[[nodiscard]] ReadOp readInto(
+		std::filesystem::path path,
+		std::span<std::byte> target,
+		uint64_t offset = 0,
+		int buffer_index = -1) noexcept;
+
+	// on_done runs once per request, possibly before this returns
+	void submit(std::span<Request* const> requests) noexcept;
+
+private:
+	void submitRing(std::span<Request* const> requests) noexcept;
+
+	static void readBlocking(Request& request) noexcept;
+};
+
+class Service::ReadOp {
+private:
+	Service* m_service;
+	Request m_request;
+
+public:
+	ReadOp(Service& service, Request request) noexcept
+		: m_service(&service)
+		, m_request(std::move(request))
+	{
+
+	}
+
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	void await_suspend(std::coroutine_handle<> handle) noexcept
+	{
+		m_request.on_done = [handle]() { handle.resume(); };
+		Request* request = &m_request;
+		m_service->submit({ &request, 1 });
+	}
+
+	ReadResult await_resume() noexcept
+	{
+		return std::move(m_request.result);
+	}
+};
+
+class Service::BatchOp {
+private:
+	Service* m_service;
+	std::vector<Request> m_requests;
+	std::atomic<size_t> m_remaining;
+
+public:
+	BatchOp(Service& service, std::vector<Request> requests) noexcept
+		: m_service(&service)
+		, m_requests(std::move(requests))
+		, m_remaining(0)
+	{
+
+	}
+
+	bool await_ready() const noexcept
+	{
+		return m_requests.empty();
+	}
+
+	void await_suspend(std::coroutine_handle<> handle) noexcept
+	{
+		// The last read to finish resumes the caller
+		m_remaining = m_requests.size();
+		std::vector<Request*> pending;
+		for (auto& request : m_requests) {
+			request.on_done = [this, handle]() {
+				if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) handle.resume();
+			};
+			pending.push_back(&request);
+		}
+		m_service->submit(pending);
+	}
+
+	std::vector<ReadResult> await_resume() noexcept
+	{
+		std::vector<ReadResult> results;
+		results.reserve(m_requests.size());
+		for (auto& request : m_requests) {
+			results.push_back(std::move(request.result));
+		}
+		return results;
+	}
+};
+
+// Through the global service
+[[nodiscard]] inline Service::ReadOp readFile(std::filesystem::path path) noexcept
+{
+	return Service::global().readFile(std::move(path));
+}
+
+[[nodiscard]] inline Service::BatchOp readFiles(std::vector<std::filesystem::path> paths) noexcept
+{
+	return Service::global().readFiles(std::move(paths));
+}
+
+};	// end of namespace
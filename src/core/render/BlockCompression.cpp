@@ -0,0 +1,708 @@
+#include "core/render/BlockCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define APE_BC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace APE::Render::BC {
+
+namespace {
+
+/*
+* Shared fitting helpers
+*/
+
+// Principal axis of the texels' first N channels by power iteration
+template <int N>
+void principalAxis(
+	const uint8_t* rgba,
+	std::array<float, N>& mean,
+	std::array<float, N>& axis) noexcept
+{
+	mean.fill(0.f);
+	for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		for (int c = 0; c < N; ++c) mean[c] += rgba[i * 4 + c];
+	}
+	for (int c = 0; c < N; ++c) mean[c] /= BLOCK_TEXELS;
+
+	float cov[N][N] = {};
+	for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		float d[N];
+		for (int c = 0; c < N; ++c) d[c] = rgba[i * 4 + c] - mean[c];
+		for (int r = 0; r < N; ++r) {
+			for (int c = 0; c < N; ++c) cov[r][c] += d[r] * d[c];
+		}
+	}
+
+	// Start from the diagonal of the bounding box, it's rarely orthogonal
+	for (int c = 0; c < N; ++c) {
+		float lo = 255.f, hi = 0.f;
+		for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+			lo = std::min<float>(lo, rgba[i * 4 + c]);
+			hi = std::max<float>(hi, rgba[i * 4 + c]);
+		}
+		axis[c] = hi - lo;
+	}
+
+	for (int iter = 0; iter < 8; ++iter) {
+		std::array<float, N> next {};
+		for (int r = 0; r < N; ++r) {
+			for (int c = 0; c < N; ++c) next[r] += cov[r][c] * axis[c];
+		}
+
+		float len_sq = 0.f;
+		for (int c = 0; c < N; ++c) len_sq += next[c] * next[c];
+		if (len_sq < 1e-12f) break;
+
+		float inv_len = 1.f / std::sqrt(len_sq);
+		for (int c = 0; c < N; ++c) axis[c] = next[c] * inv_len;
+	}
+}
+
+// Endpoints at the extremes of the texels projected onto the axis
+template <int N>
+void axisEndpoints(
+	const uint8_t* rgba,
+	const std::array<float, N>& mean,
+	const std::array<float, N>& axis,
+	std::array<float, N>& e0,
+	std::array<float, N>& e1) noexcept
+{
+	float t_min = std::numeric_limits<float>::max();
+	float t_max = std::numeric_limits<float>::lowest();
+	for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		float t = 0.f;
+		for (int c = 0; c < N; ++c) t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+		t_min = std::min(t_min, t);
+		t_max = std::max(t_max, t);
+	}
+
+	for (int c = 0; c < N; ++c) {
+		e0[c] = std::clamp(mean[c] + axis[c] * t_max, 0.f, 255.f);
+		e1[c] = std::clamp(mean[c] + axis[c] * t_min, 0.f, 255.f);
+	}
+}
+
+void writeLE16(uint8_t* out, uint16_t val) noexcept
+{
+	out[0] = static_cast<uint8_t>(val & 0xFF);
+	out[1] = static_cast<uint8_t>(val >> 8);
+}
+
+[[nodiscard]] uint16_t readLE16(const uint8_t* in) noexcept
+{
+	return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+
+/*
+* BC1 color block, always 4 color mode
+*/
+[[nodiscard]] uint16_t to565(const std::array<float, 3>& c) noexcept
+{
+	auto q = [](float v, float max) {
+		return static_cast<uint16_t>(std::clamp(std::lround(v * max / 255.f), 0l, static_cast<long>(max)));
+	};
+	return static_cast<uint16_t>((q(c[0], 31.f) << 11) | (q(c[1], 63.f) << 5) | q(c[2], 31.f));
+}
+
+void from565(uint16_t c, uint8_t* rgb) noexcept
+{
+	uint8_t r = (c >> 11) & 31;
+	uint8_t g = (c >> 5) & 63;
+	uint8_t b = c & 31;
+	rgb[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+	rgb[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+	rgb[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+}
+
+void colorPalette(uint16_t c0, uint16_t c1, uint8_t palette[4][4]) noexcept
+{
+	from565(c0, palette[0]);
+	from565(c1, palette[1]);
+	for (int c = 0; c < 3; ++c) {
+		palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c]) / 3);
+		palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c]) / 3);
+	}
+	for (int i = 0; i < 4; ++i) palette[i][3] = 255;
+}
+
+void colorIndices(const uint8_t* rgba, const uint8_t palette[4][4], uint8_t indices[16]) noexcept
+{
+#if APE_BC_SSE2
+	detail::colorIndicesSimd(rgba, palette, indices);
+#else
+	detail::colorIndicesScalar(rgba, palette, indices);
+#endif
+}
+
+// Least squares endpoints for fixed indices, keeps the old ones if singular
+void refineColorEndpoints(
+	const uint8_t* rgba,
+	const uint8_t indices[16],
+	std::array<float, 3>& e0,
+	std::array<float, 3>& e1) noexcept
+{
+	constexpr float WEIGHTS[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+
+	float aa = 0.f, ab = 0.f, bb = 0.f;
+	std::array<float, 3> ax {}, bx {};
+	for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		float a = WEIGHTS[indices[i]];
+		float b = 1.f - a;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (int c = 0; c < 3; ++c) {
+			ax[c] += a * rgba[i * 4 + c];
+			bx[c] += b * rgba[i * 4 + c];
+		}
+	}
+
+	float det = aa * bb - ab * ab;
+	if (std::abs(det) < 1e-6f) return;
+
+	float inv_det = 1.f / det;
+	for (int c = 0; c < 3; ++c) {
+		e0[c] = std::clamp((bb * ax[c] - ab * bx[c]) * inv_det, 0.f, 255.f);
+		e1[c] = std::clamp((aa * bx[c] - ab * ax[c]) * inv_det, 0.f, 255.f);
+	}
+}
+
+[[nodiscard]] uint32_t colorError(const uint8_t* rgba, const uint8_t palette[4][4], const uint8_t indices[16]) noexcept
+{
+	uint32_t err = 0;
+	for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		for (int c = 0; c < 3; ++c) {
+			int d = rgba[i * 4 + c] - palette[indices[i]][c];
+			err += static_cast<uint32_t>(d * d);
+		}
+	}
+	return err;
+}
+
+void encodeColorBlock(const uint8_t* rgba, uint8_t* out) noexcept
+{
+	std::array<float, 3> mean, axis, e0, e1;
+	principalAxis<3>(rgba, mean, axis);
+	axisEndpoints<3>(rgba, mean, axis, e0, e1);
+
+	auto fit = [&](const std::array<float, 3>& a, const std::array<float, 3>& b,
+		uint16_t& c0, uint16_t& c1, uint8_t palette[4][4], uint8_t indices[16])
+	{
+		c0 = to565(a);
+		c1 = to565(b);
+		if (c0 < c1) std::swap(c0, c1);
+		colorPalette(c0, c1, palette);
+		colorIndices(rgba, palette, indices);
+		return colorError(rgba, palette, indices);
+	};
+
+	uint16_t c0, c1;
+	uint8_t palette[4][4];
+	uint8_t indices[16];
+	uint32_t err = fit(e0, e1, c0, c1, palette, indices);
+
+	// One least squares pass, kept only if it helps
+	if (c0 != c1) {
+		std::array<float, 3> r0 = e0, r1 = e1;
+		refineColorEndpoints(rgba, indices, r0, r1);
+
+		uint16_t rc0, rc1;
+		uint8_t r_palette[4][4];
+		uint8_t r_indices[16];
+		if (fit(r0, r1, rc0, rc1, r_palette, r_indices) < err) {
+			c0 = rc0;
+			c1 = rc1;
+			std::memcpy(indices, r_indices, sizeof(indices));
+		}
+	}
+
+	// Equal endpoints would select 3 color mode, every index picks c0
+	uint32_t bits = 0;
+	if (c0 != c1) {
+		for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+			bits |= static_cast<uint32_t>(indices[i]) << (2 * i);
+		}
+	}
+
+	writeLE16(out, c0);
+	writeLE16(out + 2, c1);
+	for (int i = 0; i < 4; ++i) {
+		out[4 + i] = static_cast<uint8_t>(bits >> (8 * i));
+	}
+}
+
+void decodeColorBlock(const uint8_t* in, uint8_t* rgba, bool b_allow_3color) noexcept
+{
+	uint16_t c0 = readLE16(in);
+	uint16_t c1 = readLE16(in + 2);
+
+	uint8_t palette[4][4];
+	colorPalette(c0, c1, palette);
+	if (b_allow_3color && c0 <= c1) {
+		for (int c = 0; c < 3; ++c) {
+			palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+			palette[3][c] = 0;
+		}
+		palette[3][3] = 0;
+	}
+
+	uint32_t bits = in[4] | (in[5] << 8) | (in[6] << 16) | (static_cast<uint32_t>(in[7]) << 24);
+	for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		std::memcpy(rgba + i * 4, palette[(bits >> (2 * i)) & 3], 4);
+	}
+}
+
+
+/*
+* BC4 single channel block, 8 value mode
+*/
+void channelPalette(uint8_t a0, uint8_t a1, uint8_t palette[8]) noexcept
+{
+	palette[0] = a0;
+	palette[1] = a1;
+	if (a0 > a1) {
+		for (int i = 1; i <= 6; ++i) {
+			palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1) / 7);
+		}
+	}
+	else {
+		for (int i = 1; i <= 4; ++i) {
+			palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1) / 5);
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+void encodeChannelBlock(const uint8_t* rgba, int channel, uint8_t* out) noexcept
+{
+	uint8_t lo = 255, hi = 0;
+	for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		lo = std::min(lo, rgba[i * 4 + channel]);
+		hi = std::max(hi, rgba[i * 4 + channel]);
+	}
+
+	out[0] = hi;
+	out[1] = lo;
+
+	uint8_t palette[8];
+	channelPalette(hi, lo, palette);
+
+	uint64_t bits = 0;
+	if (hi != lo) {
+		for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+			int val = rgba[i * 4 + channel];
+			int best = 0;
+			int best_err = std::numeric_limits<int>::max();
+			for (int k = 0; k < 8; ++k) {
+				int err = std::abs(val - palette[k]);
+				if (err < best_err) {
+					best_err = err;
+					best = k;
+				}
+			}
+			bits |= static_cast<uint64_t>(best) << (3 * i);
+		}
+	}
+
+	for (int i = 0; i < 6; ++i) {
+		out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+	}
+}
+
+void decodeChannelBlock(const uint8_t* in, int channel, uint8_t* rgba) noexcept
+{
+	uint8_t palette[8];
+	channelPalette(in[0], in[1], palette);
+
+	uint64_t bits = 0;
+	for (int i = 0; i < 6; ++i) {
+		bits |= static_cast<uint64_t>(in[2 + i]) << (8 * i);
+	}
+	for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		rgba[i * 4 + channel] = palette[(bits >> (3 * i)) & 7];
+	}
+}
+
+
+/*
+* BC7 mode 6, RGBA endpoints of 7 bits plus a p-bit each, 4 bit indices
+*/
+constexpr int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+class BlockBits {
+private:
+	uint8_t* m_bytes;
+	Uint32 m_pos;
+
+public:
+	BlockBits(uint8_t* bytes) noexcept
+		: m_bytes(bytes)
+		, m_pos(0)
+	{
+
+	}
+
+	void write(uint32_t val, Uint32 num_bits) noexcept
+	{
+		for (Uint32 i = 0; i < num_bits; ++i, ++m_pos) {
+			if ((val >> i) & 1) m_bytes[m_pos / 8] |= static_cast<uint8_t>(1 << (m_pos % 8));
+		}
+	}
+
+	[[nodiscard]] uint32_t read(Uint32 num_bits) noexcept
+	{
+		uint32_t val = 0;
+		for (Uint32 i = 0; i < num_bits; ++i, ++m_pos) {
+			val |= static_cast<uint32_t>((m_bytes[m_pos / 8] >> (m_pos % 8)) & 1) << i;
+		}
+		return val;
+	}
+};
+
+// Best 7 bit values for one endpoint under either p-bit
+void quantizeBC7Endpoint(const std::array<float, 4>& e, uint8_t q[4], uint8_t& p) noexcept
+{
+	float best_err = std::numeric_limits<float>::max();
+	for (uint8_t p_bit = 0; p_bit < 2; ++p_bit) {
+		uint8_t cand[4];
+		float err = 0.f;
+		for (int c = 0; c < 4; ++c) {
+			long v = std::lround((e[c] - p_bit) / 2.f);
+			cand[c] = static_cast<uint8_t>(std::clamp(v, 0l, 127l));
+			float d = static_cast<float>((cand[c] << 1) | p_bit) - e[c];
+			err += d * d;
+		}
+		if (err < best_err) {
+			best_err = err;
+			p = p_bit;
+			std::memcpy(q, cand, 4);
+		}
+	}
+}
+
+void bc7Palette(const uint8_t q0[4], uint8_t p0, const uint8_t q1[4], uint8_t p1, uint8_t palette[16][4]) noexcept
+{
+	for (int c = 0; c < 4; ++c) {
+		int a = (q0[c] << 1) | p0;
+		int b = (q1[c] << 1) | p1;
+		for (int i = 0; i < 16; ++i) {
+			palette[i][c] = static_cast<uint8_t>(((64 - BC7_WEIGHTS[i]) * a + BC7_WEIGHTS[i] * b + 32) >> 6);
+		}
+	}
+}
+
+};	// end of namespace
+
+
+/*
+* Public entry points
+*/
+void detail::colorIndicesScalar(const uint8_t* rgba, const uint8_t palette[4][4], uint8_t indices[16]) noexcept
+{
+	for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		int best = 0;
+		int best_dist = std::numeric_limits<int>::max();
+		for (int k = 0; k < 4; ++k) {
+			int dist = 0;
+			for (int c = 0; c < 3; ++c) {
+				int d = rgba[i * 4 + c] - palette[k][c];
+				dist += d * d;
+			}
+			if (dist < best_dist) {
+				best_dist = dist;
+				best = k;
+			}
+		}
+		indices[i] = static_cast<uint8_t>(best);
+	}
+}
+
+void detail::colorIndicesSimd(const uint8_t* rgba, const uint8_t palette[4][4], uint8_t indices[16]) noexcept
+{
+#if APE_BC_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+
+	__m128i pal16[4];
+	for (int k = 0; k < 4; ++k) {
+		pal16[k] = _mm_set_epi16(
+			0, palette[k][2], palette[k][1], palette[k][0],
+			0, palette[k][2], palette[k][1], palette[k][0]
+		);
+	}
+
+	// Four texels per pass, squared RGB distance to each palette entry
+	for (int group = 0; group < 4; ++group) {
+		__m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + group * 16));
+		px = _mm_and_si128(px, rgb_mask);
+		__m128i lo = _mm_unpacklo_epi8(px, zero);
+		__m128i hi = _mm_unpackhi_epi8(px, zero);
+
+		__m128i best_dist = _mm_set1_epi32(std::numeric_limits<int>::max());
+		__m128i best_idx = zero;
+		for (int k = 0; k < 4; ++k) {
+			__m128i d_lo = _mm_sub_epi16(lo, pal16[k]);
+			__m128i d_hi = _mm_sub_epi16(hi, pal16[k]);
+			__m128 m_lo = _mm_castsi128_ps(_mm_madd_epi16(d_lo, d_lo));
+			__m128 m_hi = _mm_castsi128_ps(_mm_madd_epi16(d_hi, d_hi));
+
+			// Pairs of (r*r + g*g, b*b) per texel summed into one lane each
+			__m128i rg = _mm_castps_si128(_mm_shuffle_ps(m_lo, m_hi, _MM_SHUFFLE(2, 0, 2, 0)));
+			__m128i b = _mm_castps_si128(_mm_shuffle_ps(m_lo, m_hi, _MM_SHUFFLE(3, 1, 3, 1)));
+			__m128i dist = _mm_add_epi32(rg, b);
+
+			// Strictly less keeps the lowest index on ties, like the scalar path
+			__m128i closer = _mm_cmplt_epi32(dist, best_dist);
+			best_dist = _mm_or_si128(_mm_and_si128(closer, dist), _mm_andnot_si128(closer, best_dist));
+			best_idx = _mm_or_si128(
+				_mm_and_si128(closer, _mm_set1_epi32(k)),
+				_mm_andnot_si128(closer, best_idx)
+			);
+		}
+
+		alignas(16) int32_t idx[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(idx), best_idx);
+		for (int i = 0; i < 4; ++i) {
+			indices[group * 4 + i] = static_cast<uint8_t>(idx[i]);
+		}
+	}
+#else
+	colorIndicesScalar(rgba, palette, indices);
+#endif
+}
+
+void encodeBC1(const uint8_t* rgba, uint8_t* out) noexcept
+{
+	encodeColorBlock(rgba, out);
+}
+
+void encodeBC3(const uint8_t* rgba, uint8_t* out) noexcept
+{
+	encodeChannelBlock(rgba, 3, out);
+	encodeColorBlock(rgba, out + 8);
+}
+
+void encodeBC5(const uint8_t* rgba, uint8_t* out) noexcept
+{
+	encodeChannelBlock(rgba, 0, out);
+	encodeChannelBlock(rgba, 1, out + 8);
+}
+
+void encodeBC7(const uint8_t* rgba, uint8_t* out) noexcept
+{
+	std::array<float, 4> mean, axis, e0, e1;
+	principalAxis<4>(rgba, mean, axis);
+	axisEndpoints<4>(rgba, mean, axis, e0, e1);
+
+	uint8_t q0[4], q1[4], p0 = 0, p1 = 0;
+	quantizeBC7Endpoint(e0, q0, p0);
+	quantizeBC7Endpoint(e1, q1, p1);
+
+	uint8_t palette[16][4];
+	bc7Palette(q0, p0, q1, p1, palette);
+
+	uint8_t indices[16];
+	for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		int best = 0;
+		int best_dist = std::numeric_limits<int>::max();
+		for (int k = 0; k < 16; ++k) {
+			int dist = 0;
+			for (int c = 0; c < 4; ++c) {
+				int d = rgba[i * 4 + c] - palette[k][c];
+				dist += d * d;
+			}
+			if (dist < best_dist) {
+				best_dist = dist;
+				best = k;
+			}
+		}
+		indices[i] = static_cast<uint8_t>(best);
+	}
+
+	// The anchor texel's index drops its high bit, so it must be below 8
+	if (indices[0] >= 8) {
+		std::swap(q0, q1);
+		std::swap(p0, p1);
+		for (auto& idx : indices) idx = static_cast<uint8_t>(15 - idx);
+	}
+
+	std::memset(out, 0, 16);
+	BlockBits bits(out);
+	bits.write(1 << 6, 7);
+	for (int c = 0; c < 4; ++c) {
+		bits.write(q0[c], 7);
+		bits.write(q1[c], 7);
+	}
+	bits.write(p0, 1);
+	bits.write(p1, 1);
+	bits.write(indices[0], 3);
+	for (Uint32 i = 1; i < BLOCK_TEXELS; ++i) {
+		bits.write(indices[i], 4);
+	}
+}
+
+void decodeBlock(TextureFormat format, const uint8_t* in, uint8_t* rgba) noexcept
+{
+	switch (format) {
+	case TextureFormat::BC1_RGBA:
+		decodeColorBlock(in, rgba, true);
+		break;
+
+	case TextureFormat::BC3_RGBA:
+		decodeColorBlock(in + 8, rgba, false);
+		decodeChannelBlock(in, 3, rgba);
+		break;
+
+	case TextureFormat::BC5_RG:
+		decodeChannelBlock(in, 0, rgba);
+		decodeChannelBlock(in + 8, 1, rgba);
+		for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+			rgba[i * 4 + 2] = 0;
+			rgba[i * 4 + 3] = 255;
+		}
+		break;
+
+	case TextureFormat::BC7_RGBA:
+	{
+		BlockBits bits(const_cast<uint8_t*>(in));
+
+		// Only mode 6 is ever written, anything else decodes to magenta
+		if (bits.read(7) != (1 << 6)) {
+			for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+				rgba[i * 4 + 0] = 255;
+				rgba[i * 4 + 1] = 0;
+				rgba[i * 4 + 2] = 255;
+				rgba[i * 4 + 3] = 255;
+			}
+			break;
+		}
+
+		uint8_t q0[4], q1[4];
+		for (int c = 0; c < 4; ++c) {
+			q0[c] = static_cast<uint8_t>(bits.read(7));
+			q1[c] = static_cast<uint8_t>(bits.read(7));
+		}
+		uint8_t p0 = static_cast<uint8_t>(bits.read(1));
+		uint8_t p1 = static_cast<uint8_t>(bits.read(1));
+
+		uint8_t palette[16][4];
+		bc7Palette(q0, p0, q1, p1, palette);
+		for (Uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+			uint32_t idx = bits.read(i == 0 ? 3 : 4);
+			std::memcpy(rgba + i * 4, palette[idx], 4);
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+std::vector<std::byte> compress(
+	TextureFormat format,
+	const std::byte* rgba,
+	Uint32 width,
+	Uint32 height,
+	ThreadPool& pool) noexcept
+{
+	Uint32 blocks_x = (width + BLOCK_DIM - 1) / BLOCK_DIM;
+	Uint32 blocks_y = (height + BLOCK_DIM - 1) / BLOCK_DIM;
+	Uint32 block_bytes = blockBytes(format);
+	std::vector<std::byte> out(size_t(blocks_x) * blocks_y * block_bytes);
+
+	auto* src = reinterpret_cast<const uint8_t*>(rgba);
+	auto* dst = reinterpret_cast<uint8_t*>(out.data());
+
+	auto encodeRow = [&](size_t by) {
+		uint8_t block[BLOCK_TEXELS * 4];
+		for (Uint32 bx = 0; bx < blocks_x; ++bx) {
+			for (Uint32 y = 0; y < BLOCK_DIM; ++y) {
+				Uint32 sy = std::min<Uint32>(static_cast<Uint32>(by) * BLOCK_DIM + y, height - 1);
+				for (Uint32 x = 0; x < BLOCK_DIM; ++x) {
+					Uint32 sx = std::min(bx * BLOCK_DIM + x, width - 1);
+					std::memcpy(block + (y * BLOCK_DIM + x) * 4, src + (size_t(sy) * width + sx) * 4, 4);
+				}
+			}
+
+			uint8_t* block_out = dst + (by * blocks_x + bx) * block_bytes;
+			switch (format) {
+			case TextureFormat::BC1_RGBA: encodeBC1(block, block_out); break;
+			case TextureFormat::BC3_RGBA: encodeBC3(block, block_out); break;
+			case TextureFormat::BC5_RG: encodeBC5(block, block_out); break;
+			case TextureFormat::BC7_RGBA: encodeBC7(block, block_out); break;
+			default: break;
+			}
+		}
+	};
+
+	// Small mips aren't worth waking the workers for
+	constexpr Uint32 MIN_PARALLEL_ROWS = 16;
+	if (blocks_y < MIN_PARALLEL_ROWS) {
+		for (Uint32 by = 0; by < blocks_y; ++by) encodeRow(by);
+	}
+	else {
+		pool.parallelFor(blocks_y, encodeRow);
+	}
+	return out;
+}
+
+std::vector<std::byte> decompress(
+	TextureFormat format,
+	const std::byte* blocks,
+	Uint32 width,
+	Uint32 height) noexcept
+{
+	Uint32 blocks_x = (width + BLOCK_DIM - 1) / BLOCK_DIM;
+	Uint32 blocks_y = (height + BLOCK_DIM - 1) / BLOCK_DIM;
+	Uint32 block_bytes = blockBytes(format);
+	std::vector<std::byte> out(size_t(width) * height * 4);
+
+	auto* src = reinterpret_cast<const uint8_t*>(blocks);
+	auto* dst = reinterpret_cast<uint8_t*>(out.data());
+	for (Uint32 by = 0; by < blocks_y; ++by) {
+		for (Uint32 bx = 0; bx < blocks_x; ++bx) {
+			uint8_t block[BLOCK_TEXELS * 4];
+			decodeBlock(format, src + (size_t(by) * blocks_x + bx) * block_bytes, block);
+
+			for (Uint32 y = 0; y < BLOCK_DIM && by * BLOCK_DIM + y < height; ++y) {
+				for (Uint32 x = 0; x < BLOCK_DIM && bx * BLOCK_DIM + x < width; ++x) {
+					size_t texel = size_t(by * BLOCK_DIM + y) * width + bx * BLOCK_DIM + x;
+					std::memcpy(dst + texel * 4, block + (y * BLOCK_DIM + x) * 4, 4);
+				}
+			}
+		}
+	}
+	return out;
+}
+
+double psnr(
+	const std::byte* a,
+	const std::byte* b,
+	size_t num_texels,
+	Uint32 num_channels) noexcept
+{
+	double sq_err = 0.0;
+	for (size_t i = 0; i < num_texels; ++i) {
+		for (Uint32 c = 0; c < num_channels; ++c) {
+			double d = static_cast<double>(a[i * 4 + c]) - static_cast<double>(b[i * 4 + c]);
+			sq_err += d * d;
+		}
+	}
+
+	if (sq_err == 0.0) return std::numeric_limits<double>::infinity();
+	double mse = sq_err / static_cast<double>(num_texels * num_channels);
+	return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+};	// end of namespace
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "core/render/Image.h"
+#include "util/ThreadPool.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace APE::Render::BC {
+
+/*
+* CPU block compression for cooked textures
+* Blocks are 4x4 RGBA8 texels in row major order. BC1 and BC3 carry albedo,
+* BC5 the RG of normal maps, BC7 uses mode 6 only, one subset with 4 bit
+* indices, which suits smooth albedo without a partition search.
+*/
+constexpr Uint32 BLOCK_DIM = 4;
+constexpr Uint32 BLOCK_TEXELS = BLOCK_DIM * BLOCK_DIM;
+
+[[nodiscard]] constexpr Uint32 blockBytes(TextureFormat format) noexcept
+{
+	return (format == TextureFormat::BC1_RGBA) ? 8 : 16;
+}
+
+// Single block encoders, rgba points at 64 bytes
+void encodeBC1(const uint8_t* rgba, uint8_t* out) noexcept;
+void encodeBC3(const uint8_t* rgba, uint8_t* out) noexcept;
+void encodeBC5(const uint8_t* rgba, uint8_t* out) noexcept;
+void encodeBC7(const uint8_t* rgba, uint8_t* out) noexcept;
+
+// Writes 64 bytes of RGBA8, BC5 decodes to (r, g, 0, 255)
+void decodeBlock(TextureFormat format, const uint8_t* in, uint8_t* rgba) noexcept;
+
+// Compresses a level of RGBA8 texels, rows of blocks are spread over the
+// pool. Partial edge blocks repeat the last row and column.
+[[nodiscard]] std::vector<std::byte> compress(
+	TextureFormat format,
+	const std::byte* rgba,
+	Uint32 width,
+	Uint32 height,
+	ThreadPool& pool = ThreadPool::global()) noexcept;
+
+[[nodiscard]] std::vector<std::byte> decompress(
+	TextureFormat format,
+	const std::byte* blocks,
+	Uint32 width,
+	Uint32 height) noexcept;
+
+// Peak signal to noise ratio in dB over the first num_channels of each
+// RGBA8 texel, infinity when identical
+[[nodiscard]] double psnr(
+	const std::byte* a,
+	const std::byte* b,
+	size_t num_texels,
+	Uint32 num_channels = 4) noexcept;
+
+namespace detail {
+
+// Nearest of 4 palette colors for each of 16 texels, by RGB distance.
+// The SIMD path must match the scalar one exactly.
+void colorIndicesScalar(const uint8_t* rgba, const uint8_t palette[4][4], uint8_t indices[16]) noexcept;
+void colorIndicesSimd(const uint8_t* rgba, const uint8_t palette[4][4], uint8_t indices[16]) noexcept;
+
+};	// end of namespace
+
+};	// end of namespace
@@ -1,8 +1,14 @@
 #include "core/render/Image.h"
+#include "core/render/MipGenerator.h"
+#include "core/render/TextureCooker.h"
+#include "core/scene/AssetPack.h"
+#include "util/FileHash.h"
 #include "util/Logger.h"
+#include "util/MappedFile.h"
 
-#include <cstring>
 #include <filesystem>
+#include <system_error>
+#include <utility>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -29,21 +35,14 @@ Image::Image(std::filesystem::path path,
 	m_path = path;
 
 	// Assume data is R8G8BA8 format
-	int num_channels = DEFAULT_IMG_CHANNELS;
 	if (height > 0) {
-		m_width = width;
-		m_height = height;
-		m_num_channels = num_channels;
-
-		// Copy stb image data to a new vector
-		m_pixels.resize(getSizeBytes());
-		std::memcpy(m_pixels.data(), data, getSizeBytes());
-
+		setPixels(width, height, data, TextureCooker::settings().mip_filter);
 		return;
 	}
 
 	// if height is 0, image is compressed
-	unsigned char* decompressed_data = 
+	int num_channels;
+	std::byte* decompressed_data = reinterpret_cast<std::byte*>(
 		stbi_load_from_memory(
 			reinterpret_cast<const unsigned char*>(data),
 			width,	// num bytes of compressed image
@@ -51,26 +50,24 @@ Image::Image(std::filesystem::path path,
 			&height,
 			&num_channels,
 			DEFAULT_IMG_CHANNELS	// force R8G8B8A8
-		);
+		)
+	);
 
 	if (decompressed_data == nullptr) {
 		// Fallback to default texture
 		APE_ERROR("Failed to load embedded texture.");
 		loadCheckerboard();
+		return;
 	}
 
-	m_width = width;
-	m_height = height;
-	m_num_channels = DEFAULT_IMG_CHANNELS;
-
-	// Copy stb image data to a new vector
-	m_pixels.resize(getSizeBytes());
-	std::memcpy(m_pixels.data(), decompressed_data, getSizeBytes());
+	setPixels(width, height, decompressed_data, TextureCooker::settings().mip_filter);
 
 	// Cleanup image data
 	stbi_image_free(decompressed_data);
 }
 
+Image::~Image() noexcept = default;
+
 std::filesystem::path Image::getPath() const noexcept
 {
 	return m_path;
@@ -86,36 +83,80 @@ void Image::loadImage(std::filesystem::path path) noexcept
 	m_texture_buffer = nullptr;
 	m_path = path;
 
+	// The whole load runs under one snapshot, so the mips, the format and
+	// the recorded settings agree
+	const auto cook_settings = TextureCooker::settings();
+	const uint64_t settings_hash = TextureCooker::settingsHash(cook_settings);
+
+	// Mounted packs carry the source hash, and so does a cooked file made
+	// from a source of the same size and mtime. Either way a cooked texture
+	// is mapped without reading the source at all.
+	std::filesystem::path cooked_path = TextureCooker::cookedPath(path);
+	uint64_t source_hash = AssetPack::contentHash(path);
+	if (source_hash == 0) {
+		source_hash = TextureCooker::stampedHash(cooked_path, TextureCooker::stamp(path), cook_settings);
+	}
+	if (source_hash == 0) source_hash = Hash::fileContents(path);
+	if (loadCooked(cooked_path, source_hash, settings_hash)) return;
+
 	std::string abs_path = std::filesystem::absolute(path);
 	int width, height, num_channels;
-	std::byte* data = reinterpret_cast<std::byte*>(stbi_load(
-		abs_path.c_str(),
-		&width,
-		&height,
-		&num_channels,
-		DEFAULT_IMG_CHANNELS	// force R8G8B8A8
-	));
+	std::byte* data = nullptr;
+	if (AssetPack::File packed = AssetPack::resolve(path)) {
+		data = reinterpret_cast<std::byte*>(stbi_load_from_memory(
+			reinterpret_cast<const unsigned char*>(packed.bytes().data()),
+			static_cast<int>(packed.bytes().size()),
+			&width,
+			&height,
+			&num_channels,
+			DEFAULT_IMG_CHANNELS	// force R8G8B8A8
+		));
+	}
+	else {
+		data = reinterpret_cast<std::byte*>(stbi_load(
+			abs_path.c_str(),
+			&width,
+			&height,
+			&num_channels,
+			DEFAULT_IMG_CHANNELS	// force R8G8B8A8
+		));
+	}
 
 	// Fallback to default texture if stbi_load fails
 	if (data == nullptr) {
 		APE_ERROR("Failed to load image: {}", abs_path.c_str());
 
+		// The default texture itself is missing, generate one
+		if (path == DEFAULT_IMG_PATH) {
+			constexpr int SIZE = 8;
+			std::vector<std::byte> checker(SIZE * SIZE * DEFAULT_IMG_CHANNELS);
+			for (int i = 0; i < SIZE * SIZE; ++i) {
+				bool b_odd = ((i % SIZE) + (i / SIZE)) % 2;
+				std::byte val = b_odd ? std::byte { 0xFF } : std::byte { 0x00 };
+				checker[i * 4 + 0] = val;
+				checker[i * 4 + 1] = std::byte { 0x00 };
+				checker[i * 4 + 2] = val;
+				checker[i * 4 + 3] = std::byte { 0xFF };
+			}
+			setPixels(SIZE, SIZE, checker.data(), cook_settings.mip_filter);
+			return;
+		}
+
 		loadCheckerboard();
 		return;
 	}
 
-	m_width = width;
-	m_height = height;
-	m_num_channels = DEFAULT_IMG_CHANNELS;
-
-	// Copy stb image data to a new vector
-	m_pixels.resize(getSizeBytes());
-	std::memcpy(m_pixels.data(), data, getSizeBytes());
+	setPixels(width, height, data, cook_settings.mip_filter);
 
 	// Cleanup image data
 	stbi_image_free(data);
-}
 
+	// First load cooks, later loads map the result. Remapping picks up the
+	// block compressed levels so every load uploads the same data.
+	if (TextureCooker::save(cooked_path, *this, source_hash, cook_settings)) {
+		loadCooked(cooked_path, source_hash, settings_hash);
+	}
+}
 
 void Image::loadCheckerboard() noexcept
 {
@@ -129,7 +170,7 @@ SafeGPU::UniqueGPUTexture& Image::textureBuffer() noexcept
 
 Uint32 Image::getSizeBytes() const noexcept
 {
-	return m_width * m_height * m_num_channels;
+	return m_levels.empty() ? 0 : m_levels.front().size_bytes;
 }
 
 Uint32 Image::getWidth() const noexcept
@@ -147,16 +188,32 @@ Uint32 Image::getNumChannels() const noexcept
 	return m_num_channels;
 }
 
-std::byte* Image::getPixels() noexcept
+TextureFormat Image::getFormat() const noexcept
+{
+	return m_format;
+}
+
+const std::byte* Image::getPixels() const noexcept
+{
+	return m_levels.empty() ? nullptr : m_levels.front().data;
+}
+
+const std::vector<Image::MipLevel>& Image::getMipLevels() const noexcept
+{
+	return m_levels;
+}
+
+size_t Image::cpuBytes() const noexcept
 {
-	return m_pixels.data();
+	return m_pixels.capacity() + (m_mapped ? m_mapped->size() : 0);
 }
 
 void Image::trace() const noexcept
 {
 	std::string pixel_str;
-	for (size_t i = 0; i < m_pixels.size(); ++i) {
-		pixel_str += std::to_string(static_cast<unsigned char>(m_pixels[i]));
+	const std::byte* pixels = getPixels();
+	for (size_t i = 0; i < getSizeBytes(); ++i) {
+		pixel_str += std::to_string(static_cast<unsigned char>(pixels[i]));
 		pixel_str += " ";
 	}
 
@@ -169,4 +226,55 @@ void Image::trace() const noexcept
 	);
 }
 
+void Image::setPixels(int width, int height, const std::byte* data, Mip::Filter mip_filter) noexcept
+{
+	m_width = width;
+	m_height = height;
+	m_num_channels = DEFAULT_IMG_CHANNELS;
+	m_format = TextureFormat::RGBA8;
+	m_mapped.reset();
+
+	auto settings = Mip::settingsFor(m_path, mip_filter);
+	auto chain = Mip::generate(
+		static_cast<Uint32>(width),
+		static_cast<Uint32>(height),
+		data,
+		settings,
+		TextureCooker::LEVEL_ALIGN
+	);
+	m_pixels = std::move(chain.pixels);
+	m_levels = std::move(chain.levels);
+}
+
+bool Image::loadCooked(
+	const std::filesystem::path& cooked_path,
+	uint64_t source_hash,
+	uint64_t settings_hash) noexcept
+{
+	std::error_code ec;
+	if (source_hash == 0 || !std::filesystem::is_regular_file(cooked_path, ec)) {
+		return false;
+	}
+
+	auto mapped = std::make_unique<MappedFile>(cooked_path);
+	if (!mapped->isOpen()) return false;
+
+	TextureFormat format;
+	auto levels = TextureCooker::readLevels(*mapped, source_hash, format, settings_hash);
+	if (levels.empty()) {
+		APE_TRACE("Image::loadCooked() {} is stale, recooking.", cooked_path.string());
+		return false;
+	}
+
+	m_width = static_cast<int>(levels.front().width);
+	m_height = static_cast<int>(levels.front().height);
+	m_num_channels = DEFAULT_IMG_CHANNELS;
+	m_format = format;
+	m_pixels.clear();
+	m_pixels.shrink_to_fit();
+	m_levels = std::move(levels);
+	m_mapped = std::move(mapped);
+	return true;
+}
+
 };	// end of namespace
@@ -6,44 +6,105 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <memory>
 #include <string_view>
 #include <vector>
 
+// Forward declare MappedFile
+namespace APE {
+	class MappedFile;
+};	// end of namespace
+
+// Forward declare the mip filter, MipGenerator.h includes this header
+namespace APE::Render::Mip {
+	enum class Filter : Uint32;
+};	// end of namespace
+
 namespace APE::Render {
 
+enum class TextureFormat : Uint32 {
+	RGBA8 = 1,
+	BC1_RGBA,
+	BC3_RGBA,
+	BC5_RG,
+	BC7_RGBA,
+};
+
+[[nodiscard]] constexpr bool isBlockCompressed(TextureFormat format) noexcept
+{
+	return format != TextureFormat::RGBA8;
+}
+
+// Bytes in one mip level, block formats round up to whole 4x4 blocks
+[[nodiscard]] constexpr Uint32 levelSizeBytes(
+	TextureFormat format,
+	Uint32 width,
+	Uint32 height) noexcept
+{
+	Uint32 blocks = ((width + 3) / 4) * ((height + 3) / 4);
+	switch (format) {
+	case TextureFormat::BC1_RGBA:
+		return blocks * 8;
+	case TextureFormat::BC3_RGBA:
+	case TextureFormat::BC5_RG:
+	case TextureFormat::BC7_RGBA:
+		return blocks * 16;
+	default:
+		return width * height * 4;
+	}
+}
+
 class Image {
 public:
 	static inline std::string_view DEFAULT_IMG_PATH = "res/textures/checkerboard.png";
+
+	// One level of the mip chain, level 0 is full size
+	struct MipLevel {
+		Uint32 width;
+		Uint32 height;
+		Uint32 size_bytes;
+		const std::byte* data;
+	};
+
 private:
 	static constexpr int DEFAULT_IMG_CHANNELS = 4;
 
 	int m_width;
 	int m_height;
 	int m_num_channels;
-	std::vector<std::byte> m_pixels;
+	TextureFormat m_format;
 	std::filesystem::path m_path;
 	SafeGPU::UniqueGPUTexture m_texture_buffer;
 
+	// Decoded images own their mip chain, cooked ones point into the mapping
+	std::vector<std::byte> m_pixels;
+	std::unique_ptr<MappedFile> m_mapped;
+	std::vector<MipLevel> m_levels;
+
 public:
 	Image() noexcept;
 
 	Image(std::filesystem::path path) noexcept;
 
-	Image(std::filesystem::path path, 
+	Image(std::filesystem::path path,
 		int width,
 		int height,
 		const std::byte* data) noexcept;
 
+	~Image() noexcept;
+
 	[[nodiscard]] std::filesystem::path getPath() const noexcept;
 
 	[[nodiscard]] static std::filesystem::path getDefaultPath() noexcept;
 
+	// Maps the cooked texture if it is up to date, else decodes and cooks it
 	void loadImage(std::filesystem::path path) noexcept;
 
 	void loadCheckerboard() noexcept;
 
 	[[nodiscard]] SafeGPU::UniqueGPUTexture& textureBuffer() noexcept;
 
+	// Size of the full resolution level
 	[[nodiscard]] Uint32 getSizeBytes() const noexcept;
 
 	[[nodiscard]] Uint32 getWidth() const noexcept;
@@ -52,10 +113,26 @@ public:
 
 	[[nodiscard]] Uint32 getNumChannels() const noexcept;
 
-	[[nodiscard]] std::byte* getPixels() noexcept;
+	[[nodiscard]] TextureFormat getFormat() const noexcept;
+
+	// Full resolution level
+	[[nodiscard]] const std::byte* getPixels() const noexcept;
+
+	[[nodiscard]] const std::vector<MipLevel>& getMipLevels() const noexcept;
+
+	// Decoded pixels plus the cooked mapping, for the asset budget
+	[[nodiscard]] size_t cpuBytes() const noexcept;
 
 	void trace() const noexcept;
+
+private:
+	// Takes RGBA8 level 0 and builds the rest of the chain
+	void setPixels(int width, int height, const std::byte* data, Mip::Filter mip_filter) noexcept;
+
+	bool loadCooked(
+		const std::filesystem::path& cooked_path,
+		uint64_t source_hash,
+		uint64_t settings_hash) noexcept;
 };
 
 };	// end of namespace
-
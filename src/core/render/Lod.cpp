@@ -0,0 +1,419 @@
+#include "core/render/Lod.h"
+#include "core/render/MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+namespace APE::Render::Lod {
+
+namespace {
+
+// Levels with fewer triangles than this aren't worth a draw of their own
+constexpr size_t MIN_TRIANGLES = 8;
+
+// A unit of normal or UV difference across a collapse costs as much as
+// moving by this fraction of the mesh's extent
+constexpr double ATTRIBUTE_WEIGHT = 0.02;
+
+constexpr Uint32 NO_VERTEX = std::numeric_limits<Uint32>::max();
+
+/*
+* Symmetric 4x4 error quadric, the sum of squared distances to planes
+*/
+struct Quadric {
+	// xx xy xz xw yy yz yw zz zw ww
+	std::array<double, 10> m {};
+
+	static Quadric plane(const glm::dvec3& n, double d) noexcept
+	{
+		Quadric q;
+		q.m = {
+			n.x * n.x, n.x * n.y, n.x * n.z, n.x * d,
+			n.y * n.y, n.y * n.z, n.y * d,
+			n.z * n.z, n.z * d,
+			d * d,
+		};
+		return q;
+	}
+
+	Quadric& operator+=(const Quadric& other) noexcept
+	{
+		for (size_t i = 0; i < m.size(); ++i) m[i] += other.m[i];
+		return *this;
+	}
+
+	[[nodiscard]] double error(const glm::vec3& p) const noexcept
+	{
+		double x = p.x, y = p.y, z = p.z;
+		double e =
+			m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x +
+			m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y +
+			m[7] * z * z + 2.0 * m[8] * z +
+			m[9];
+		return std::max(e, 0.0);
+	}
+};
+
+struct PositionHash {
+	size_t operator()(const glm::vec3& p) const noexcept
+	{
+		std::array<uint32_t, 3> bits;
+		std::memcpy(bits.data(), &p, sizeof(bits));
+		return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+	}
+};
+
+struct Collapse {
+	double cost;
+	Uint32 from;
+	Uint32 to;
+};
+
+[[nodiscard]] double attributeDistance(const TextureVertex& a, const TextureVertex& b) noexcept
+{
+	glm::dvec3 normal = glm::dvec3(a.normal) - glm::dvec3(b.normal);
+	glm::dvec2 uv = glm::dvec2(a.uv) - glm::dvec2(b.uv);
+	return glm::dot(normal, normal) + glm::dot(uv, uv);
+}
+
+[[nodiscard]] uint64_t edgeKey(Uint32 a, Uint32 b) noexcept
+{
+	if (a > b) std::swap(a, b);
+	return (uint64_t(a) << 32) | b;
+}
+
+};	// end of namespace
+
+std::vector<Uint32> simplify(
+	std::span<const TextureVertex> vertices,
+	std::span<const Uint32> indices,
+	size_t target_index_count,
+	float target_error,
+	float* error) noexcept
+{
+	std::vector<Uint32> tris(indices.begin(), indices.end());
+	if (error) *error = 0.f;
+	if (tris.size() <= target_index_count) return tris;
+
+	// Vertices sharing a position are its wedges, the first of each group
+	// stands for all. Collapses move every wedge of a position at once.
+	size_t num_vertices = vertices.size();
+	std::vector<Uint32> position(num_vertices);
+	std::vector<Uint32> wedge_offsets(num_vertices + 1, 0);
+	std::vector<Uint32> wedges(num_vertices);
+	{
+		std::unordered_map<glm::vec3, Uint32, PositionHash> lookup;
+		lookup.reserve(num_vertices);
+		for (Uint32 v = 0; v < num_vertices; ++v) {
+			position[v] = lookup.try_emplace(vertices[v].pos, v).first->second;
+			++wedge_offsets[position[v] + 1];
+		}
+		for (size_t v = 0; v < num_vertices; ++v) wedge_offsets[v + 1] += wedge_offsets[v];
+
+		std::vector<Uint32> fill(wedge_offsets.begin(), wedge_offsets.end() - 1);
+		for (Uint32 v = 0; v < num_vertices; ++v) {
+			wedges[fill[position[v]]++] = v;
+		}
+	}
+
+	// Attribute differences are priced against the mesh's extent
+	double attribute_scale = 0.0;
+	if (num_vertices > 0) {
+		glm::vec3 lo = vertices[0].pos;
+		glm::vec3 hi = vertices[0].pos;
+		for (auto& vertex : vertices) {
+			lo = glm::min(lo, vertex.pos);
+			hi = glm::max(hi, vertex.pos);
+		}
+		double extent = ATTRIBUTE_WEIGHT * glm::length(glm::dvec3(hi - lo));
+		attribute_scale = extent * extent;
+	}
+
+	// Borders have edges with a single triangle, moving them would open
+	// cracks. Locks are kept per position.
+	std::vector<bool> b_locked(num_vertices, false);
+	{
+		std::unordered_map<uint64_t, Uint32> edge_uses;
+		edge_uses.reserve(tris.size());
+		for (size_t i = 0; i < tris.size(); i += 3) {
+			for (size_t k = 0; k < 3; ++k) {
+				Uint32 a = position[tris[i + k]];
+				Uint32 b = position[tris[i + (k + 1) % 3]];
+				++edge_uses[edgeKey(a, b)];
+			}
+		}
+		for (auto [key, uses] : edge_uses) {
+			if (uses == 1) {
+				b_locked[key >> 32] = true;
+				b_locked[key & 0xFFFFFFFF] = true;
+			}
+		}
+	}
+
+	// Plane quadrics gathered per position
+	std::vector<Quadric> quadrics(num_vertices);
+	for (size_t i = 0; i < tris.size(); i += 3) {
+		glm::dvec3 p0(vertices[tris[i]].pos);
+		glm::dvec3 p1(vertices[tris[i + 1]].pos);
+		glm::dvec3 p2(vertices[tris[i + 2]].pos);
+		glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+		double length = glm::length(n);
+		if (length <= 0.0) continue;
+
+		n /= length;
+		Quadric q = Quadric::plane(n, -glm::dot(n, p0));
+		for (size_t k = 0; k < 3; ++k) {
+			quadrics[position[tris[i + k]]] += q;
+		}
+	}
+
+	double max_cost = double(target_error) * double(target_error);
+	double taken_cost = 0.0;
+
+	std::vector<Uint32> offsets(num_vertices + 1);
+	std::vector<Uint32> adjacency;
+	std::vector<Uint32> remap(num_vertices);
+	std::vector<bool> b_touched(num_vertices);
+	std::vector<Collapse> collapses;
+	std::vector<std::pair<Uint32, Uint32>> moves;
+
+	auto b_used = [&](Uint32 v) { return offsets[v] != offsets[v + 1]; };
+
+	// Picks the wedge of to that each used wedge of from turns into and
+	// returns the attribute cost. Wedges on the collapsed edge keep their
+	// side of any seam for free, the others take the closest match.
+	auto mapWedges = [&](Uint32 from, Uint32 to, std::vector<std::pair<Uint32, Uint32>>* out) {
+		double cost = 0.0;
+		for (Uint32 i = wedge_offsets[from]; i < wedge_offsets[from + 1]; ++i) {
+			Uint32 w = wedges[i];
+			if (!b_used(w)) continue;
+
+			Uint32 target = NO_VERTEX;
+			for (Uint32 j = offsets[w]; j < offsets[w + 1] && target == NO_VERTEX; ++j) {
+				const Uint32* tri = &tris[adjacency[j] * 3];
+				for (size_t k = 0; k < 3; ++k) {
+					if (position[tri[k]] == to) target = tri[k];
+				}
+			}
+			if (target == NO_VERTEX) {
+				double closest = std::numeric_limits<double>::max();
+				for (Uint32 t = wedge_offsets[to]; t < wedge_offsets[to + 1]; ++t) {
+					Uint32 u = wedges[t];
+					if (!b_used(u)) continue;
+
+					double distance = attributeDistance(vertices[w], vertices[u]);
+					if (distance < closest) {
+						closest = distance;
+						target = u;
+					}
+				}
+				if (target == NO_VERTEX) return std::numeric_limits<double>::max();
+				cost += closest * attribute_scale;
+			}
+			if (out) out->emplace_back(w, target);
+		}
+		return cost;
+	};
+
+	while (tris.size() > target_index_count) {
+		// Triangles around each vertex
+		std::fill(offsets.begin(), offsets.end(), 0);
+		for (Uint32 v : tris) ++offsets[v + 1];
+		for (size_t v = 0; v < num_vertices; ++v) offsets[v + 1] += offsets[v];
+		adjacency.resize(tris.size());
+		{
+			std::vector<Uint32> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < tris.size(); ++i) {
+				adjacency[fill[tris[i]]++] = static_cast<Uint32>(i / 3);
+			}
+		}
+
+		// Every edge between positions once, from the triangle that walks it
+		// in increasing order
+		collapses.clear();
+		for (size_t i = 0; i < tris.size(); i += 3) {
+			for (size_t k = 0; k < 3; ++k) {
+				Uint32 a = position[tris[i + k]];
+				Uint32 b = position[tris[i + (k + 1) % 3]];
+				if (a >= b) continue;
+
+				Quadric q = quadrics[a];
+				q += quadrics[b];
+				double cost_ab = b_locked[a] ? std::numeric_limits<double>::max() : q.error(vertices[b].pos) + mapWedges(a, b, nullptr);
+				double cost_ba = b_locked[b] ? std::numeric_limits<double>::max() : q.error(vertices[a].pos) + mapWedges(b, a, nullptr);
+				if (cost_ab <= cost_ba && !b_locked[a]) {
+					collapses.push_back({ cost_ab, a, b });
+				}
+				else if (!b_locked[b]) {
+					collapses.push_back({ cost_ba, b, a });
+				}
+			}
+		}
+		if (collapses.empty()) break;
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) {
+			return l.cost < r.cost;
+		});
+
+		// An interior collapse removes two triangles
+		size_t num_tris = tris.size() / 3;
+		size_t target_tris = target_index_count / 3;
+		size_t budget = std::max<size_t>((num_tris - target_tris) / 2, 1);
+
+		for (Uint32 v = 0; v < num_vertices; ++v) remap[v] = v;
+		std::fill(b_touched.begin(), b_touched.end(), false);
+
+		size_t num_collapsed = 0;
+		for (auto& collapse : collapses) {
+			if (num_collapsed >= budget || collapse.cost > max_cost) break;
+			if (b_touched[collapse.from] || b_touched[collapse.to]) continue;
+
+			// Triangles around from must keep facing the same way
+			glm::vec3 target = vertices[collapse.to].pos;
+			bool b_flips = false;
+			for (Uint32 i = wedge_offsets[collapse.from]; i < wedge_offsets[collapse.from + 1] && !b_flips; ++i) {
+				Uint32 w = wedges[i];
+				for (Uint32 j = offsets[w]; j < offsets[w + 1] && !b_flips; ++j) {
+					const Uint32* tri = &tris[adjacency[j] * 3];
+					if (position[tri[0]] == collapse.to || position[tri[1]] == collapse.to || position[tri[2]] == collapse.to) continue;
+
+					std::array<glm::vec3, 3> p;
+					std::array<glm::vec3, 3> moved;
+					for (size_t k = 0; k < 3; ++k) {
+						p[k] = vertices[tri[k]].pos;
+						moved[k] = (tri[k] == w) ? target : p[k];
+					}
+					glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+					glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+					b_flips = glm::dot(before, after) <= 0.f;
+				}
+			}
+			if (b_flips) continue;
+
+			moves.clear();
+			mapWedges(collapse.from, collapse.to, &moves);
+			for (auto [w, to] : moves) remap[w] = to;
+			quadrics[collapse.to] += quadrics[collapse.from];
+			taken_cost = std::max(taken_cost, collapse.cost);
+
+			// Whatever shares a triangle with from has new neighbours now
+			for (auto [w, to] : moves) {
+				for (Uint32 j = offsets[w]; j < offsets[w + 1]; ++j) {
+					const Uint32* tri = &tris[adjacency[j] * 3];
+					for (size_t k = 0; k < 3; ++k) b_touched[position[tri[k]]] = true;
+				}
+			}
+			++num_collapsed;
+		}
+		if (num_collapsed == 0) break;
+
+		size_t write = 0;
+		for (size_t i = 0; i < tris.size(); i += 3) {
+			Uint32 a = remap[tris[i]];
+			Uint32 b = remap[tris[i + 1]];
+			Uint32 c = remap[tris[i + 2]];
+			if (position[a] == position[b] || position[b] == position[c] || position[c] == position[a]) continue;
+
+			tris[write++] = a;
+			tris[write++] = b;
+			tris[write++] = c;
+		}
+		tris.resize(write);
+	}
+
+	if (error) *error = static_cast<float>(std::sqrt(taken_cost));
+	return tris;
+}
+
+Chain generate(
+	std::span<const TextureVertex> vertices,
+	std::span<const Uint32> indices,
+	float radius,
+	const Settings& settings) noexcept
+{
+	Chain chain;
+	if (radius <= 0.f) return chain;
+
+	std::vector<Uint32> previous(indices.begin(), indices.end());
+	float total_error = 0.f;
+	for (Uint32 level = 0; level < settings.max_levels; ++level) {
+		size_t target_tris = static_cast<size_t>(float(previous.size() / 3) * settings.ratio);
+		if (target_tris < MIN_TRIANGLES) break;
+
+		float level_error = 0.f;
+		float error_left = settings.max_error * radius - total_error;
+		if (error_left <= 0.f) break;
+
+		auto simplified = simplify(vertices, previous, target_tris * 3, error_left, &level_error);
+		if (float(simplified.size()) > float(previous.size()) * settings.min_reduction) break;
+
+		MeshOpt::optimizeVertexCache(simplified, vertices.size());
+		total_error += level_error;
+		chain.lods.push_back({
+			.index_offset = static_cast<Uint32>(chain.indices.size()),
+			.index_count = static_cast<Uint32>(simplified.size()),
+			.error = total_error / radius,
+		});
+		chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+		previous = std::move(simplified);
+	}
+	return chain;
+}
+
+float projectionScale(float fov_y_degrees, float viewport_height) noexcept
+{
+	return viewport_height / (2.f * std::tan(glm::radians(fov_y_degrees) * 0.5f));
+}
+
+float projectedRadius(
+	const Physics::Collisions::Sphere& sphere,
+	const glm::vec3& eye,
+	float projection_scale) noexcept
+{
+	float distance = glm::length(sphere.center - eye);
+	if (distance <= sphere.radius) return std::numeric_limits<float>::max();
+	return sphere.radius * projection_scale / distance;
+}
+
+Physics::Collisions::Sphere worldSphere(
+	const Physics::Collisions::Sphere& local,
+	const glm::mat4& model_matrix) noexcept
+{
+	glm::vec3 center = glm::vec3(model_matrix * glm::vec4(local.center, 1.f));
+	float scale = std::max({
+		glm::length(glm::vec3(model_matrix[0])),
+		glm::length(glm::vec3(model_matrix[1])),
+		glm::length(glm::vec3(model_matrix[2])),
+	});
+	return Physics::Collisions::Sphere(center, local.radius * scale);
+}
+
+Uint32 select(
+	std::span<const MeshLod> lods,
+	float radius_pixels,
+	Uint32 current,
+	const Selection& selection) noexcept
+{
+	auto pixels = [&](Uint32 level) {
+		return (level == 0) ? 0.f : lods[level - 1].error * radius_pixels;
+	};
+
+	// Too coarse for its size on screen now, refine until it fits
+	Uint32 level = std::min(current, static_cast<Uint32>(lods.size()));
+	while (level > 0 && pixels(level) > selection.pixel_error) {
+		--level;
+	}
+
+	// Coarsen only once the next level fits with margin
+	float coarsen_limit = selection.pixel_error * (1.f - selection.hysteresis);
+	while (level < lods.size() && pixels(level + 1) <= coarsen_limit) {
+		++level;
+	}
+	return level;
+}
+
+};	// end of namespace
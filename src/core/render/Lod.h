@@ -0,0 +1,90 @@
+#pragma once
+
+#include "core/render/Mesh.h"
+#include "core/render/Vertex.h"
+#include "physics/collisions/Colliders.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace APE::Render::Lod {
+
+/*
+* Mesh LODs
+* Levels are built at import by quadric error edge collapse. Every collapse
+* moves all vertices at one position onto a neighbouring position, so all
+* levels index the mesh's own vertex buffer and UV or normal seams stay
+* closed. Differences in attributes a seam vertex takes on count towards
+* the error. Vertices on open borders are locked, which keeps levels free
+* of cracks.
+*/
+struct Settings {
+	// 0 disables LOD generation
+	Uint32 max_levels = 3;
+	// Target triangle count of each level relative to the one before
+	float ratio = 0.5f;
+	// Largest error a level may reach, relative to the bounding sphere radius
+	float max_error = 0.05f;
+	// Levels that keep more than this fraction of the one before are dropped
+	float min_reduction = 0.9f;
+};
+
+// Collapses edges cheapest first until target_index_count or target_error,
+// an absolute distance, is reached. error receives the largest cost taken.
+[[nodiscard]] std::vector<Uint32> simplify(
+	std::span<const TextureVertex> vertices,
+	std::span<const Uint32> indices,
+	size_t target_index_count,
+	float target_error,
+	float* error = nullptr) noexcept;
+
+struct Chain {
+	std::vector<Uint32> indices;
+	std::vector<MeshLod> lods;
+};
+
+// Each level is simplified from the one before, errors add up
+[[nodiscard]] Chain generate(
+	std::span<const TextureVertex> vertices,
+	std::span<const Uint32> indices,
+	float radius,
+	const Settings& settings = {}) noexcept;
+
+/*
+* Runtime selection
+* A level is good enough while its error covers at most pixel_error pixels
+* on screen. Coarser levels are only taken once they fit with hysteresis to
+* spare, so meshes near a threshold don't flicker between levels.
+*/
+struct Selection {
+	float pixel_error = 1.f;
+	float hysteresis = 0.25f;
+};
+
+// Pixels covered by one world unit at distance one
+[[nodiscard]] float projectionScale(float fov_y_degrees, float viewport_height) noexcept;
+
+// Radius of a world space sphere on screen in pixels, unbounded from inside
+[[nodiscard]] float projectedRadius(
+	const Physics::Collisions::Sphere& sphere,
+	const glm::vec3& eye,
+	float projection_scale) noexcept;
+
+// Bounding sphere of a mesh placed by model_matrix
+[[nodiscard]] Physics::Collisions::Sphere worldSphere(
+	const Physics::Collisions::Sphere& local,
+	const glm::mat4& model_matrix) noexcept;
+
+// Level to draw, 0 being the full mesh, given the level drawn last frame
+[[nodiscard]] Uint32 select(
+	std::span<const MeshLod> lods,
+	float radius_pixels,
+	Uint32 current,
+	const Selection& selection = {}) noexcept;
+
+};	// end of namespace
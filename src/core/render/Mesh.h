@@ -4,22 +4,80 @@
 #include "core/scene/AssetHandle.h"
 #include "core/render/Image.h"
 #include "core/render/SafeGPU.h"
+#include "core/render/Vertex.h"
+#include "core/render/VertexQuantization.h"
+#include "physics/collisions/Colliders.h"
 
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace APE::Render {
 
+// Coarser index list over the same vertices as the full mesh
+struct MeshLod {
+	// Range in Mesh::lod_indices
+	Uint32 index_offset;
+	Uint32 index_count;
+	// Geometric error relative to the bounding sphere radius
+	float error;
+};
+
+// Meshes up to this many vertices are drawn with 16 bit indices
+inline constexpr size_t MAX_INDEX16_VERTICES = 65536;
+
+[[nodiscard]] inline Uint32 indexSizeFor(size_t num_vertices) noexcept
+{
+	return num_vertices <= MAX_INDEX16_VERTICES ? sizeof(Uint16) : sizeof(Uint32);
+}
+
+// Index list at a narrower width, callers check that every index fits
+template <typename To, typename From>
+[[nodiscard]] std::vector<To> narrowIndices(std::span<const From> indices) noexcept
+{
+	std::vector<To> narrow;
+	narrow.reserve(indices.size());
+	for (From index : indices) {
+		narrow.push_back(static_cast<To>(index));
+	}
+	return narrow;
+}
+
 template <typename VertexType, typename IndexType>
 struct Mesh {
 	std::vector<VertexType> vertices;
 	std::vector<IndexType> indices;
+
+	// LOD 1 and up, LOD 0 is indices itself
+	std::vector<IndexType> lod_indices;
+	std::vector<MeshLod> lods;
+
+	// Bytes per index in the GPU buffer and the model cache, chosen at
+	// import. The CPU copy stays IndexType for cooking and physics.
+	Uint32 index_size = sizeof(IndexType);
+
+	// Optional streams derived from vertices, see VertexQuant::Settings
+	std::vector<CompactVertex> compact_vertices;
+	std::vector<PositionVertex> positions;
+	VertexQuant::Quantization quantization;
+
 	TransformComponent transform;
 	AssetHandle<Image> texture_handle;
+	// One GPU buffer per vertex layout, so the buffer a draw binds always
+	// matches what its pipeline reads
 	SafeGPU::UniqueGPUBuffer vertex_buffer;
+	SafeGPU::UniqueGPUBuffer compact_vertex_buffer;
 	SafeGPU::UniqueGPUBuffer index_buffer;
 
+	// Local space bounds, computed once at import
+	Physics::Collisions::AABB bounds;
+	Physics::Collisions::Sphere bounding_sphere;
+
 	Mesh() noexcept = default;
 
 	Mesh(const std::vector<VertexType>& vertices,
@@ -31,23 +89,86 @@ struct Mesh {
 		, transform(transform)
 		, texture_handle(texture_handle)
 		, vertex_buffer(nullptr)
+		, compact_vertex_buffer(nullptr)
 		, index_buffer(nullptr)
 	{
+		computeBounds();
+	}
 
+	[[nodiscard]] size_t numLods() const noexcept
+	{
+		return lods.size() + 1;
+	}
+
+	// Where a level starts in the GPU index buffer, which holds indices
+	// followed by lod_indices, and how many indices it draws
+	[[nodiscard]] std::pair<Uint32, Uint32> lodRange(size_t level) const noexcept
+	{
+		if (level == 0 || lods.empty()) {
+			return { 0, static_cast<Uint32>(indices.size()) };
+		}
+
+		auto& lod = lods[std::min(level, lods.size()) - 1];
+		return { static_cast<Uint32>(indices.size()) + lod.index_offset, lod.index_count };
+	}
+
+	// Call after computeBounds(), compact positions are relative to bounds
+	void buildStreams(const VertexQuant::Settings& settings) noexcept
+	{
+		compact_vertices.clear();
+		positions.clear();
+
+		if (settings.b_compact) {
+			quantization = VertexQuant::fromBounds(bounds);
+			compact_vertices = VertexQuant::compress(vertices, quantization);
+		}
+		if (settings.b_position_stream) {
+			positions = VertexQuant::positions(vertices);
+		}
+	}
+
+	void computeBounds() noexcept
+	{
+		if (vertices.empty()) {
+			bounds = Physics::Collisions::AABB();
+			bounding_sphere = Physics::Collisions::Sphere();
+			return;
+		}
+
+		glm::vec3 min_bounds(std::numeric_limits<float>::max());
+		glm::vec3 max_bounds(-std::numeric_limits<float>::max());
+		for (auto& vertex : vertices) {
+			min_bounds = glm::min(min_bounds, vertex.pos);
+			max_bounds = glm::max(max_bounds, vertex.pos);
+		}
+		bounds = Physics::Collisions::AABB(min_bounds, max_bounds);
+
+		// Sphere around the box center, tighter than the box's circumsphere
+		glm::vec3 center = bounds.center();
+		float radius_sq = 0.f;
+		for (auto& vertex : vertices) {
+			glm::vec3 d = vertex.pos - center;
+			radius_sq = std::max(radius_sq, glm::dot(d, d));
+		}
+		bounding_sphere = Physics::Collisions::Sphere(center, std::sqrt(radius_sq));
 	}
 
 	using Triangle = std::tuple<glm::vec3, glm::vec3, glm::vec3>;
 	[[nodiscard]] std::vector<Triangle> triangles() const noexcept
 	{
-		std::vector<Triangle> tris;
-		for (size_t i = 0; i < indices.size(); i += 3) {
-			tris.push_back({ 
-       				vertices[indices[i]].pos,
-				vertices[indices[i+1]].pos,
-				vertices[indices[i+2]].pos
-			});
-		}
-		return tris;
+		// The position stream keeps the walk off the other attributes
+		auto build = [&](const auto& stream) {
+			std::vector<Triangle> tris;
+			for (size_t i = 0; i < indices.size(); i += 3) {
+				tris.push_back({
+					stream[indices[i]].pos,
+					stream[indices[i+1]].pos,
+					stream[indices[i+2]].pos
+				});
+			}
+			return tris;
+		};
+		return positions.empty() ? build(vertices) : build(positions);
 	}
 };
 
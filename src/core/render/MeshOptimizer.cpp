@@ -0,0 +1,480 @@
+#include "core/render/MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace APE::Render::MeshOpt {
+
+namespace {
+
+constexpr Uint32 NONE = std::numeric_limits<Uint32>::max();
+
+/*
+* FIFO cache simulation
+* A vertex is cached while fewer than cache_size misses happened since it
+* was last transformed. Advancing time past cache_size flushes the cache.
+*/
+struct FifoCache {
+	std::vector<Uint32> stamps;
+	Uint32 time;
+	Uint32 size;
+
+	FifoCache(size_t num_vertices, Uint32 cache_size) noexcept
+		: stamps(num_vertices, 0)
+		, time(cache_size + 1)
+		, size(cache_size)
+	{ }
+
+	[[nodiscard]] bool access(Uint32 v) noexcept
+	{
+		if (time - stamps[v] <= size) return true;
+		stamps[v] = time++;
+		return false;
+	}
+
+	[[nodiscard]] Uint32 triangleMisses(const Uint32* tri) noexcept
+	{
+		return !access(tri[0]) + !access(tri[1]) + !access(tri[2]);
+	}
+
+	void flush() noexcept
+	{
+		time += size + 1;
+	}
+};
+
+/*
+* Forsyth scoring, "Linear-Speed Vertex Cache Optimisation"
+*/
+constexpr Uint32 LRU_SIZE = 32;
+constexpr Uint32 MAX_VALENCE = 64;
+
+struct ScoreTables {
+	std::array<float, LRU_SIZE + 1> cache;
+	std::array<float, MAX_VALENCE + 1> valence;
+
+	ScoreTables() noexcept
+	{
+		// Slot 0 is for vertices outside the cache
+		cache[0] = 0.f;
+		for (Uint32 pos = 0; pos < LRU_SIZE; ++pos) {
+			float score = (pos < 3) ? 0.75f :
+				std::pow(1.f - float(pos - 3) / float(LRU_SIZE - 3), 1.5f);
+			cache[pos + 1] = score;
+		}
+		valence[0] = 0.f;
+		for (Uint32 i = 1; i <= MAX_VALENCE; ++i) {
+			valence[i] = 2.f / std::sqrt(float(i));
+		}
+	}
+};
+
+const ScoreTables& scoreTables() noexcept
+{
+	static const ScoreTables tables;
+	return tables;
+}
+
+[[nodiscard]] float vertexScore(int cache_pos, Uint32 remaining) noexcept
+{
+	// Vertices without triangles left no longer matter
+	if (remaining == 0) return -1.f;
+
+	auto& tables = scoreTables();
+	float valence = (remaining <= MAX_VALENCE) ?
+		tables.valence[remaining] : 2.f / std::sqrt(float(remaining));
+	return tables.cache[cache_pos + 1] + valence;
+}
+
+[[nodiscard]] glm::vec3 triangleCross(
+	const Uint32* tri,
+	std::span<const TextureVertex> vertices) noexcept
+{
+	glm::vec3 a = vertices[tri[0]].pos;
+	return glm::cross(vertices[tri[1]].pos - a, vertices[tri[2]].pos - a);
+}
+
+[[nodiscard]] uint64_t hashVertex(const TextureVertex& vertex) noexcept
+{
+	static_assert(sizeof(TextureVertex) % sizeof(uint64_t) == 0);
+	std::array<uint64_t, sizeof(TextureVertex) / sizeof(uint64_t)> words;
+	std::memcpy(words.data(), &vertex, sizeof(TextureVertex));
+
+	uint64_t hash = 0;
+	for (uint64_t word : words) {
+		hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+		hash ^= hash >> 29;
+	}
+	return hash;
+}
+
+};	// end of namespace
+
+CacheStats analyze(
+	std::span<const Uint32> indices,
+	size_t num_vertices,
+	Uint32 cache_size) noexcept
+{
+	size_t num_tris = indices.size() / 3;
+	if (num_tris == 0) return {};
+
+	FifoCache cache(num_vertices, cache_size);
+	std::vector<bool> b_used(num_vertices, false);
+	size_t misses = 0;
+	size_t num_used = 0;
+	for (size_t t = 0; t < num_tris; ++t) {
+		misses += cache.triangleMisses(&indices[t * 3]);
+		for (size_t k = 0; k < 3; ++k) {
+			Uint32 v = indices[t * 3 + k];
+			if (!b_used[v]) {
+				b_used[v] = true;
+				++num_used;
+			}
+		}
+	}
+
+	return {
+		.acmr = float(misses) / float(num_tris),
+		.atvr = float(misses) / float(num_used),
+	};
+}
+
+Report optimize(
+	std::vector<TextureVertex>& vertices,
+	std::vector<Uint32>& indices,
+	const Settings& settings) noexcept
+{
+	Report report;
+	report.vertices_before = vertices.size();
+	report.before = analyze(indices, vertices.size(), settings.cache_size);
+
+	if (settings.b_weld) {
+		(void)weld(vertices, indices);
+	}
+	if (settings.b_vertex_cache) {
+		optimizeVertexCache(indices, vertices.size());
+	}
+	if (settings.b_overdraw) {
+		optimizeOverdraw(indices, vertices, settings.overdraw_threshold, settings.cache_size);
+	}
+	if (settings.b_vertex_fetch) {
+		(void)optimizeVertexFetch(vertices, indices);
+	}
+
+	report.vertices_after = vertices.size();
+	report.after = analyze(indices, vertices.size(), settings.cache_size);
+	return report;
+}
+
+size_t weld(std::vector<TextureVertex>& vertices, std::vector<Uint32>& indices) noexcept
+{
+	if (vertices.empty()) return 0;
+
+	// Open addressing over the unique vertices, compacted to the front in place
+	size_t table_size = std::bit_ceil(vertices.size() * 2);
+	size_t mask = table_size - 1;
+	std::vector<Uint32> table(table_size, NONE);
+	std::vector<Uint32> remap(vertices.size());
+
+	Uint32 num_unique = 0;
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		size_t slot = hashVertex(vertices[i]) & mask;
+		while (table[slot] != NONE &&
+			std::memcmp(&vertices[table[slot]], &vertices[i], sizeof(TextureVertex)) != 0)
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		if (table[slot] == NONE) {
+			vertices[num_unique] = vertices[i];
+			table[slot] = num_unique++;
+		}
+		remap[i] = table[slot];
+	}
+
+	for (auto& index : indices) {
+		index = remap[index];
+	}
+	vertices.resize(num_unique);
+	return num_unique;
+}
+
+void optimizeVertexCache(std::span<Uint32> indices, size_t num_vertices) noexcept
+{
+	size_t num_tris = indices.size() / 3;
+	if (num_tris == 0) return;
+
+	// Triangles around each vertex, emitted ones are swapped past the end
+	std::vector<Uint32> offsets(num_vertices + 1, 0);
+	std::vector<Uint32> remaining(num_vertices, 0);
+	for (size_t i = 0; i < num_tris * 3; ++i) {
+		++remaining[indices[i]];
+	}
+	for (size_t v = 0; v < num_vertices; ++v) {
+		offsets[v + 1] = offsets[v] + remaining[v];
+	}
+	std::vector<Uint32> adjacency(num_tris * 3);
+	{
+		std::vector<Uint32> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < num_tris * 3; ++i) {
+			adjacency[fill[indices[i]]++] = static_cast<Uint32>(i / 3);
+		}
+	}
+
+	std::vector<int> cache_pos(num_vertices, -1);
+	std::vector<float> vertex_scores(num_vertices);
+	for (size_t v = 0; v < num_vertices; ++v) {
+		vertex_scores[v] = vertexScore(-1, remaining[v]);
+	}
+
+	auto triangleScore = [&](Uint32 t) {
+		return vertex_scores[indices[t * 3]] +
+			vertex_scores[indices[t * 3 + 1]] +
+			vertex_scores[indices[t * 3 + 2]];
+	};
+
+	std::vector<bool> b_emitted(num_tris, false);
+	std::vector<Uint32> result;
+	result.reserve(num_tris * 3);
+
+	std::array<Uint32, LRU_SIZE + 3> cache;
+	std::array<Uint32, LRU_SIZE + 3> next_cache;
+	size_t cache_count = 0;
+
+	Uint32 best = 0;
+	size_t cursor = 0;
+	for (size_t num_emitted = 0; num_emitted < num_tris; ++num_emitted) {
+		// Nothing in the cache has triangles left, continue in input order
+		if (best == NONE) {
+			while (b_emitted[cursor]) ++cursor;
+			best = static_cast<Uint32>(cursor);
+		}
+
+		const Uint32* tri = &indices[best * 3];
+		result.insert(result.end(), tri, tri + 3);
+		b_emitted[best] = true;
+
+		for (size_t k = 0; k < 3; ++k) {
+			Uint32 v = tri[k];
+			Uint32* begin = &adjacency[offsets[v]];
+			Uint32* end = begin + remaining[v];
+			Uint32* it = std::find(begin, end, best);
+			std::swap(*it, *(end - 1));
+			--remaining[v];
+		}
+
+		// Emitted vertices move to the front, the rest shift back
+		size_t next_count = 0;
+		for (size_t k = 0; k < 3; ++k) {
+			if (std::find(next_cache.begin(), next_cache.begin() + next_count, tri[k]) ==
+				next_cache.begin() + next_count)
+			{
+				next_cache[next_count++] = tri[k];
+			}
+		}
+		for (size_t i = 0; i < cache_count; ++i) {
+			Uint32 v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2]) {
+				next_cache[next_count++] = v;
+			}
+		}
+
+		for (size_t i = 0; i < next_count; ++i) {
+			Uint32 v = next_cache[i];
+			cache_pos[v] = (i < LRU_SIZE) ? static_cast<int>(i) : -1;
+			vertex_scores[v] = vertexScore(cache_pos[v], remaining[v]);
+		}
+
+		// Only triangles touching the cache changed score
+		best = NONE;
+		float best_score = -std::numeric_limits<float>::max();
+		for (size_t i = 0; i < next_count; ++i) {
+			Uint32 v = next_cache[i];
+			for (Uint32 j = 0; j < remaining[v]; ++j) {
+				Uint32 t = adjacency[offsets[v] + j];
+				float score = triangleScore(t);
+				if (score > best_score) {
+					best_score = score;
+					best = t;
+				}
+			}
+		}
+
+		cache_count = std::min<size_t>(next_count, LRU_SIZE);
+		std::copy_n(next_cache.begin(), cache_count, cache.begin());
+	}
+
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void optimizeOverdraw(
+	std::span<Uint32> indices,
+	std::span<const TextureVertex> vertices,
+	float threshold,
+	Uint32 cache_size) noexcept
+{
+	size_t num_tris = indices.size() / 3;
+	if (num_tris < 2) return;
+
+	// Hard boundaries where the cache ordering started over, every vertex missed
+	FifoCache cache(vertices.size(), cache_size);
+	std::vector<size_t> hard = { 0 };
+	for (size_t t = 0; t < num_tris; ++t) {
+		if (cache.triangleMisses(&indices[t * 3]) == 3 && t > 0) {
+			hard.push_back(t);
+		}
+	}
+	hard.push_back(num_tris);
+
+	// Soft boundaries split a hard cluster wherever the part so far is
+	// cheap enough, so reordering costs at most threshold in ACMR
+	std::vector<size_t> clusters;
+	for (size_t h = 0; h + 1 < hard.size(); ++h) {
+		size_t begin = hard[h];
+		size_t end = hard[h + 1];
+
+		cache.flush();
+		size_t cluster_misses = 0;
+		for (size_t t = begin; t < end; ++t) {
+			cluster_misses += cache.triangleMisses(&indices[t * 3]);
+		}
+		float limit = threshold * float(cluster_misses) / float(end - begin);
+
+		cache.flush();
+		size_t start = begin;
+		size_t misses = 0;
+		clusters.push_back(begin);
+		for (size_t t = begin; t + 1 < end; ++t) {
+			misses += cache.triangleMisses(&indices[t * 3]);
+			if (float(misses) <= limit * float(t + 1 - start)) {
+				clusters.push_back(t + 1);
+				start = t + 1;
+				misses = 0;
+				cache.flush();
+			}
+		}
+	}
+	clusters.push_back(num_tris);
+
+	// Area weighted centroids, the mesh center is the same over all triangles
+	size_t num_clusters = clusters.size() - 1;
+	std::vector<glm::vec3> centroids(num_clusters, glm::vec3(0.f));
+	std::vector<glm::vec3> normals(num_clusters, glm::vec3(0.f));
+	std::vector<float> areas(num_clusters, 0.f);
+	glm::vec3 mesh_center(0.f);
+	float mesh_area = 0.f;
+	for (size_t c = 0; c < num_clusters; ++c) {
+		for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+			const Uint32* tri = &indices[t * 3];
+			glm::vec3 cross = triangleCross(tri, vertices);
+			float area = glm::length(cross);
+			glm::vec3 center = (vertices[tri[0]].pos + vertices[tri[1]].pos + vertices[tri[2]].pos) / 3.f;
+
+			centroids[c] += center * area;
+			normals[c] += cross;
+			areas[c] += area;
+		}
+		mesh_center += centroids[c];
+		mesh_area += areas[c];
+		if (areas[c] > 0.f) centroids[c] /= areas[c];
+	}
+	if (mesh_area > 0.f) mesh_center /= mesh_area;
+
+	std::vector<float> keys(num_clusters, 0.f);
+	for (size_t c = 0; c < num_clusters; ++c) {
+		float length = glm::length(normals[c]);
+		if (length > 0.f) {
+			keys[c] = glm::dot(centroids[c] - mesh_center, normals[c] / length);
+		}
+	}
+
+	std::vector<Uint32> order(num_clusters);
+	for (size_t c = 0; c < num_clusters; ++c) order[c] = static_cast<Uint32>(c);
+	std::stable_sort(order.begin(), order.end(), [&](Uint32 a, Uint32 b) {
+		return keys[a] > keys[b];
+	});
+
+	std::vector<Uint32> result;
+	result.reserve(indices.size());
+	for (Uint32 c : order) {
+		result.insert(
+			result.end(),
+			indices.begin() + clusters[c] * 3,
+			indices.begin() + clusters[c + 1] * 3
+		);
+	}
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+size_t optimizeVertexFetch(std::vector<TextureVertex>& vertices, std::span<Uint32> indices) noexcept
+{
+	std::vector<Uint32> remap(vertices.size(), NONE);
+	std::vector<TextureVertex> ordered;
+	ordered.reserve(vertices.size());
+
+	for (auto& index : indices) {
+		if (remap[index] == NONE) {
+			remap[index] = static_cast<Uint32>(ordered.size());
+			ordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	vertices.swap(ordered);
+	return vertices.size();
+}
+
+std::vector<Part> split(
+	std::span<const TextureVertex> vertices,
+	std::span<const Uint32> indices,
+	size_t max_vertices) noexcept
+{
+	max_vertices = std::max<size_t>(max_vertices, 3);
+
+	std::vector<Part> parts;
+	std::vector<Uint32> remap(vertices.size(), NONE);
+	std::vector<Uint32> touched;
+	Part part;
+
+	auto flush = [&]() {
+		for (Uint32 v : touched) remap[v] = NONE;
+		touched.clear();
+		parts.push_back(std::move(part));
+		part = {};
+	};
+
+	for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+		Uint32 a = indices[t];
+		Uint32 b = indices[t + 1];
+		Uint32 c = indices[t + 2];
+		size_t num_new =
+			(remap[a] == NONE) +
+			(remap[b] == NONE && b != a) +
+			(remap[c] == NONE && c != a && c != b);
+
+		if (part.vertices.size() + num_new > max_vertices) {
+			flush();
+		}
+
+		for (Uint32 v : { a, b, c }) {
+			if (remap[v] == NONE) {
+				remap[v] = static_cast<Uint32>(part.vertices.size());
+				part.vertices.push_back(vertices[v]);
+				touched.push_back(v);
+			}
+			part.indices.push_back(remap[v]);
+		}
+	}
+
+	if (!part.indices.empty() || parts.empty()) {
+		flush();
+	}
+	return parts;
+}
+
+};	// end of namespace
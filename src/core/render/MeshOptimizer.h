@@ -0,0 +1,92 @@
+#pragma once
+
+#include "core/render/Vertex.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace APE::Render::MeshOpt {
+
+/*
+* Import time mesh optimization
+* Passes run in order: welding merges vertices with identical attributes,
+* vertex cache ordering reorders triangles for post-transform cache hits,
+* overdraw ordering sorts clusters of those triangles front facing first,
+* and vertex fetch ordering lays vertices out in the order they are used.
+* Triangles keep their winding throughout.
+*/
+struct Settings {
+	bool b_weld = true;
+	bool b_vertex_cache = true;
+	bool b_overdraw = true;
+	bool b_vertex_fetch = true;
+
+	// Overdraw ordering may raise ACMR by at most this factor
+	float overdraw_threshold = 1.05f;
+
+	// FIFO size used to simulate the post-transform cache
+	Uint32 cache_size = 16;
+
+	// Meshes too large for 16 bit indices are split into parts that fit,
+	// otherwise they are drawn with 32 bit indices
+	bool b_split_index16 = false;
+};
+
+struct CacheStats {
+	// Average cache miss ratio, transformed vertices per triangle, 0.5 at best
+	float acmr = 0.f;
+	// Average transform to vertex ratio, 1.0 when every vertex is shaded once
+	float atvr = 0.f;
+};
+
+struct Report {
+	CacheStats before;
+	CacheStats after;
+	size_t vertices_before = 0;
+	size_t vertices_after = 0;
+};
+
+[[nodiscard]] CacheStats analyze(
+	std::span<const Uint32> indices,
+	size_t num_vertices,
+	Uint32 cache_size = 16) noexcept;
+
+// Runs the passes enabled in settings
+Report optimize(
+	std::vector<TextureVertex>& vertices,
+	std::vector<Uint32>& indices,
+	const Settings& settings = {}) noexcept;
+
+// Merges vertices whose attributes match bit for bit, returns the new count
+size_t weld(std::vector<TextureVertex>& vertices, std::vector<Uint32>& indices) noexcept;
+
+// Forsyth's linear speed ordering with a 32 entry LRU cache model
+void optimizeVertexCache(std::span<Uint32> indices, size_t num_vertices) noexcept;
+
+// Splits a cache ordered list into clusters and draws those facing away
+// from the mesh center first, so they occlude the rest
+void optimizeOverdraw(
+	std::span<Uint32> indices,
+	std::span<const TextureVertex> vertices,
+	float threshold = 1.05f,
+	Uint32 cache_size = 16) noexcept;
+
+// Orders vertices by first use and drops unreferenced ones, returns the new count
+size_t optimizeVertexFetch(std::vector<TextureVertex>& vertices, std::span<Uint32> indices) noexcept;
+
+struct Part {
+	std::vector<TextureVertex> vertices;
+	std::vector<Uint32> indices;
+};
+
+// Cuts the triangle list, in its current order, into parts of at most
+// max_vertices vertices. Vertices shared across a cut are duplicated.
+[[nodiscard]] std::vector<Part> split(
+	std::span<const TextureVertex> vertices,
+	std::span<const Uint32> indices,
+	size_t max_vertices) noexcept;
+
+};	// end of namespace
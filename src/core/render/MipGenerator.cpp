@@ -0,0 +1,475 @@
+#include "core/render/MipGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define APE_MIP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace APE::Render::Mip {
+
+namespace {
+
+constexpr Uint32 CHANNELS = 4;
+
+/*
+* sRGB transfer tables
+*/
+constexpr Uint32 LINEAR_STEPS = 16384;
+
+struct SrgbTables {
+	std::array<float, 256> to_linear;
+	std::array<uint8_t, LINEAR_STEPS> to_srgb;
+
+	SrgbTables() noexcept
+	{
+		for (Uint32 i = 0; i < 256; ++i) {
+			float c = i / 255.f;
+			to_linear[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+		for (Uint32 i = 0; i < LINEAR_STEPS; ++i) {
+			float l = i / float(LINEAR_STEPS - 1);
+			float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * std::pow(l, 1.f / 2.4f) - 0.055f;
+			to_srgb[i] = static_cast<uint8_t>(std::lround(std::clamp(c, 0.f, 1.f) * 255.f));
+		}
+	}
+};
+
+const SrgbTables& srgbTables() noexcept
+{
+	static const SrgbTables tables;
+	return tables;
+}
+
+/*
+* Separable kernels, taps start at 2 * x + first in the source
+*/
+struct Kernel {
+	int first;
+	std::vector<float> weights;
+};
+
+[[nodiscard]] double besselI0(double x) noexcept
+{
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; ++k) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+[[nodiscard]] Kernel makeKaiser() noexcept
+{
+	constexpr double ALPHA = 4.0;
+	constexpr double RADIUS = 1.5;
+
+	// Source texel centers sit at +-0.25, 0.75 and 1.25 destination texels
+	Kernel kernel { -2, {} };
+	double total = 0.0;
+	for (int i = -2; i <= 3; ++i) {
+		double t = (i - 0.5) / 2.0;
+		double sinc = std::sin(std::numbers::pi * t) / (std::numbers::pi * t);
+		double r = t / RADIUS;
+		double window = besselI0(ALPHA * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(ALPHA);
+		kernel.weights.push_back(static_cast<float>(sinc * window));
+		total += sinc * window;
+	}
+	for (auto& w : kernel.weights) w = static_cast<float>(w / total);
+	return kernel;
+}
+
+const Kernel& kernelFor(Filter filter) noexcept
+{
+	static const Kernel box { 0, { 0.5f, 0.5f } };
+	static const Kernel kaiser = makeKaiser();
+	return (filter == Filter::Kaiser) ? kaiser : box;
+}
+
+// Values are clamped non-negative first, so adding a half rounds
+[[nodiscard]] inline Uint32 roundClamped(float v, float max) noexcept
+{
+	return static_cast<Uint32>(std::clamp(v, 0.f, 1.f) * max + 0.5f);
+}
+
+// RGBA8 row to floats in the space the settings average in
+void decodeRow(const std::byte* src, Uint32 width, const Settings& settings, float* out) noexcept
+{
+	const auto* texels = reinterpret_cast<const uint8_t*>(src);
+	auto& to_linear = srgbTables().to_linear;
+	for (Uint32 x = 0; x < width; ++x) {
+		const uint8_t* in = texels + x * CHANNELS;
+		float* texel = out + x * CHANNELS;
+		for (Uint32 c = 0; c < 3; ++c) {
+			if (settings.b_normal_map) texel[c] = in[c] / 127.5f - 1.f;
+			else if (settings.b_srgb) texel[c] = to_linear[in[c]];
+			else texel[c] = in[c] / 255.f;
+		}
+		texel[3] = in[3] / 255.f;
+	}
+}
+
+void encodeRow(const float* in, Uint32 width, const Settings& settings, std::byte* dst) noexcept
+{
+	auto& to_srgb = srgbTables().to_srgb;
+	for (Uint32 x = 0; x < width; ++x) {
+		const float* src = in + x * CHANNELS;
+		std::byte* texel = dst + x * CHANNELS;
+		if (settings.b_normal_map) {
+			float len_sq = src[0] * src[0] + src[1] * src[1] + src[2] * src[2];
+			float n[3] = { 0.f, 0.f, 1.f };
+			if (len_sq > 1e-12f) {
+				float inv_len = 1.f / std::sqrt(len_sq);
+				for (Uint32 c = 0; c < 3; ++c) n[c] = src[c] * inv_len;
+			}
+			for (Uint32 c = 0; c < 3; ++c) {
+				texel[c] = static_cast<std::byte>(roundClamped(n[c] * 0.5f + 0.5f, 255.f));
+			}
+		}
+		else if (settings.b_srgb) {
+			for (Uint32 c = 0; c < 3; ++c) {
+				texel[c] = static_cast<std::byte>(to_srgb[roundClamped(src[c], LINEAR_STEPS - 1)]);
+			}
+		}
+		else {
+			for (Uint32 c = 0; c < 3; ++c) texel[c] = static_cast<std::byte>(roundClamped(src[c], 255.f));
+		}
+		texel[3] = static_cast<std::byte>(roundClamped(src[3], 255.f));
+	}
+}
+
+#if APE_MIP_SSE2
+
+/*
+* SSE2 rows, a texel's four channels are one vector. Every step keeps the
+* scalar path's operations and their order.
+*/
+void decodeRowSimd(const std::byte* src, Uint32 width, const Settings& settings, float* out) noexcept
+{
+	const auto* texels = reinterpret_cast<const uint8_t*>(src);
+	if (settings.b_srgb && !settings.b_normal_map) {
+		// No gather in SSE2, the table reads stay scalar
+		auto& to_linear = srgbTables().to_linear;
+		for (Uint32 x = 0; x < width; ++x) {
+			const uint8_t* in = texels + x * CHANNELS;
+			_mm_storeu_ps(out + x * CHANNELS,
+				_mm_setr_ps(to_linear[in[0]], to_linear[in[1]], to_linear[in[2]], in[3] / 255.f));
+		}
+		return;
+	}
+
+	const __m128 divisor = settings.b_normal_map ? _mm_setr_ps(127.5f, 127.5f, 127.5f, 255.f) : _mm_set1_ps(255.f);
+	const __m128 bias = settings.b_normal_map ? _mm_setr_ps(1.f, 1.f, 1.f, 0.f) : _mm_setzero_ps();
+	const __m128i zero = _mm_setzero_si128();
+	auto decode = [&](__m128i words, float* texel) {
+		__m128 v = _mm_cvtepi32_ps(words);
+		_mm_storeu_ps(texel, _mm_sub_ps(_mm_div_ps(v, divisor), bias));
+	};
+
+	// Four texels per load
+	Uint32 x = 0;
+	for (; x + 4 <= width; x += 4) {
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + x * CHANNELS));
+		__m128i lo = _mm_unpacklo_epi8(bytes, zero);
+		__m128i hi = _mm_unpackhi_epi8(bytes, zero);
+		decode(_mm_unpacklo_epi16(lo, zero), out + x * CHANNELS);
+		decode(_mm_unpackhi_epi16(lo, zero), out + (x + 1) * CHANNELS);
+		decode(_mm_unpacklo_epi16(hi, zero), out + (x + 2) * CHANNELS);
+		decode(_mm_unpackhi_epi16(hi, zero), out + (x + 3) * CHANNELS);
+	}
+	for (; x < width; ++x) {
+		const uint8_t* in = texels + x * CHANNELS;
+		decode(_mm_setr_epi32(in[0], in[1], in[2], in[3]), out + x * CHANNELS);
+	}
+}
+
+void encodeRowSimd(const float* in, Uint32 width, const Settings& settings, std::byte* dst) noexcept
+{
+	auto& to_srgb = srgbTables().to_srgb;
+	const bool b_srgb = settings.b_srgb && !settings.b_normal_map;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 scale = b_srgb ? _mm_setr_ps(LINEAR_STEPS - 1, LINEAR_STEPS - 1, LINEAR_STEPS - 1, 255.f) : _mm_set1_ps(255.f);
+	const __m128 alpha_mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+	const __m128 up = _mm_setr_ps(0.f, 0.f, 1.f, 0.f);
+
+	for (Uint32 x = 0; x < width; ++x) {
+		__m128 v = _mm_loadu_ps(in + x * CHANNELS);
+
+		if (settings.b_normal_map) {
+			// (x * x + y * y) + z * z, like the scalar sum
+			__m128 sq = _mm_mul_ps(v, v);
+			__m128 len_sq = _mm_add_ss(
+				_mm_add_ss(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1))),
+				_mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 2, 2, 2))
+			);
+			len_sq = _mm_shuffle_ps(len_sq, len_sq, _MM_SHUFFLE(0, 0, 0, 0));
+
+			__m128 n = _mm_mul_ps(v, _mm_div_ps(one, _mm_sqrt_ps(len_sq)));
+			__m128 valid = _mm_cmpgt_ps(len_sq, _mm_set1_ps(1e-12f));
+			n = _mm_or_ps(_mm_and_ps(valid, n), _mm_andnot_ps(valid, up));
+			n = _mm_add_ps(_mm_mul_ps(n, half), half);
+
+			// Alpha is stored as is
+			v = _mm_or_ps(_mm_and_ps(alpha_mask, v), _mm_andnot_ps(alpha_mask, n));
+		}
+
+		v = _mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(v, zero), one), scale), half);
+		__m128i words = _mm_cvttps_epi32(v);
+		std::byte* texel = dst + x * CHANNELS;
+		if (b_srgb) {
+			alignas(16) int32_t idx[CHANNELS];
+			_mm_store_si128(reinterpret_cast<__m128i*>(idx), words);
+			texel[0] = static_cast<std::byte>(to_srgb[idx[0]]);
+			texel[1] = static_cast<std::byte>(to_srgb[idx[1]]);
+			texel[2] = static_cast<std::byte>(to_srgb[idx[2]]);
+			texel[3] = static_cast<std::byte>(idx[3]);
+		}
+		else {
+			__m128i bytes = _mm_packus_epi16(_mm_packs_epi32(words, words), words);
+			int32_t packed = _mm_cvtsi128_si32(bytes);
+			std::memcpy(texel, &packed, CHANNELS);
+		}
+	}
+}
+
+#endif
+
+// Vertical taps are summed a source row at a time, then filtered across,
+// so the working set is a few rows rather than the level
+template <bool SIMD>
+void filterFloat(
+	const Image::MipLevel& src,
+	std::byte* dst,
+	Uint32 dst_w,
+	Uint32 dst_h,
+	const Settings& settings) noexcept
+{
+	const Kernel& kernel = kernelFor(settings.filter);
+	const int taps = static_cast<int>(kernel.weights.size());
+
+	std::vector<float> row(size_t(src.width) * CHANNELS);
+	std::vector<float> column(size_t(src.width) * CHANNELS);
+	std::vector<float> out(size_t(dst_w) * CHANNELS);
+
+	for (Uint32 y = 0; y < dst_h; ++y) {
+		std::fill(column.begin(), column.end(), 0.f);
+		for (int t = 0; t < taps; ++t) {
+			int sy = std::clamp(static_cast<int>(2 * y) + kernel.first + t, 0, static_cast<int>(src.height) - 1);
+			const std::byte* src_row = src.data + size_t(sy) * src.width * CHANNELS;
+			float w = kernel.weights[t];
+#if APE_MIP_SSE2
+			if constexpr (SIMD) {
+				decodeRowSimd(src_row, src.width, settings, row.data());
+				const __m128 weight = _mm_set1_ps(w);
+				for (size_t i = 0; i < column.size(); i += CHANNELS) {
+					__m128 acc = _mm_loadu_ps(column.data() + i);
+					acc = _mm_add_ps(acc, _mm_mul_ps(weight, _mm_loadu_ps(row.data() + i)));
+					_mm_storeu_ps(column.data() + i, acc);
+				}
+				continue;
+			}
+#endif
+			decodeRow(src_row, src.width, settings, row.data());
+			for (size_t i = 0; i < column.size(); ++i) column[i] += w * row[i];
+		}
+
+		for (Uint32 x = 0; x < dst_w; ++x) {
+#if APE_MIP_SSE2
+			if constexpr (SIMD) {
+				__m128 acc = _mm_setzero_ps();
+				for (int t = 0; t < taps; ++t) {
+					int sx = std::clamp(static_cast<int>(2 * x) + kernel.first + t, 0, static_cast<int>(src.width) - 1);
+					__m128 texel = _mm_loadu_ps(column.data() + sx * CHANNELS);
+					acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(kernel.weights[t]), texel));
+				}
+				_mm_storeu_ps(out.data() + x * CHANNELS, acc);
+				continue;
+			}
+#endif
+			float acc[CHANNELS] = {};
+			for (int t = 0; t < taps; ++t) {
+				int sx = std::clamp(static_cast<int>(2 * x) + kernel.first + t, 0, static_cast<int>(src.width) - 1);
+				float w = kernel.weights[t];
+				for (Uint32 c = 0; c < CHANNELS; ++c) acc[c] += w * column[sx * CHANNELS + c];
+			}
+			std::memcpy(out.data() + x * CHANNELS, acc, sizeof(acc));
+		}
+
+		std::byte* dst_row = dst + size_t(y) * dst_w * CHANNELS;
+#if APE_MIP_SSE2
+		if constexpr (SIMD) {
+			encodeRowSimd(out.data(), dst_w, settings, dst_row);
+			continue;
+		}
+#endif
+		encodeRow(out.data(), dst_w, settings, dst_row);
+	}
+}
+
+};	// end of namespace
+
+
+bool isNormalMap(const std::filesystem::path& path) noexcept
+{
+	std::string stem = path.stem().string();
+	std::transform(stem.begin(), stem.end(), stem.begin(), [](unsigned char c) {
+		return static_cast<char>(std::tolower(c));
+	});
+	return stem.find("normal") != std::string::npos;
+}
+
+Settings settingsFor(const std::filesystem::path& path, Filter filter) noexcept
+{
+	bool b_normal_map = isNormalMap(path);
+	return Settings {
+		.filter = filter,
+		.b_srgb = !b_normal_map,
+		.b_normal_map = b_normal_map,
+	};
+}
+
+Chain generate(
+	Uint32 width,
+	Uint32 height,
+	const std::byte* rgba,
+	const Settings& settings,
+	size_t align) noexcept
+{
+	// Lay out the whole chain down to 1x1 before writing any level
+	Chain chain;
+	std::vector<size_t> offsets;
+	size_t total_bytes = 0;
+	Uint32 w = width;
+	Uint32 h = height;
+	while (true) {
+		total_bytes = (total_bytes + align - 1) / align * align;
+		offsets.push_back(total_bytes);
+
+		Uint32 size_bytes = w * h * CHANNELS;
+		chain.levels.push_back({ w, h, size_bytes, nullptr });
+		total_bytes += size_bytes;
+
+		if (w == 1 && h == 1) break;
+		w = std::max<Uint32>(w / 2, 1);
+		h = std::max<Uint32>(h / 2, 1);
+	}
+
+	chain.pixels.resize(total_bytes);
+	std::memcpy(chain.pixels.data(), rgba, chain.levels.front().size_bytes);
+	chain.levels.front().data = chain.pixels.data();
+
+	for (size_t i = 1; i < chain.levels.size(); ++i) {
+		std::byte* dst = chain.pixels.data() + offsets[i];
+		downsample(chain.levels[i - 1], dst, chain.levels[i].width, chain.levels[i].height, settings);
+		chain.levels[i].data = dst;
+	}
+	return chain;
+}
+
+void downsample(
+	const Image::MipLevel& src,
+	std::byte* dst,
+	Uint32 dst_w,
+	Uint32 dst_h,
+	const Settings& settings) noexcept
+{
+	if (settings.filter == Filter::Box && !settings.b_srgb && !settings.b_normal_map) {
+		detail::boxSimd(src, dst, dst_w, dst_h);
+		return;
+	}
+	detail::filterSimd(src, dst, dst_w, dst_h, settings);
+}
+
+void detail::filterScalar(
+	const Image::MipLevel& src,
+	std::byte* dst,
+	Uint32 dst_w,
+	Uint32 dst_h,
+	const Settings& settings) noexcept
+{
+	filterFloat<false>(src, dst, dst_w, dst_h, settings);
+}
+
+void detail::filterSimd(
+	const Image::MipLevel& src,
+	std::byte* dst,
+	Uint32 dst_w,
+	Uint32 dst_h,
+	const Settings& settings) noexcept
+{
+	filterFloat<true>(src, dst, dst_w, dst_h, settings);
+}
+
+void detail::boxScalar(const Image::MipLevel& src, std::byte* dst, Uint32 dst_w, Uint32 dst_h) noexcept
+{
+	auto texel = [&](Uint32 x, Uint32 y, Uint32 c) {
+		x = std::min(x, src.width - 1);
+		y = std::min(y, src.height - 1);
+		return static_cast<Uint32>(src.data[(size_t(y) * src.width + x) * CHANNELS + c]);
+	};
+
+	for (Uint32 y = 0; y < dst_h; ++y) {
+		for (Uint32 x = 0; x < dst_w; ++x) {
+			for (Uint32 c = 0; c < CHANNELS; ++c) {
+				Uint32 sum =
+					texel(2 * x, 2 * y, c) + texel(2 * x + 1, 2 * y, c) +
+					texel(2 * x, 2 * y + 1, c) + texel(2 * x + 1, 2 * y + 1, c);
+				dst[(size_t(y) * dst_w + x) * CHANNELS + c] = static_cast<std::byte>((sum + 2) / 4);
+			}
+		}
+	}
+}
+
+void detail::boxSimd(const Image::MipLevel& src, std::byte* dst, Uint32 dst_w, Uint32 dst_h) noexcept
+{
+#if APE_MIP_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi16(2);
+
+	for (Uint32 y = 0; y < dst_h; ++y) {
+		const auto* row_a = src.data + size_t(std::min(2 * y, src.height - 1)) * src.width * CHANNELS;
+		const auto* row_b = src.data + size_t(std::min(2 * y + 1, src.height - 1)) * src.width * CHANNELS;
+		auto* out = dst + size_t(y) * dst_w * CHANNELS;
+
+		// Two destination texels from four source texels of each row
+		Uint32 x = 0;
+		for (; x + 1 < dst_w && 2 * x + 3 < src.width; x += 2) {
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_a + 2 * x * CHANNELS));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_b + 2 * x * CHANNELS));
+			__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+			__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+			lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+			hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+			__m128i sum = _mm_unpacklo_epi64(lo, hi);
+			sum = _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * CHANNELS), _mm_packus_epi16(sum, zero));
+		}
+
+		// Clamped edges and odd widths
+		for (; x < dst_w; ++x) {
+			Uint32 x0 = std::min(2 * x, src.width - 1);
+			Uint32 x1 = std::min(2 * x + 1, src.width - 1);
+			for (Uint32 c = 0; c < CHANNELS; ++c) {
+				Uint32 sum =
+					static_cast<Uint32>(row_a[x0 * CHANNELS + c]) + static_cast<Uint32>(row_a[x1 * CHANNELS + c]) +
+					static_cast<Uint32>(row_b[x0 * CHANNELS + c]) + static_cast<Uint32>(row_b[x1 * CHANNELS + c]);
+				out[x * CHANNELS + c] = static_cast<std::byte>((sum + 2) / 4);
+			}
+		}
+	}
+#else
+	boxScalar(src, dst, dst_w, dst_h);
+#endif
+}
+
+};	// end of namespace
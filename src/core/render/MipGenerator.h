@@ -0,0 +1,86 @@
+#pragma once
+
+#include "core/render/Image.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+namespace APE::Render::Mip {
+
+/*
+* CPU mip chain generation
+* Every level is filtered from the one above it. Albedo is averaged in linear
+* light and re-encoded to sRGB, normal maps are averaged as vectors and
+* renormalized, alpha and everything else is averaged as stored.
+*/
+enum class Filter : Uint32 {
+	// 2x2 average, odd sizes reuse the last row or column
+	Box,
+	// 6 tap Kaiser windowed sinc, sharper minification with less aliasing
+	Kaiser,
+};
+
+struct Settings {
+	Filter filter = Filter::Box;
+	bool b_srgb = true;
+	bool b_normal_map = false;
+};
+
+// Tangent space normal maps are recognised by name, like "hull_normal.png"
+[[nodiscard]] bool isNormalMap(const std::filesystem::path& path) noexcept;
+
+[[nodiscard]] Settings settingsFor(
+	const std::filesystem::path& path,
+	Filter filter = Filter::Box) noexcept;
+
+// RGBA8 levels down to 1x1, each starting on an align byte boundary.
+// The levels point into pixels, which may be moved but not resized.
+struct Chain {
+	std::vector<std::byte> pixels;
+	std::vector<Image::MipLevel> levels;
+};
+
+[[nodiscard]] Chain generate(
+	Uint32 width,
+	Uint32 height,
+	const std::byte* rgba,
+	const Settings& settings,
+	size_t align = 16) noexcept;
+
+// Filters an RGBA8 level into dst, which is dst_w * dst_h texels
+void downsample(
+	const Image::MipLevel& src,
+	std::byte* dst,
+	Uint32 dst_w,
+	Uint32 dst_h,
+	const Settings& settings) noexcept;
+
+namespace detail {
+
+// Integer box filter for data that is averaged as stored.
+// The SIMD path must match the scalar one exactly.
+void boxScalar(const Image::MipLevel& src, std::byte* dst, Uint32 dst_w, Uint32 dst_h) noexcept;
+void boxSimd(const Image::MipLevel& src, std::byte* dst, Uint32 dst_w, Uint32 dst_h) noexcept;
+
+// Float filter for sRGB, normal maps and Kaiser, what Image takes.
+// The SIMD path keeps the scalar one's arithmetic, so they agree too.
+void filterScalar(
+	const Image::MipLevel& src,
+	std::byte* dst,
+	Uint32 dst_w,
+	Uint32 dst_h,
+	const Settings& settings) noexcept;
+
+void filterSimd(
+	const Image::MipLevel& src,
+	std::byte* dst,
+	Uint32 dst_w,
+	Uint32 dst_h,
+	const Settings& settings) noexcept;
+
+};	// end of namespace
+
+};	// end of namespace
@@ -3,8 +3,14 @@
 #include "core/components/Object.h"
 #include "core/render/Mesh.h"
 #include "core/render/Vertex.h"
+#include "physics/collisions/Colliders.h"
+#include "physics/collisions/Collisions.h"
+#include "physics/collisions/CookedMesh.h"
 
+#include <algorithm>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string_view>
 
@@ -23,6 +29,16 @@ struct Model {
 	std::filesystem::path model_path;
 	TransformComponent transform;
 
+	// Bounds of all meshes in model space
+	Physics::Collisions::AABB bounds;
+	Physics::Collisions::Sphere bounding_sphere;
+
+	struct CollisionCache {
+		std::once_flag once;
+		std::unique_ptr<Physics::Collisions::CookedMesh> cooked;
+	};
+	std::unique_ptr<CollisionCache> collision_cache = std::make_unique<CollisionCache>();
+
 	Model() noexcept = default;
 
 	Model(std::filesystem::path model_path) noexcept
@@ -30,6 +46,85 @@ struct Model {
 	{
 
 	}
+
+	// Vertex and index copies kept on the CPU, for the asset budget
+	[[nodiscard]] size_t cpuBytes() const noexcept
+	{
+		size_t bytes = meshes.capacity() * sizeof(ModelMesh);
+		for (auto& mesh : meshes) {
+			bytes += mesh.vertices.capacity() * sizeof(VertexType);
+			bytes += mesh.indices.capacity() * sizeof(IndexType);
+			bytes += mesh.lod_indices.capacity() * sizeof(IndexType);
+			bytes += mesh.compact_vertices.capacity() * sizeof(CompactVertex);
+			bytes += mesh.positions.capacity() * sizeof(PositionVertex);
+		}
+		return bytes;
+	}
+
+	// Triangles of all meshes in model space, cooked on first use and
+	// shared by every body made from this model
+	[[nodiscard]] const Physics::Collisions::CookedMesh& collision() const noexcept
+	{
+		std::call_once(collision_cache->once, [this]() {
+			std::vector<Physics::Collisions::Triangle> tris;
+			for (auto& mesh : meshes) {
+				glm::mat4 mesh_mat = mesh.transform.getModelMatrix();
+				auto place = [&](const glm::vec3& p) {
+					return glm::vec3(mesh_mat * glm::vec4(p, 1.f));
+				};
+				for (auto& [v0, v1, v2] : mesh.triangles()) {
+					tris.emplace_back(place(v0), place(v1), place(v2));
+				}
+			}
+			collision_cache->cooked = std::make_unique<Physics::Collisions::CookedMesh>(
+				Physics::Collisions::cook(std::move(tris))
+			);
+		});
+		return *collision_cache->cooked;
+	}
+
+	// Call once all meshes have been added
+	void computeBounds() noexcept
+	{
+		if (meshes.empty()) {
+			bounds = Physics::Collisions::AABB();
+			bounding_sphere = Physics::Collisions::Sphere();
+			return;
+		}
+
+		// Meshes are placed in the model by their node transforms
+		std::vector<Physics::Collisions::AABB> mesh_bounds;
+		mesh_bounds.reserve(meshes.size());
+		for (auto& mesh : meshes) {
+			mesh_bounds.push_back(Physics::Collisions::transformAABB(
+				mesh.bounds,
+				mesh.transform.getModelMatrix()
+			));
+		}
+
+		bounds = mesh_bounds.front();
+		for (auto& box : mesh_bounds) {
+			bounds = bounds.merge(box);
+		}
+
+		// Enclose each mesh sphere moved into model space
+		glm::vec3 center = bounds.center();
+		float radius = 0.f;
+		for (auto& mesh : meshes) {
+			glm::mat4 mesh_mat = mesh.transform.getModelMatrix();
+			glm::vec3 mesh_center = glm::vec3(
+				mesh_mat * glm::vec4(mesh.bounding_sphere.center, 1.f)
+			);
+			glm::vec3 scale = glm::abs(mesh.transform.scale);
+			float max_scale = std::max(std::max(scale.x, scale.y), scale.z);
+
+			radius = std::max(radius, 
+				glm::length(mesh_center - center) + 
+				mesh.bounding_sphere.radius * max_scale
+			);
+		}
+		bounding_sphere = Physics::Collisions::Sphere(center, radius);
+	}
 };
 
 };	// end of namespace
@@ -1,6 +1,9 @@
 #include "core/render/Renderer.h"
+#include "core/render/BlockCompression.h"
+#include "core/render/Lod.h"
 #include "core/render/SafeGPU.h"
 #include "core/render/Vertex.h"
+#include "core/scene/AssetLoader.h"
 #include "util/Logger.h"
 
 #include <SDL3/SDL_gpu.h>
@@ -20,6 +23,11 @@ Renderer::Renderer(std::shared_ptr<Context> context) noexcept
 	, clear_color(SDL_FColor { 0.f, 1.f, 1.f, 1.f })
 	, m_shader(nullptr)
 	, m_pipeline({})
+	, m_compact_shader(nullptr)
+	, m_compact_pipeline({})
+	, m_b_compact_supported(true)
+	, m_b_compact_failed(false)
+	, m_bound_pipeline(nullptr)
 	, m_debug_shader(nullptr)
 	, m_debug_pipeline({})
 	, m_swapchain_texture(nullptr)
@@ -53,6 +61,11 @@ Renderer::Renderer(std::shared_ptr<Context> context,
 	, clear_color(SDL_FColor { 0.f, 1.f, 1.f, 1.f })
 	, m_shader(shader)
 	, m_pipeline({})
+	, m_compact_shader(nullptr)
+	, m_compact_pipeline({})
+	, m_b_compact_supported(false)
+	, m_b_compact_failed(false)
+	, m_bound_pipeline(nullptr)
 	, m_debug_shader(nullptr)
 	, m_debug_pipeline({})
 	, m_swapchain_texture(nullptr)
@@ -94,6 +107,10 @@ void Renderer::reset() noexcept
 	}
 	m_pipeline = std::move(pipeline);
 
+	// Rebuilt on next use
+	m_compact_pipeline = {};
+	m_b_compact_failed = false;
+
 	createSampler();
 	createDepthTexture();
 
@@ -274,6 +291,34 @@ void Renderer::bindPipeline(SafePipeline* pipeline) noexcept
 	SDL_BindGPUGraphicsPipeline(m_render_pass, render_pipeline);
 }
 
+bool Renderer::loadCompactPipeline() noexcept
+{
+	if (m_compact_pipeline.fill && m_compact_pipeline.line) return true;
+
+	// User shaders have no compact variant, their meshes draw full vertices
+	if (!m_b_compact_supported || m_b_compact_failed) return false;
+
+	if (!m_compact_shader) {
+		m_compact_shader = std::make_unique<Shader>(
+			compact_vert_shader_desc,
+			default_frag_shader_desc,
+			m_context->device
+		);
+	}
+
+	auto pipeline = shaderToPipeline(
+		m_compact_shader.get(),
+		SDL_GPU_PRIMITIVETYPE_TRIANGLELIST
+	);
+	if (!pipeline.fill || !pipeline.line) {
+		APE_WARN("Renderer: compact vertex pipeline unavailable, drawing full vertices");
+		m_b_compact_failed = true;
+		return false;
+	}
+	m_compact_pipeline = std::move(pipeline);
+	return true;
+}
+
 void Renderer::beginDrawing() noexcept
 {
 	// Check that we are not already drawing
@@ -316,6 +361,7 @@ void Renderer::beginDrawing() noexcept
 
 	// Bind render pipeline
 	bindPipeline(&m_pipeline);
+	m_bound_pipeline = &m_pipeline;
 }
 
 void Renderer::draw(
@@ -335,21 +381,38 @@ void Renderer::draw(
 	);
 	auto cam = camera.lock();
 
-	// Check if gpu vertex buffer was already created
-	auto& raw_mesh = mesh.model_handle.data->meshes[mesh.mesh_index];
-	if (!raw_mesh.vertex_buffer) {
+	// Models that were evicted are skipped until they stream back in
+	auto [model, texture] = AssetLoader::resolveAll<Model, Image>(
+		mesh.model_id,
+		material.texture_id
+	);
+	if (!model) return;
+
+	// Meshes imported with a compact stream draw it through the variant
+	auto& raw_mesh = model->meshes[mesh.mesh_index];
+	bool b_compact = !raw_mesh.compact_vertices.empty() && loadCompactPipeline();
+	SafePipeline* pipeline = b_compact ? &m_compact_pipeline : &m_pipeline;
+	if (pipeline != m_bound_pipeline) {
+		bindPipeline(pipeline);
+		m_bound_pipeline = pipeline;
+	}
+
+	// Check if gpu vertex buffer was already created for this layout, the
+	// compact pipeline may come and go or another renderer may lack it
+	auto& vertex_buffer = b_compact ? raw_mesh.compact_vertex_buffer : raw_mesh.vertex_buffer;
+	if (!vertex_buffer) {
 		// Create GPU buffer with vertex data
-		SafeGPU::UniqueGPUBuffer vertex_buffer = uploadBuffer(
-			vectorToRawBytes(raw_mesh.vertices),
+		vertex_buffer = uploadBuffer(
+			b_compact
+				? vectorToRawBytes(raw_mesh.compact_vertices)
+				: vectorToRawBytes(raw_mesh.vertices),
 			SDL_GPU_BUFFERUSAGE_VERTEX
 		);
-
-		raw_mesh.vertex_buffer = std::move(vertex_buffer);
 	}
 
 	// Bind vertex buffer
 	SDL_GPUBufferBinding vertex_buffer_binding = {
-		.buffer = raw_mesh.vertex_buffer.get(),
+		.buffer = vertex_buffer.get(),
 		.offset = 0,
 	};
 	SDL_BindGPUVertexBuffers(
@@ -360,11 +423,21 @@ void Renderer::draw(
 	);
 
 
-	// Check if gpu index buffer was already created
+	// Check if gpu index buffer was already created, LODs follow the full mesh
 	if (!raw_mesh.index_buffer) {
-		// Create GPU buffer with index data
+		std::vector<Model::IndexType> all_indices = raw_mesh.indices;
+		all_indices.insert(
+			all_indices.end(),
+			raw_mesh.lod_indices.begin(),
+			raw_mesh.lod_indices.end()
+		);
+
+		// Create GPU buffer with index data at the mesh's width
+		bool b_index16 = raw_mesh.index_size == sizeof(Uint16);
 		SafeGPU::UniqueGPUBuffer index_buffer = uploadBuffer(
-			vectorToRawBytes(raw_mesh.indices),
+			b_index16
+				? vectorToRawBytes(narrowIndices<Uint16, Model::IndexType>(all_indices))
+				: vectorToRawBytes(all_indices),
 			SDL_GPU_BUFFERUSAGE_INDEX
 		);
 
@@ -379,16 +452,23 @@ void Renderer::draw(
 	SDL_BindGPUIndexBuffer(
 		m_render_pass,
 		&index_buffer_binding,
-		SDL_GPU_INDEXELEMENTSIZE_32BIT
+		(raw_mesh.index_size == sizeof(Uint16))
+			? SDL_GPU_INDEXELEMENTSIZE_16BIT
+			: SDL_GPU_INDEXELEMENTSIZE_32BIT
 	);
 
 
-	// Check if mesh texture was uploaded yet
-	auto& texture = material.texture_handle.data;
+	// Check if mesh texture was uploaded yet, the default image stands in
+	// while the real texture is still decoding
+	AssetHandle<Image> fallback;
+	if (!texture) {
+		fallback = ImageLoader::defaultImage();
+		texture = fallback.get().get();
+	}
 	if (!texture->textureBuffer()) {
 		// Create GPU Texture
 		SafeGPU::UniqueGPUTexture gpu_tex = createTexture(
-			texture.get()
+			texture
 		);
 		texture->textureBuffer() = std::move(gpu_tex);
 	}
@@ -430,6 +510,20 @@ void Renderer::draw(
 		sizeof(mvp_uniform)
 	);
 
+	// Bind Quantization Uniform
+	if (b_compact) {
+		QuantizationUniform quant_uniform {
+			.center = glm::vec4(raw_mesh.quantization.center, 0.f),
+			.extent = glm::vec4(raw_mesh.quantization.extent, 0.f),
+		};
+		SDL_PushGPUVertexUniformData(
+			m_cmd_buf,
+			2,
+			&quant_uniform,
+			sizeof(quant_uniform)
+		);
+	}
+
 
 	// Bind DebugMode Uniform
 	SDL_PushGPUFragmentUniformData(
@@ -450,11 +544,20 @@ void Renderer::draw(
 
 
 
-	// Draw mesh
+	// Draw the level that fits the mesh's size on screen
+	auto sphere = Lod::worldSphere(raw_mesh.bounding_sphere, model_matrix);
+	float radius_pixels = Lod::projectedRadius(
+		sphere,
+		cam->getPosition(),
+		Lod::projectionScale(cam->getFOV(), static_cast<float>(m_context->window_height))
+	);
+	mesh.lod_level = Lod::select(raw_mesh.lods, radius_pixels, mesh.lod_level);
+	auto [first_index, num_indices] = raw_mesh.lodRange(mesh.lod_level);
+
 	SDL_DrawGPUIndexedPrimitives(
 		m_render_pass, 
-		raw_mesh.indices.size(), 
-		1, 0, 0, 0
+		num_indices, 
+		1, first_index, 0, 0
 	);
 }
 
@@ -654,17 +757,21 @@ SafeGPU::UniqueGPUBuffer Renderer::uploadBuffer(
 
 SDL_GPUTextureFormat Renderer::getTextureFormat(Image* image) noexcept
 {
-	switch (image->getNumChannels()) {
-	case 1:
-		return SDL_GPU_TEXTUREFORMAT_R8_UNORM;
-	case 2:
-		return SDL_GPU_TEXTUREFORMAT_R8G8_UNORM;
-	case 4:
+	switch (image->getFormat()) {
+	case TextureFormat::RGBA8:
 		return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+	case TextureFormat::BC1_RGBA:
+		return SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM;
+	case TextureFormat::BC3_RGBA:
+		return SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM;
+	case TextureFormat::BC5_RG:
+		return SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM;
+	case TextureFormat::BC7_RGBA:
+		return SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM;
 	default:
 		APE_ERROR(
-			"Unsupported texture channel count: {}",
-	    		image->getNumChannels()
+			"Unsupported texture format: {}",
+			static_cast<Uint32>(image->getFormat())
 		);
 		return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
 	}
@@ -672,15 +779,48 @@ SDL_GPUTextureFormat Renderer::getTextureFormat(Image* image) noexcept
 
 SafeGPU::UniqueGPUTexture Renderer::createTexture(Image* image) noexcept
 {
+	const std::vector<Image::MipLevel>* level_list = &image->getMipLevels();
+	SDL_GPUTextureFormat format = getTextureFormat(image);
+
+	// Devices without BC sampling get the levels decoded back to RGBA8
+	std::vector<std::vector<std::byte>> decoded;
+	std::vector<Image::MipLevel> decoded_levels;
+	if (isBlockCompressed(image->getFormat()) &&
+		!SDL_GPUTextureSupportsFormat(
+			m_context->device,
+			format,
+			SDL_GPU_TEXTURETYPE_2D,
+			SDL_GPU_TEXTUREUSAGE_SAMPLER))
+	{
+		APE_WARN(
+			"Renderer::createTexture() Block compressed format {} unsupported, decompressing {}.",
+			static_cast<Uint32>(image->getFormat()),
+			image->getPath().string()
+		);
+
+		for (auto& level : *level_list) {
+			decoded.push_back(BC::decompress(image->getFormat(), level.data, level.width, level.height));
+			decoded_levels.push_back({
+				.width = level.width,
+				.height = level.height,
+				.size_bytes = static_cast<Uint32>(decoded.back().size()),
+				.data = decoded.back().data(),
+			});
+		}
+		level_list = &decoded_levels;
+		format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+	}
+	auto& levels = *level_list;
+
 	// Create texture
 	SDL_GPUTextureCreateInfo tex_desc = {
 		.type = SDL_GPU_TEXTURETYPE_2D,
-		.format = getTextureFormat(image),
+		.format = format,
 		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
 		.width = image->getWidth(),
 		.height = image->getHeight(),
 		.layer_count_or_depth = 1,
-		.num_levels = 1,
+		.num_levels = static_cast<Uint32>(levels.size()),
 	};
 	SDL_GPUTexture* texture = SDL_CreateGPUTexture(m_context->device, &tex_desc);
 
@@ -692,28 +832,34 @@ SafeGPU::UniqueGPUTexture Renderer::createTexture(Image* image) noexcept
 		}
 	);
 
+	// Every level goes up in one transfer buffer
+	std::vector<Uint32> offsets;
+	Uint32 total_bytes = 0;
+	for (auto& level : levels) {
+		offsets.push_back(total_bytes);
+		total_bytes += level.size_bytes;
+	}
+
 	// Create transfer buffer
 	SDL_GPUTransferBufferCreateInfo transfer_desc = {
 		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-		.size = image->getSizeBytes(),
+		.size = total_bytes,
 	};
 	SDL_GPUTransferBuffer* transfer_buf = SDL_CreateGPUTransferBuffer(
 		m_context->device,
 		&transfer_desc
 	);
 
-	// Write data to transfer buffer
+	// Write data to transfer buffer, cooked levels come straight from the mapping
 	std::byte* mapped = static_cast<std::byte*>(SDL_MapGPUTransferBuffer(
 		m_context->device, 
 		transfer_buf, 
 		false
 	));
 
-	std::memcpy(
-		mapped,
-		static_cast<void*>(image->getPixels()),
-		image->getSizeBytes()
-	);
+	for (size_t i = 0; i < levels.size(); ++i) {
+		std::memcpy(mapped + offsets[i], levels[i].data, levels[i].size_bytes);
+	}
 
 	SDL_UnmapGPUTransferBuffer(m_context->device, transfer_buf);
 
@@ -723,17 +869,20 @@ SafeGPU::UniqueGPUTexture Renderer::createTexture(Image* image) noexcept
 	);
 	SDL_GPUCopyPass* copy_pass = SDL_BeginGPUCopyPass(cmd_buf);
 
-	SDL_GPUTextureTransferInfo src = {
-		.transfer_buffer = transfer_buf,
-		.offset = 0,
-	};
-	SDL_GPUTextureRegion dest = {
-		.texture = texture,
-		.w = image->getWidth(),
-		.h = image->getHeight(),
-		.d = 1,
-	};
-	SDL_UploadToGPUTexture(copy_pass, &src, &dest, false);
+	for (size_t i = 0; i < levels.size(); ++i) {
+		SDL_GPUTextureTransferInfo src = {
+			.transfer_buffer = transfer_buf,
+			.offset = offsets[i],
+		};
+		SDL_GPUTextureRegion dest = {
+			.texture = texture,
+			.mip_level = static_cast<Uint32>(i),
+			.w = levels[i].width,
+			.h = levels[i].height,
+			.d = 1,
+		};
+		SDL_UploadToGPUTexture(copy_pass, &src, &dest, false);
+	}
 
 	// Cleanup resources
 	SDL_EndGPUCopyPass(copy_pass);
@@ -746,12 +895,14 @@ SafeGPU::UniqueGPUTexture Renderer::createTexture(Image* image) noexcept
 void Renderer::createSampler() noexcept
 {
 	SDL_GPUSamplerCreateInfo sampler_desc = {
-		.min_filter = SDL_GPU_FILTER_NEAREST,
-		.mag_filter = SDL_GPU_FILTER_NEAREST,
-		.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
+		.min_filter = SDL_GPU_FILTER_LINEAR,
+		.mag_filter = SDL_GPU_FILTER_LINEAR,
+		.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_LINEAR,
 		.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
 		.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
 		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.min_lod = 0.f,
+		.max_lod = 1000.f,	// every level the texture has
 	};
 	SDL_GPUSampler* sampler = SDL_CreateGPUSampler(
 		m_context->device,
@@ -32,6 +32,12 @@ struct ModelViewProjUniform {
 	glm::mat4 proj;
 };
 
+// VertexQuant::Quantization of the mesh being drawn
+struct QuantizationUniform {
+	glm::vec4 center;
+	glm::vec4 extent;
+};
+
 struct DebugModeUniform {
 	int show_normals;
 	float pad[3];
@@ -67,6 +73,16 @@ static const ShaderDescription default_frag_shader_desc {
 	.vertex_format = Model::VertexType::getLayout(),
 };
 
+// Variant of the default vertex shader for CompactVertex meshes
+static const ShaderDescription compact_vert_shader_desc {
+	.filepath = "res/shaders/Compact.vert.spv",
+	.num_samplers = 0, 
+	.num_uniform_buffers = 3, 
+	.num_storage_buffers = 0, 
+	.num_storage_textures = 0,
+	.vertex_format = CompactVertex::getLayout(),
+};
+
 static const ShaderDescription debug_vert_shader_desc {	
 	.filepath = "res/shaders/PositionColor.vert.spv",
 	.num_samplers = 0, 
@@ -95,6 +111,11 @@ private:
 	std::shared_ptr<Context> m_context;
 	std::shared_ptr<Shader> m_shader;
 	SafePipeline m_pipeline;
+	std::unique_ptr<Shader> m_compact_shader;
+	SafePipeline m_compact_pipeline;
+	bool m_b_compact_supported;
+	bool m_b_compact_failed;
+	SafePipeline* m_bound_pipeline;
 	std::unique_ptr<Shader> m_debug_shader;
 	SafePipeline m_debug_pipeline;
 	SDL_GPUTexture* m_swapchain_texture;
@@ -155,6 +176,9 @@ public:
 private:
 	void bindPipeline(SafePipeline* pipeline) noexcept;
 
+	// Built on first use, so the variant only has to exist once models use it
+	[[nodiscard]] bool loadCompactPipeline() noexcept;
+
 	void drawDebug() noexcept;
 
 	void createDepthTexture() noexcept;
@@ -1,4 +1,5 @@
 #include "core/render/Shader.h"
+#include "core/scene/AssetPack.h"
 #include "util/Logger.h"
 
 #include <SDL3/SDL_gpu.h>
@@ -68,9 +69,21 @@ SDL_GPUShader* Shader::loadShader(
 	const ShaderDescription& shader_desc, 
 	SDL_GPUShaderStage stage) noexcept
 {
-	// Read shader code into buffer
+	// Read shader code in place from a mounted pack, else into a buffer.
+	// SDL copies the code, so either only needs to outlive creation.
 	size_t code_size;
-	void *code = SDL_LoadFile(shader_desc.filepath.c_str(), &code_size);
+	const void* code = nullptr;
+	void* loaded_code = nullptr;
+	AssetPack::File packed = AssetPack::resolve(shader_desc.filepath);
+	if (packed) {
+		code = packed.bytes().data();
+		code_size = packed.bytes().size();
+	}
+	else {
+		loaded_code = SDL_LoadFile(shader_desc.filepath.c_str(), &code_size);
+		code = loaded_code;
+	}
+
 	if (!code) {
 		APE_ERROR("Failed to load shader code from {} - {}", 
 			shader_desc.filepath.c_str(), 
@@ -103,12 +116,13 @@ SDL_GPUShader* Shader::loadShader(
 			SDL_GetError()
 		);
 
+		SDL_free(loaded_code);
 		return nullptr;
 	}
 
 	SDL_GPUShaderCreateInfo shaderInfo = {
 		.code_size = code_size,
-		.code = static_cast<Uint8*>(code),
+		.code = static_cast<const Uint8*>(code),
 		.entrypoint = entrypoint.c_str(),
 		.format = format,
 		.stage = stage,
@@ -124,7 +138,7 @@ SDL_GPUShader* Shader::loadShader(
 		SDL_GetError()
 	);
 
-	SDL_free(code);
+	SDL_free(loaded_code);
 	return shader;
 }
 
@@ -0,0 +1,294 @@
+#include "core/render/TextureCooker.h"
+#include "core/render/BlockCompression.h"
+#include "util/ByteStream.h"
+#include "util/FileHash.h"
+#include "util/Hash.h"
+#include "util/Logger.h"
+#include "util/MappedFile.h"
+
+#include <array>
+#include <atomic>
+#include <format>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+namespace APE::Render {
+
+TextureCooker::Settings TextureCooker::s_settings;
+
+void TextureCooker::setDirectory(std::filesystem::path dir) noexcept
+{
+	s_directory = std::move(dir);
+}
+
+const std::filesystem::path& TextureCooker::directory() noexcept
+{
+	return s_directory;
+}
+
+void TextureCooker::setSettings(const Settings& settings) noexcept
+{
+	std::lock_guard lock(s_settings_mutex);
+	s_settings = settings;
+}
+
+TextureCooker::Settings TextureCooker::settings() noexcept
+{
+	std::lock_guard lock(s_settings_mutex);
+	return s_settings;
+}
+
+uint64_t TextureCooker::settingsHash(const Settings& cook_settings) noexcept
+{
+	std::array<uint32_t, 3> fields = {
+		cook_settings.b_compress,
+		cook_settings.b_prefer_bc7,
+		static_cast<uint32_t>(cook_settings.mip_filter),
+	};
+	return Hash::fnv1a(fields.data(), sizeof(fields));
+}
+
+TextureFormat TextureCooker::chooseFormat(
+	const Image& image,
+	const Settings& cook_settings) noexcept
+{
+	// Block formats need whole blocks at level 0, smaller mips may be partial
+	if (!cook_settings.b_compress ||
+		image.getFormat() != TextureFormat::RGBA8 ||
+		image.getWidth() % BC::BLOCK_DIM != 0 ||
+		image.getHeight() % BC::BLOCK_DIM != 0)
+	{
+		return image.getFormat();
+	}
+
+	if (Mip::isNormalMap(image.getPath())) {
+		return TextureFormat::BC5_RG;
+	}
+
+	const std::byte* pixels = image.getPixels();
+	size_t num_texels = size_t(image.getWidth()) * image.getHeight();
+	bool b_opaque = true;
+	for (size_t i = 0; i < num_texels && b_opaque; ++i) {
+		b_opaque = pixels[i * 4 + 3] == std::byte { 0xFF };
+	}
+
+	if (b_opaque) return TextureFormat::BC1_RGBA;
+	return cook_settings.b_prefer_bc7 ? TextureFormat::BC7_RGBA : TextureFormat::BC3_RGBA;
+}
+
+std::filesystem::path TextureCooker::cookedPath(
+	const std::filesystem::path& source_path) noexcept
+{
+	uint64_t path_hash = Hash::fnv1a(source_path.lexically_normal().generic_string());
+	return s_directory / std::format("{}_{:016x}{}",
+		source_path.stem().string(),
+		path_hash,
+		EXTENSION
+	);
+}
+
+TextureCooker::SourceStamp TextureCooker::stamp(const std::filesystem::path& source_path) noexcept
+{
+	return Hash::fileStamp(source_path);
+}
+
+uint64_t TextureCooker::stampedHash(
+	const std::filesystem::path& cooked_path,
+	const SourceStamp& source_stamp,
+	const Settings& cook_settings) noexcept
+{
+	if (source_stamp == SourceStamp {}) return 0;
+
+	FileHeader header;
+	std::ifstream is(cooked_path, std::ios::binary);
+	if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))) return 0;
+
+	if (header.magic != MAGIC ||
+		header.version != VERSION ||
+		header.source_size != source_stamp.size ||
+		header.source_mtime != source_stamp.mtime ||
+		header.settings_hash != settingsHash(cook_settings))
+	{
+		return 0;
+	}
+	return header.source_hash;
+}
+
+bool TextureCooker::cook(const std::filesystem::path& source_path) noexcept
+{
+	const Settings cook_settings = settings();
+	std::filesystem::path cooked_path = cookedPath(source_path);
+	uint64_t source_hash = stampedHash(cooked_path, stamp(source_path), cook_settings);
+	if (source_hash != 0) return true;
+
+	source_hash = Hash::fileContents(source_path);
+	if (source_hash == 0) {
+		APE_ERROR("TextureCooker::cook() Failed to read {}.", source_path.string());
+		return false;
+	}
+
+	MappedFile file;
+	TextureFormat format;
+	std::error_code ec;
+	if (std::filesystem::is_regular_file(cooked_path, ec) &&
+		file.open(cooked_path) &&
+		!readLevels(file, source_hash, format, settingsHash(cook_settings)).empty())
+	{
+		return true;
+	}
+	file.close();
+
+	// Loading an image cooks it on the way
+	Image image(source_path);
+	return std::filesystem::is_regular_file(cooked_path, ec);
+}
+
+size_t TextureCooker::cookAll(
+	std::span<const std::filesystem::path> source_paths,
+	ThreadPool& pool) noexcept
+{
+	std::atomic<size_t> num_cooked = 0;
+	pool.parallelFor(source_paths.size(), [&](size_t i) {
+		if (cook(source_paths[i])) ++num_cooked;
+	});
+	return num_cooked;
+}
+
+bool TextureCooker::save(
+	const std::filesystem::path& cooked_path,
+	const Image& image,
+	uint64_t source_hash,
+	const Settings& cook_settings) noexcept
+{
+	auto& levels = image.getMipLevels();
+	if (source_hash == 0 || levels.empty()) return false;
+
+	ByteWriter out;
+	out.write(FileHeader {});
+	size_t table_offset = out.pos();
+	for (size_t i = 0; i < levels.size(); ++i) {
+		out.write(LevelRecord {});
+	}
+
+	TextureFormat format = chooseFormat(image, cook_settings);
+
+	std::vector<LevelRecord> records;
+	for (auto& level : levels) {
+		std::vector<std::byte> blocks;
+		const std::byte* data = level.data;
+		Uint32 size_bytes = level.size_bytes;
+		if (format != image.getFormat()) {
+			blocks = BC::compress(format, level.data, level.width, level.height);
+			data = blocks.data();
+			size_bytes = static_cast<Uint32>(blocks.size());
+		}
+
+		out.align(LEVEL_ALIGN);
+		records.push_back({
+			.offset = out.pos(),
+			.width = level.width,
+			.height = level.height,
+			.size_bytes = size_bytes,
+			.reserved = 0,
+		});
+		out.writeBytes(data, size_bytes);
+	}
+
+	for (size_t i = 0; i < records.size(); ++i) {
+		out.patch(table_offset + i * sizeof(LevelRecord), records[i]);
+	}
+	SourceStamp source_stamp = stamp(image.getPath());
+	out.patch(0, FileHeader {
+		.magic = MAGIC,
+		.version = VERSION,
+		.format = static_cast<uint32_t>(format),
+		.width = image.getWidth(),
+		.height = image.getHeight(),
+		.num_levels = static_cast<uint32_t>(records.size()),
+		.source_hash = source_hash,
+		.source_size = source_stamp.size,
+		.source_mtime = source_stamp.mtime,
+		.settings_hash = settingsHash(cook_settings),
+		.file_size = out.pos(),
+	});
+
+	// Written aside and renamed, so a concurrent load never maps half a file
+	std::error_code ec;
+	std::filesystem::create_directories(cooked_path.parent_path(), ec);
+	std::filesystem::path tmp_path = cooked_path;
+	tmp_path += ".tmp";
+	{
+		std::ofstream os(tmp_path, std::ios::binary | std::ios::trunc);
+		auto& bytes = out.buffer();
+		os.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+		if (!os) {
+			APE_WARN("TextureCooker::save() Failed to write {}.", cooked_path.string());
+			os.close();
+			std::filesystem::remove(tmp_path, ec);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(tmp_path, cooked_path, ec);
+	if (ec) {
+		APE_WARN("TextureCooker::save() Failed to write {}.", cooked_path.string());
+		std::filesystem::remove(tmp_path, ec);
+		return false;
+	}
+	return true;
+}
+
+std::vector<Image::MipLevel> TextureCooker::readLevels(
+	const MappedFile& file,
+	uint64_t source_hash,
+	TextureFormat& format,
+	uint64_t settings_hash) noexcept
+{
+	ByteReader in(file.data(), file.size());
+	auto* header = in.array<FileHeader>(1);
+	if (!header ||
+		header->magic != MAGIC ||
+		header->version != VERSION ||
+		header->file_size != file.size() ||
+		header->source_hash != source_hash ||
+		header->settings_hash != settings_hash ||
+		header->format < static_cast<uint32_t>(TextureFormat::RGBA8) ||
+		header->format > static_cast<uint32_t>(TextureFormat::BC7_RGBA))
+	{
+		return {};
+	}
+
+	auto* records = in.array<LevelRecord>(header->num_levels);
+	if (!records || header->num_levels == 0) return {};
+
+	auto file_format = static_cast<TextureFormat>(header->format);
+	std::vector<Image::MipLevel> levels;
+	levels.reserve(header->num_levels);
+	for (uint32_t i = 0; i < header->num_levels; ++i) {
+		auto& rec = records[i];
+		if (rec.width == 0 || rec.height == 0 ||
+			rec.size_bytes != levelSizeBytes(file_format, rec.width, rec.height) ||
+			rec.offset > file.size() ||
+			rec.size_bytes > file.size() - rec.offset)
+		{
+			return {};
+		}
+
+		levels.push_back({
+			.width = rec.width,
+			.height = rec.height,
+			.size_bytes = rec.size_bytes,
+			.data = file.data() + rec.offset,
+		});
+	}
+
+	if (levels.front().width != header->width || levels.front().height != header->height) {
+		return {};
+	}
+
+	format = file_format;
+	return levels;
+}
+
+};	// end of namespace
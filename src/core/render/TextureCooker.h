@@ -0,0 +1,138 @@
+#pragma once
+
+#include "core/render/Image.h"
+#include "core/render/MipGenerator.h"
+#include "util/FileHash.h"
+#include "util/ThreadPool.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace APE {
+	class MappedFile;
+};	// end of namespace
+
+namespace APE::Render {
+
+/*
+* Cooked texture container
+* A header and level table followed by the pixels of every mip level, each
+* 16 byte aligned and laid out exactly as the GPU upload expects. Loading
+* maps the file and copies straight into the transfer buffer, nothing is
+* decoded. Cooked files live next to the model cache and are keyed by the
+* source's content hash and the cook settings. They also record the
+* source's size and mtime, and while those match, the stored hash stands in
+* for rehashing the source.
+* Levels are block compressed when the size allows it: BC5 for normal maps,
+* BC1 for opaque albedo, BC3 (or BC7 if preferred) when alpha is used.
+*/
+struct TextureCooker {
+	static constexpr std::string_view EXTENSION = ".apetex";
+
+	// "APET" when read as little endian bytes
+	static constexpr uint32_t MAGIC = 0x54455041;
+
+	// Bump whenever the layout or the mip generation changes
+	static constexpr uint32_t VERSION = 5;
+
+	static constexpr size_t LEVEL_ALIGN = 16;
+
+	struct FileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t num_levels;
+		uint64_t source_hash;
+		uint64_t source_size;
+		int64_t source_mtime;
+		uint64_t settings_hash;
+		uint64_t file_size;
+	};
+
+	using SourceStamp = Hash::FileStamp;
+
+	struct LevelRecord {
+		uint64_t offset;
+		uint32_t width;
+		uint32_t height;
+		uint32_t size_bytes;
+		uint32_t reserved;
+	};
+
+	struct Settings {
+		bool b_compress = true;
+		bool b_prefer_bc7 = false;
+		Mip::Filter mip_filter = Mip::Filter::Box;
+	};
+
+	// Applies to cooks that start afterwards, files cooked under other
+	// settings are cooked again
+	static void setSettings(const Settings& settings) noexcept;
+
+	// A copy, one cook runs under one snapshot
+	[[nodiscard]] static Settings settings() noexcept;
+
+	[[nodiscard]] static uint64_t settingsHash(const Settings& cook_settings) noexcept;
+
+	// Format an RGBA8 image is cooked to
+	[[nodiscard]] static TextureFormat chooseFormat(
+		const Image& image,
+		const Settings& cook_settings = settings()) noexcept;
+
+	// Relative to the working directory, like res/
+	static void setDirectory(std::filesystem::path dir) noexcept;
+
+	[[nodiscard]] static const std::filesystem::path& directory() noexcept;
+
+	[[nodiscard]] static std::filesystem::path cookedPath(
+		const std::filesystem::path& source_path) noexcept;
+
+	[[nodiscard]] static SourceStamp stamp(const std::filesystem::path& source_path) noexcept;
+
+	// Source hash recorded in the cooked file if it was cooked from a
+	// source with this stamp under these settings, 0 otherwise. Reads only
+	// the header.
+	[[nodiscard]] static uint64_t stampedHash(
+		const std::filesystem::path& cooked_path,
+		const SourceStamp& source_stamp,
+		const Settings& cook_settings = settings()) noexcept;
+
+	// Offline entry point, cooks source_path unless already up to date
+	static bool cook(const std::filesystem::path& source_path) noexcept;
+
+	// Cooks a batch with one image per job, returns how many succeeded
+	static size_t cookAll(
+		std::span<const std::filesystem::path> source_paths,
+		ThreadPool& pool = ThreadPool::global()) noexcept;
+
+	// Stamped with the image's source path. The image's mips should have
+	// been filtered under the same settings.
+	static bool save(
+		const std::filesystem::path& cooked_path,
+		const Image& image,
+		uint64_t source_hash,
+		const Settings& cook_settings = settings()) noexcept;
+
+	// Levels pointing into the mapped file, empty if it is stale, cooked
+	// under other settings or corrupt
+	[[nodiscard]] static std::vector<Image::MipLevel> readLevels(
+		const MappedFile& file,
+		uint64_t source_hash,
+		TextureFormat& format,
+		uint64_t settings_hash = settingsHash(settings())) noexcept;
+
+private:
+	static inline std::filesystem::path s_directory = "cache/textures";
+
+	// Images load on pool threads while the editor may change settings
+	static inline std::mutex s_settings_mutex;
+	static Settings s_settings;
+};
+
+};	// end of namespace
@@ -5,6 +5,8 @@
 
 #include <glm/glm.hpp>
 #include <glm/fwd.hpp>
+
+#include <array>
 #include <vector>
 
 namespace APE::Render {
@@ -109,5 +111,69 @@ struct TextureVertex {
 	}
 };
 
-};	// end of namespace
+// Positions alone, for physics cooking and depth only passes
+struct PositionVertex {
+	glm::vec3 pos;
+
+	[[nodiscard]] static VertexFormat getLayout() noexcept
+	{
+		std::vector<SDL_GPUVertexBufferDescription> buffer_desc = {{
+			.slot = 0,
+			.pitch = sizeof(PositionVertex),
+			.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+			.instance_step_rate = 0,
+		}};
+
+		std::vector<SDL_GPUVertexAttribute> attributes = {{
+			.location = 0,
+			.buffer_slot = 0,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
+			.offset = 0,
+		}};
+
+		return VertexFormat(attributes, buffer_desc);
+	}
+};
+
+/*
+* Quantized TextureVertex, half the size
+* Positions are normalized int16 within the mesh bounds, see
+* VertexQuant::Quantization, the fourth component is padding. Normals are
+* octahedral encoded in two normalized int16 and UVs are half floats.
+*/
+struct CompactVertex {
+	std::array<Sint16, 4> pos;
+	std::array<Sint16, 2> normal;
+	std::array<Uint16, 2> uv;
+
+	[[nodiscard]] static VertexFormat getLayout() noexcept
+	{
+		std::vector<SDL_GPUVertexBufferDescription> buffer_desc = {{
+			.slot = 0,
+			.pitch = sizeof(CompactVertex),
+			.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+			.instance_step_rate = 0,
+		}};
+
+		std::vector<SDL_GPUVertexAttribute> attributes = {{
+			.location = 0,
+			.buffer_slot = 0,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT4_NORM,
+			.offset = 0,
+		}, {
+			.location = 1,
+			.buffer_slot = 0,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM,
+			.offset = sizeof(Sint16) * 4,
+		}, {
+			.location = 2,
+			.buffer_slot = 0,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_HALF2,
+			.offset = sizeof(Sint16) * 6,
+		}};
+
+		return VertexFormat(attributes, buffer_desc);
+	}
+};
 
+};	// end of namespace
@@ -0,0 +1,175 @@
+#include "core/render/VertexQuantization.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace APE::Render::VertexQuant {
+
+namespace {
+
+constexpr float SNORM16_MAX = 32767.f;
+
+static_assert(sizeof(CompactVertex) * 2 == sizeof(TextureVertex));
+
+[[nodiscard]] Sint16 toSnorm16(float value) noexcept
+{
+	return static_cast<Sint16>(std::round(std::clamp(value, -1.f, 1.f) * SNORM16_MAX));
+}
+
+// Same as the GPU's SHORT_NORM conversion, -32768 maps to -1 as well
+[[nodiscard]] float fromSnorm16(Sint16 value) noexcept
+{
+	return std::max(static_cast<float>(value) / SNORM16_MAX, -1.f);
+}
+
+[[nodiscard]] float signNotZero(float value) noexcept
+{
+	return value >= 0.f ? 1.f : -1.f;
+}
+
+};	// end of namespace
+
+Quantization fromBounds(const Physics::Collisions::AABB& bounds) noexcept
+{
+	// Flat axes hold only zeros, any extent decodes them
+	glm::vec3 extent = bounds.extents();
+	for (int axis = 0; axis < 3; ++axis) {
+		if (!(extent[axis] > 0.f)) extent[axis] = 1.f;
+	}
+
+	return Quantization {
+		.center = bounds.center(),
+		.extent = extent,
+	};
+}
+
+Uint16 toHalf(float value) noexcept
+{
+	uint32_t bits = std::bit_cast<uint32_t>(value);
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t abs = bits & 0x7FFFFFFF;
+
+	// Infinity and NaN, NaN keeps a mantissa bit
+	if (abs >= 0x7F800000) {
+		return static_cast<Uint16>(sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 : 0));
+	}
+
+	// 65520 and up round past the largest half
+	if (abs >= 0x477FF000) {
+		return static_cast<Uint16>(sign | 0x7C00);
+	}
+
+	// Below 2^-14 halfs are subnormal, in steps of 2^-24
+	if (abs < 0x38800000) {
+		float steps = std::nearbyint(std::bit_cast<float>(abs) * 16777216.f);
+		return static_cast<Uint16>(sign | static_cast<uint32_t>(steps));
+	}
+
+	// Rebias the exponent and round the dropped mantissa bits, a carry
+	// moves into the exponent as it should
+	uint32_t half = (abs - 0x38000000) >> 13;
+	uint32_t rest = abs & 0x1FFF;
+	if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) ++half;
+	return static_cast<Uint16>(sign | half);
+}
+
+float fromHalf(Uint16 half) noexcept
+{
+	uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+	uint32_t exponent = (half >> 10) & 0x1F;
+	uint32_t mantissa = half & 0x3FF;
+
+	if (exponent == 0) {
+		float value = std::ldexp(static_cast<float>(mantissa), -24);
+		return sign ? -value : value;
+	}
+	if (exponent == 0x1F) {
+		return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+	}
+	return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+std::array<Sint16, 2> octEncode(const glm::vec3& normal) noexcept
+{
+	// Zero normals, as imported from meshes without any, encode as +Z
+	float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if (!(l1 > 0.f)) return { 0, 0 };
+
+	glm::vec3 n = normal / l1;
+	float x = n.x;
+	float y = n.y;
+
+	// The lower hemisphere folds over the diagonals
+	if (n.z < 0.f) {
+		x = (1.f - std::abs(n.y)) * signNotZero(n.x);
+		y = (1.f - std::abs(n.x)) * signNotZero(n.y);
+	}
+	return { toSnorm16(x), toSnorm16(y) };
+}
+
+glm::vec3 octDecode(const std::array<Sint16, 2>& oct) noexcept
+{
+	glm::vec3 n(fromSnorm16(oct[0]), fromSnorm16(oct[1]), 0.f);
+	n.z = 1.f - std::abs(n.x) - std::abs(n.y);
+
+	float fold = std::max(-n.z, 0.f);
+	n.x += n.x >= 0.f ? -fold : fold;
+	n.y += n.y >= 0.f ? -fold : fold;
+	return glm::normalize(n);
+}
+
+CompactVertex compress(
+	const TextureVertex& vertex,
+	const Quantization& quantization) noexcept
+{
+	glm::vec3 p = (vertex.pos - quantization.center) / quantization.extent;
+
+	return CompactVertex {
+		.pos = { toSnorm16(p.x), toSnorm16(p.y), toSnorm16(p.z), 0 },
+		.normal = octEncode(vertex.normal),
+		.uv = { toHalf(vertex.uv.x), toHalf(vertex.uv.y) },
+	};
+}
+
+TextureVertex decompress(
+	const CompactVertex& vertex,
+	const Quantization& quantization) noexcept
+{
+	glm::vec3 p(
+		fromSnorm16(vertex.pos[0]),
+		fromSnorm16(vertex.pos[1]),
+		fromSnorm16(vertex.pos[2])
+	);
+
+	return TextureVertex {
+		.pos = quantization.center + p * quantization.extent,
+		.normal = octDecode(vertex.normal),
+		.uv = glm::vec2(fromHalf(vertex.uv[0]), fromHalf(vertex.uv[1])),
+	};
+}
+
+std::vector<CompactVertex> compress(
+	std::span<const TextureVertex> vertices,
+	const Quantization& quantization) noexcept
+{
+	std::vector<CompactVertex> compact;
+	compact.reserve(vertices.size());
+	for (auto& vertex : vertices) {
+		compact.push_back(compress(vertex, quantization));
+	}
+	return compact;
+}
+
+std::vector<PositionVertex> positions(std::span<const TextureVertex> vertices) noexcept
+{
+	std::vector<PositionVertex> stream;
+	stream.reserve(vertices.size());
+	for (auto& vertex : vertices) {
+		stream.push_back({ .pos = vertex.pos });
+	}
+	return stream;
+}
+
+};	// end of namespace
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/render/Vertex.h"
+#include "physics/collisions/Colliders.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <span>
+#include <vector>
+
+namespace APE::Render::VertexQuant {
+
+/*
+* Compact vertex streams
+* The import pipeline keeps full TextureVertex data for cooking and
+* caching, and optionally derives a CompactVertex stream for the GPU and a
+* position only stream for physics.
+*/
+struct Settings {
+	// Draw with CompactVertex and the Compact vertex shader
+	bool b_compact = false;
+	// Keep a PositionVertex stream that Mesh::triangles() reads
+	bool b_position_stream = false;
+};
+
+// Positions decode as center + snorm * extent, per axis
+struct Quantization {
+	glm::vec3 center = glm::vec3(0.f);
+	glm::vec3 extent = glm::vec3(1.f);
+};
+
+[[nodiscard]] Quantization fromBounds(const Physics::Collisions::AABB& bounds) noexcept;
+
+// IEEE half precision, rounded to nearest even
+[[nodiscard]] Uint16 toHalf(float value) noexcept;
+[[nodiscard]] float fromHalf(Uint16 half) noexcept;
+
+// Unit normal to and from an octahedron unfolded onto [-1, 1]^2
+[[nodiscard]] std::array<Sint16, 2> octEncode(const glm::vec3& normal) noexcept;
+[[nodiscard]] glm::vec3 octDecode(const std::array<Sint16, 2>& oct) noexcept;
+
+[[nodiscard]] CompactVertex compress(
+	const TextureVertex& vertex,
+	const Quantization& quantization) noexcept;
+
+// What the Compact vertex shader sees
+[[nodiscard]] TextureVertex decompress(
+	const CompactVertex& vertex,
+	const Quantization& quantization) noexcept;
+
+[[nodiscard]] std::vector<CompactVertex> compress(
+	std::span<const TextureVertex> vertices,
+	const Quantization& quantization) noexcept;
+
+[[nodiscard]] std::vector<PositionVertex> positions(
+	std::span<const TextureVertex> vertices) noexcept;
+
+};	// end of namespace
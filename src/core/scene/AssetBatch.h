@@ -0,0 +1,69 @@
+#pragma once
+
+#include "core/scene/AssetHandle.h"
+#include "core/scene/AssetLoader.h"
+#include "core/scene/AssetManager.h"
+#include "core/scene/SceneLoadProgress.h"
+#include "util/ThreadPool.h"
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace APE {
+
+/*
+* Unique set of assets referenced by a load
+* Keys are gathered while parsing, then imported concurrently so the cost
+* scales with cores rather than with the order components appear in.
+*/
+class AssetBatch {
+private:
+	using Request = std::pair<AssetKey, AssetClass>;
+
+	std::unordered_map<AssetKey, AssetClass, AssetKeyHash> m_requests;
+
+public:
+	void request(const AssetKey& key, AssetClass asset_class) noexcept
+	{
+		if (asset_class == AssetClass::None) return;
+		m_requests.try_emplace(key, asset_class);
+	}
+
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_requests.size();
+	}
+
+	// Blocks until every requested asset is in the AssetManager. Runs on
+	// parallelFor, so this is safe to call from a job on the same pool.
+	void resolve(ThreadPool& pool, SceneLoadProgress* progress = nullptr) noexcept
+	{
+		if (m_requests.empty()) return;
+
+		std::vector<Request> requests(m_requests.begin(), m_requests.end());
+		m_requests.clear();
+
+		pool.parallelFor(requests.size(), [&](size_t i) {
+			loadAsset(requests[i].first, requests[i].second);
+			if (progress) ++progress->assets_loaded;
+		});
+	}
+
+private:
+	static void loadAsset(const AssetKey& key, AssetClass asset_class) noexcept
+	{
+		switch (asset_class) {
+		case AssetClass::Model:
+			(void)AssetLoader::load<Render::Model>(key, asset_class);
+			break;
+		case AssetClass::Texture:
+			(void)AssetLoader::load<Render::Image>(key, asset_class);
+			break;
+		default:
+			break;
+		}
+	}
+};
+
+};	// end of namespace
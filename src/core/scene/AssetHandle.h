@@ -1,7 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace APE {
 
@@ -37,20 +45,142 @@ struct AssetKey {
 	}
 };
 
+struct AssetKeyHash {
+	size_t operator()(const AssetKey& k) const noexcept
+	{
+		size_t seed = std::filesystem::hash_value(k.path);
+		return seed ^ (std::hash<std::string>()(k.sub_index) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+	}
+};
+
+/*
+* Generational slot index into the AssetManager, 32 bits so components can
+* hold it by value. The low bits select the slot, the high bits count how
+* often the slot was reused so IDs of released assets stop resolving.
+*/
+struct AssetId {
+	static constexpr uint32_t INDEX_BITS = 20;
+	static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+	static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+	// Generations start at 1, so 0 is never a live ID
+	uint32_t value = 0;
+
+	constexpr AssetId() noexcept = default;
+
+	constexpr AssetId(uint32_t index, uint32_t generation) noexcept
+		: value((index & INDEX_MASK) | ((generation & GENERATION_MASK) << INDEX_BITS))
+	{ }
+
+	[[nodiscard]] constexpr uint32_t index() const noexcept { return value & INDEX_MASK; }
+	[[nodiscard]] constexpr uint32_t generation() const noexcept { return value >> INDEX_BITS; }
+	[[nodiscard]] constexpr bool isValid() const noexcept { return value != 0; }
+
+	constexpr bool operator==(const AssetId& other) const noexcept = default;
+};
+
+enum class AssetStatus {
+	Loading = 0,
+	Ready,
+	Failed,
+};
+
+template <typename Asset>
+struct AssetHandle;
+
+/*
+* Shared by every handle to an asset requested asynchronously
+* data is written once, before status leaves Loading.
+*/
+template <typename Asset>
+struct AssetLoadState {
+	using Callback = std::function<void(const AssetHandle<Asset>&)>;
+
+	std::atomic<AssetStatus> status = AssetStatus::Loading;
+	std::shared_ptr<Asset> data;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<Callback> callbacks;
+};
+
 template <typename Asset>
 struct AssetHandle {
 	AssetKey key;
 	AssetClass asset_class;
+	AssetId id;
+
+	// The asset, or a placeholder while load_state is still loading
 	std::shared_ptr<Asset> data;
+	std::shared_ptr<AssetLoadState<Asset>> load_state;
 
 	AssetHandle(
 		AssetKey asset_key = {},
 		AssetClass asset_class = AssetClass::None,
-		std::shared_ptr<Asset> data = nullptr) noexcept
+		std::shared_ptr<Asset> data = nullptr,
+		std::shared_ptr<AssetLoadState<Asset>> load_state = nullptr,
+		AssetId id = {}) noexcept
 		: key(asset_key)
 		, asset_class(asset_class)
+		, id(id)
 		, data(data)
+		, load_state(load_state)
 	{ }
+
+	// Handles without data that are not loading report Failed
+	[[nodiscard]] AssetStatus status() const noexcept
+	{
+		if (load_state) {
+			return load_state->status.load(std::memory_order_acquire);
+		}
+		return data ? AssetStatus::Ready : AssetStatus::Failed;
+	}
+
+	[[nodiscard]] bool isReady() const noexcept
+	{
+		return status() == AssetStatus::Ready;
+	}
+
+	// The loaded asset, or the placeholder until it arrives
+	[[nodiscard]] const std::shared_ptr<Asset>& get() const noexcept
+	{
+		if (load_state && load_state->status.load(std::memory_order_acquire) == AssetStatus::Ready) {
+			return load_state->data;
+		}
+		return data;
+	}
+
+	// Blocks until the load finishes, false if it failed
+	bool wait() const noexcept
+	{
+		if (!load_state) return data != nullptr;
+
+		std::unique_lock lock(load_state->mutex);
+		load_state->cv.wait(lock, [this]() {
+			return load_state->status.load(std::memory_order_acquire) != AssetStatus::Loading;
+		});
+		return load_state->status.load(std::memory_order_acquire) == AssetStatus::Ready;
+	}
+
+	// Runs on the main thread once the load finishes or fails, see
+	// AssetManager::dispatchCallbacks(). Runs immediately if already done.
+	void onComplete(typename AssetLoadState<Asset>::Callback callback) const noexcept
+	{
+		if (load_state) {
+			std::unique_lock lock(load_state->mutex);
+			if (load_state->status.load(std::memory_order_acquire) == AssetStatus::Loading) {
+				load_state->callbacks.push_back(std::move(callback));
+				return;
+			}
+		}
+		callback(resolved());
+	}
+
+	// Copy that no longer tracks the load, holding the final data
+	[[nodiscard]] AssetHandle resolved() const noexcept
+	{
+		return AssetHandle(key, asset_class, isReady() ? get() : nullptr, nullptr, id);
+	}
 };
 
 };	// end of namespace
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "core/render/Model.h"
+#include "core/scene/AssetManager.h"
 #include "core/scene/ImageLoader.h"
 #include "core/scene/ModelLoader.h"
 
+#include <tuple>
 #include <type_traits>
 
 namespace APE {
@@ -25,6 +27,44 @@ struct AssetLoader {
 			);
 		}
 	}
+
+	// The resident asset behind id, or null while it is missing. Missing
+	// assets are requested in the background, so calling this every frame
+	// brings evicted assets back without stalling.
+	template <typename Asset>
+	[[nodiscard]] static Asset* resolve(AssetId id, int priority = 0) noexcept
+	{
+		if (auto* asset = AssetManager::find<Asset>(id)) return asset;
+		if (AssetManager::hasFailed(id)) return nullptr;
+
+		AssetKey key = AssetManager::keyOf(id);
+		if (key.path.empty()) return nullptr;
+
+		if constexpr (std::is_same_v<Asset, Render::Model>) {
+			(void)ModelLoader::loadAsync(key, priority);
+		}
+		else if constexpr (std::is_same_v<Asset, Render::Image>) {
+			// Embedded textures come back with the model that holds them
+			if (!key.sub_index.empty()) {
+				(void)ModelLoader::loadAsync(key.path, priority);
+			}
+			else {
+				(void)ImageLoader::loadAsync(key, priority);
+			}
+		}
+		return nullptr;
+	}
+
+	// resolve() for several assets, with one AssetManager lock while they
+	// are all resident
+	template <typename... Assets>
+	[[nodiscard]] static std::tuple<Assets*...>
+	resolveAll(AssetManager::IdOf<Assets>... ids) noexcept
+	{
+		return std::apply([&](auto*... found) {
+			return std::tuple<Assets*...>((found ? found : resolve<Assets>(ids))...);
+		}, AssetManager::findAll<Assets...>(ids...));
+	}
 };
 
 };
@@ -1,95 +1,687 @@
 #pragma once
 
 #include "util/Logger.h"
+#include "util/ThreadPool.h"
 #include "core/scene/AssetHandle.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <tuple>
 #include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace APE {
 
+// Monitoring counters for one asset class
+struct AssetClassStats {
+	size_t resident_bytes = 0;
+	size_t budget_bytes = std::numeric_limits<size_t>::max();
+	size_t num_assets = 0;
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+};
+
+/*
+* Assets live in a slot map indexed by AssetId. A key is hashed once, when
+* it is first registered, after which components refer to the asset by ID
+* alone and the key is only read back for serialization.
+*
+* Assets stay resident until their class goes over its CPU budget. Only
+* assets nothing outside the manager references can be evicted, least
+* recently used first, on the next trim(). Handles count as references, and
+* so do components, through the LiveAssetId they hold. An evicted asset
+* keeps its slot and ID, and the next request for its key loads it again.
+*/
 class AssetManager {
 private:
-	struct InternalAsset {
-		AssetClass asset_class;
-		std::type_index type_id;
+	struct Slot {
+		AssetKey key;
+		AssetClass asset_class = AssetClass::None;
+		std::type_index type_id = typeid(void);
 		std::shared_ptr<void> data;
+		size_t bytes = 0;
+		uint64_t last_used = 0;
+		uint32_t generation = 1;
+		bool b_registered = false;
+		bool b_failed = false;
 	};
 
-	struct AssetKeyHash {
-		size_t operator()(const AssetKey& k) const noexcept
-		{
-			return std::hash<std::string>()(k.to_string());
-		}
-	};
+	static constexpr size_t NUM_ASSET_CLASSES = static_cast<size_t>(AssetClass::Texture) + 1;
+
+	static inline std::array<AssetClassStats, NUM_ASSET_CLASSES> s_stats;
+
+	// Bumped on every access, orders eviction
+	static inline uint64_t s_clock = 0;
+
+	static inline std::vector<Slot> s_slots;
+	static inline std::vector<uint32_t> s_free_slots;
+	static inline std::unordered_map<AssetKey, uint32_t, AssetKeyHash> s_lookup;
 
-	static inline 
-	std::unordered_map<AssetKey, InternalAsset, AssetKeyHash> s_assets;
+	// Loads currently running, so concurrent requests wait instead of re-importing
+	static inline std::unordered_map<uint32_t, std::shared_future<void>> s_in_flight;
+
+	// Async loads still running, shared by every handle requested meanwhile
+	static inline std::unordered_map<uint32_t, std::shared_ptr<void>> s_pending;
+
+	// Finished async loads whose callbacks wait for the main thread
+	static inline std::vector<std::function<void()>> s_completed;
+
+	// Assets may be loaded from background streaming threads
+	static inline std::mutex s_mutex;
+
+	// Components referencing each slot through a LiveAssetId, counted
+	// without s_mutex since every component copy touches them. A word holds
+	// the slot's generation above the count, so stale IDs count nothing
+	// and release() can't free a slot a reference is being added to.
+	static constexpr size_t REF_CHUNK_SIZE = 4096;
+	static constexpr size_t NUM_REF_CHUNKS = (AssetId::INDEX_MASK + REF_CHUNK_SIZE) / REF_CHUNK_SIZE;
+	using RefChunk = std::array<std::atomic<uint64_t>, REF_CHUNK_SIZE>;
+
+	// Chunks never move, one is allocated before any ID into it exists
+	static inline std::array<std::unique_ptr<RefChunk>, NUM_REF_CHUNKS> s_refs;
 
 public:
 	AssetManager() noexcept = default;
 
-	[[nodiscard]] static bool 
+	[[nodiscard]] static bool
 	contains(const AssetKey& key) noexcept
 	{
-		if (!s_assets.contains(key)) return false;
-		return s_assets.at(key).data != nullptr;
+		std::lock_guard lock(s_mutex);
+		auto it = s_lookup.find(key);
+		return it != s_lookup.end() && s_slots[it->second].data != nullptr;
+	}
+
+	[[nodiscard]] static bool
+	isResident(AssetId id) noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		Slot* slot = slotUnlocked(id);
+		return slot && slot->data != nullptr;
+	}
+
+	// The last load of id came back empty, it is not retried on its own
+	[[nodiscard]] static bool
+	hasFailed(AssetId id) noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		Slot* slot = slotUnlocked(id);
+		return slot && slot->b_failed;
+	}
+
+	// ID for key without loading it, the same for the life of the slot
+	template <typename Asset>
+	[[nodiscard]] static AssetId
+	registerKey(const AssetKey& key, AssetClass asset_class) noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		return idOf(registerUnlocked<Asset>(key, asset_class));
 	}
 
 	template <typename Asset>
-	static AssetHandle<Asset> 
+	static AssetHandle<Asset>
 	upload(const AssetKey& key,
 		AssetClass asset_class,
 		std::unique_ptr<Asset> data) noexcept
 	{
-		APE_CHECK((!contains(key)),
-			"AssetManager::upload() Failed: Cannot reupload asset {}.",
-			key.to_string()
-		);
+		std::lock_guard lock(s_mutex);
+		uint32_t index = registerUnlocked<Asset>(key, asset_class);
+		Slot& slot = s_slots[index];
 
-		s_assets.emplace(
-			key,
-			InternalAsset { 
-				.asset_class = asset_class,
-				.type_id = typeid(Asset),
-				.data = std::shared_ptr<void>(std::move(data)),
+		// Another thread finished loading the same asset first, keep theirs
+		if (slot.data) {
+			APE_WARN(
+				"AssetManager::upload() Asset {} already loaded, discarding duplicate.",
+				key.to_string()
+			);
+			return makeHandle<Asset>(index);
+		}
+
+		slot.b_failed = (data == nullptr);
+		if (data) {
+			slot.bytes = assetBytes(*data);
+			slot.data = std::shared_ptr<void>(std::move(data));
+
+			auto& class_stats = stats(slot.asset_class);
+			class_stats.resident_bytes += slot.bytes;
+			class_stats.num_assets += 1;
+		}
+		return makeHandle<Asset>(index);
+	}
+
+	// Runs make() at most once per key, even when several threads ask for
+	// the same asset at once. Later callers block until the first finishes.
+	template <typename Asset, typename F>
+	[[nodiscard]] static AssetHandle<Asset>
+	findOrLoad(const AssetKey& key, AssetClass asset_class, F&& make) noexcept
+	{
+		std::shared_future<void> pending;
+		std::promise<void> loaded;
+		uint32_t index;
+		{
+			std::lock_guard lock(s_mutex);
+			index = registerUnlocked<Asset>(key, asset_class);
+			if (s_slots[index].data) {
+				stats(asset_class).hits += 1;
+				return makeHandle<Asset>(index);
+			}
+
+			auto it = s_in_flight.find(index);
+			if (it != s_in_flight.end()) {
+				stats(asset_class).hits += 1;
+				pending = it->second;
+			}
+			else {
+				stats(asset_class).misses += 1;
+				s_in_flight.emplace(index, loaded.get_future().share());
+			}
+		}
+
+		if (pending.valid()) {
+			pending.wait();
+			std::lock_guard lock(s_mutex);
+			return makeHandle<Asset>(index);
+		}
+
+		auto handle = upload<Asset>(key, asset_class, make());
+		{
+			std::lock_guard lock(s_mutex);
+			s_in_flight.erase(index);
+		}
+		loaded.set_value();
+		return handle;
+	}
+
+	// Returns at once, the handle serves placeholder until make() finishes
+	// on the pool. Higher priorities are picked up first.
+	template <typename Asset, typename F>
+	[[nodiscard]] static AssetHandle<Asset>
+	loadAsync(const AssetKey& key,
+		AssetClass asset_class,
+		F&& make,
+		std::shared_ptr<Asset> placeholder,
+		int priority = 0,
+		ThreadPool& pool = ThreadPool::global()) noexcept
+	{
+		using State = AssetLoadState<Asset>;
+
+		std::shared_ptr<State> state;
+		AssetId id;
+		{
+			std::lock_guard lock(s_mutex);
+			uint32_t index = registerUnlocked<Asset>(key, asset_class);
+			if (s_slots[index].data) {
+				stats(asset_class).hits += 1;
+				return makeHandle<Asset>(index);
+			}
+
+			// A fresh load is counted as a miss by findOrLoad on the pool
+			id = idOf(index);
+			auto it = s_pending.find(index);
+			if (it != s_pending.end()) {
+				stats(asset_class).hits += 1;
+				state = std::static_pointer_cast<State>(it->second);
+				return AssetHandle<Asset>(key, asset_class, std::move(placeholder), state, id);
 			}
+
+			state = std::make_shared<State>();
+			s_pending.emplace(index, state);
+		}
+
+		(void)pool.submit(
+			[key, asset_class, state, make = std::forward<F>(make)]() mutable {
+				auto loaded = findOrLoad<Asset>(key, asset_class, std::move(make));
+				complete<Asset>(loaded, state);
+			},
+			priority
 		);
-		return makeHandle<Asset>(key);
+		return AssetHandle<Asset>(key, asset_class, std::move(placeholder), std::move(state), id);
 	}
 
-	template <typename Asset>
-	[[nodiscard]] static AssetHandle<Asset> 
-	get(const AssetKey& key) noexcept
+	// Nearer assets load first, one priority step per world unit
+	[[nodiscard]] static int distancePriority(float distance) noexcept
 	{
-		return makeHandle<Asset>(key);
+		constexpr float MAX_DISTANCE = 1e6f;
+		return -static_cast<int>(std::min(std::max(distance, 0.f), MAX_DISTANCE));
 	}
 
-private:
+	// Runs the callbacks of async loads finished since the last call,
+	// the engine calls this once per frame on the main thread
+	static void dispatchCallbacks() noexcept
+	{
+		std::vector<std::function<void()>> completed;
+		{
+			std::lock_guard lock(s_mutex);
+			completed.swap(s_completed);
+		}
+
+		for (auto& callback : completed) {
+			callback();
+		}
+	}
+
+	// Only valid while something keeps the asset referenced, otherwise it
+	// may have been evicted. Load through the loaders to reload on demand.
 	template <typename Asset>
 	[[nodiscard]] static AssetHandle<Asset>
-	makeHandle(const AssetKey& key) noexcept
+	get(const AssetKey& key) noexcept
 	{
-		auto it = s_assets.find(key);
-		APE_CHECK((it != s_assets.end()),
+		std::lock_guard lock(s_mutex);
+		auto it = s_lookup.find(key);
+		APE_CHECK((it != s_lookup.end()),
 			"AssetManager::get() Failed: Asset {} not yet loaded.",
 			key.to_string()
 		);
+		return makeHandle<Asset>(it->second);
+	}
+
+	// The resident asset behind id, or null if it is stale or evicted.
+	// Eviction only happens in trim(), so the pointer holds until then.
+	template <typename Asset>
+	[[nodiscard]] static Asset* find(AssetId id) noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		return findUnlocked<Asset>(id);
+	}
 
-		auto& asset = it->second;
-		APE_CHECK((asset.type_id == typeid(Asset)),
+	// One ID per asset type, for findAll
+	template <typename Asset>
+	using IdOf = AssetId;
+
+	// Several assets under one lock, like the model and texture of a draw
+	template <typename... Assets>
+	[[nodiscard]] static std::tuple<Assets*...> findAll(IdOf<Assets>... ids) noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		return std::tuple<Assets*...>(findUnlocked<Assets>(ids)...);
+	}
+
+	// Serialization reads the key back, empty for stale IDs
+	[[nodiscard]] static AssetKey keyOf(AssetId id) noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		Slot* slot = slotUnlocked(id);
+		return slot ? slot->key : AssetKey();
+	}
+
+	[[nodiscard]] static AssetClass classOf(AssetId id) noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		Slot* slot = slotUnlocked(id);
+		return slot ? slot->asset_class : AssetClass::None;
+	}
+
+	// Live references pin an asset in memory, see LiveAssetId
+	static void addRef(AssetId id) noexcept
+	{
+		if (!id.isValid()) return;
+
+		auto& refs = refsOf(id.index());
+		uint64_t word = refs.load(std::memory_order_relaxed);
+		while (refGeneration(word) == id.generation() &&
+			!refs.compare_exchange_weak(word, word + 1, std::memory_order_relaxed))
+		{
+
+		}
+	}
+
+	static void releaseRef(AssetId id) noexcept
+	{
+		if (!id.isValid()) return;
+
+		auto& refs = refsOf(id.index());
+		uint64_t word = refs.load(std::memory_order_relaxed);
+		while (refGeneration(word) == id.generation() && refCount(word) > 0 &&
+			!refs.compare_exchange_weak(word, word - 1, std::memory_order_release))
+		{
+
+		}
+	}
+
+	[[nodiscard]] static uint32_t numRefs(AssetId id) noexcept
+	{
+		if (!id.isValid()) return 0;
+
+		uint64_t word = refsOf(id.index()).load(std::memory_order_acquire);
+		return refGeneration(word) == id.generation() ? refCount(word) : 0;
+	}
+
+	// Frees the slot of an asset nothing else references, the ID and any
+	// copies of it go stale. False if it is still in use or loading.
+	static bool release(AssetId id) noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		Slot* slot = slotUnlocked(id);
+		uint32_t index = id.index();
+		if (!slot ||
+			(slot->data && slot->data.use_count() > 1) ||
+			s_in_flight.contains(index) ||
+			s_pending.contains(index))
+		{
+			return false;
+		}
+
+		// Bumping the generation here fails if a reference came in first
+		uint32_t generation = (slot->generation + 1) & AssetId::GENERATION_MASK;
+		generation = (generation != 0) ? generation : 1;
+		uint64_t unreferenced = refWord(slot->generation, 0);
+		if (!refsOf(index).compare_exchange_strong(
+			unreferenced, refWord(generation, 0), std::memory_order_acq_rel))
+		{
+			return false;
+		}
+
+		if (slot->data) {
+			auto& class_stats = stats(slot->asset_class);
+			class_stats.resident_bytes -= slot->bytes;
+			class_stats.num_assets -= 1;
+		}
+		s_lookup.erase(slot->key);
+
+		*slot = Slot {};
+		slot->generation = generation;
+		s_free_slots.push_back(index);
+		return true;
+	}
+
+	// Evicts at once if the class is already over the new budget
+	static void setBudget(AssetClass asset_class, size_t budget_bytes) noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		stats(asset_class).budget_bytes = budget_bytes;
+		trimUnlocked(asset_class);
+	}
+
+	[[nodiscard]] static AssetClassStats getStats(AssetClass asset_class) noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		return stats(asset_class);
+	}
+
+	// Assets become evictable as their last handles go away, the engine
+	// calls this once per frame. Returns the number of assets evicted.
+	static size_t trim() noexcept
+	{
+		std::lock_guard lock(s_mutex);
+		size_t num_evicted = 0;
+		for (size_t i = 0; i < NUM_ASSET_CLASSES; ++i) {
+			num_evicted += trimUnlocked(static_cast<AssetClass>(i));
+		}
+		return num_evicted;
+	}
+
+private:
+	[[nodiscard]] static AssetClassStats& stats(AssetClass asset_class) noexcept
+	{
+		return s_stats[std::min(static_cast<size_t>(asset_class), NUM_ASSET_CLASSES - 1)];
+	}
+
+	// CPU side bytes, assets that know their size report it
+	template <typename Asset>
+	[[nodiscard]] static size_t assetBytes(const Asset& asset) noexcept
+	{
+		if constexpr (requires { { asset.cpuBytes() } -> std::convertible_to<size_t>; }) {
+			return asset.cpuBytes();
+		}
+		else {
+			return sizeof(Asset);
+		}
+	}
+
+	[[nodiscard]] static constexpr uint64_t refWord(uint32_t generation, uint32_t count) noexcept
+	{
+		return (static_cast<uint64_t>(generation) << 32) | count;
+	}
+
+	[[nodiscard]] static constexpr uint32_t refGeneration(uint64_t word) noexcept
+	{
+		return static_cast<uint32_t>(word >> 32);
+	}
+
+	[[nodiscard]] static constexpr uint32_t refCount(uint64_t word) noexcept
+	{
+		return static_cast<uint32_t>(word);
+	}
+
+	[[nodiscard]] static std::atomic<uint64_t>& refsOf(uint32_t index) noexcept
+	{
+		return (*s_refs[index / REF_CHUNK_SIZE])[index % REF_CHUNK_SIZE];
+	}
+
+	// Acquire pairs with releaseRef, so nothing a component did with the
+	// asset races the eviction
+	[[nodiscard]] static bool isReferenced(uint32_t index) noexcept
+	{
+		return refCount(refsOf(index).load(std::memory_order_acquire)) > 0;
+	}
+
+	/*
+	* Slot map, every function below expects s_mutex to be held
+	*/
+	[[nodiscard]] static AssetId idOf(uint32_t index) noexcept
+	{
+		return AssetId(index, s_slots[index].generation);
+	}
+
+	[[nodiscard]] static Slot* slotUnlocked(AssetId id) noexcept
+	{
+		if (!id.isValid() || id.index() >= s_slots.size()) return nullptr;
+
+		Slot& slot = s_slots[id.index()];
+		return (slot.b_registered && slot.generation == id.generation()) ? &slot : nullptr;
+	}
+
+	template <typename Asset>
+	[[nodiscard]] static Asset* findUnlocked(AssetId id) noexcept
+	{
+		Slot* slot = slotUnlocked(id);
+		if (!slot || !slot->data) return nullptr;
+
+		APE_CHECK((slot->type_id == typeid(Asset)),
+			"AssetManager::find() Failed: Type mismatch for {}.",
+			slot->key.to_string()
+		);
+		slot->last_used = ++s_clock;
+		return static_cast<Asset*>(slot->data.get());
+	}
+
+	template <typename Asset>
+	[[nodiscard]] static uint32_t
+	registerUnlocked(const AssetKey& key, AssetClass asset_class) noexcept
+	{
+		auto it = s_lookup.find(key);
+		if (it != s_lookup.end()) {
+			APE_CHECK((s_slots[it->second].type_id == typeid(Asset)),
+				"AssetManager::registerKey() Failed: Type mismatch for {}.",
+				key.to_string()
+			);
+			return it->second;
+		}
+
+		uint32_t index;
+		if (!s_free_slots.empty()) {
+			index = s_free_slots.back();
+			s_free_slots.pop_back();
+		}
+		else {
+			index = static_cast<uint32_t>(s_slots.size());
+			APE_CHECK((index <= AssetId::INDEX_MASK),
+				"AssetManager::registerKey() Failed: More than {} assets.",
+				AssetId::INDEX_MASK
+			);
+			s_slots.emplace_back();
+
+			auto& chunk = s_refs[index / REF_CHUNK_SIZE];
+			if (!chunk) {
+				chunk = std::make_unique<RefChunk>();
+			}
+			refsOf(index).store(refWord(s_slots[index].generation, 0), std::memory_order_relaxed);
+		}
+
+		Slot& slot = s_slots[index];
+		slot.key = key;
+		slot.asset_class = asset_class;
+		slot.type_id = typeid(Asset);
+		slot.b_registered = true;
+		s_lookup.emplace(key, index);
+		return index;
+	}
+
+	static size_t trimUnlocked(AssetClass asset_class) noexcept
+	{
+		auto& class_stats = stats(asset_class);
+		if (class_stats.resident_bytes <= class_stats.budget_bytes) return 0;
+
+		// Referenced only by the manager, so no handle or component can
+		// observe the eviction
+		std::vector<std::pair<uint64_t, uint32_t>> candidates;
+		for (uint32_t i = 0; i < s_slots.size(); ++i) {
+			auto& slot = s_slots[i];
+			if (slot.asset_class == asset_class && slot.data &&
+				slot.data.use_count() == 1 && !isReferenced(i))
+			{
+				candidates.emplace_back(slot.last_used, i);
+			}
+		}
+		std::sort(candidates.begin(), candidates.end());
+
+		size_t num_evicted = 0;
+		for (auto [last_used, index] : candidates) {
+			if (class_stats.resident_bytes <= class_stats.budget_bytes) break;
+
+			auto& slot = s_slots[index];
+			APE_TRACE("AssetManager::trim() Evicting {}.", slot.key.to_string());
+			class_stats.resident_bytes -= slot.bytes;
+			class_stats.num_assets -= 1;
+			class_stats.evictions += 1;
+			slot.data.reset();
+			slot.bytes = 0;
+			++num_evicted;
+		}
+		return num_evicted;
+	}
+
+	template <typename Asset>
+	static void complete(
+		const AssetHandle<Asset>& loaded,
+		const std::shared_ptr<AssetLoadState<Asset>>& state) noexcept
+	{
+		AssetStatus status = loaded.data ? AssetStatus::Ready : AssetStatus::Failed;
+		if (status == AssetStatus::Failed) {
+			APE_ERROR("AssetManager::loadAsync() Failed to load {}.", loaded.key.to_string());
+		}
+
+		// Callbacks are queued before the status flips, so anyone woken by
+		// it finds them on the next dispatch
+		{
+			std::scoped_lock lock(s_mutex, state->mutex);
+			state->data = loaded.data;
+			state->status.store(status, std::memory_order_release);
+
+			std::vector<typename AssetLoadState<Asset>::Callback> callbacks;
+			callbacks.swap(state->callbacks);
+			s_pending.erase(loaded.id.index());
+			if (!callbacks.empty()) {
+				s_completed.push_back([loaded, callbacks = std::move(callbacks)]() {
+					for (auto& callback : callbacks) {
+						callback(loaded);
+					}
+				});
+			}
+		}
+		state->cv.notify_all();
+	}
+
+	template <typename Asset>
+	[[nodiscard]] static AssetHandle<Asset>
+	makeHandle(uint32_t index) noexcept
+	{
+		auto& slot = s_slots[index];
+		APE_CHECK((slot.type_id == typeid(Asset)),
 			"AssetManager::makeHandle() Failed: Type mismatch for {}.",
-			key.to_string()
+			slot.key.to_string()
 		);
+		slot.last_used = ++s_clock;
 
 		return AssetHandle<Asset>(
-			key, 
-			asset.asset_class, 
-			std::static_pointer_cast<Asset>(asset.data)
+			slot.key,
+			slot.asset_class,
+			std::static_pointer_cast<Asset>(slot.data),
+			nullptr,
+			idOf(index)
 		);
 	}
 };
 
+/*
+* AssetId held by a component
+* Counts as a reference for as long as it exists, so trim() never evicts an
+* asset something in a scene still draws. Converts to a plain AssetId.
+*/
+class LiveAssetId {
+private:
+	AssetId m_id;
+
+public:
+	LiveAssetId(AssetId id = {}) noexcept
+		: m_id(id)
+	{
+		AssetManager::addRef(m_id);
+	}
+
+	LiveAssetId(const LiveAssetId& other) noexcept
+		: LiveAssetId(other.m_id)
+	{
+
+	}
+
+	LiveAssetId(LiveAssetId&& other) noexcept
+		: m_id(std::exchange(other.m_id, AssetId()))
+	{
+
+	}
+
+	LiveAssetId& operator=(LiveAssetId other) noexcept
+	{
+		std::swap(m_id, other.m_id);
+		return *this;
+	}
+
+	~LiveAssetId() noexcept
+	{
+		AssetManager::releaseRef(m_id);
+	}
+
+	operator AssetId() const noexcept
+	{
+		return m_id;
+	}
+
+	[[nodiscard]] AssetId id() const noexcept
+	{
+		return m_id;
+	}
+
+	[[nodiscard]] bool isValid() const noexcept
+	{
+		return m_id.isValid();
+	}
+
+	bool operator==(const LiveAssetId& other) const noexcept
+	{
+		return m_id == other.m_id;
+	}
+};
+
 };	// end of namespace
 
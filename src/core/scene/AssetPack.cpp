@@ -0,0 +1,345 @@
+#include "core/scene/AssetPack.h"
+#include "util/ByteStream.h"
+#include "util/FileHash.h"
+#include "util/Hash.h"
+#include "util/Logger.h"
+#include "util/Lz4.h"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace APE {
+
+namespace {
+
+static_assert(std::is_trivially_copyable_v<AssetPack::FileHeader>);
+static_assert(std::is_trivially_copyable_v<AssetPack::Entry>);
+
+// Paths are NUL separated in the manifest
+constexpr char PATH_END = '\0';
+
+void pad(std::ofstream& os, size_t alignment) noexcept
+{
+	static const std::vector<char> zeros(AssetPack::PAGE_SIZE, 0);
+
+	size_t pos = static_cast<size_t>(os.tellp());
+	size_t padded = (pos + alignment - 1) / alignment * alignment;
+	os.write(zeros.data(), static_cast<std::streamsize>(padded - pos));
+}
+
+template <typename T>
+void writeArray(std::ofstream& os, const T* vals, size_t count) noexcept
+{
+	os.write(reinterpret_cast<const char*>(vals), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+};	// end of namespace
+
+std::string AssetPack::key(const std::filesystem::path& path) noexcept
+{
+	return path.lexically_normal().generic_string();
+}
+
+bool AssetPack::write(
+	const std::filesystem::path& pack_path,
+	std::span<const std::filesystem::path> files,
+	const PackSettings& settings) noexcept
+{
+	// Name order for the manifest, duplicates only packed once
+	std::vector<std::pair<std::string, std::filesystem::path>> sources;
+	for (auto& file : files) {
+		sources.emplace_back(key(file), file);
+	}
+	std::sort(sources.begin(), sources.end(), [](auto& a, auto& b) { return a.first < b.first; });
+	sources.erase(std::unique(sources.begin(), sources.end(), [](auto& a, auto& b) {
+		return a.first == b.first;
+	}), sources.end());
+
+	ByteWriter manifest;
+	std::vector<Entry> entries;
+	entries.reserve(sources.size());
+
+	// Written aside and renamed, so a running engine never maps half a file
+	std::error_code ec;
+	if (pack_path.has_parent_path()) {
+		std::filesystem::create_directories(pack_path.parent_path(), ec);
+	}
+	std::filesystem::path tmp_path = pack_path;
+	tmp_path += ".tmp";
+
+	std::ofstream os(tmp_path, std::ios::binary | std::ios::trunc);
+	FileHeader header {};
+	writeArray(os, &header, 1);
+
+	bool b_ok = static_cast<bool>(os);
+	for (auto& [path_key, path] : sources) {
+		if (!b_ok) break;
+
+		MappedFile file(path);
+		if (!file.isOpen()) {
+			APE_ERROR("AssetPack::write() Failed to read {}.", path.string());
+			b_ok = false;
+			break;
+		}
+
+		pad(os, PAGE_SIZE);
+		Entry entry {
+			.path_hash = Hash::fnv1a(path_key),
+			.offset = static_cast<uint64_t>(os.tellp()),
+			.stored_size = file.size(),
+			.size = file.size(),
+			.content_hash = Hash::contents(file.bytes()),
+			.path_offset = static_cast<uint32_t>(manifest.pos()),
+			.path_size = static_cast<uint32_t>(path_key.size()),
+			.flags = 0,
+			.reserved = 0,
+		};
+		manifest.writeBytes(path_key.data(), path_key.size());
+		manifest.write(PATH_END);
+
+		// Already compressed formats like png don't shrink and stay stored
+		std::vector<std::byte> packed;
+		if (settings.b_compress && file.size() > 0) {
+			packed = Lz4::compress(file.bytes());
+			float saving = 1.f - static_cast<float>(packed.size()) / static_cast<float>(file.size());
+			if (saving >= settings.min_saving) {
+				entry.stored_size = packed.size();
+				entry.flags |= FLAG_LZ4;
+			}
+		}
+
+		if (entry.flags & FLAG_LZ4) {
+			writeArray(os, packed.data(), packed.size());
+		}
+		else {
+			writeArray(os, file.data(), file.size());
+		}
+		entries.push_back(entry);
+		b_ok = static_cast<bool>(os);
+	}
+
+	// Two paths on one hash would shadow each other
+	std::sort(entries.begin(), entries.end(), [](auto& a, auto& b) {
+		return a.path_hash < b.path_hash;
+	});
+	auto collision = std::adjacent_find(entries.begin(), entries.end(), [](auto& a, auto& b) {
+		return a.path_hash == b.path_hash;
+	});
+	if (b_ok && collision != entries.end()) {
+		APE_ERROR("AssetPack::write() Path hash collision in {}.", pack_path.string());
+		b_ok = false;
+	}
+
+	if (b_ok) {
+		pad(os, PAGE_SIZE);
+		header.toc_offset = static_cast<uint64_t>(os.tellp());
+		writeArray(os, entries.data(), entries.size());
+
+		header.manifest_offset = static_cast<uint64_t>(os.tellp());
+		header.manifest_size = manifest.pos();
+		writeArray(os, manifest.buffer().data(), manifest.buffer().size());
+
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.num_entries = static_cast<uint32_t>(entries.size());
+		header.page_size = PAGE_SIZE;
+		header.file_size = static_cast<uint64_t>(os.tellp());
+		os.seekp(0);
+		writeArray(os, &header, 1);
+		b_ok = static_cast<bool>(os);
+	}
+	os.close();
+
+	if (b_ok) {
+		std::filesystem::rename(tmp_path, pack_path, ec);
+		b_ok = !ec;
+	}
+	if (!b_ok) {
+		APE_ERROR("AssetPack::write() Failed to write {}.", pack_path.string());
+		std::filesystem::remove(tmp_path, ec);
+		return false;
+	}
+
+	APE_INFO("AssetPack::write() Packed {} files into {}.", entries.size(), pack_path.string());
+	return true;
+}
+
+bool AssetPack::open(const std::filesystem::path& pack_path) noexcept
+{
+	m_entries = nullptr;
+	m_num_entries = 0;
+	m_manifest = {};
+	if (!m_file.open(pack_path)) return false;
+
+	ByteReader in(m_file.data(), m_file.size());
+	auto* header = in.array<FileHeader>(1);
+	if (!header ||
+		header->magic != MAGIC ||
+		header->version != VERSION ||
+		header->page_size != PAGE_SIZE ||
+		header->file_size != m_file.size() ||
+		header->toc_offset > m_file.size() ||
+		header->manifest_offset > m_file.size() ||
+		header->manifest_size > m_file.size() - header->manifest_offset)
+	{
+		APE_ERROR("AssetPack::open() {} is not a valid pack.", pack_path.string());
+		m_file.close();
+		return false;
+	}
+
+	ByteReader toc(m_file.data() + header->toc_offset, m_file.size() - header->toc_offset);
+	auto* entries = toc.array<Entry>(header->num_entries);
+	m_manifest = std::string_view(
+		reinterpret_cast<const char*>(m_file.data() + header->manifest_offset),
+		header->manifest_size
+	);
+
+	// Checked once here so lookups can trust the table
+	bool b_valid = entries != nullptr;
+	for (uint32_t i = 0; b_valid && i < header->num_entries; ++i) {
+		const Entry& entry = entries[i];
+		b_valid =
+			entry.offset <= m_file.size() &&
+			entry.stored_size <= m_file.size() - entry.offset &&
+			(entry.flags & FLAG_LZ4 || entry.stored_size == entry.size) &&
+			entry.path_offset <= m_manifest.size() &&
+			entry.path_size <= m_manifest.size() - entry.path_offset &&
+			(i == 0 || entries[i - 1].path_hash < entry.path_hash);
+	}
+	if (!b_valid) {
+		APE_ERROR("AssetPack::open() {} has a corrupt table of contents.", pack_path.string());
+		m_manifest = {};
+		m_file.close();
+		return false;
+	}
+
+	// Empty packs still count as open
+	static const Entry NO_ENTRIES {};
+	m_entries = header->num_entries > 0 ? entries : &NO_ENTRIES;
+	m_num_entries = header->num_entries;
+	return true;
+}
+
+const AssetPack::Entry* AssetPack::find(const std::filesystem::path& path) const noexcept
+{
+	std::string path_key = key(path);
+	uint64_t path_hash = Hash::fnv1a(path_key);
+
+	auto table = entries();
+	auto it = std::lower_bound(table.begin(), table.end(), path_hash, [](auto& entry, uint64_t hash) {
+		return entry.path_hash < hash;
+	});
+	if (it == table.end() || it->path_hash != path_hash) return nullptr;
+
+	// Paths the packer never saw can still share a hash
+	return this->path(*it) == path_key ? &*it : nullptr;
+}
+
+std::string_view AssetPack::path(const Entry& entry) const noexcept
+{
+	return m_manifest.substr(entry.path_offset, entry.path_size);
+}
+
+std::vector<std::string_view> AssetPack::paths() const noexcept
+{
+	std::vector<std::string_view> result;
+	result.reserve(m_num_entries);
+
+	size_t pos = 0;
+	while (pos < m_manifest.size()) {
+		size_t end = m_manifest.find(PATH_END, pos);
+		if (end == std::string_view::npos) end = m_manifest.size();
+		result.push_back(m_manifest.substr(pos, end - pos));
+		pos = end + 1;
+	}
+	return result;
+}
+
+std::vector<std::string> AssetPack::list(const std::filesystem::path& dir) const noexcept
+{
+	std::string prefix = key(dir);
+	if (prefix == ".") prefix.clear();
+	if (!prefix.empty() && prefix.back() != '/') prefix += '/';
+
+	// Name order keeps each subdirectory's paths together
+	std::vector<std::string> names;
+	for (auto path : paths()) {
+		if (!path.starts_with(prefix)) continue;
+
+		std::string_view rest = path.substr(prefix.size());
+		size_t slash = rest.find('/');
+		std::string name(rest.substr(0, slash == std::string_view::npos ? rest.size() : slash + 1));
+		if (names.empty() || names.back() != name) {
+			names.push_back(std::move(name));
+		}
+	}
+	return names;
+}
+
+bool AssetPack::read(const Entry& entry, File& file) const noexcept
+{
+	auto stored = m_file.bytes().subspan(entry.offset, entry.stored_size);
+	file.content_hash = entry.content_hash;
+
+	if (!(entry.flags & FLAG_LZ4)) {
+		file.mapped = stored;
+		return true;
+	}
+
+	file.decoded.resize(entry.size);
+	if (!Lz4::decompress(stored, file.decoded)) {
+		APE_ERROR("AssetPack::read() {} is corrupt.", path(entry));
+		file.decoded.clear();
+		return false;
+	}
+	return true;
+}
+
+bool AssetPack::mount(const std::filesystem::path& pack_path) noexcept
+{
+	auto pack = std::make_shared<AssetPack>();
+	if (!pack->open(pack_path)) return false;
+
+	APE_INFO("AssetPack::mount() Mounted {} with {} files.", pack_path.string(), pack->m_num_entries);
+
+	std::unique_lock lock(s_mount_mutex);
+	s_mounted.push_back(std::move(pack));
+	return true;
+}
+
+void AssetPack::unmountAll() noexcept
+{
+	// Files already resolved keep their archive mapped
+	std::unique_lock lock(s_mount_mutex);
+	s_mounted.clear();
+}
+
+AssetPack::File AssetPack::resolve(const std::filesystem::path& path) noexcept
+{
+	std::shared_lock lock(s_mount_mutex);
+	for (auto it = s_mounted.rbegin(); it != s_mounted.rend(); ++it) {
+		auto* entry = (*it)->find(path);
+		if (!entry) continue;
+
+		File file;
+		if (!(*it)->read(*entry, file)) return {};
+		file.pack = *it;
+		return file;
+	}
+	return {};
+}
+
+uint64_t AssetPack::contentHash(const std::filesystem::path& path) noexcept
+{
+	std::shared_lock lock(s_mount_mutex);
+	for (auto it = s_mounted.rbegin(); it != s_mounted.rend(); ++it) {
+		if (auto* entry = (*it)->find(path)) return entry->content_hash;
+	}
+	return 0;
+}
+
+};	// end of namespace
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "util/MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace APE {
+
+struct PackSettings {
+	bool b_compress = false;
+	// Entries stay stored unless LZ4 saves at least this fraction
+	float min_saving = 0.125f;
+};
+
+/*
+* Read only archive of asset files, built by the ape_pack tool
+* The whole archive is mapped once. Entries are found by the hash of their
+* path in a table of contents sorted by hash, and every entry starts on a
+* page boundary, so stored entries are read in place without a copy. Paths
+* are kept in a manifest sorted by name for directory style listings.
+*
+* Loaders resolve paths through the mounted archives before the file
+* system, so a shipped build opens one file where it used to open one per
+* shader, model and texture.
+*/
+class AssetPack {
+public:
+	static constexpr std::string_view EXTENSION = ".apepack";
+
+	// Mounted by the engine at startup when present
+	static constexpr std::string_view DEFAULT_PATH = "res.apepack";
+
+	// "APEK" when read as little endian bytes
+	static constexpr uint32_t MAGIC = 0x4B455041;
+
+	// Bump whenever a record layout changes
+	static constexpr uint32_t VERSION = 1;
+
+	static constexpr size_t PAGE_SIZE = 4096;
+
+	enum Flags : uint32_t {
+		// Stored as an LZ4 block, decoded into a copy on read
+		FLAG_LZ4 = 1 << 0,
+	};
+
+	struct FileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t num_entries;
+		uint32_t page_size;
+		uint64_t toc_offset;
+		uint64_t manifest_offset;
+		uint64_t manifest_size;
+		uint64_t file_size;
+	};
+
+	// Table of contents record, the table is sorted by path hash
+	struct Entry {
+		uint64_t path_hash;
+		uint64_t offset;
+		uint64_t stored_size;
+		uint64_t size;
+		// Hash::contents of the original file, keys the derived data caches
+		uint64_t content_hash;
+		// Into the manifest
+		uint32_t path_offset;
+		uint32_t path_size;
+		uint32_t flags;
+		uint32_t reserved;
+	};
+
+	// One entry's bytes, in place in the mapping unless it was compressed.
+	// Holds the archive open while alive.
+	struct File {
+		std::shared_ptr<const AssetPack> pack;
+		std::span<const std::byte> mapped;
+		std::vector<std::byte> decoded;
+		uint64_t content_hash = 0;
+
+		[[nodiscard]] explicit operator bool() const noexcept
+		{
+			return pack != nullptr;
+		}
+
+		[[nodiscard]] std::span<const std::byte> bytes() const noexcept
+		{
+			return decoded.empty() ? mapped : std::span<const std::byte>(decoded);
+		}
+	};
+
+private:
+	MappedFile m_file;
+	const Entry* m_entries = nullptr;
+	size_t m_num_entries = 0;
+	std::string_view m_manifest;
+
+	static inline std::shared_mutex s_mount_mutex;
+	static inline std::vector<std::shared_ptr<const AssetPack>> s_mounted;
+
+public:
+	AssetPack() noexcept = default;
+
+	AssetPack(const AssetPack& other) = delete;
+	AssetPack& operator=(const AssetPack& other) = delete;
+
+	// Packs files under the paths they are given by, relative to the
+	// working directory like res/
+	static bool write(
+		const std::filesystem::path& pack_path,
+		std::span<const std::filesystem::path> files,
+		const PackSettings& settings = {}) noexcept;
+
+	// Validates the header and table of contents
+	bool open(const std::filesystem::path& pack_path) noexcept;
+
+	[[nodiscard]] bool isOpen() const noexcept
+	{
+		return m_entries != nullptr;
+	}
+
+	// Lookup key of a path, "./res\a.png" and "res/a.png" are the same entry
+	[[nodiscard]] static std::string key(const std::filesystem::path& path) noexcept;
+
+	[[nodiscard]] const Entry* find(const std::filesystem::path& path) const noexcept;
+
+	[[nodiscard]] std::span<const Entry> entries() const noexcept
+	{
+		return { m_entries, m_num_entries };
+	}
+
+	[[nodiscard]] std::string_view path(const Entry& entry) const noexcept;
+
+	// Every path in name order
+	[[nodiscard]] std::vector<std::string_view> paths() const noexcept;
+
+	// Names directly under dir, subdirectories end in '/'
+	[[nodiscard]] std::vector<std::string> list(const std::filesystem::path& dir) const noexcept;
+
+	// Later mounts shadow earlier ones
+	static bool mount(const std::filesystem::path& pack_path) noexcept;
+
+	static void unmountAll() noexcept;
+
+	// The newest mounted copy of path, empty when no archive has it
+	[[nodiscard]] static File resolve(const std::filesystem::path& path) noexcept;
+
+	// Only the content hash, without decoding anything
+	[[nodiscard]] static uint64_t contentHash(const std::filesystem::path& path) noexcept;
+
+private:
+	[[nodiscard]] bool read(const Entry& entry, File& file) const noexcept;
+};
+
+};	// end of namespace
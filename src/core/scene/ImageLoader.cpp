@@ -1,5 +1,6 @@
 #include "core/scene/ImageLoader.h"
 #include "core/scene/AssetManager.h"
+#include "core/scene/ModelLoader.h"
 
 namespace APE {
 
@@ -13,14 +14,35 @@ ImageLoader::load(std::filesystem::path path) noexcept
 AssetHandle<Render::Image> 
 ImageLoader::load(AssetKey asset_key) noexcept
 {
-	if (!AssetManager::contains(asset_key)) {
-		AssetManager::upload<Render::Image>(
-			asset_key,
-			AssetClass::Texture,
-			std::move(std::make_unique<Render::Image>(asset_key.path))
-		);
+	// Embedded textures come back with the model that holds them
+	if (!asset_key.sub_index.empty() && !AssetManager::contains(asset_key)) {
+		(void)ModelLoader::load(asset_key.path);
 	}
-	return AssetManager::get<Render::Image>(asset_key);
+
+	return AssetManager::findOrLoad<Render::Image>(
+		asset_key,
+		AssetClass::Texture,
+		[&]() { return std::make_unique<Render::Image>(asset_key.path); }
+	);
+}
+
+AssetHandle<Render::Image>
+ImageLoader::loadAsync(std::filesystem::path path, int priority) noexcept
+{
+	AssetKey asset_key { path };
+	return loadAsync(asset_key, priority);
+}
+
+AssetHandle<Render::Image>
+ImageLoader::loadAsync(AssetKey asset_key, int priority) noexcept
+{
+	return AssetManager::loadAsync<Render::Image>(
+		asset_key,
+		AssetClass::Texture,
+		[asset_key]() { return std::make_unique<Render::Image>(asset_key.path); },
+		defaultImage().data,
+		priority
+	);
 }
 
 AssetHandle<Render::Image> ImageLoader::defaultImage() noexcept
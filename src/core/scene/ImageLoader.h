@@ -14,6 +14,13 @@ struct ImageLoader {
 	[[nodiscard]] static AssetHandle<Render::Image>
 	load(AssetKey asset_key) noexcept;
 
+	// Serves the checkerboard until decoding finishes on the thread pool
+	[[nodiscard]] static AssetHandle<Render::Image>
+	loadAsync(std::filesystem::path path, int priority = 0) noexcept;
+
+	[[nodiscard]] static AssetHandle<Render::Image>
+	loadAsync(AssetKey asset_key, int priority = 0) noexcept;
+
 	[[nodiscard]] static AssetHandle<Render::Image>
 	defaultImage() noexcept;
 };
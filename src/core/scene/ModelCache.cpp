@@ -0,0 +1,418 @@
+#include "core/scene/ModelCache.h"
+#include "core/scene/AssetManager.h"
+#include "core/scene/AssetPack.h"
+#include "core/scene/ImageLoader.h"
+#include "util/ByteStream.h"
+#include "util/FileHash.h"
+#include "util/Hash.h"
+#include "util/Logger.h"
+#include "util/MappedFile.h"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace APE {
+
+namespace {
+
+// Vertices and records are copied byte for byte
+static_assert(std::is_trivially_copyable_v<Render::Model::VertexType>);
+static_assert(std::is_trivially_copyable_v<ModelCache::MeshRecord>);
+static_assert(std::is_trivially_copyable_v<Render::MeshLod>);
+static_assert(sizeof(Render::Model::VertexType) == 32,
+	"Model vertex layout changed, bump ModelCache::VERSION");
+static_assert(sizeof(ModelCache::MeshRecord) == 144,
+	"MeshRecord layout changed, bump ModelCache::VERSION");
+
+// Embedded textures are keyed by the model file itself
+[[nodiscard]] bool isEmbedded(
+	const AssetHandle<Render::Image>& texture,
+	const Render::Model& model) noexcept
+{
+	return texture.key.path == model.model_path && texture.data != nullptr;
+}
+
+void writeIndices(
+	ByteWriter& out,
+	const std::vector<Render::Model::IndexType>& indices,
+	uint32_t index_size) noexcept
+{
+	if (index_size == sizeof(Uint16)) {
+		out.writeArray(Render::narrowIndices<Uint16, Render::Model::IndexType>(indices));
+	}
+	else {
+		out.writeArray(indices);
+	}
+}
+
+template <typename T>
+[[nodiscard]] const T* blob(const MappedFile& file, uint64_t offset, size_t count) noexcept
+{
+	if (offset > file.size()) return nullptr;
+	return ByteReader(file.data() + offset, file.size() - offset).array<T>(count);
+}
+
+// Widens an index blob stored as T, a bad index would read past the
+// vertex buffer on the GPU
+template <typename T>
+[[nodiscard]] bool readIndices(
+	const MappedFile& file,
+	uint64_t offset,
+	uint32_t count,
+	uint32_t num_vertices,
+	std::vector<Render::Model::IndexType>& indices) noexcept
+{
+	auto* stored = blob<T>(file, offset, count);
+	if (!stored) return false;
+
+	indices.assign(stored, stored + count);
+	return std::all_of(indices.begin(), indices.end(), [&](auto index) {
+		return index < num_vertices;
+	});
+}
+
+[[nodiscard]] bool readIndices(
+	const MappedFile& file,
+	const ModelCache::MeshRecord& rec,
+	uint64_t offset,
+	uint32_t count,
+	std::vector<Render::Model::IndexType>& indices) noexcept
+{
+	if (rec.index_size == sizeof(Uint16) && rec.num_vertices <= Render::MAX_INDEX16_VERTICES) {
+		return readIndices<Uint16>(file, offset, count, rec.num_vertices, indices);
+	}
+	if (rec.index_size == sizeof(Uint32)) {
+		return readIndices<Uint32>(file, offset, count, rec.num_vertices, indices);
+	}
+	return false;
+}
+
+};	// end of namespace
+
+
+void ModelCache::setDirectory(std::filesystem::path dir) noexcept
+{
+	s_directory = std::move(dir);
+}
+
+const std::filesystem::path& ModelCache::directory() noexcept
+{
+	return s_directory;
+}
+
+std::filesystem::path ModelCache::cachePath(
+	const std::filesystem::path& source_path) noexcept
+{
+	uint64_t path_hash = Hash::fnv1a(source_path.lexically_normal().generic_string());
+	return s_directory / std::format("{}_{:016x}{}",
+		source_path.stem().string(),
+		path_hash,
+		EXTENSION
+	);
+}
+
+uint64_t ModelCache::contentHash(
+	const std::filesystem::path& source_path,
+	const std::filesystem::path& cache_path) noexcept
+{
+	// Packed sources were hashed by the packer
+	if (uint64_t packed_hash = AssetPack::contentHash(source_path)) return packed_hash;
+	if (!cache_path.empty()) {
+		if (uint64_t stamped = stampedHash(cache_path, Hash::fileStamp(source_path))) return stamped;
+	}
+	return Hash::fileContents(source_path);
+}
+
+uint64_t ModelCache::stampedHash(
+	const std::filesystem::path& cache_path,
+	const Hash::FileStamp& source_stamp) noexcept
+{
+	if (source_stamp == Hash::FileStamp {}) return 0;
+
+	FileHeader header;
+	std::ifstream is(cache_path, std::ios::binary);
+	if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))) return 0;
+
+	if (header.magic != MAGIC ||
+		header.version != VERSION ||
+		header.source_size != source_stamp.size ||
+		header.source_mtime != source_stamp.mtime)
+	{
+		return 0;
+	}
+	return header.source_hash;
+}
+
+bool ModelCache::save(
+	const std::filesystem::path& cache_path,
+	const Render::Model& model,
+	uint64_t content_hash,
+	uint64_t source_hash) noexcept
+{
+	if (content_hash == 0) return false;
+
+	// Material references and embedded textures, deduplicated by key
+	StringTableBuilder strings;
+	std::vector<const Render::Model::ModelMesh*> meshes;
+	std::vector<std::shared_ptr<Render::Image>> textures;
+	std::vector<TextureRecord> texture_records;
+	std::unordered_map<std::string, uint32_t> texture_lookup;
+	std::vector<MeshRecord> mesh_records;
+
+	for (auto& mesh : model.meshes) {
+		auto& tex = mesh.texture_handle;
+		MeshRecord rec {
+			.vertex_offset = 0,
+			.index_offset = 0,
+			.num_vertices = static_cast<uint32_t>(mesh.vertices.size()),
+			.num_indices = static_cast<uint32_t>(mesh.indices.size()),
+			.transform = mesh.transform,
+			.bounds_min = mesh.bounds.min,
+			.bounds_max = mesh.bounds.max,
+			.sphere_center = mesh.bounding_sphere.center,
+			.sphere_radius = mesh.bounding_sphere.radius,
+			.texture_path = strings.own(tex.key.path.generic_string()),
+			.texture_sub_index = strings.own(tex.key.sub_index),
+			.embedded_texture = NULL_INDEX,
+			.num_lods = static_cast<uint32_t>(mesh.lods.size()),
+			.lod_offset = 0,
+			.lod_index_offset = 0,
+			.num_lod_indices = static_cast<uint32_t>(mesh.lod_indices.size()),
+			.index_size = mesh.index_size,
+		};
+
+		if (isEmbedded(tex, model)) {
+			auto [it, b_inserted] = texture_lookup.try_emplace(
+				tex.key.to_string(),
+				static_cast<uint32_t>(textures.size())
+			);
+			if (b_inserted) {
+				textures.push_back(tex.data);
+				texture_records.push_back({
+					.offset = 0,
+					.width = tex.data->getWidth(),
+					.height = tex.data->getHeight(),
+					.path = rec.texture_path,
+					.sub_index = rec.texture_sub_index,
+				});
+			}
+			rec.embedded_texture = it->second;
+		}
+
+		meshes.push_back(&mesh);
+		mesh_records.push_back(rec);
+	}
+
+	// Header and record tables are patched once blob offsets are known
+	ByteWriter out;
+	out.write(FileHeader {});
+	size_t mesh_table = out.pos();
+	out.writeArray(mesh_records);
+	size_t texture_table = out.pos();
+	out.writeArray(texture_records);
+
+	auto& str_list = strings.strings();
+	std::vector<uint32_t> str_offsets { 0 };
+	for (auto str : str_list) {
+		str_offsets.push_back(str_offsets.back() + static_cast<uint32_t>(str.size()));
+	}
+	out.writeArray(str_offsets);
+	for (auto str : str_list) {
+		out.writeBytes(str.data(), str.size());
+	}
+
+	for (size_t i = 0; i < meshes.size(); ++i) {
+		out.align(BLOB_ALIGN);
+		mesh_records[i].vertex_offset = out.pos();
+		out.writeArray(meshes[i]->vertices);
+
+		out.align(BLOB_ALIGN);
+		mesh_records[i].index_offset = out.pos();
+		writeIndices(out, meshes[i]->indices, mesh_records[i].index_size);
+
+		out.align(BLOB_ALIGN);
+		mesh_records[i].lod_offset = out.pos();
+		out.writeArray(meshes[i]->lods);
+
+		out.align(BLOB_ALIGN);
+		mesh_records[i].lod_index_offset = out.pos();
+		writeIndices(out, meshes[i]->lod_indices, mesh_records[i].index_size);
+	}
+
+	for (size_t i = 0; i < textures.size(); ++i) {
+		out.align(BLOB_ALIGN);
+		texture_records[i].offset = out.pos();
+		out.writeBytes(textures[i]->getPixels(), textures[i]->getSizeBytes());
+	}
+
+	for (size_t i = 0; i < mesh_records.size(); ++i) {
+		out.patch(mesh_table + i * sizeof(MeshRecord), mesh_records[i]);
+	}
+	for (size_t i = 0; i < texture_records.size(); ++i) {
+		out.patch(texture_table + i * sizeof(TextureRecord), texture_records[i]);
+	}
+	Hash::FileStamp source_stamp = (source_hash != 0) ? Hash::fileStamp(model.model_path) : Hash::FileStamp {};
+	out.patch(0, FileHeader {
+		.magic = MAGIC,
+		.version = VERSION,
+		.importer_version = IMPORTER_VERSION,
+		.num_meshes = static_cast<uint32_t>(mesh_records.size()),
+		.num_textures = static_cast<uint32_t>(texture_records.size()),
+		.num_strings = static_cast<uint32_t>(str_list.size()),
+		.content_hash = content_hash,
+		.source_hash = source_hash,
+		.source_size = source_stamp.size,
+		.source_mtime = source_stamp.mtime,
+		.file_size = out.pos(),
+	});
+
+	// Written aside and renamed, so a concurrent load never maps half a file
+	std::error_code ec;
+	std::filesystem::create_directories(cache_path.parent_path(), ec);
+	std::filesystem::path tmp_path = cache_path;
+	tmp_path += ".tmp";
+	{
+		std::ofstream os(tmp_path, std::ios::binary | std::ios::trunc);
+		auto& bytes = out.buffer();
+		os.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+		if (!os) {
+			APE_WARN("ModelCache::save() Failed to write {}.", cache_path.string());
+			os.close();
+			std::filesystem::remove(tmp_path, ec);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(tmp_path, cache_path, ec);
+	if (ec) {
+		APE_WARN("ModelCache::save() Failed to write {}.", cache_path.string());
+		std::filesystem::remove(tmp_path, ec);
+		return false;
+	}
+	return true;
+}
+
+std::unique_ptr<Render::Model> ModelCache::load(
+	const std::filesystem::path& cache_path,
+	const std::filesystem::path& source_path,
+	uint64_t content_hash) noexcept
+{
+	std::error_code ec;
+	if (content_hash == 0 || !std::filesystem::is_regular_file(cache_path, ec)) {
+		return nullptr;
+	}
+
+	MappedFile file(cache_path);
+	if (!file.isOpen()) return nullptr;
+
+	ByteReader in(file.data(), file.size());
+	auto* header = in.array<FileHeader>(1);
+	if (!header ||
+		header->magic != MAGIC ||
+		header->version != VERSION ||
+		header->file_size != file.size())
+	{
+		APE_WARN("ModelCache::load() Ignoring corrupt cache {}.", cache_path.string());
+		return nullptr;
+	}
+
+	if (header->importer_version != IMPORTER_VERSION ||
+		header->content_hash != content_hash)
+	{
+		APE_TRACE("ModelCache::load() {} is stale, reimporting.", cache_path.string());
+		return nullptr;
+	}
+
+	auto* mesh_records = in.array<MeshRecord>(header->num_meshes);
+	auto* texture_records = in.array<TextureRecord>(header->num_textures);
+	auto* str_offsets = in.array<uint32_t>(header->num_strings + 1);
+	auto* chars = str_offsets ? in.array<char>(str_offsets[header->num_strings]) : nullptr;
+	if (!mesh_records || !texture_records || !chars) {
+		APE_WARN("ModelCache::load() Ignoring corrupt cache {}.", cache_path.string());
+		return nullptr;
+	}
+
+	std::vector<std::string_view> strings;
+	strings.reserve(header->num_strings);
+	for (uint32_t i = 0; i < header->num_strings; ++i) {
+		if (str_offsets[i] > str_offsets[i + 1]) return nullptr;
+		strings.emplace_back(chars + str_offsets[i], str_offsets[i + 1] - str_offsets[i]);
+	}
+	auto string = [&](uint32_t idx) {
+		return (idx < strings.size()) ? std::string(strings[idx]) : std::string();
+	};
+
+	// Embedded textures resolve once each, however many meshes share them
+	std::vector<AssetHandle<Render::Image>> embedded(header->num_textures);
+	auto texture = [&](const MeshRecord& rec) -> std::optional<AssetHandle<Render::Image>> {
+		AssetKey key { string(rec.texture_path), string(rec.texture_sub_index) };
+		if (rec.embedded_texture == NULL_INDEX) {
+			return key.path.empty() ? ImageLoader::defaultImage() : ImageLoader::load(key);
+		}
+		if (rec.embedded_texture >= header->num_textures) return std::nullopt;
+
+		auto& handle = embedded[rec.embedded_texture];
+		if (!handle.data) {
+			auto& tex = texture_records[rec.embedded_texture];
+			auto* pixels = blob<std::byte>(file, tex.offset, size_t(tex.width) * tex.height * 4);
+			if (!pixels || tex.height == 0) return std::nullopt;
+
+			handle = AssetManager::findOrLoad<Render::Image>(key, AssetClass::Texture, [&]() {
+				return std::make_unique<Render::Image>(
+					source_path,
+					static_cast<int>(tex.width),
+					static_cast<int>(tex.height),
+					pixels
+				);
+			});
+		}
+		return handle;
+	};
+
+	auto model = std::make_unique<Render::Model>(source_path);
+	model->meshes.reserve(header->num_meshes);
+	for (uint32_t i = 0; i < header->num_meshes; ++i) {
+		auto& rec = mesh_records[i];
+		auto* vertices = blob<Render::Model::VertexType>(file, rec.vertex_offset, rec.num_vertices);
+		auto* lods = blob<Render::MeshLod>(file, rec.lod_offset, rec.num_lods);
+		auto tex_handle = texture(rec);
+		if (!vertices || !lods || !tex_handle) {
+			APE_WARN("ModelCache::load() Ignoring corrupt cache {}.", cache_path.string());
+			return nullptr;
+		}
+
+		Render::Model::ModelMesh mesh;
+		if (!readIndices(file, rec, rec.index_offset, rec.num_indices, mesh.indices) ||
+			!readIndices(file, rec, rec.lod_index_offset, rec.num_lod_indices, mesh.lod_indices))
+		{
+			APE_WARN("ModelCache::load() Ignoring corrupt cache {}.", cache_path.string());
+			return nullptr;
+		}
+
+		for (uint32_t j = 0; j < rec.num_lods; ++j) {
+			if (uint64_t(lods[j].index_offset) + lods[j].index_count > rec.num_lod_indices) return nullptr;
+		}
+
+		mesh.vertices.assign(vertices, vertices + rec.num_vertices);
+		mesh.index_size = rec.index_size;
+		mesh.lods.assign(lods, lods + rec.num_lods);
+		mesh.transform = rec.transform;
+		mesh.texture_handle = std::move(*tex_handle);
+		mesh.bounds = Physics::Collisions::AABB(rec.bounds_min, rec.bounds_max);
+		mesh.bounding_sphere = Physics::Collisions::Sphere(rec.sphere_center, rec.sphere_radius);
+		model->meshes.push_back(std::move(mesh));
+	}
+
+	model->computeBounds();
+	return model;
+}
+
+};	// end of namespace
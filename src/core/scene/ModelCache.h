@@ -0,0 +1,124 @@
+#pragma once
+
+#include "core/components/Object.h"
+#include "core/render/Model.h"
+#include "util/FileHash.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+namespace APE {
+
+/*
+* Derived data cache for imported models
+* The converted meshes, transforms and material references of an import
+* are written to one file per source path, tagged with the source's content
+* hash and the importer version. While both still match, later loads map
+* that file and skip Assimp entirely. The source's size and mtime are
+* recorded too, and while they match, the stored hash stands in for
+* rehashing the source.
+*/
+struct ModelCache {
+	static constexpr std::string_view EXTENSION = ".apemodel";
+
+	// "APEM" when read as little endian bytes
+	static constexpr uint32_t MAGIC = 0x4D455041;
+
+	// Bump whenever a record layout changes
+	static constexpr uint32_t VERSION = 4;
+
+	// Bump whenever ModelLoader's import flags or mesh conversion change
+	static constexpr uint32_t IMPORTER_VERSION = 3;
+
+	static constexpr uint32_t NULL_INDEX = 0xFFFFFFFF;
+	static constexpr size_t BLOB_ALIGN = 16;
+
+	struct FileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t importer_version;
+		uint32_t num_meshes;
+		uint32_t num_textures;
+		uint32_t num_strings;
+		uint64_t content_hash;
+		// The source file's own hash, content_hash may mix in settings
+		uint64_t source_hash;
+		uint64_t source_size;
+		int64_t source_mtime;
+		uint64_t file_size;
+	};
+
+	struct MeshRecord {
+		uint64_t vertex_offset;
+		uint64_t index_offset;
+		uint32_t num_vertices;
+		uint32_t num_indices;
+		TransformComponent transform;
+		glm::vec3 bounds_min;
+		glm::vec3 bounds_max;
+		glm::vec3 sphere_center;
+		float sphere_radius;
+		uint32_t texture_path;
+		uint32_t texture_sub_index;
+		uint32_t embedded_texture;
+		uint32_t num_lods;
+		// Render::MeshLod records, then the LOD index blob
+		uint64_t lod_offset;
+		uint64_t lod_index_offset;
+		uint32_t num_lod_indices;
+		// Bytes per stored index, 2 or 4
+		uint32_t index_size;
+	};
+
+	// Textures embedded in the source file, stored decoded as RGBA8
+	struct TextureRecord {
+		uint64_t offset;
+		uint32_t width;
+		uint32_t height;
+		uint32_t path;
+		uint32_t sub_index;
+	};
+
+	// Relative to the working directory, like res/
+	static void setDirectory(std::filesystem::path dir) noexcept;
+
+	[[nodiscard]] static const std::filesystem::path& directory() noexcept;
+
+	// Cache file a source model maps to
+	[[nodiscard]] static std::filesystem::path cachePath(
+		const std::filesystem::path& source_path) noexcept;
+
+	// Hash of the source file's bytes, 0 if it can't be read. A cache file
+	// made from a source of the same size and mtime supplies it unread.
+	[[nodiscard]] static uint64_t contentHash(
+		const std::filesystem::path& source_path,
+		const std::filesystem::path& cache_path = {}) noexcept;
+
+	// Source hash recorded in the cache file if it was made from a source
+	// with this stamp, 0 otherwise. Reads only the header.
+	[[nodiscard]] static uint64_t stampedHash(
+		const std::filesystem::path& cache_path,
+		const Hash::FileStamp& source_stamp) noexcept;
+
+	// Stamped with the model's source path when source_hash is given
+	static bool save(
+		const std::filesystem::path& cache_path,
+		const Render::Model& model,
+		uint64_t content_hash,
+		uint64_t source_hash = 0) noexcept;
+
+	// Null when the cache file is missing, stale or corrupt
+	[[nodiscard]] static std::unique_ptr<Render::Model> load(
+		const std::filesystem::path& cache_path,
+		const std::filesystem::path& source_path,
+		uint64_t content_hash) noexcept;
+
+private:
+	static inline std::filesystem::path s_directory = "cache/models";
+};
+
+};	// end of namespace
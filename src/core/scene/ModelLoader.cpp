@@ -1,14 +1,138 @@
 #include "core/scene/ModelLoader.h"
 #include "core/scene/AssetManager.h"
+#include "core/scene/AssetPack.h"
 #include "core/render/Model.h"
 #include "core/scene/ImageLoader.h"
+#include "core/scene/ModelCache.h"
+#include "util/Hash.h"
+#include "util/ThreadPool.h"
 
+#include <assimp/DefaultIOSystem.h>
+#include <assimp/IOStream.hpp>
 #include <assimp/postprocess.h>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
 #include <utility>
 
 namespace APE {
 
+namespace {
+
+// Meshes cached under other optimizer or LOD settings are stale too
+[[nodiscard]] uint64_t withSettings(
+	uint64_t content_hash,
+	const Render::MeshOpt::Settings& mesh_settings,
+	const Render::Lod::Settings& lod_settings) noexcept
+{
+	if (content_hash == 0) return 0;
+
+	std::array<uint32_t, 11> fields = {
+		mesh_settings.b_weld,
+		mesh_settings.b_vertex_cache,
+		mesh_settings.b_overdraw,
+		mesh_settings.b_vertex_fetch,
+		std::bit_cast<uint32_t>(mesh_settings.overdraw_threshold),
+		mesh_settings.cache_size,
+		mesh_settings.b_split_index16,
+		lod_settings.max_levels,
+		std::bit_cast<uint32_t>(lod_settings.ratio),
+		std::bit_cast<uint32_t>(lod_settings.max_error),
+		std::bit_cast<uint32_t>(lod_settings.min_reduction),
+	};
+	return Hash::fnv1a(fields.data(), sizeof(fields), content_hash);
+}
+
+void buildStreams(
+	Render::Model& model,
+	const Render::VertexQuant::Settings& vertex_settings) noexcept
+{
+	for (auto& mesh : model.meshes) {
+		mesh.buildStreams(vertex_settings);
+	}
+}
+
+// Read only stream over a packed file
+class PackIOStream : public Assimp::IOStream {
+private:
+	AssetPack::File m_file;
+	size_t m_pos = 0;
+
+public:
+	explicit PackIOStream(AssetPack::File file) noexcept
+		: m_file(std::move(file))
+	{
+
+	}
+
+	size_t Read(void* buffer, size_t size, size_t count) override
+	{
+		if (size == 0) return 0;
+
+		auto bytes = m_file.bytes();
+		size_t num_read = std::min(count, (bytes.size() - m_pos) / size);
+		std::memcpy(buffer, bytes.data() + m_pos, num_read * size);
+		m_pos += num_read * size;
+		return num_read;
+	}
+
+	size_t Write(const void*, size_t, size_t) override
+	{
+		return 0;
+	}
+
+	aiReturn Seek(size_t offset, aiOrigin origin) override
+	{
+		size_t base = 0;
+		if (origin == aiOrigin_CUR) base = m_pos;
+		if (origin == aiOrigin_END) base = FileSize();
+
+		if (offset > FileSize() - base) return aiReturn_FAILURE;
+		m_pos = base + offset;
+		return aiReturn_SUCCESS;
+	}
+
+	size_t Tell() const override
+	{
+		return m_pos;
+	}
+
+	size_t FileSize() const override
+	{
+		return m_file.bytes().size();
+	}
+
+	void Flush() override
+	{
+
+	}
+};
+
+// Files a model references, like .mtl and .bin, come from the mounted
+// packs as well and fall back to disk
+class PackIOSystem : public Assimp::DefaultIOSystem {
+public:
+	bool Exists(const char* path) const override
+	{
+		return AssetPack::contentHash(path) != 0 || DefaultIOSystem::Exists(path);
+	}
+
+	Assimp::IOStream* Open(const char* path, const char* mode = "rb") override
+	{
+		bool b_write = std::strchr(mode, 'w') || std::strchr(mode, 'a');
+		if (!b_write) {
+			if (AssetPack::File file = AssetPack::resolve(path)) {
+				return new PackIOStream(std::move(file));
+			}
+		}
+		return DefaultIOSystem::Open(path, mode);
+	}
+};
+
+};	// end of namespace
+
 AssetHandle<Render::Model> ModelLoader::load(
 	std::filesystem::path model_path) noexcept
 {
@@ -19,11 +143,53 @@ AssetHandle<Render::Model> ModelLoader::load(
 AssetHandle<Render::Model> 
 ModelLoader::load(AssetKey asset_key) noexcept
 {
-	if (AssetManager::contains(asset_key)) {
-		return AssetManager::get<Render::Model>(asset_key);
+	return AssetManager::findOrLoad<Render::Model>(
+		asset_key,
+		AssetClass::Model,
+		[&]() { return importModel(asset_key); }
+	);
+}
+
+AssetHandle<Render::Model>
+ModelLoader::loadAsync(std::filesystem::path model_path, int priority) noexcept
+{
+	AssetKey key { model_path };
+	return loadAsync(key, priority);
+}
+
+AssetHandle<Render::Model>
+ModelLoader::loadAsync(AssetKey asset_key, int priority) noexcept
+{
+	return AssetManager::loadAsync<Render::Model>(
+		asset_key,
+		AssetClass::Model,
+		[asset_key]() { return importModel(asset_key); },
+		defaultModel().data,
+		priority
+	);
+}
+
+std::unique_ptr<Render::Model> 
+ModelLoader::importModel(const AssetKey& asset_key, ThreadPool& pool) noexcept
+{
+	// The pool workers see this copy, settings changed mid import apply
+	// to the next one
+	const ImportSettings settings = importSettings();
+
+	// Converted meshes from an earlier run skip Assimp entirely
+	std::filesystem::path cache_path = ModelCache::cachePath(asset_key.path);
+	uint64_t source_hash = ModelCache::contentHash(asset_key.path, cache_path);
+	uint64_t content_hash = withSettings(source_hash, settings.mesh, settings.lod);
+	if (auto cached = ModelCache::load(cache_path, asset_key.path, content_hash)) {
+		buildStreams(*cached, settings.vertex);
+		return cached;
 	}
 
+	// The importer owns its IO handler
 	Assimp::Importer importer;
+	if (AssetPack::contentHash(asset_key.path) != 0) {
+		importer.SetIOHandler(new PackIOSystem());
+	}
 	const aiScene* scene = importer.ReadFile(
 		asset_key.path,
 		aiProcess_Triangulate | 
@@ -41,15 +207,59 @@ ModelLoader::load(AssetKey asset_key) noexcept
 		importer.GetErrorString()
 	);
 
-	auto m = std::make_unique<Render::Model>(asset_key.path);
-	processNode(scene->mRootNode, scene, *m, asset_key.path);
+	// Collect meshes and the materials they use
+	std::vector<MeshTask> mesh_tasks;
+	collectMeshes(scene->mRootNode, scene, mesh_tasks);
 
-	auto handle = AssetManager::upload<Render::Model>(
-		asset_key,
-		AssetClass::Model,
-		std::move(m)
+	std::vector<unsigned int> materials;
+	std::vector<uint32_t> material_slot(scene->mNumMaterials, ~0u);
+	for (auto& task : mesh_tasks) {
+		unsigned int mat_idx = task.ai_mesh->mMaterialIndex;
+		if (material_slot[mat_idx] == ~0u) {
+			material_slot[mat_idx] = static_cast<uint32_t>(materials.size());
+			materials.push_back(mat_idx);
+		}
+	}
+
+	// Decode textures and convert meshes side by side, the asset manager
+	// dedupes textures shared by several materials
+	std::vector<AssetHandle<Render::Image>> textures(materials.size());
+	std::vector<std::vector<Render::Model::ModelMesh>> converted(mesh_tasks.size());
+	pool.parallelFor(
+		materials.size() + mesh_tasks.size(),
+		[&](size_t i) {
+			if (i < materials.size()) {
+				textures[i] = convertAiMaterial(
+					scene->mMaterials[materials[i]],
+					scene,
+					asset_key.path
+				);
+				return;
+			}
+
+			auto& task = mesh_tasks[i - materials.size()];
+			converted[i - materials.size()] = processAiMesh(
+				task.ai_mesh,
+				task.transform,
+				settings
+			);
+		}
 	);
-	return handle;
+
+	// Assemble in node order
+	auto m = std::make_unique<Render::Model>(asset_key.path);
+	for (size_t i = 0; i < mesh_tasks.size(); ++i) {
+		auto& texture = textures[material_slot[mesh_tasks[i].ai_mesh->mMaterialIndex]];
+		for (auto& mesh : converted[i]) {
+			mesh.texture_handle = texture;
+			m->meshes.push_back(std::move(mesh));
+		}
+	}
+	m->computeBounds();
+
+	ModelCache::save(cache_path, *m, content_hash, source_hash);
+	buildStreams(*m, settings.vertex);
+	return m;
 }
 
 AssetHandle<Render::Model> ModelLoader::defaultModel() noexcept
@@ -91,21 +301,7 @@ AssetHandle<Render::Image> ModelLoader::convertAiMaterial(
 	if (ai_mat->GetTexture(aiTextureType_DIFFUSE, 0, &path) == AI_SUCCESS) {
 		// Check if texture is embedded in model file
 		if (path.length > 0 && path.data[0] == '*') {
-			int tex_idx = std::atoi(path.C_Str() + 1);
-			aiTexture* ai_tex = scene->mTextures[tex_idx];
-
-			AssetKey key { model_path, ai_mat->GetName().C_Str() };
-			auto img = std::make_unique<Render::Image>(
-				model_path,
-				ai_tex->mWidth,
-				ai_tex->mHeight,
-				reinterpret_cast<std::byte*>(ai_tex->pcData)
-			);
-			return AssetManager::upload<Render::Image>(
-				key,
-				AssetClass::Texture,
-				std::move(img)
-			);
+			return loadEmbeddedTexture(scene, path, model_path);
 		}
 		// Otherwise create texture from file
 		else {
@@ -123,42 +319,60 @@ AssetHandle<Render::Image> ModelLoader::convertAiMaterial(
 	return ImageLoader::defaultImage();
 }
 
-void ModelLoader::processNode(
+AssetHandle<Render::Image> ModelLoader::loadEmbeddedTexture(
+	const aiScene* scene,
+	const aiString& ref,
+	const std::filesystem::path& model_path) noexcept
+{
+	int tex_idx = std::atoi(ref.C_Str() + 1);
+	if (tex_idx < 0 || static_cast<unsigned int>(tex_idx) >= scene->mNumTextures) {
+		APE_ERROR(
+			"ModelLoader::loadEmbeddedTexture() Failed: {} out of range.",
+			ref.C_Str()
+		);
+		return ImageLoader::defaultImage();
+	}
+	const aiTexture* ai_tex = scene->mTextures[tex_idx];
+
+	AssetKey key { model_path, ref.C_Str() };
+	return AssetManager::findOrLoad<Render::Image>(
+		key,
+		AssetClass::Texture,
+		[&]() {
+			return std::make_unique<Render::Image>(
+				model_path,
+				ai_tex->mWidth,
+				ai_tex->mHeight,
+				reinterpret_cast<const std::byte*>(ai_tex->pcData)
+			);
+		}
+	);
+}
+
+void ModelLoader::collectMeshes(
 	const aiNode* node,
 	const aiScene* scene,
-	Render::Model& model,
-	std::filesystem::path model_path) noexcept
+	std::vector<MeshTask>& tasks) noexcept
 {
 	TransformComponent local_transform = convertAiTransform(node->mTransformation);
 
-	// Convert nodes aiMeshes into our own Meshes
 	for (size_t i = 0; i < node->mNumMeshes; ++i) {
-		// Get aiMesh
-		unsigned int mesh_idx = node->mMeshes[i];
-		aiMesh* ai_mesh = scene->mMeshes[mesh_idx];
-
-		// Get texture for current mesh
-		aiMaterial* ai_mat = scene->mMaterials[ai_mesh->mMaterialIndex];
-		AssetHandle<Render::Image> texture_handle = 
-			convertAiMaterial(ai_mat, scene, model_path);
-
-		model.meshes.emplace_back(processAiMesh(
-			ai_mesh,
-			texture_handle,
-			local_transform
-		));
+		tasks.push_back({
+			.ai_mesh = scene->mMeshes[node->mMeshes[i]],
+			.transform = local_transform,
+		});
 	}
 
 	// Process child nodes
 	for (size_t i = 0; i < node->mNumChildren; ++i) {
-		processNode(node->mChildren[i], scene, model, model_path);
+		collectMeshes(node->mChildren[i], scene, tasks);
 	}
 }
 
-Render::Model::ModelMesh ModelLoader::processAiMesh(
+std::vector<Render::Model::ModelMesh> ModelLoader::processAiMesh(
 	const aiMesh* ai_mesh,
-	const AssetHandle<Render::Image>& texture_handle,
-	const TransformComponent& transform) noexcept
+	const TransformComponent& transform,
+	const ImportSettings& settings) noexcept
 {
 	std::vector<Render::Model::VertexType> vertices;
 	vertices.reserve(ai_mesh->mNumVertices);
@@ -204,12 +418,58 @@ Render::Model::ModelMesh ModelLoader::processAiMesh(
 		}
 	}
 
-	return Render::Model::ModelMesh(
+	auto report = Render::MeshOpt::optimize(vertices, indices, settings.mesh);
+	APE_TRACE(
+		"ModelLoader: mesh {} vertices {} -> {}, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+		ai_mesh->mName.C_Str(),
+		report.vertices_before,
+		report.vertices_after,
+		report.before.acmr,
+		report.after.acmr,
+		report.before.atvr,
+		report.after.atvr
+	);
+
+	// Parts that fit 16 bit indices each get their own LOD chain, the
+	// vertices along a cut are borders there and stay put
+	std::vector<Render::Model::ModelMesh> meshes;
+	if (settings.mesh.b_split_index16 && vertices.size() > Render::MAX_INDEX16_VERTICES) {
+		auto parts = Render::MeshOpt::split(vertices, indices, Render::MAX_INDEX16_VERTICES);
+		APE_TRACE("ModelLoader: mesh {} split into {} parts", ai_mesh->mName.C_Str(), parts.size());
+		for (auto& part : parts) {
+			meshes.push_back(buildMesh(part.vertices, part.indices, transform, settings.lod));
+		}
+	}
+	else {
+		meshes.push_back(buildMesh(vertices, indices, transform, settings.lod));
+	}
+	return meshes;
+}
+
+Render::Model::ModelMesh ModelLoader::buildMesh(
+	const std::vector<Render::Model::VertexType>& vertices,
+	const std::vector<Render::Model::IndexType>& indices,
+	const TransformComponent& transform,
+	const Render::Lod::Settings& lod_settings) noexcept
+{
+	Render::Model::ModelMesh mesh(
 		vertices,
 		indices,
 		transform,
-		texture_handle
+		AssetHandle<Render::Image>()
+	);
+	mesh.index_size = Render::indexSizeFor(mesh.vertices.size());
+
+	// Coarser levels share the optimized vertex buffer
+	auto chain = Render::Lod::generate(
+		mesh.vertices,
+		mesh.indices,
+		mesh.bounding_sphere.radius,
+		lod_settings
 	);
+	mesh.lod_indices = std::move(chain.indices);
+	mesh.lods = std::move(chain.lods);
+	return mesh;
 }
 
 };	// end of namespace
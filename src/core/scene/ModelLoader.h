@@ -1,12 +1,20 @@
 #pragma once
 
+#include "core/render/Lod.h"
+#include "core/render/MeshOptimizer.h"
 #include "core/render/Model.h"
+#include "core/render/VertexQuantization.h"
 #include "core/scene/AssetHandle.h"
+#include "util/ThreadPool.h"
 
 #include "assimp/Importer.hpp"
 #include <assimp/material.h>
 #include <assimp/scene.h>
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace APE {
 
 class ModelLoader {
@@ -17,10 +25,87 @@ public:
 	[[nodiscard]] static AssetHandle<Render::Model> 
 	load(AssetKey asset_key) noexcept;
 
+	// Serves defaultModel() until the import finishes on the thread pool
+	[[nodiscard]] static AssetHandle<Render::Model>
+	loadAsync(std::filesystem::path model_path, int priority = 0) noexcept;
+
+	[[nodiscard]] static AssetHandle<Render::Model>
+	loadAsync(AssetKey asset_key, int priority = 0) noexcept;
+
 	[[nodiscard]] static AssetHandle<Render::Model> 
 	defaultModel() noexcept;
 
+	// Settings one import runs under, read once when it starts
+	struct ImportSettings {
+		Render::MeshOpt::Settings mesh;
+		Render::Lod::Settings lod;
+		// Streams are derived on every load and aren't part of the model cache
+		Render::VertexQuant::Settings vertex;
+	};
+
+	// Applies to imports that start afterwards, cached models under other
+	// settings are imported again
+	static void setMeshSettings(const Render::MeshOpt::Settings& settings) noexcept
+	{
+		std::lock_guard lock(s_settings_mutex);
+		s_settings.mesh = settings;
+	}
+
+	[[nodiscard]] static Render::MeshOpt::Settings meshSettings() noexcept
+	{
+		std::lock_guard lock(s_settings_mutex);
+		return s_settings.mesh;
+	}
+
+	static void setLodSettings(const Render::Lod::Settings& settings) noexcept
+	{
+		std::lock_guard lock(s_settings_mutex);
+		s_settings.lod = settings;
+	}
+
+	[[nodiscard]] static Render::Lod::Settings lodSettings() noexcept
+	{
+		std::lock_guard lock(s_settings_mutex);
+		return s_settings.lod;
+	}
+
+	static void setVertexSettings(const Render::VertexQuant::Settings& settings) noexcept
+	{
+		std::lock_guard lock(s_settings_mutex);
+		s_settings.vertex = settings;
+	}
+
+	[[nodiscard]] static Render::VertexQuant::Settings vertexSettings() noexcept
+	{
+		std::lock_guard lock(s_settings_mutex);
+		return s_settings.vertex;
+	}
+
+	[[nodiscard]] static ImportSettings importSettings() noexcept
+	{
+		std::lock_guard lock(s_settings_mutex);
+		return s_settings;
+	}
+
+	// Runs the Assimp import with materials and meshes converted on pool,
+	// load() and loadAsync() go through the AssetManager for dedupe
+	[[nodiscard]] static std::unique_ptr<Render::Model> 
+	importModel(
+		const AssetKey& asset_key,
+		ThreadPool& pool = ThreadPool::global()) noexcept;
+
+	// A `*N` reference into the scene's own textures. Keyed by the
+	// reference, not the material, so materials sharing it decode it once.
+	[[nodiscard]] static AssetHandle<Render::Image>
+	loadEmbeddedTexture(
+		const aiScene* scene,
+		const aiString& ref,
+		const std::filesystem::path& model_path) noexcept;
+
 private:
+	static inline std::mutex s_settings_mutex;
+	static inline ImportSettings s_settings;
+
 	[[nodiscard]] static TransformComponent 
 	convertAiTransform(const aiMatrix4x4 ai_transform) noexcept;
 
@@ -30,17 +115,32 @@ private:
 		const aiScene* scene,
 		std::filesystem::path model_path) noexcept;
 
-	void static processNode(
+	struct MeshTask {
+		const aiMesh* ai_mesh;
+		TransformComponent transform;
+	};
+
+	// Meshes in node order, the first import phase
+	static void collectMeshes(
 		const aiNode* node,
 		const aiScene* scene,
-		Render::Model& model,
-		std::filesystem::path model_path) noexcept;
+		std::vector<MeshTask>& tasks) noexcept;
 
-	[[nodiscard]] static Render::Model::ModelMesh 
+	// One mesh, or several when it's split for 16 bit indices. Textures
+	// are assigned once all tasks are done.
+	[[nodiscard]] static std::vector<Render::Model::ModelMesh> 
 	processAiMesh(
 		const aiMesh* ai_mesh,
-		const AssetHandle<Render::Image>& texture_handle,
-		const TransformComponent& transform) noexcept;
+		const TransformComponent& transform,
+		const ImportSettings& settings) noexcept;
+
+	// Picks the index width and generates LODs
+	[[nodiscard]] static Render::Model::ModelMesh
+	buildMesh(
+		const std::vector<Render::Model::VertexType>& vertices,
+		const std::vector<Render::Model::IndexType>& indices,
+		const TransformComponent& transform,
+		const Render::Lod::Settings& lod_settings) noexcept;
 };
 
 };	// end of namespace
@@ -5,11 +5,15 @@
 #include "core/components/Render.h"
 #include "core/ecs/Registry.h"
 #include "core/render/Model.h"
+#include "core/scene/AssetLoader.h"
+#include "core/scene/SpatialIndex.h"
 #include "physics/PhysicsWorld.h"
 #include "physics/RigidBody.h"
 #include "physics/collisions/Colliders.h"
+#include "physics/collisions/Collisions.h"
 
 #include <format>
+#include <string>
 
 namespace APE {
 
@@ -18,6 +22,7 @@ struct Scene {
 	ECS::EntityHandle root;
 
 	Physics::PhysicsWorld phys_world;
+	SpatialIndex spatial;
 
 	Scene() noexcept
 	{
@@ -58,6 +63,28 @@ struct Scene {
 
 		// Assign new parent to child
 		h_child.parent = parent;
+		markDirty(child);
+	}
+
+	// Call after writing an entity's transform, its subtree's bounds are
+	// refreshed by the next updateSpatialIndex()
+	void markDirty(ECS::EntityHandle ent) noexcept
+	{
+		m_dirty.push_back(ent);
+	}
+
+	// For bulk edits that don't mark what they touch, like loads, the next
+	// updateSpatialIndex() rescans every entity
+	void markAllDirty() noexcept
+	{
+		m_b_all_dirty = true;
+	}
+
+	// Destroys an entity and drops it from the spatial index
+	void destroyEntity(ECS::EntityHandle ent) noexcept
+	{
+		spatial.remove(ent);
+		registry.destroyEntity(ent);
 	}
 
 	glm::mat4 getModelMatrix(ECS::EntityHandle ent) noexcept
@@ -82,17 +109,107 @@ struct Scene {
 		return model_mat;
 	}
 
+	// Refresh cached world bounds and sync them into the spatial index
+	void updateSpatialIndex() noexcept
+	{
+		if (m_b_all_dirty) {
+			rebuildSpatialIndex();
+			return;
+		}
+
+		// Bounds whose assets weren't ready last time
+		if (!m_unbounded.empty()) {
+			auto unbounded = std::move(m_unbounded);
+			m_unbounded.clear();
+			for (auto ent : unbounded) {
+				if (addWorldBounds(ent)) markDirty(ent);
+			}
+		}
+
+		// Walk each dirty subtree once from its parent's world matrix
+		std::vector<std::pair<ECS::EntityHandle, glm::mat4>> stack;
+		for (auto dirty : m_dirty) {
+			if (!registry.hasComponent<HierarchyComponent>(dirty)) continue;
+
+			auto& h = registry.getComponent<HierarchyComponent>(dirty);
+			stack.push_back({ dirty, getModelMatrix(h.parent) });
+			while (!stack.empty()) {
+				auto [ent, par_mat] = stack.back();
+				stack.pop_back();
+
+				// getModelMatrix() stops at the first entity without both
+				glm::mat4 mat(1.f);
+				if (registry.hasComponent<TransformComponent>(ent)) {
+					mat = par_mat * registry.getComponent<TransformComponent>(ent).getModelMatrix();
+					refreshBounds(ent, mat);
+				}
+
+				for (auto child : registry.getComponent<HierarchyComponent>(ent).children) {
+					if (registry.hasComponent<HierarchyComponent>(child)) {
+						stack.push_back({ child, mat });
+					}
+				}
+			}
+		}
+		m_dirty.clear();
+	}
+
+	// Derives bounds from an entity's mesh or rigid body if it has none,
+	// false if it still has none
+	bool addWorldBounds(ECS::EntityHandle ent) noexcept
+	{
+		if (registry.hasComponent<WorldBoundsComponent>(ent)) return true;
+		if (!registry.hasComponent<TransformComponent>(ent)) return false;
+
+		if (registry.hasComponent<Render::MeshComponent>(ent)) {
+			auto& mesh_comp = registry.getComponent<Render::MeshComponent>(ent);
+			auto* model = AssetLoader::resolve<Render::Model>(mesh_comp.model_id);
+			if (!model) {
+				m_unbounded.push_back(ent);
+				return false;
+			}
+
+			auto& mesh = model->meshes[mesh_comp.mesh_index];
+			registry.emplaceComponent<WorldBoundsComponent>(
+				ent,
+				mesh.bounds,
+				mesh.bounding_sphere
+			);
+			return true;
+		}
+
+		if (registry.hasComponent<Physics::RigidBodyComponent>(ent)) {
+			auto* collider = registry.getComponent<Physics::RigidBodyComponent>(ent).collider();
+			if (collider->type != Physics::Collisions::ColliderType::AABB) return false;
+
+			auto& box = *static_cast<Physics::Collisions::AABB*>(collider);
+			glm::vec3 center = box.center();
+			registry.emplaceComponent<WorldBoundsComponent>(ent, WorldBoundsComponent {
+				box,
+				{ center, glm::length(box.extents()) }
+			});
+			return true;
+		}
+		return false;
+	}
+
 	ECS::EntityHandle addModel(AssetHandle<Render::Model> model_handle,
 		const TransformComponent& transform = {}) noexcept
 	{
-		APE_CHECK((model_handle.data != nullptr),
-			"Scene::addModel() Failed: model_handle data is null."
+		APE_CHECK((model_handle.isReady()),
+			"Scene::addModel() Failed: model {} is not loaded.",
+			model_handle.key.to_string()
 		);
 
+		auto& model = model_handle.get();
+
+		// Tags are interned for good, so they're shared by every instance
+		// of a model rather than unique to the entity
 		ECS::EntityHandle par = registry.createEntity();
+		std::string model_name = model->model_path.stem().string();
 		registry.emplaceComponent<HierarchyComponent>(
 			par,
-			std::format("Model {}", par.id)
+			model_name.empty() ? std::string("Model") : std::format("Model {}", model_name)
 		);
 		setParent(par, root);
 
@@ -101,7 +218,13 @@ struct Scene {
 			transform
 		);
 
-		auto& model = model_handle.data;
+		registry.emplaceComponent<WorldBoundsComponent>(
+			par,
+			model->bounds,
+			model->bounding_sphere
+		);
+		markDirty(par);
+
 		for (size_t idx = 0; idx < model->meshes.size(); ++idx) {
 			auto& mesh = model->meshes[idx];
 
@@ -114,17 +237,22 @@ struct Scene {
 
 			registry.emplaceComponent<Render::MeshComponent>(
 				ent,
-				model_handle,
+				model_handle.id,
 				idx
 			);
 			registry.emplaceComponent<Render::MaterialComponent>(
 				ent,
-				mesh.texture_handle
+				mesh.texture_handle.id
 			);
 			registry.emplaceComponent<TransformComponent>(
 				ent,
 				mesh.transform
 			);
+			registry.emplaceComponent<WorldBoundsComponent>(
+				ent,
+				mesh.bounds,
+				mesh.bounding_sphere
+			);
 		}
 		return par;
 	}
@@ -134,8 +262,9 @@ struct Scene {
 		AssetHandle<Render::Model> model_handle) noexcept
 	{
 		APE_CHECK(
-			(model_handle.data != nullptr),
-			"Scene::addRigidBody() Failed: model_handle data is null."
+			(model_handle.isReady()),
+			"Scene::addRigidBody() Failed: model {} is not loaded.",
+			model_handle.key.to_string()
 		);
 
 		APE_CHECK(
@@ -143,33 +272,81 @@ struct Scene {
 			"Scene::addRigidBody() Failed: entity {} does not have Transform Component."
 		);
 
-		auto& model = *model_handle.data;
-		std::vector<Physics::Collisions::Triangle> tris;
-		for (auto& mesh : model.meshes) {
-			for (auto [v0, v1, v2] : mesh.triangles()) {
-				tris.emplace_back(v0, v1, v2);
-			}
-		}
-		APE_TRACE("Model {} has {} polygons.", model.model_path.c_str(), tris.size());
-
-		glm::vec3 min_bounds(std::numeric_limits<float>::max());
-		glm::vec3 max_bounds(-std::numeric_limits<float>::max());
-		for (auto& tri : tris) {
-			min_bounds = glm::min(min_bounds, tri.v0, tri.v1, tri.v2);
-			max_bounds = glm::max(max_bounds, tri.v0, tri.v1, tri.v2);
-		}
+		// Cooked once per model, every body made from it shares the result
+		auto& cooked = model_handle.get()->collision();
+		auto& bounds = cooked.bounds;
 
 		auto& transform = registry.getComponent<TransformComponent>(ent);
-		auto rbd = phys_world.createRigidBody(Physics::RigidBody(transform.position));
+		Physics::RigidBody body(transform.position);
+		if (cooked.mass.volume > 0.f) {
+			body.inertia_per_mass = cooked.mass.inertia * (1.f / cooked.mass.volume);
+		}
+		auto rbd = phys_world.createRigidBody(body);
 
-		auto collider = std::make_shared<Physics::Collisions::AABB>(min_bounds, max_bounds);
+		// Colliders are moved with their body each step, so they aren't shared
+		auto collider = std::make_shared<Physics::Collisions::AABB>(bounds.min, bounds.max);
 		phys_world.addCollider(rbd, collider);
 
-		return registry.emplaceComponent<Physics::RigidBodyComponent>(
+		auto& rbd_comp = registry.emplaceComponent<Physics::RigidBodyComponent>(
 			ent,
 			&phys_world,
 			rbd
 		);
+		if (addWorldBounds(ent)) markDirty(ent);
+		return rbd_comp;
+	}
+
+private:
+	// Roots of subtrees whose transforms changed since the last update
+	std::vector<ECS::EntityHandle> m_dirty;
+	std::vector<ECS::EntityHandle> m_unbounded;
+	bool m_b_all_dirty = true;
+
+	void refreshBounds(ECS::EntityHandle ent, const glm::mat4& mat) noexcept
+	{
+		if (!registry.hasComponent<WorldBoundsComponent>(ent)) return;
+
+		auto& bounds = registry.getComponent<WorldBoundsComponent>(ent);
+		bool b_moved = bounds.refresh(mat);
+		if (b_moved || !spatial.contains(ent)) {
+			spatial.update(ent, bounds.world);
+		}
+	}
+
+	void rebuildSpatialIndex() noexcept
+	{
+		m_b_all_dirty = false;
+		m_dirty.clear();
+		m_unbounded.clear();
+
+		// Entities loaded from disk don't carry bounds, derive them from their assets
+		std::vector<ECS::EntityHandle> unbounded;
+		auto mesh_view = registry.view<Render::MeshComponent, TransformComponent>();
+		for (auto [ent, mesh_comp, transform] : mesh_view.each()) {
+			if (!registry.hasComponent<WorldBoundsComponent>(ent)) unbounded.push_back(ent);
+		}
+		auto rbd_view = registry.view<Physics::RigidBodyComponent, TransformComponent>();
+		for (auto [ent, rbd, transform] : rbd_view.each()) {
+			if (registry.hasComponent<Render::MeshComponent>(ent)) continue;
+			if (!registry.hasComponent<WorldBoundsComponent>(ent)) unbounded.push_back(ent);
+		}
+		for (auto ent : unbounded) {
+			(void)addWorldBounds(ent);
+		}
+
+		// Drop entities that were destroyed or lost their bounds
+		for (auto ent : spatial.entities()) {
+			if (!registry.hasAllComponents<
+				TransformComponent, WorldBoundsComponent>(ent))
+			{
+				spatial.remove(ent);
+			}
+		}
+
+		auto view = registry.view<TransformComponent, WorldBoundsComponent>();
+		for (auto [ent, transform, bounds] : view.each()) {
+			refreshBounds(ent, getModelMatrix(ent));
+		}
 	}
 };
 
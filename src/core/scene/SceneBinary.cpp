@@ -0,0 +1,708 @@
+#include "core/scene/SceneBinary.h"
+#include "core/scene/AssetBatch.h"
+#include "core/scene/AssetLoader.h"
+#include "core/scene/AssetManager.h"
+#include "util/ByteStream.h"
+#include "util/Hash.h"
+#include "util/Logger.h"
+#include "util/MappedFile.h"
+#include "util/ThreadPool.h"
+
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace APE {
+
+namespace {
+
+// Raw pools are copied byte for byte, catch layout changes at compile time
+static_assert(std::is_trivially_copyable_v<TransformComponent>);
+static_assert(std::is_trivially_copyable_v<Render::LightComponent>);
+static_assert(sizeof(TransformComponent) == 40,
+	"TransformComponent layout changed, bump SceneBinary::VERSION");
+static_assert(sizeof(Render::LightComponent) == 36,
+	"LightComponent layout changed, bump SceneBinary::VERSION");
+
+constexpr uint64_t STRINGS_TAG = Hash::fnv1a("Strings");
+constexpr uint64_t ASSETS_TAG = Hash::fnv1a("Assets");
+constexpr uint64_t TRANSFORM_TAG = Hash::fnv1a(TransformComponent::Name);
+constexpr uint64_t HIERARCHY_TAG = Hash::fnv1a(HierarchyComponent::Name);
+constexpr uint64_t MESH_TAG = Hash::fnv1a(Render::MeshComponent::Name);
+constexpr uint64_t MATERIAL_TAG = Hash::fnv1a(Render::MaterialComponent::Name);
+constexpr uint64_t LIGHT_TAG = Hash::fnv1a(Render::LightComponent::Name);
+
+constexpr size_t NUM_POOL_SECTIONS = 5;
+
+struct AssetRecord {
+	uint32_t path;
+	uint32_t sub_index;
+	uint32_t asset_class;
+};
+
+
+/*
+* Writing
+*/
+class SceneWriter {
+private:
+	const ECS::Registry& m_registry;
+	ECS::EntityHandle m_root;
+	ByteWriter m_out;
+	std::vector<SceneBinary::SectionHeader> m_sections;
+
+	std::unordered_map<ECS::EntityID, uint32_t> m_ent_index;
+	StringTableBuilder m_strings;
+	std::vector<AssetRecord> m_assets;
+	std::unordered_map<uint32_t, uint32_t> m_asset_lookup;
+
+public:
+	SceneWriter(const ECS::Registry& registry, ECS::EntityHandle root) noexcept
+		: m_registry(registry)
+		, m_root(root)
+	{
+
+	}
+
+	std::vector<std::byte> write() noexcept
+	{
+		auto ents = m_registry.entities();
+		m_ent_index.reserve(ents.size());
+		for (uint32_t i = 0; i < ents.size(); ++i) {
+			m_ent_index[ents[i].id] = i;
+		}
+
+		// Header and section table are patched once offsets are known
+		m_out.write(SceneBinary::FileHeader {});
+		size_t table_offset = m_out.pos();
+		constexpr size_t MAX_SECTIONS = NUM_POOL_SECTIONS + 2;
+		for (size_t i = 0; i < MAX_SECTIONS; ++i) {
+			m_out.write(SceneBinary::SectionHeader {});
+		}
+
+		// Pools first so the string and asset tables are complete after
+		writeRawPool<TransformComponent>(TRANSFORM_TAG);
+		writeRawPool<Render::LightComponent>(LIGHT_TAG);
+		writeHierarchy();
+		writeMeshes();
+		writeMaterials();
+		writeAssets();
+		writeStrings();
+
+		for (size_t i = 0; i < m_sections.size(); ++i) {
+			m_out.patch(table_offset + i * sizeof(SceneBinary::SectionHeader), m_sections[i]);
+		}
+
+		SceneBinary::FileHeader header {
+			.magic = SceneBinary::MAGIC,
+			.version = SceneBinary::VERSION,
+			.num_entities = static_cast<uint32_t>(ents.size()),
+			.root = index(m_root),
+			.num_sections = static_cast<uint32_t>(m_sections.size()),
+			.reserved = 0,
+			.file_size = m_out.pos(),
+		};
+		m_out.patch(0, header);
+
+		return m_out.buffer();
+	}
+
+private:
+	[[nodiscard]] uint32_t index(ECS::EntityHandle ent) const noexcept
+	{
+		auto it = m_ent_index.find(ent.id);
+		return (it != m_ent_index.end()) ? it->second : SceneBinary::NULL_INDEX;
+	}
+
+	// Keys are looked up once per asset, repeat references hit the ID
+	[[nodiscard]] uint32_t assetIndex(AssetId id) noexcept
+	{
+		auto it = m_asset_lookup.find(id.value);
+		if (it != m_asset_lookup.end()) {
+			return it->second;
+		}
+
+		AssetKey key = AssetManager::keyOf(id);
+		uint32_t idx = static_cast<uint32_t>(m_assets.size());
+		m_assets.push_back({
+			m_strings.own(key.path.string()),
+			m_strings.own(key.sub_index),
+			static_cast<uint32_t>(AssetManager::classOf(id)),
+		});
+		m_asset_lookup.emplace(id.value, idx);
+		return idx;
+	}
+
+	void beginSection(uint64_t tag, size_t count) noexcept
+	{
+		m_out.align(SceneBinary::SECTION_ALIGN);
+		m_sections.push_back({
+			.tag = tag,
+			.offset = m_out.pos(),
+			.size = 0,
+			.count = static_cast<uint32_t>(count),
+			.reserved = 0,
+		});
+	}
+
+	void endSection() noexcept
+	{
+		auto& section = m_sections.back();
+		section.size = m_out.pos() - section.offset;
+	}
+
+	template <typename Component>
+	void collect(
+		std::vector<uint32_t>& ents,
+		std::vector<const Component*>& comps) noexcept
+	{
+		if (!m_registry.hasComponent<Component>()) return;
+
+		for (auto [id, comp] : m_registry.getPool<Component>()) {
+			ents.push_back(index({ id }));
+			comps.push_back(&comp);
+		}
+	}
+
+	// Entity indices, then the components exactly as they sit in memory
+	template <typename Component>
+	void writeRawPool(uint64_t tag) noexcept
+	{
+		std::vector<uint32_t> ents;
+		std::vector<const Component*> comps;
+		collect<Component>(ents, comps);
+
+		beginSection(tag, ents.size());
+		m_out.writeArray(ents);
+		m_out.align(SceneBinary::SECTION_ALIGN);
+		for (auto* comp : comps) {
+			m_out.write(*comp);
+		}
+		endSection();
+	}
+
+	void writeHierarchy() noexcept
+	{
+		std::vector<uint32_t> ents;
+		std::vector<const HierarchyComponent*> comps;
+		collect<HierarchyComponent>(ents, comps);
+
+		std::vector<uint32_t> parents;
+		std::vector<uint32_t> tags;
+		std::vector<uint32_t> child_starts { 0 };
+		std::vector<uint32_t> children;
+		for (auto* h : comps) {
+			parents.push_back(index(h->parent));
+
+			// Interned tags stay alive for the life of the process
+			tags.push_back(m_strings.add(h->tag.view()));
+
+			for (auto child : h->children) {
+				children.push_back(index(child));
+			}
+			child_starts.push_back(static_cast<uint32_t>(children.size()));
+		}
+
+		beginSection(HIERARCHY_TAG, ents.size());
+		m_out.writeArray(ents);
+		m_out.writeArray(parents);
+		m_out.writeArray(tags);
+		m_out.writeArray(child_starts);
+		m_out.writeArray(children);
+		endSection();
+	}
+
+	void writeMeshes() noexcept
+	{
+		std::vector<uint32_t> ents;
+		std::vector<const Render::MeshComponent*> comps;
+		collect<Render::MeshComponent>(ents, comps);
+
+		std::vector<uint32_t> assets;
+		std::vector<uint32_t> mesh_indices;
+		for (auto* mesh : comps) {
+			assets.push_back(assetIndex(mesh->model_id));
+			mesh_indices.push_back(static_cast<uint32_t>(mesh->mesh_index));
+		}
+
+		beginSection(MESH_TAG, ents.size());
+		m_out.writeArray(ents);
+		m_out.writeArray(assets);
+		m_out.writeArray(mesh_indices);
+		endSection();
+	}
+
+	void writeMaterials() noexcept
+	{
+		std::vector<uint32_t> ents;
+		std::vector<const Render::MaterialComponent*> comps;
+		collect<Render::MaterialComponent>(ents, comps);
+
+		std::vector<uint32_t> assets;
+		for (auto* mat : comps) {
+			assets.push_back(assetIndex(mat->texture_id));
+		}
+
+		beginSection(MATERIAL_TAG, ents.size());
+		m_out.writeArray(ents);
+		m_out.writeArray(assets);
+		endSection();
+	}
+
+	void writeAssets() noexcept
+	{
+		beginSection(ASSETS_TAG, m_assets.size());
+		m_out.writeArray(m_assets);
+		endSection();
+	}
+
+	void writeStrings() noexcept
+	{
+		auto& strings = m_strings.strings();
+
+		std::vector<uint32_t> offsets { 0 };
+		for (auto str : strings) {
+			offsets.push_back(offsets.back() + static_cast<uint32_t>(str.size()));
+		}
+
+		beginSection(STRINGS_TAG, strings.size());
+		m_out.writeArray(offsets);
+		for (auto str : strings) {
+			m_out.writeBytes(str.data(), str.size());
+		}
+		endSection();
+	}
+};
+
+
+/*
+* Reading
+*/
+class SceneReader {
+private:
+	const MappedFile& m_file;
+	Scene& m_world;
+	SceneLoadProgress* m_progress;
+
+	SceneBinary::FileHeader m_header;
+	std::unordered_map<uint64_t, SceneBinary::SectionHeader> m_sections;
+	ECS::EntityID m_first_id;
+
+	std::vector<std::string_view> m_strings;
+	std::vector<AssetHandle<Render::Model>> m_models;
+	std::vector<AssetHandle<Render::Image>> m_images;
+
+public:
+	SceneReader(
+		const MappedFile& file,
+		Scene& world,
+		SceneLoadProgress* progress) noexcept
+		: m_file(file)
+		, m_world(world)
+		, m_progress(progress)
+		, m_header()
+		, m_first_id(0)
+	{
+
+	}
+
+	bool read() noexcept
+	{
+		if (!readHeader()) return false;
+
+		if (!readStrings()) return fail("string table");
+		if (!readAssets()) return fail("asset table");
+
+		// Old root from the Scene constructor is replaced by the file's
+		ECS::EntityHandle old_root = m_world.root;
+		m_first_id = m_world.registry.createEntities(m_header.num_entities);
+
+		setStage(SceneLoadProgress::Stage::Components);
+		if (!readRawPool<TransformComponent>(TRANSFORM_TAG)) return fail("transforms");
+		if (!readRawPool<Render::LightComponent>(LIGHT_TAG)) return fail("lights");
+		if (!readHierarchy()) return fail("hierarchy");
+		if (!readMeshes()) return fail("meshes");
+		if (!readMaterials()) return fail("materials");
+
+		m_world.root = handle(m_header.root);
+		if (m_world.root != old_root) {
+			m_world.registry.destroyEntity(old_root);
+		}
+		m_world.markAllDirty();
+		return true;
+	}
+
+private:
+	bool fail(const char* what) noexcept
+	{
+		APE_ERROR("SceneBinary::load() Failed: corrupt {} section.", what);
+		return false;
+	}
+
+	void setStage(SceneLoadProgress::Stage stage) noexcept
+	{
+		if (m_progress) m_progress->stage = stage;
+	}
+
+	void poolDone() noexcept
+	{
+		if (m_progress) ++m_progress->pools_done;
+	}
+
+	[[nodiscard]] ECS::EntityHandle handle(uint32_t idx) const noexcept
+	{
+		if (idx == SceneBinary::NULL_INDEX) {
+			return m_world.registry.tombstone();
+		}
+		return { m_first_id + idx };
+	}
+
+	[[nodiscard]] bool validIndex(uint32_t idx) const noexcept
+	{
+		return idx == SceneBinary::NULL_INDEX || idx < m_header.num_entities;
+	}
+
+	bool readHeader() noexcept
+	{
+		if (m_file.size() < sizeof(SceneBinary::FileHeader)) {
+			APE_ERROR("SceneBinary::load() Failed: file too small.");
+			return false;
+		}
+		std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+
+		if (m_header.magic != SceneBinary::MAGIC) {
+			APE_ERROR("SceneBinary::load() Failed: not a binary scene.");
+			return false;
+		}
+		if (m_header.version != SceneBinary::VERSION) {
+			APE_ERROR("SceneBinary::load() Failed: version {} unsupported, expected {}.",
+				m_header.version,
+				SceneBinary::VERSION
+			);
+			return false;
+		}
+		if (m_header.file_size != m_file.size()) {
+			APE_ERROR("SceneBinary::load() Failed: truncated file.");
+			return false;
+		}
+		if (m_header.root >= m_header.num_entities) {
+			APE_ERROR("SceneBinary::load() Failed: invalid root entity.");
+			return false;
+		}
+
+		size_t table_end = sizeof(SceneBinary::FileHeader) +
+			m_header.num_sections * sizeof(SceneBinary::SectionHeader);
+		if (table_end > m_file.size()) {
+			APE_ERROR("SceneBinary::load() Failed: truncated section table.");
+			return false;
+		}
+
+		const std::byte* table = m_file.data() + sizeof(SceneBinary::FileHeader);
+		for (uint32_t i = 0; i < m_header.num_sections; ++i) {
+			SceneBinary::SectionHeader section;
+			std::memcpy(&section, table + i * sizeof(section), sizeof(section));
+
+			if (section.offset > m_file.size() ||
+				section.size > m_file.size() - section.offset)
+			{
+				APE_ERROR("SceneBinary::load() Failed: section out of bounds.");
+				return false;
+			}
+
+			// Unknown tags are skipped so newer files can add sections
+			m_sections[section.tag] = section;
+		}
+
+		if (m_progress) {
+			m_progress->pools_total = NUM_POOL_SECTIONS;
+		}
+		return true;
+	}
+
+	[[nodiscard]] const SceneBinary::SectionHeader* section(uint64_t tag) const noexcept
+	{
+		auto it = m_sections.find(tag);
+		return (it != m_sections.end()) ? &it->second : nullptr;
+	}
+
+	[[nodiscard]] ByteReader reader(const SceneBinary::SectionHeader& s) const noexcept
+	{
+		return ByteReader(m_file.data() + s.offset, s.size);
+	}
+
+	bool readStrings() noexcept
+	{
+		auto* s = section(STRINGS_TAG);
+		if (!s) return true;
+
+		ByteReader in = reader(*s);
+		auto* offsets = in.array<uint32_t>(s->count + 1);
+		if (!offsets) return false;
+
+		auto* chars = in.array<char>(offsets[s->count]);
+		if (!chars) return false;
+
+		m_strings.reserve(s->count);
+		for (uint32_t i = 0; i < s->count; ++i) {
+			if (offsets[i] > offsets[i + 1]) return false;
+			m_strings.emplace_back(chars + offsets[i], offsets[i + 1] - offsets[i]);
+		}
+		return true;
+	}
+
+	[[nodiscard]] std::string_view string(uint32_t idx) const noexcept
+	{
+		return (idx < m_strings.size()) ? m_strings[idx] : std::string_view();
+	}
+
+	bool readAssets() noexcept
+	{
+		auto* s = section(ASSETS_TAG);
+		if (!s) return true;
+
+		ByteReader in = reader(*s);
+		auto* records = in.array<AssetRecord>(s->count);
+		if (!records) return false;
+
+		// Table entries are already unique, import them all in parallel
+		AssetBatch batch;
+		for (uint32_t i = 0; i < s->count; ++i) {
+			batch.request(key(records[i]), static_cast<AssetClass>(records[i].asset_class));
+		}
+		if (m_progress) {
+			m_progress->assets_total = batch.size();
+		}
+		batch.resolve(ThreadPool::global(), m_progress);
+
+		m_models.resize(s->count);
+		m_images.resize(s->count);
+		for (uint32_t i = 0; i < s->count; ++i) {
+			switch (static_cast<AssetClass>(records[i].asset_class)) {
+			case AssetClass::Model:
+				m_models[i] = AssetLoader::load<Render::Model>(
+					key(records[i]),
+					AssetClass::Model
+				);
+				break;
+			case AssetClass::Texture:
+				m_images[i] = AssetLoader::load<Render::Image>(
+					key(records[i]),
+					AssetClass::Texture
+				);
+				break;
+			default:
+				break;
+			}
+		}
+		return true;
+	}
+
+	[[nodiscard]] AssetKey key(const AssetRecord& record) const noexcept
+	{
+		return AssetKey(
+			std::string(string(record.path)),
+			std::string(string(record.sub_index))
+		);
+	}
+
+	// Entity ids for a section, bounds checked against the entity count
+	bool readEntities(
+		ByteReader& in,
+		uint32_t count,
+		std::vector<ECS::EntityID>& ids) const noexcept
+	{
+		auto* ents = in.array<uint32_t>(count);
+		if (!ents) return false;
+
+		ids.resize(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			if (ents[i] >= m_header.num_entities) return false;
+			ids[i] = m_first_id + ents[i];
+		}
+		return true;
+	}
+
+	template <typename Component>
+	bool readRawPool(uint64_t tag) noexcept
+	{
+		auto* s = section(tag);
+		if (!s) {
+			poolDone();
+			return true;
+		}
+
+		ByteReader in = reader(*s);
+		std::vector<ECS::EntityID> ids;
+		if (!readEntities(in, s->count, ids)) return false;
+
+		in.align(SceneBinary::SECTION_ALIGN);
+		auto* comps = in.array<Component>(s->count);
+		if (!comps) return false;
+
+		m_world.registry.emplaceComponents<Component>(ids.data(), comps, s->count);
+		poolDone();
+		return true;
+	}
+
+	bool readHierarchy() noexcept
+	{
+		auto* s = section(HIERARCHY_TAG);
+		if (!s) {
+			poolDone();
+			return true;
+		}
+
+		ByteReader in = reader(*s);
+		std::vector<ECS::EntityID> ids;
+		if (!readEntities(in, s->count, ids)) return false;
+
+		auto* parents = in.array<uint32_t>(s->count);
+		auto* tags = in.array<uint32_t>(s->count);
+		auto* child_starts = in.array<uint32_t>(s->count + 1);
+		if (!parents || !tags || !child_starts) return false;
+
+		auto* children = in.array<uint32_t>(child_starts[s->count]);
+		if (!children) return false;
+
+		std::vector<HierarchyComponent> comps;
+		comps.reserve(s->count);
+		for (uint32_t i = 0; i < s->count; ++i) {
+			if (!validIndex(parents[i])) return false;
+			if (child_starts[i] > child_starts[i + 1]) return false;
+
+			auto& h = comps.emplace_back(StringId(string(tags[i])));
+			h.parent = handle(parents[i]);
+
+			h.children.reserve(child_starts[i + 1] - child_starts[i]);
+			for (uint32_t c = child_starts[i]; c < child_starts[i + 1]; ++c) {
+				if (!validIndex(children[c])) return false;
+				h.children.push_back(handle(children[c]));
+			}
+		}
+
+		m_world.registry.emplaceComponents<HierarchyComponent>(
+			ids.data(), comps.data(), comps.size()
+		);
+		poolDone();
+		return true;
+	}
+
+	bool readMeshes() noexcept
+	{
+		auto* s = section(MESH_TAG);
+		if (!s) {
+			poolDone();
+			return true;
+		}
+
+		ByteReader in = reader(*s);
+		std::vector<ECS::EntityID> ids;
+		if (!readEntities(in, s->count, ids)) return false;
+
+		auto* assets = in.array<uint32_t>(s->count);
+		auto* mesh_indices = in.array<uint32_t>(s->count);
+		if (!assets || !mesh_indices) return false;
+
+		std::vector<Render::MeshComponent> comps;
+		comps.reserve(s->count);
+		for (uint32_t i = 0; i < s->count; ++i) {
+			if (assets[i] >= m_models.size()) return false;
+			comps.emplace_back(m_models[assets[i]].id, mesh_indices[i]);
+		}
+
+		m_world.registry.emplaceComponents<Render::MeshComponent>(
+			ids.data(), comps.data(), comps.size()
+		);
+		poolDone();
+		return true;
+	}
+
+	bool readMaterials() noexcept
+	{
+		auto* s = section(MATERIAL_TAG);
+		if (!s) {
+			poolDone();
+			return true;
+		}
+
+		ByteReader in = reader(*s);
+		std::vector<ECS::EntityID> ids;
+		if (!readEntities(in, s->count, ids)) return false;
+
+		auto* assets = in.array<uint32_t>(s->count);
+		if (!assets) return false;
+
+		std::vector<Render::MaterialComponent> comps;
+		comps.reserve(s->count);
+		for (uint32_t i = 0; i < s->count; ++i) {
+			if (assets[i] >= m_images.size()) return false;
+			comps.emplace_back(m_images[assets[i]].id);
+		}
+
+		m_world.registry.emplaceComponents<Render::MaterialComponent>(
+			ids.data(), comps.data(), comps.size()
+		);
+		poolDone();
+		return true;
+	}
+};
+
+};	// end of namespace
+
+
+bool SceneBinary::save(
+	const std::filesystem::path& save_path,
+	Scene& world) noexcept
+{
+	return save(save_path, world.registry, world.root);
+}
+
+bool SceneBinary::save(
+	const std::filesystem::path& save_path,
+	const ECS::Registry& registry,
+	ECS::EntityHandle root) noexcept
+{
+	std::vector<std::byte> bytes = SceneWriter(registry, root).write();
+
+	std::ofstream os(save_path, std::ios::binary | std::ios::trunc);
+	if (!os) {
+		APE_ERROR("SceneBinary::save() Failed to open {}.", save_path.string());
+		return false;
+	}
+
+	os.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	if (!os) {
+		APE_ERROR("SceneBinary::save() Failed to write {}.", save_path.string());
+		return false;
+	}
+
+	APE_TRACE("Saved {} byte binary scene to {}.", bytes.size(), save_path.string());
+	return true;
+}
+
+bool SceneBinary::load(
+	const std::filesystem::path& load_path,
+	Scene& world,
+	SceneLoadProgress* progress) noexcept
+{
+	if (progress) {
+		progress->stage = SceneLoadProgress::Stage::Parsing;
+	}
+
+	MappedFile file(load_path);
+	if (!file.isOpen() || !SceneReader(file, world, progress).read()) {
+		if (progress) {
+			progress->stage = SceneLoadProgress::Stage::Failed;
+		}
+		return false;
+	}
+
+	APE_TRACE("New scene entity count: {}", world.registry.numEntities());
+	return true;
+}
+
+};	// end of namespace
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "core/scene/Scene.h"
+#include "core/scene/SceneLoadProgress.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace APE {
+
+/*
+* Versioned binary scene format
+* A file header and section table are followed by one 16 byte aligned blob
+* per section. Entities are stored by compact index, so loading can
+* allocate a contiguous id block and bulk copy trivially copyable pools
+* straight out of the memory mapped file. JSON remains the
+* interchange/debug format.
+*/
+struct SceneBinary {
+	static constexpr std::string_view EXTENSION = ".apescene";
+
+	// "APES" when read as little endian bytes
+	static constexpr uint32_t MAGIC = 0x53455041;
+
+	// Bump whenever a section layout or a raw component struct changes
+	static constexpr uint32_t VERSION = 1;
+
+	static constexpr uint32_t NULL_INDEX = 0xFFFFFFFF;
+	static constexpr size_t SECTION_ALIGN = 16;
+
+	struct FileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t num_entities;
+		uint32_t root;
+		uint32_t num_sections;
+		uint32_t reserved;
+		uint64_t file_size;
+	};
+
+	struct SectionHeader {
+		uint64_t tag;
+		uint64_t offset;
+		uint64_t size;
+		uint32_t count;
+		uint32_t reserved;
+	};
+
+	[[nodiscard]] static bool isBinaryScene(
+		const std::filesystem::path& path) noexcept
+	{
+		return path.extension() == EXTENSION;
+	}
+
+	static bool save(
+		const std::filesystem::path& save_path,
+		Scene& world) noexcept;
+
+	// Writes a registry that isn't owned by a Scene, such as a snapshot
+	static bool save(
+		const std::filesystem::path& save_path,
+		const ECS::Registry& registry,
+		ECS::EntityHandle root) noexcept;
+
+	static bool load(
+		const std::filesystem::path& load_path,
+		Scene& world,
+		SceneLoadProgress* progress = nullptr) noexcept;
+};
+
+};	// end of namespace
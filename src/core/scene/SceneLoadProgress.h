@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace APE {
+
+/*
+* Progress of a scene load, safe to poll from another thread
+*/
+struct SceneLoadProgress {
+	enum class Stage {
+		Idle = 0,
+		Parsing,
+		Components,
+		Assets,
+		Finalizing,
+		Done,
+		Failed,
+	};
+
+	std::atomic<Stage> stage = Stage::Idle;
+	std::atomic<size_t> pools_done = 0;
+	std::atomic<size_t> pools_total = 0;
+	std::atomic<size_t> assets_loaded = 0;
+	std::atomic<size_t> assets_total = 0;
+
+	void reset() noexcept
+	{
+		stage = Stage::Idle;
+		pools_done = 0;
+		pools_total = 0;
+		assets_loaded = 0;
+		assets_total = 0;
+	}
+
+	[[nodiscard]] float fraction() const noexcept
+	{
+		switch (stage.load()) {
+		case Stage::Idle:
+		case Stage::Parsing:
+			return 0.f;
+		case Stage::Components:
+		{
+			size_t total = pools_total.load();
+			if (total == 0) return 0.f;
+			return 0.5f * static_cast<float>(pools_done.load()) / total;
+		}
+		case Stage::Assets:
+		{
+			size_t total = assets_total.load();
+			if (total == 0) return 0.5f;
+			return 0.5f + 0.4f * static_cast<float>(assets_loaded.load()) / total;
+		}
+		case Stage::Finalizing:
+			return 0.9f;
+		default:
+			return 1.f;
+		}
+	}
+};
+
+};	// end of namespace
@@ -0,0 +1,195 @@
+#include "core/scene/SceneSaver.h"
+#include "core/scene/SceneBinary.h"
+#include "core/scene/SceneSnapshot.h"
+#include "core/scene/Serialize.h"
+#include "util/Logger.h"
+
+#include <memory>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace APE {
+
+namespace {
+
+// Flushes a file's data to the disk, not just to the OS
+[[nodiscard]] bool syncFile(const std::filesystem::path& path) noexcept
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileW(
+		path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+	);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	bool b_synced = FlushFileBuffers(file);
+	CloseHandle(file);
+	return b_synced;
+#else
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+	bool b_synced = fsync(fd) == 0;
+	::close(fd);
+	return b_synced;
+#endif
+}
+
+// Makes a rename in dir durable, Windows commits renames with the file
+void syncDirectory(const std::filesystem::path& dir) noexcept
+{
+#ifndef _WIN32
+	int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd < 0) return;
+	(void)fsync(fd);
+	::close(fd);
+#else
+	(void)dir;
+#endif
+}
+
+};	// end of namespace
+
+SceneSaver::SceneSaver(ThreadPool& pool) noexcept
+	: m_pool(pool)
+	, m_autosave_interval(0.0)
+	, m_last_autosave(Clock::now())
+{
+
+}
+
+SceneSaver::~SceneSaver() noexcept
+{
+	wait();
+}
+
+void SceneSaver::requestSave(std::filesystem::path save_path) noexcept
+{
+	m_requested = std::move(save_path);
+}
+
+void SceneSaver::setAutosave(
+	std::filesystem::path save_path,
+	Timing::seconds interval) noexcept
+{
+	m_autosave_path = std::move(save_path);
+	m_autosave_interval = interval;
+	m_last_autosave = Clock::now();
+}
+
+void SceneSaver::update(const Scene& world) noexcept
+{
+	reap();
+
+	bool b_autosave_due =
+		m_autosave_interval > Timing::seconds::zero() &&
+		Clock::now() - m_last_autosave >= m_autosave_interval;
+
+	// Only one save writes at a time, later requests wait a frame
+	if (isSaving()) return;
+
+	if (m_requested) {
+		beginSave(world, std::move(*m_requested));
+		m_requested.reset();
+	}
+	else if (b_autosave_due) {
+		beginSave(world, m_autosave_path);
+		m_last_autosave = Clock::now();
+	}
+}
+
+void SceneSaver::wait() noexcept
+{
+	if (m_pending.valid()) {
+		m_pending.wait();
+	}
+	reap();
+}
+
+bool SceneSaver::isSaving() const noexcept
+{
+	return m_pending.valid();
+}
+
+const SceneSaveMetrics& SceneSaver::metrics() const noexcept
+{
+	return m_metrics;
+}
+
+void SceneSaver::reap() noexcept
+{
+	if (!m_pending.valid()) return;
+
+	if (m_pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		(void)m_pending.get();
+	}
+}
+
+void SceneSaver::beginSave(
+	const Scene& world,
+	std::filesystem::path save_path) noexcept
+{
+	Timing::millis snapshot_time;
+	std::shared_ptr<SceneSnapshot> snapshot = Timing::timeFunctionCall([&]() {
+		return SceneSnapshot::capture(world);
+	}, snapshot_time);
+	m_metrics.last_snapshot_ms = snapshot_time.count();
+
+	m_pending = m_pool.submit([this, snapshot, save_path]() {
+		Timing::millis write_time;
+		std::filesystem::path tmp_path = save_path;
+		tmp_path += ".tmp";
+
+		bool b_saved = Timing::timeFunctionCall([&]() {
+			if (SceneBinary::isBinaryScene(save_path)) {
+				return SceneBinary::save(tmp_path, snapshot->registry, snapshot->root);
+			}
+			return Serialize::saveSnapshot(tmp_path, *snapshot);
+		}, write_time);
+
+		// Rename within a directory replaces the old file atomically. The
+		// data is synced first, or after a power loss the rename could
+		// land on disk before it.
+		std::error_code ec;
+		size_t num_bytes = 0;
+		if (b_saved) {
+			num_bytes = std::filesystem::file_size(tmp_path, ec);
+			b_saved = syncFile(tmp_path);
+		}
+		if (b_saved) {
+			std::filesystem::rename(tmp_path, save_path, ec);
+			b_saved = !ec;
+		}
+		if (b_saved) {
+			syncDirectory(save_path.parent_path());
+		}
+
+		if (!b_saved) {
+			APE_ERROR("SceneSaver::beginSave() Failed to save {}.", save_path.string());
+			std::filesystem::remove(tmp_path, ec);
+			++m_metrics.saves_failed;
+			return false;
+		}
+
+		m_metrics.last_write_ms = write_time.count();
+		m_metrics.last_bytes_written = num_bytes;
+		m_metrics.total_bytes_written += num_bytes;
+		++m_metrics.saves_completed;
+
+		APE_TRACE("Saved {} bytes to {} in {:.2f}ms.",
+			num_bytes,
+			save_path.string(),
+			write_time.count()
+		);
+		return true;
+	});
+}
+
+};	// end of namespace
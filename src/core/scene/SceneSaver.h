@@ -0,0 +1,84 @@
+#pragma once
+
+#include "core/scene/Scene.h"
+#include "util/ThreadPool.h"
+#include "util/Timing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <future>
+#include <optional>
+
+namespace APE {
+
+// Written by the save worker, safe to poll from the main thread
+struct SceneSaveMetrics {
+	std::atomic<size_t> saves_completed = 0;
+	std::atomic<size_t> saves_failed = 0;
+
+	// Main thread stall to copy the world
+	std::atomic<double> last_snapshot_ms = 0.0;
+
+	// Worker time to serialize and write the file
+	std::atomic<double> last_write_ms = 0.0;
+
+	std::atomic<size_t> last_bytes_written = 0;
+	std::atomic<size_t> total_bytes_written = 0;
+};
+
+/*
+* Saves scenes without stalling the frame
+* Requests are captured as a snapshot at the next frame boundary, then
+* serialized on a worker into a temporary file that is renamed over the
+* target once complete and synced to disk, so neither a crash nor a power
+* loss mid-save leaves a partial scene.
+*/
+class SceneSaver {
+private:
+	using Clock = std::chrono::steady_clock;
+
+	ThreadPool& m_pool;
+	std::future<bool> m_pending;
+	std::optional<std::filesystem::path> m_requested;
+
+	std::filesystem::path m_autosave_path;
+	Timing::seconds m_autosave_interval;
+	Clock::time_point m_last_autosave;
+
+	SceneSaveMetrics m_metrics;
+
+public:
+	SceneSaver(ThreadPool& pool = ThreadPool::global()) noexcept;
+
+	~SceneSaver() noexcept;
+
+	SceneSaver(const SceneSaver& other) = delete;
+	SceneSaver& operator=(const SceneSaver& other) = delete;
+
+	// Saved at the next update(), the format follows the file extension
+	void requestSave(std::filesystem::path save_path) noexcept;
+
+	// An interval of zero turns autosave off
+	void setAutosave(
+		std::filesystem::path save_path,
+		Timing::seconds interval) noexcept;
+
+	// Call at a frame boundary, when nothing is mutating the world
+	void update(const Scene& world) noexcept;
+
+	// Blocks until the in-flight save, if any, has hit the disk
+	void wait() noexcept;
+
+	[[nodiscard]] bool isSaving() const noexcept;
+
+	[[nodiscard]] const SceneSaveMetrics& metrics() const noexcept;
+
+private:
+	void reap() noexcept;
+
+	void beginSave(const Scene& world, std::filesystem::path save_path) noexcept;
+};
+
+};	// end of namespace
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "core/components/Object.h"
+#include "core/components/Render.h"
+#include "core/ecs/Registry.h"
+#include "core/scene/Scene.h"
+
+#include <memory>
+
+namespace APE {
+
+/*
+* Copy of the serialized parts of a scene, frozen at a frame boundary
+* Pools are copied whole, so asset handles only bump their ref counts.
+* The copy can then be written out on a worker while the world changes.
+*/
+struct SceneSnapshot {
+	ECS::Registry registry;
+	ECS::EntityHandle root;
+
+	[[nodiscard]] static std::unique_ptr<SceneSnapshot>
+	capture(const Scene& world) noexcept
+	{
+		auto snapshot = std::make_unique<SceneSnapshot>();
+		snapshot->registry.copyFrom<
+			TransformComponent,
+			HierarchyComponent,
+			Render::MeshComponent,
+			Render::MaterialComponent,
+			Render::LightComponent>(world.registry);
+		snapshot->root = world.root;
+		return snapshot;
+	}
+};
+
+};	// end of namespace
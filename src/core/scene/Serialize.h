@@ -1,23 +1,151 @@
 #pragma once
 
 #include "core/components/Object.h"
+#include "core/scene/AssetBatch.h"
 #include "core/scene/AssetLoader.h"
 #include "core/ecs/Registry.h"
 #include "core/scene/Scene.h"
+#include "core/scene/SceneLoadProgress.h"
+#include "core/scene/SceneSnapshot.h"
 #include "util/Logger.h"
+#include "util/ThreadPool.h"
 
 #include <cereal/cereal.hpp>
+#include <cereal/archives/adapters.hpp>
 #include <cereal/archives/json.hpp>
 #include <cereal/types/vector.hpp>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
-namespace cereal {
+namespace APE {
+
+/*
+* Per-save state, attached to the archive
+* Entity ids are written as their index in the saved entity list, so
+* loads can remap through a dense array.
+*/
+class SceneSaveContext {
+private:
+	std::unordered_map<ECS::EntityID, ECS::EntityID> m_compact;
+
+public:
+	SceneSaveContext(const ECS::Registry& r) noexcept
+	{
+		auto ents = r.entities();
+		m_compact.reserve(ents.size());
+		for (size_t i = 0; i < ents.size(); ++i) {
+			m_compact.emplace(ents[i].id, i);
+		}
+	}
 
-static inline
-std::unordered_map<APE::ECS::EntityID, APE::ECS::EntityHandle> s_old_to_new;
+	[[nodiscard]] ECS::EntityID compact(ECS::EntityHandle ent) const noexcept
+	{
+		auto it = m_compact.find(ent.id);
+		return (it != m_compact.end()) ? it->second : ECS::EntityHandle().id;
+	}
+};
+
+/*
+* Per-load state, attached to the archive
+* Nothing is shared between loads, so scenes can parse on several threads.
+*/
+class SceneLoadContext {
+private:
+	// Indexed by saved id, or keyed by it when the ids are too sparse
+	std::vector<ECS::EntityHandle> m_remap;
+	std::unordered_map<ECS::EntityID, ECS::EntityHandle> m_sparse_remap;
+
+public:
+	AssetBatch assets;
+	SceneLoadProgress* progress;
+
+	SceneLoadContext(SceneLoadProgress* progress = nullptr) noexcept
+		: progress(progress)
+	{
+
+	}
+
+	// Allocates a contiguous block of new entities for the saved ones
+	void mapEntities(
+		ECS::Registry& r,
+		const std::vector<ECS::EntityHandle>& saved_ents)
+	{
+		// Saves are compacted, older files may still have gaps in their ids
+		ECS::EntityID max_id = 0;
+		for (auto ent : saved_ents) {
+			max_id = std::max(max_id, ent.id);
+		}
+		bool b_sparse = !saved_ents.empty() && max_id >= MAX_SPARSITY * saved_ents.size();
+
+		// Check every id before creating anything
+		m_remap.clear();
+		m_sparse_remap.clear();
+		if (b_sparse) {
+			m_sparse_remap.reserve(saved_ents.size());
+		}
+		else {
+			m_remap.assign(saved_ents.empty() ? 0 : max_id + 1, ECS::EntityHandle());
+		}
+		for (size_t i = 0; i < saved_ents.size(); ++i) {
+			ECS::EntityHandle& slot = b_sparse
+				? m_sparse_remap[saved_ents[i].id]
+				: m_remap[saved_ents[i].id];
+			if (slot != ECS::EntityHandle()) {
+				m_remap.clear();
+				m_sparse_remap.clear();
+				throw cereal::Exception("SceneLoadContext: duplicate saved entity id");
+			}
+			slot = { static_cast<ECS::EntityID>(i) };
+		}
+
+		ECS::EntityID first = r.createEntities(saved_ents.size());
+		for (auto& [saved_id, ent] : m_sparse_remap) {
+			ent.id += first;
+		}
+		for (auto& ent : m_remap) {
+			if (ent != ECS::EntityHandle()) ent.id += first;
+		}
+	}
+
+	[[nodiscard]] ECS::EntityHandle remap(ECS::EntityHandle saved) const
+	{
+		ECS::EntityHandle tombstone;
+		if (saved == tombstone) {
+			return tombstone;
+		}
+
+		if (!m_sparse_remap.empty()) {
+			auto it = m_sparse_remap.find(saved.id);
+			if (it == m_sparse_remap.end()) {
+				throw cereal::Exception("SceneLoadContext: reference to unsaved entity");
+			}
+			return it->second;
+		}
+
+		if (saved.id >= m_remap.size() || m_remap[saved.id] == tombstone) {
+			throw cereal::Exception("SceneLoadContext: reference to unsaved entity");
+		}
+		return m_remap[saved.id];
+	}
+
+private:
+	static constexpr ECS::EntityID MAX_SPARSITY = 64;
+};
+
+using SceneOutputArchive =
+	cereal::UserDataAdapter<SceneSaveContext, cereal::JSONOutputArchive>;
+using SceneInputArchive =
+	cereal::UserDataAdapter<SceneLoadContext, cereal::JSONInputArchive>;
+
+};	// end of namespace
+
+
+namespace cereal {
 
 /*
 * GLM
@@ -84,9 +212,17 @@ void load(Archive& ar, std::filesystem::path& path)
 
 /*
 * Entity Handle
+* Loaded ids are still saved ids, remap them through the SceneLoadContext
 */
 template <class Archive>
-void serialize(Archive& ar, APE::ECS::EntityHandle& ent)
+void save(Archive& ar, const APE::ECS::EntityHandle& ent)
+{
+	auto& ctx = cereal::get_user_data<APE::SceneSaveContext>(ar);
+	ar(cereal::make_nvp("id", ctx.compact(ent)));
+}
+
+template <class Archive>
+void load(Archive& ar, APE::ECS::EntityHandle& ent)
 {
 	ar(cereal::make_nvp("id", ent.id));
 }
@@ -121,7 +257,10 @@ void load(Archive& ar, APE::AssetHandle<Asset>& asset)
 		cereal::make_nvp("asset_class", asset.asset_class)
 	);
 
-	asset = APE::AssetLoader::load<Asset>(asset.key, asset.asset_class);
+	// Defer to the batch so unique assets import in parallel after parsing
+	auto& ctx = cereal::get_user_data<APE::SceneLoadContext>(ar);
+	ctx.assets.request(asset.key, asset.asset_class);
+	asset.data = nullptr;
 }
 
 
@@ -144,22 +283,25 @@ void save(Archive& ar, const APE::HierarchyComponent& h)
 	ar(
 		cereal::make_nvp("parent", h.parent), 
 		cereal::make_nvp("children", h.children),
-		cereal::make_nvp("tag", h.tag)
+		cereal::make_nvp("tag", h.tag.str())
 	);
 }
 
 template <class Archive>
 void load(Archive& ar, APE::HierarchyComponent& h)
 {
+	std::string tag;
 	ar(
 		cereal::make_nvp("parent", h.parent), 
 		cereal::make_nvp("children", h.children),
-		cereal::make_nvp("tag", h.tag)
+		cereal::make_nvp("tag", tag)
 	);
+	h.tag = APE::StringId(tag);
 
-	h.parent = s_old_to_new.at(h.parent.id);
-	for (size_t i = 0; i < h.children.size(); ++i) {
-		h.children[i] = s_old_to_new.at(h.children[i].id);
+	auto& ctx = cereal::get_user_data<APE::SceneLoadContext>(ar);
+	h.parent = ctx.remap(h.parent);
+	for (auto& child : h.children) {
+		child = ctx.remap(child);
 	}
 }
 
@@ -167,19 +309,52 @@ void load(Archive& ar, APE::HierarchyComponent& h)
 /*
 * Render Components
 */
+// Components only hold IDs, the file keeps the key so it outlives the slot
+template <typename Asset>
+[[nodiscard]] APE::AssetHandle<Asset> assetRef(APE::AssetId id) noexcept
+{
+	return APE::AssetHandle<Asset>(APE::AssetManager::keyOf(id), APE::AssetManager::classOf(id));
+}
+
+template <typename Asset>
+[[nodiscard]] APE::AssetId assetId(const APE::AssetHandle<Asset>& ref) noexcept
+{
+	if (ref.asset_class == APE::AssetClass::None) return {};
+	return APE::AssetManager::registerKey<Asset>(ref.key, ref.asset_class);
+}
+
 template <class Archive>
-void serialize(Archive& ar, APE::Render::MeshComponent& m)
+void save(Archive& ar, const APE::Render::MeshComponent& m)
 {
 	ar(
-		cereal::make_nvp("model_handle", m.model_handle), 
+		cereal::make_nvp("model_handle", assetRef<APE::Render::Model>(m.model_id)),
 		cereal::make_nvp("mesh_index", m.mesh_index)
 	);
 }
 
 template <class Archive>
-void serialize(Archive& ar, APE::Render::MaterialComponent& m)
+void load(Archive& ar, APE::Render::MeshComponent& m)
 {
-	ar(cereal::make_nvp("texture_handle", m.texture_handle));
+	APE::AssetHandle<APE::Render::Model> ref;
+	ar(
+		cereal::make_nvp("model_handle", ref),
+		cereal::make_nvp("mesh_index", m.mesh_index)
+	);
+	m.model_id = assetId(ref);
+}
+
+template <class Archive>
+void save(Archive& ar, const APE::Render::MaterialComponent& m)
+{
+	ar(cereal::make_nvp("texture_handle", assetRef<APE::Render::Image>(m.texture_id)));
+}
+
+template <class Archive>
+void load(Archive& ar, APE::Render::MaterialComponent& m)
+{
+	APE::AssetHandle<APE::Render::Image> ref;
+	ar(cereal::make_nvp("texture_handle", ref));
+	m.texture_id = assetId(ref);
 }
 
 template <class Archive>
@@ -227,16 +402,21 @@ void serializePool(Archive& ar, const APE::ECS::Registry& r) noexcept
 }
 
 template <class Archive, typename Component>
-void deserializePool(Archive& ar, APE::ECS::Registry& r) noexcept
+void deserializePool(
+	Archive& ar,
+	APE::ECS::Registry& r,
+	const APE::SceneLoadContext& ctx)
 {
 	std::vector<ECSPair<Component>> entries;
 	ar(cereal::make_nvp(Component::Name, entries));
 
 	for (auto& [ent, comp] : entries) {
-		APE::ECS::EntityHandle new_ent = s_old_to_new.at(ent.id);
-		r.emplaceComponent<Component>(new_ent, comp);
+		r.emplaceComponent<Component>(ctx.remap(ent), comp);
 	}
 
+	if (ctx.progress) {
+		++ctx.progress->pools_done;
+	}
 	APE_TRACE("Deserialized {}", Component::Name);
 }
 
@@ -244,6 +424,8 @@ void deserializePool(Archive& ar, APE::ECS::Registry& r) noexcept
 /*
 * ECS Registry
 */
+constexpr size_t NUM_SERIALIZED_POOLS = 5;
+
 template <class Archive>
 void save(Archive& ar, const APE::ECS::Registry& r)
 {
@@ -259,18 +441,22 @@ void save(Archive& ar, const APE::ECS::Registry& r)
 template <class Archive>
 void load(Archive& ar, APE::ECS::Registry& r)
 {
-	std::vector<APE::ECS::EntityHandle> old_ents;
-	ar(cereal::make_nvp("entities", old_ents));
+	auto& ctx = cereal::get_user_data<APE::SceneLoadContext>(ar);
 
-	for (auto old_ent : old_ents) {
-		s_old_to_new[old_ent.id] = r.createEntity();
+	std::vector<APE::ECS::EntityHandle> saved_ents;
+	ar(cereal::make_nvp("entities", saved_ents));
+	ctx.mapEntities(r, saved_ents);
+
+	if (ctx.progress) {
+		ctx.progress->pools_total = NUM_SERIALIZED_POOLS;
+		ctx.progress->stage = APE::SceneLoadProgress::Stage::Components;
 	}
 
-	deserializePool<Archive, APE::TransformComponent>(ar, r);
-	deserializePool<Archive, APE::HierarchyComponent>(ar, r);
-	deserializePool<Archive, APE::Render::MeshComponent>(ar, r);
-	deserializePool<Archive, APE::Render::MaterialComponent>(ar, r);
-	deserializePool<Archive, APE::Render::LightComponent>(ar, r);
+	deserializePool<Archive, APE::TransformComponent>(ar, r, ctx);
+	deserializePool<Archive, APE::HierarchyComponent>(ar, r, ctx);
+	deserializePool<Archive, APE::Render::MeshComponent>(ar, r, ctx);
+	deserializePool<Archive, APE::Render::MaterialComponent>(ar, r, ctx);
+	deserializePool<Archive, APE::Render::LightComponent>(ar, r, ctx);
 }
 
 
@@ -286,19 +472,39 @@ void save(Archive& ar, const APE::Scene& scene)
 	);
 }
 
+// Same layout as a Scene, so snapshots load like any other scene file
+template <class Archive>
+void save(Archive& ar, const APE::SceneSnapshot& snapshot)
+{
+	ar(
+		cereal::make_nvp("registry", snapshot.registry),
+		cereal::make_nvp("root", snapshot.root)
+	);
+}
+
 template <class Archive>
 void load(Archive& ar, APE::Scene& scene)
 {
-	s_old_to_new.clear();
-	APE::ECS::EntityHandle tombstone = scene.registry.tombstone();
-	s_old_to_new[tombstone.id] = tombstone;
+	auto& ctx = cereal::get_user_data<APE::SceneLoadContext>(ar);
+	APE::ECS::EntityHandle old_root = scene.root;
 
 	ar(
 		cereal::make_nvp("registry", scene.registry),
 		cereal::make_nvp("root", scene.root)
 	);
+	scene.root = ctx.remap(scene.root);
+
+	// The saved root replaces the one made by the Scene constructor
+	if (scene.root != old_root) {
+		scene.registry.destroyEntity(old_root);
+	}
+	scene.markAllDirty();
 
-	scene.root = s_old_to_new.at(scene.root.id);
+	if (ctx.progress) {
+		ctx.progress->assets_total = ctx.assets.size();
+		ctx.progress->stage = APE::SceneLoadProgress::Stage::Assets;
+	}
+	ctx.assets.resolve(APE::ThreadPool::global(), ctx.progress);
 }
 
 };	// end of namespace
@@ -312,22 +518,69 @@ struct Serialize {
 		::APE::Scene& world) noexcept
 	{
 		std::ofstream os(save_path);
-		cereal::JSONOutputArchive archive(os);
+		SceneSaveContext ctx(world.registry);
+		SceneOutputArchive archive(ctx, os);
 		archive(world);
 	}
 
+	static bool saveSnapshot(
+		const std::filesystem::path& save_path,
+		const SceneSnapshot& snapshot) noexcept
+	{
+		try {
+			std::ofstream os(save_path);
+			{
+				SceneSaveContext ctx(snapshot.registry);
+				SceneOutputArchive archive(ctx, os);
+				archive(snapshot);
+			}
+			return static_cast<bool>(os);
+		}
+		catch (const std::exception& e) {
+			APE_ERROR("Serialize::saveSnapshot() Failed to write {}: {}",
+				save_path.string(),
+				e.what()
+			);
+			return false;
+		}
+	}
+
 	static Scene loadScene(std::filesystem::path load_path)
 	{
-		std::ifstream is(load_path);
-		cereal::JSONInputArchive archive(is);
-		
 		Scene world;
-		archive(world);
+		loadScene(load_path, world);
+		return world;
+	}
+
+	// Progress is updated as the load runs, so this can sit on a worker
+	static void loadScene(
+		std::filesystem::path load_path,
+		Scene& world,
+		SceneLoadProgress* progress = nullptr)
+	{
+		if (progress) {
+			progress->stage = SceneLoadProgress::Stage::Parsing;
+		}
+
+		try {
+			std::ifstream is(load_path);
+			if (!is) {
+				throw cereal::Exception("Serialize::loadScene: can't open " + load_path.string());
+			}
+			SceneLoadContext ctx(progress);
+			SceneInputArchive archive(ctx, is);
+			archive(world);
+		}
+		catch (...) {
+			if (progress) {
+				progress->stage = SceneLoadProgress::Stage::Failed;
+			}
+			throw;
+		}
 
 		APE_TRACE("New scene entity count: {}",
 			world.registry.numEntities()
 		);
-		return world;
 	}
 };
 
@@ -0,0 +1,704 @@
+#include "core/scene/SnapshotDelta.h"
+#include "core/scene/AssetLoader.h"
+#include "util/Logger.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+namespace APE {
+
+namespace {
+
+/*
+* Per component delta rules
+* quantize() rounds a component to exactly what the decoder rebuilds, so
+* both ends diff against bit identical baselines. read() returns the
+* component in sender id space, toLocal() maps it into the receiver's.
+*/
+template <typename Component>
+struct DeltaTraits;
+
+template <>
+struct DeltaTraits<TransformComponent> {
+	// 1mm positions and scales, rotations at int16 precision
+	static constexpr float POSITION_SCALE = 1024.f;
+	static constexpr float SCALE_SCALE = 1024.f;
+	static constexpr float ROTATION_SCALE = 32767.f;
+
+	using Fields = std::array<int32_t, 10>;
+
+	// Field ranges for position, rotation and scale, each sent with one flag
+	static constexpr std::array<std::pair<size_t, size_t>, 3> GROUPS {{
+		{ 0, 3 }, { 3, 7 }, { 7, 10 },
+	}};
+
+	[[nodiscard]] static Fields fields(const TransformComponent& t) noexcept
+	{
+		// q and -q are the same rotation, keep w positive so deltas stay small
+		glm::quat rot = (t.rotation.w < 0.f) ? -t.rotation : t.rotation;
+
+		// Out of range values saturate, about 2000km at 1mm, NaN sends 0
+		auto q = [](float val, float scale) {
+			constexpr double LIMIT = std::numeric_limits<int32_t>::max();
+			double scaled = static_cast<double>(val) * scale;
+			if (!(scaled == scaled)) return int32_t(0);
+			return static_cast<int32_t>(std::lround(std::clamp(scaled, -LIMIT, LIMIT)));
+		};
+		return {
+			q(t.position.x, POSITION_SCALE),
+			q(t.position.y, POSITION_SCALE),
+			q(t.position.z, POSITION_SCALE),
+			q(rot.x, ROTATION_SCALE),
+			q(rot.y, ROTATION_SCALE),
+			q(rot.z, ROTATION_SCALE),
+			q(rot.w, ROTATION_SCALE),
+			q(t.scale.x, SCALE_SCALE),
+			q(t.scale.y, SCALE_SCALE),
+			q(t.scale.z, SCALE_SCALE),
+		};
+	}
+
+	[[nodiscard]] static TransformComponent fromFields(const Fields& f) noexcept
+	{
+		return TransformComponent(
+			glm::vec3(f[0], f[1], f[2]) / POSITION_SCALE,
+			glm::vec3(f[7], f[8], f[9]) / SCALE_SCALE,
+			glm::quat(f[6] / ROTATION_SCALE, f[3] / ROTATION_SCALE,
+				f[4] / ROTATION_SCALE, f[5] / ROTATION_SCALE)
+		);
+	}
+
+	[[nodiscard]] static TransformComponent quantize(const TransformComponent& t) noexcept
+	{
+		return fromFields(fields(t));
+	}
+
+	[[nodiscard]] static bool equal(
+		const TransformComponent& a,
+		const TransformComponent& b) noexcept
+	{
+		return fields(a) == fields(b);
+	}
+
+	static void write(
+		BitWriter& out,
+		const TransformComponent& cur,
+		const TransformComponent* base) noexcept
+	{
+		Fields f = fields(cur);
+		Fields b = base ? fields(*base) : Fields {};
+
+		for (auto [first, last] : GROUPS) {
+			bool b_changed = !std::equal(f.begin() + first, f.begin() + last, b.begin() + first);
+			out.writeBool(b_changed);
+			if (!b_changed) continue;
+
+			for (size_t i = first; i < last; ++i) {
+				out.writeSignedVarint(static_cast<int64_t>(f[i]) - b[i]);
+			}
+		}
+	}
+
+	[[nodiscard]] static TransformComponent read(
+		BitReader& in,
+		const TransformComponent* base) noexcept
+	{
+		Fields f = base ? fields(*base) : Fields {};
+
+		for (auto [first, last] : GROUPS) {
+			if (!in.readBool()) continue;
+
+			for (size_t i = first; i < last; ++i) {
+				f[i] = static_cast<int32_t>(f[i] + in.readSignedVarint());
+			}
+		}
+		return fromFields(f);
+	}
+
+	template <typename Remap>
+	[[nodiscard]] static TransformComponent toLocal(
+		const TransformComponent& t,
+		Remap&&) noexcept
+	{
+		return t;
+	}
+};
+
+template <>
+struct DeltaTraits<HierarchyComponent> {
+	[[nodiscard]] static HierarchyComponent quantize(const HierarchyComponent& h) noexcept
+	{
+		return h;
+	}
+
+	[[nodiscard]] static bool equal(
+		const HierarchyComponent& a,
+		const HierarchyComponent& b) noexcept
+	{
+		return a.parent == b.parent && a.tag == b.tag && a.children == b.children;
+	}
+
+	static void write(
+		BitWriter& out,
+		const HierarchyComponent& cur,
+		const HierarchyComponent* base) noexcept
+	{
+		bool b_parent = !base || cur.parent != base->parent;
+		out.writeBool(b_parent);
+		if (b_parent) {
+			// Tombstone wraps around to zero
+			out.writeVarint(cur.parent.id + 1);
+		}
+
+		bool b_tag = !base || cur.tag != base->tag;
+		out.writeBool(b_tag);
+		if (b_tag) {
+			out.writeString(cur.tag.view());
+		}
+
+		bool b_children = !base || cur.children != base->children;
+		out.writeBool(b_children);
+		if (b_children) {
+			out.writeVarint(cur.children.size());
+			ECS::EntityID prev = 0;
+			for (auto child : cur.children) {
+				out.writeSignedVarint(static_cast<int64_t>(child.id - prev));
+				prev = child.id;
+			}
+		}
+	}
+
+	[[nodiscard]] static HierarchyComponent read(
+		BitReader& in,
+		const HierarchyComponent* base) noexcept
+	{
+		HierarchyComponent h = base ? *base : HierarchyComponent();
+
+		if (in.readBool()) {
+			h.parent = { in.readVarint() - 1 };
+		}
+		if (in.readBool()) {
+			h.tag = StringId(in.readString());
+		}
+		if (in.readBool()) {
+			uint64_t count = in.readVarint();
+			h.children.clear();
+
+			ECS::EntityID prev = 0;
+			for (uint64_t i = 0; i < count && !in.overflowed(); ++i) {
+				prev += static_cast<ECS::EntityID>(in.readSignedVarint());
+				h.children.push_back({ prev });
+			}
+		}
+		return h;
+	}
+
+	template <typename Remap>
+	[[nodiscard]] static HierarchyComponent toLocal(
+		const HierarchyComponent& h,
+		Remap&& remap) noexcept
+	{
+		HierarchyComponent local(h.tag);
+		local.parent = remap(h.parent.id);
+		for (auto child : h.children) {
+			local.children.push_back(remap(child.id));
+		}
+		return local;
+	}
+};
+
+// Mesh and Material replicate their asset keys, receivers load the assets
+struct AssetKeyDelta {
+	static void write(
+		BitWriter& out,
+		const AssetKey& cur,
+		const AssetKey* base) noexcept
+	{
+		bool b_changed = !base || cur != *base;
+		out.writeBool(b_changed);
+		if (b_changed) {
+			out.writeString(cur.path.string());
+			out.writeString(cur.sub_index);
+		}
+	}
+
+	// Components hold IDs, keys are only registered here and loaded in toLocal
+	template <typename Asset>
+	[[nodiscard]] static AssetId readId(BitReader& in, AssetId base, AssetClass asset_class) noexcept
+	{
+		if (!in.readBool()) return base;
+
+		std::string path = in.readString();
+		AssetKey key(path, in.readString());
+		if (key.path.empty()) return {};
+		return AssetManager::registerKey<Asset>(key, asset_class);
+	}
+
+	template <typename Asset>
+	[[nodiscard]] static AssetId loadId(AssetId id, AssetClass asset_class) noexcept
+	{
+		if (!id.isValid()) return id;
+		return AssetLoader::load<Asset>(AssetManager::keyOf(id), asset_class).id;
+	}
+};
+
+template <>
+struct DeltaTraits<Render::MeshComponent> {
+	[[nodiscard]] static Render::MeshComponent quantize(const Render::MeshComponent& m) noexcept
+	{
+		return m;
+	}
+
+	[[nodiscard]] static bool equal(
+		const Render::MeshComponent& a,
+		const Render::MeshComponent& b) noexcept
+	{
+		return a.model_id == b.model_id && a.mesh_index == b.mesh_index;
+	}
+
+	static void write(
+		BitWriter& out,
+		const Render::MeshComponent& cur,
+		const Render::MeshComponent* base) noexcept
+	{
+		AssetKey base_key = base ? AssetManager::keyOf(base->model_id) : AssetKey();
+		AssetKeyDelta::write(out, AssetManager::keyOf(cur.model_id), base ? &base_key : nullptr);
+
+		bool b_index = !base || cur.mesh_index != base->mesh_index;
+		out.writeBool(b_index);
+		if (b_index) {
+			out.writeVarint(cur.mesh_index);
+		}
+	}
+
+	[[nodiscard]] static Render::MeshComponent read(
+		BitReader& in,
+		const Render::MeshComponent* base) noexcept
+	{
+		Render::MeshComponent m = base ? *base : Render::MeshComponent();
+		m.model_id = AssetKeyDelta::readId<Render::Model>(in, m.model_id, AssetClass::Model);
+
+		if (in.readBool()) {
+			m.mesh_index = in.readVarint();
+		}
+		return m;
+	}
+
+	template <typename Remap>
+	[[nodiscard]] static Render::MeshComponent toLocal(
+		const Render::MeshComponent& m,
+		Remap&&) noexcept
+	{
+		return Render::MeshComponent(
+			AssetKeyDelta::loadId<Render::Model>(m.model_id, AssetClass::Model),
+			m.mesh_index
+		);
+	}
+};
+
+template <>
+struct DeltaTraits<Render::MaterialComponent> {
+	[[nodiscard]] static Render::MaterialComponent quantize(
+		const Render::MaterialComponent& m) noexcept
+	{
+		return m;
+	}
+
+	[[nodiscard]] static bool equal(
+		const Render::MaterialComponent& a,
+		const Render::MaterialComponent& b) noexcept
+	{
+		return a.texture_id == b.texture_id;
+	}
+
+	static void write(
+		BitWriter& out,
+		const Render::MaterialComponent& cur,
+		const Render::MaterialComponent* base) noexcept
+	{
+		AssetKey base_key = base ? AssetManager::keyOf(base->texture_id) : AssetKey();
+		AssetKeyDelta::write(out, AssetManager::keyOf(cur.texture_id), base ? &base_key : nullptr);
+	}
+
+	[[nodiscard]] static Render::MaterialComponent read(
+		BitReader& in,
+		const Render::MaterialComponent* base) noexcept
+	{
+		// Empty ID, the default constructor would load the default image
+		Render::MaterialComponent m = base ? *base : Render::MaterialComponent(AssetId());
+		m.texture_id = AssetKeyDelta::readId<Render::Image>(in, m.texture_id, AssetClass::Texture);
+		return m;
+	}
+
+	template <typename Remap>
+	[[nodiscard]] static Render::MaterialComponent toLocal(
+		const Render::MaterialComponent& m,
+		Remap&&) noexcept
+	{
+		return Render::MaterialComponent(
+			AssetKeyDelta::loadId<Render::Image>(m.texture_id, AssetClass::Texture)
+		);
+	}
+};
+
+// Lights change rarely, changed fields are sent as raw floats
+template <>
+struct DeltaTraits<Render::LightComponent> {
+	[[nodiscard]] static Render::LightComponent quantize(const Render::LightComponent& l) noexcept
+	{
+		return l;
+	}
+
+	[[nodiscard]] static bool equal(
+		const Render::LightComponent& a,
+		const Render::LightComponent& b) noexcept
+	{
+		return a.type == b.type &&
+			a.intensity == b.intensity &&
+			a.color == b.color &&
+			a.cutoff_angle == b.cutoff_angle &&
+			a.shape == b.shape &&
+			a.extent == b.extent;
+	}
+
+	static void write(
+		BitWriter& out,
+		const Render::LightComponent& cur,
+		const Render::LightComponent* base) noexcept
+	{
+		auto field = [&](bool b_changed, auto&& writeField) {
+			out.writeBool(b_changed);
+			if (b_changed) writeField();
+		};
+
+		field(!base || cur.type != base->type, [&]() {
+			out.writeVarint(static_cast<uint64_t>(cur.type));
+		});
+		field(!base || cur.intensity != base->intensity, [&]() {
+			out.writeFloat(cur.intensity);
+		});
+		field(!base || cur.color != base->color, [&]() {
+			out.writeFloat(cur.color.x);
+			out.writeFloat(cur.color.y);
+			out.writeFloat(cur.color.z);
+		});
+		field(!base || cur.cutoff_angle != base->cutoff_angle, [&]() {
+			out.writeFloat(cur.cutoff_angle);
+		});
+		field(!base || cur.shape != base->shape, [&]() {
+			out.writeVarint(static_cast<uint64_t>(cur.shape));
+		});
+		field(!base || cur.extent != base->extent, [&]() {
+			out.writeFloat(cur.extent.x);
+			out.writeFloat(cur.extent.y);
+		});
+	}
+
+	[[nodiscard]] static Render::LightComponent read(
+		BitReader& in,
+		const Render::LightComponent* base) noexcept
+	{
+		Render::LightComponent l = base ? *base : Render::LightComponent();
+
+		if (in.readBool()) {
+			l.type = static_cast<Render::LightType>(in.readVarint());
+		}
+		if (in.readBool()) {
+			l.intensity = in.readFloat();
+		}
+		if (in.readBool()) {
+			l.color.x = in.readFloat();
+			l.color.y = in.readFloat();
+			l.color.z = in.readFloat();
+		}
+		if (in.readBool()) {
+			l.cutoff_angle = in.readFloat();
+		}
+		if (in.readBool()) {
+			l.shape = static_cast<Render::AreaLightShape>(in.readVarint());
+		}
+		if (in.readBool()) {
+			l.extent.x = in.readFloat();
+			l.extent.y = in.readFloat();
+		}
+		return l;
+	}
+
+	template <typename Remap>
+	[[nodiscard]] static Render::LightComponent toLocal(
+		const Render::LightComponent& l,
+		Remap&&) noexcept
+	{
+		return l;
+	}
+};
+
+// Sorted ids as gaps from the previous id
+void writeSortedIds(BitWriter& out, const std::vector<ECS::EntityID>& ids) noexcept
+{
+	out.writeVarint(ids.size());
+	ECS::EntityID prev = 0;
+	for (auto id : ids) {
+		out.writeVarint(id - prev);
+		prev = id;
+	}
+}
+
+[[nodiscard]] std::vector<ECS::EntityID> readSortedIds(BitReader& in) noexcept
+{
+	uint64_t count = in.readVarint();
+
+	std::vector<ECS::EntityID> ids;
+	ECS::EntityID prev = 0;
+	for (uint64_t i = 0; i < count && !in.overflowed(); ++i) {
+		prev += in.readVarint();
+		ids.push_back(prev);
+	}
+	return ids;
+}
+
+};	// end of namespace
+
+
+/*
+* Encoder
+*/
+DeltaEncoder::DeltaEncoder() noexcept
+	: m_tick(0)
+	, m_keyframe(true)
+{
+
+}
+
+std::vector<std::byte> DeltaEncoder::encode(ECS::Registry& registry) noexcept
+{
+	BitWriter out;
+	out.writeVarint(m_tick);
+	out.writeBool(m_keyframe);
+
+	if (m_keyframe) {
+		m_baseline.clear();
+		m_entities.clear();
+	}
+
+	// Entity lifetimes first, so components can refer to new entities
+	std::vector<ECS::EntityID> entities;
+	for (auto ent : registry.entities()) {
+		entities.push_back(ent.id);
+	}
+	std::sort(entities.begin(), entities.end());
+
+	std::vector<ECS::EntityID> created;
+	std::set_difference(
+		entities.begin(), entities.end(),
+		m_entities.begin(), m_entities.end(),
+		std::back_inserter(created)
+	);
+
+	std::vector<ECS::EntityID> destroyed;
+	std::set_difference(
+		m_entities.begin(), m_entities.end(),
+		entities.begin(), entities.end(),
+		std::back_inserter(destroyed)
+	);
+
+	writeSortedIds(out, created);
+	writeSortedIds(out, destroyed);
+	for (auto id : destroyed) {
+		m_baseline.erase(id);
+	}
+	m_entities = std::move(entities);
+
+	encodePool<TransformComponent>(out, registry);
+	encodePool<HierarchyComponent>(out, registry);
+	encodePool<Render::MeshComponent>(out, registry);
+	encodePool<Render::MaterialComponent>(out, registry);
+	encodePool<Render::LightComponent>(out, registry);
+
+	++m_tick;
+	m_keyframe = false;
+	return out.finish();
+}
+
+void DeltaEncoder::forceKeyframe() noexcept
+{
+	m_keyframe = true;
+}
+
+uint32_t DeltaEncoder::tick() const noexcept
+{
+	return m_tick;
+}
+
+template <typename Component>
+void DeltaEncoder::encodePool(BitWriter& out, ECS::Registry& registry) noexcept
+{
+	using Traits = DeltaTraits<Component>;
+	auto& baseline = m_baseline.pool<Component>();
+
+	// Changed entries, in pool order so consecutive ids are usually close
+	std::vector<std::pair<ECS::EntityID, Component>> changed;
+	std::vector<ECS::EntityID> removed;
+	if (registry.hasComponent<Component>()) {
+		auto& pool = registry.getPool<Component>();
+		for (auto [id, comp] : pool) {
+			Component q = Traits::quantize(comp);
+
+			auto it = baseline.find(id);
+			if (it != baseline.end() && Traits::equal(q, it->second)) continue;
+			changed.emplace_back(id, std::move(q));
+		}
+
+		for (auto& [id, comp] : baseline) {
+			if (!pool.contains(id)) removed.push_back(id);
+		}
+	}
+	else {
+		for (auto& [id, comp] : baseline) {
+			removed.push_back(id);
+		}
+	}
+
+	// Untouched pools cost a single bit
+	out.writeBool(!changed.empty() || !removed.empty());
+	if (changed.empty() && removed.empty()) return;
+
+	out.writeVarint(changed.size());
+	ECS::EntityID prev = 0;
+	for (auto& [id, comp] : changed) {
+		out.writeSignedVarint(static_cast<int64_t>(id - prev));
+		prev = id;
+
+		auto it = baseline.find(id);
+		Traits::write(out, comp, (it != baseline.end()) ? &it->second : nullptr);
+		baseline.insert_or_assign(id, std::move(comp));
+	}
+
+	std::sort(removed.begin(), removed.end());
+	writeSortedIds(out, removed);
+	for (auto id : removed) {
+		baseline.erase(id);
+	}
+}
+
+
+/*
+* Decoder
+*/
+DeltaDecoder::DeltaDecoder() noexcept
+	: m_next_tick(0)
+	, m_synced(false)
+{
+
+}
+
+bool DeltaDecoder::apply(
+	std::span<const std::byte> packet,
+	ECS::Registry& registry) noexcept
+{
+	BitReader in(packet);
+	uint32_t tick = static_cast<uint32_t>(in.readVarint());
+	bool b_keyframe = in.readBool();
+
+	if (!b_keyframe && (!m_synced || tick != m_next_tick)) {
+		APE_WARN("DeltaDecoder::apply() Dropped tick {}, waiting for a keyframe.", tick);
+		m_synced = false;
+		return false;
+	}
+
+	// Keyframes rebuild everything this decoder created
+	if (b_keyframe) {
+		for (auto [remote, local] : m_local) {
+			registry.destroyEntity(local);
+		}
+		m_local.clear();
+		m_baseline.clear();
+	}
+
+	for (auto id : readSortedIds(in)) {
+		if (!m_local.contains(id)) {
+			m_local.emplace(id, registry.createEntity());
+		}
+	}
+	for (auto id : readSortedIds(in)) {
+		auto it = m_local.find(id);
+		if (it == m_local.end()) continue;
+
+		registry.destroyEntity(it->second);
+		m_local.erase(it);
+		m_baseline.erase(id);
+	}
+
+	bool b_ok =
+		decodePool<TransformComponent>(in, registry) &&
+		decodePool<HierarchyComponent>(in, registry) &&
+		decodePool<Render::MeshComponent>(in, registry) &&
+		decodePool<Render::MaterialComponent>(in, registry) &&
+		decodePool<Render::LightComponent>(in, registry);
+
+	if (!b_ok || in.overflowed()) {
+		APE_ERROR("DeltaDecoder::apply() Failed: corrupt packet for tick {}.", tick);
+		m_synced = false;
+		return false;
+	}
+
+	m_synced = true;
+	m_next_tick = tick + 1;
+	return true;
+}
+
+ECS::EntityHandle DeltaDecoder::localEntity(ECS::EntityID remote) const noexcept
+{
+	auto it = m_local.find(remote);
+	return (it != m_local.end()) ? it->second : ECS::EntityHandle();
+}
+
+bool DeltaDecoder::isSynced() const noexcept
+{
+	return m_synced;
+}
+
+template <typename Component>
+bool DeltaDecoder::decodePool(BitReader& in, ECS::Registry& registry) noexcept
+{
+	using Traits = DeltaTraits<Component>;
+	auto& baseline = m_baseline.pool<Component>();
+	auto remap = [this](ECS::EntityID remote) { return localEntity(remote); };
+
+	if (!in.readBool()) return true;
+
+	uint64_t num_changed = in.readVarint();
+	ECS::EntityID prev = 0;
+	for (uint64_t i = 0; i < num_changed; ++i) {
+		ECS::EntityID id = prev + static_cast<ECS::EntityID>(in.readSignedVarint());
+		prev = id;
+
+		auto local = m_local.find(id);
+		if (in.overflowed() || local == m_local.end()) return false;
+
+		auto it = baseline.find(id);
+		Component remote = Traits::read(in, (it != baseline.end()) ? &it->second : nullptr);
+		if (in.overflowed()) return false;
+
+		registry.emplaceOrReplaceComponent<Component>(
+			local->second,
+			Traits::toLocal(remote, remap)
+		);
+		baseline.insert_or_assign(id, std::move(remote));
+	}
+
+	for (auto id : readSortedIds(in)) {
+		auto local = m_local.find(id);
+		if (local == m_local.end()) return false;
+
+		registry.removeComponent<Component>(local->second);
+		baseline.erase(id);
+	}
+	return true;
+}
+
+};	// end of namespace
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "core/components/Object.h"
+#include "core/components/Render.h"
+#include "core/ecs/Registry.h"
+#include "util/BitStream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace APE {
+
+/*
+* Last state both ends agree on, per replicated component, by sender id
+*/
+struct DeltaBaseline {
+	template <typename Component>
+	using Pool = std::unordered_map<ECS::EntityID, Component>;
+
+	std::tuple<
+		Pool<TransformComponent>,
+		Pool<HierarchyComponent>,
+		Pool<Render::MeshComponent>,
+		Pool<Render::MaterialComponent>,
+		Pool<Render::LightComponent>> pools;
+
+	template <typename Component>
+	[[nodiscard]] Pool<Component>& pool() noexcept
+	{
+		return std::get<Pool<Component>>(pools);
+	}
+
+	void erase(ECS::EntityID id) noexcept
+	{
+		std::apply([&](auto&... pool) { (pool.erase(id), ...); }, pools);
+	}
+
+	void clear() noexcept
+	{
+		std::apply([](auto&... pool) { (pool.clear(), ...); }, pools);
+	}
+};
+
+/*
+* Encodes each tick of a registry as a bit packed delta against the last
+* encoded tick. Only changed components are sent, Transforms are
+* quantized and sent as varint deltas of their fixed point fields.
+*/
+class DeltaEncoder {
+private:
+	DeltaBaseline m_baseline;
+	std::vector<ECS::EntityID> m_entities;
+	uint32_t m_tick;
+	bool m_keyframe;
+
+public:
+	DeltaEncoder() noexcept;
+
+	// Diff against the previous tick, then adopt this tick as the baseline
+	[[nodiscard]] std::vector<std::byte> encode(ECS::Registry& registry) noexcept;
+
+	// The next packet carries the full state, e.g. for a late joining peer
+	void forceKeyframe() noexcept;
+
+	[[nodiscard]] uint32_t tick() const noexcept;
+
+private:
+	template <typename Component>
+	void encodePool(BitWriter& out, ECS::Registry& registry) noexcept;
+};
+
+/*
+* Applies DeltaEncoder packets to a registry, creating local entities for
+* the sender's. Packets must arrive in order, after a gap or a corrupt
+* packet only a keyframe is accepted.
+*/
+class DeltaDecoder {
+private:
+	DeltaBaseline m_baseline;
+	std::unordered_map<ECS::EntityID, ECS::EntityHandle> m_local;
+	uint32_t m_next_tick;
+	bool m_synced;
+
+public:
+	DeltaDecoder() noexcept;
+
+	bool apply(std::span<const std::byte> packet, ECS::Registry& registry) noexcept;
+
+	// Local entity mirroring a sender entity, tombstone if unknown
+	[[nodiscard]] ECS::EntityHandle localEntity(ECS::EntityID remote) const noexcept;
+
+	[[nodiscard]] bool isSynced() const noexcept;
+
+private:
+	template <typename Component>
+	bool decodePool(BitReader& in, ECS::Registry& registry) noexcept;
+};
+
+};	// end of namespace
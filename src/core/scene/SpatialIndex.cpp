@@ -0,0 +1,482 @@
+#include "core/scene/SpatialIndex.h"
+#include "physics/collisions/Collisions.h"
+#include "util/Logger.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace APE {
+
+using Physics::Collisions::AABB;
+
+SpatialIndex::SpatialIndex(float margin) noexcept
+	: m_root(NULL_NODE)
+	, m_free_list(NULL_NODE)
+	, m_margin(margin)
+{
+
+}
+
+void SpatialIndex::insert(ECS::EntityHandle ent, const AABB& aabb) noexcept
+{
+	APE_CHECK(!contains(ent),
+		"SpatialIndex::insert() Failed: entity {} is already indexed.",
+		ent.id
+	);
+
+	NodeID leaf = allocateNode();
+	m_nodes[leaf].aabb = aabb.expand(m_margin);
+	m_nodes[leaf].ent = ent;
+	m_nodes[leaf].height = 0;
+
+	insertLeaf(leaf);
+	m_leaves[ent.id] = leaf;
+}
+
+bool SpatialIndex::update(ECS::EntityHandle ent, const AABB& aabb) noexcept
+{
+	auto it = m_leaves.find(ent.id);
+	if (it == m_leaves.end()) {
+		insert(ent, aabb);
+		return true;
+	}
+
+	// Skip the tree entirely while the bounds stay inside the fat box,
+	// unless the fat box has become far too loose to be useful
+	NodeID leaf = it->second;
+	AABB fat = aabb.expand(m_margin);
+	const AABB& old_fat = m_nodes[leaf].aabb;
+	if (old_fat.contains(aabb) &&
+		old_fat.surfaceArea() <= 4.f * fat.surfaceArea())
+	{
+		return false;
+	}
+
+	removeLeaf(leaf);
+	m_nodes[leaf].aabb = fat;
+	insertLeaf(leaf);
+	return true;
+}
+
+bool SpatialIndex::remove(ECS::EntityHandle ent) noexcept
+{
+	auto it = m_leaves.find(ent.id);
+	if (it == m_leaves.end()) {
+		return false;
+	}
+
+	NodeID leaf = it->second;
+	m_leaves.erase(it);
+
+	removeLeaf(leaf);
+	freeNode(leaf);
+	return true;
+}
+
+void SpatialIndex::clear() noexcept
+{
+	m_nodes.clear();
+	m_leaves.clear();
+	m_root = NULL_NODE;
+	m_free_list = NULL_NODE;
+}
+
+std::vector<ECS::EntityHandle> SpatialIndex::queryAABB(
+	const AABB& aabb) const noexcept
+{
+	std::vector<ECS::EntityHandle> res;
+	query([&](const AABB& node_aabb) {
+		return Physics::Collisions::overlaps(node_aabb, aabb);
+	}, res);
+	return res;
+}
+
+std::vector<ECS::EntityHandle> SpatialIndex::querySphere(
+	const Physics::Collisions::Sphere& sphere) const noexcept
+{
+	std::vector<ECS::EntityHandle> res;
+	query([&](const AABB& node_aabb) {
+		return Physics::Collisions::intersects(node_aabb, sphere);
+	}, res);
+	return res;
+}
+
+std::vector<ECS::EntityHandle> SpatialIndex::queryFrustum(
+	const Physics::Collisions::Frustum& frustum) const noexcept
+{
+	std::vector<ECS::EntityHandle> res;
+	query([&](const AABB& node_aabb) {
+		return Physics::Collisions::intersects(frustum, node_aabb);
+	}, res);
+	return res;
+}
+
+std::vector<SpatialIndex::RayHit> SpatialIndex::queryRay(
+	const Physics::Collisions::Ray& ray,
+	float max_t) const noexcept
+{
+	std::vector<RayHit> res;
+	if (m_root == NULL_NODE) return res;
+
+	glm::vec3 inv_dir = 1.f / ray.dir;
+
+	// Slab test returning the entry distance, clamped to the ray origin
+	auto entryDist = [&](const AABB& box, float& t_entry) {
+		glm::vec3 t0 = (box.min - ray.pos) * inv_dir;
+		glm::vec3 t1 = (box.max - ray.pos) * inv_dir;
+		glm::vec3 t_near = glm::min(t0, t1);
+		glm::vec3 t_far = glm::max(t0, t1);
+
+		float t_min = std::max(std::max(t_near.x, t_near.y), t_near.z);
+		float t_max = std::min(std::min(t_far.x, t_far.y), t_far.z);
+
+		t_entry = std::max(t_min, 0.f);
+		return t_max >= t_entry && t_entry <= max_t;
+	};
+
+	std::vector<NodeID> stack { m_root };
+	while (!stack.empty()) {
+		NodeID idx = stack.back();
+		stack.pop_back();
+
+		const Node& node = m_nodes[idx];
+		float t;
+		if (!entryDist(node.aabb, t)) continue;
+
+		if (node.isLeaf()) {
+			res.push_back({ node.ent, t });
+		}
+		else {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+
+	std::sort(res.begin(), res.end(), [](const RayHit& a, const RayHit& b) {
+		return a.t < b.t;
+	});
+	return res;
+}
+
+bool SpatialIndex::contains(ECS::EntityHandle ent) const noexcept
+{
+	return m_leaves.contains(ent.id);
+}
+
+size_t SpatialIndex::size() const noexcept
+{
+	return m_leaves.size();
+}
+
+int SpatialIndex::height() const noexcept
+{
+	if (m_root == NULL_NODE) return 0;
+	return m_nodes[m_root].height;
+}
+
+std::vector<ECS::EntityHandle> SpatialIndex::entities() const noexcept
+{
+	std::vector<ECS::EntityHandle> res;
+	res.reserve(m_leaves.size());
+	for (auto& [ent_id, leaf] : m_leaves) {
+		res.emplace_back(ent_id);
+	}
+	return res;
+}
+
+const AABB& SpatialIndex::fatBounds(ECS::EntityHandle ent) const noexcept
+{
+	APE_CHECK(contains(ent),
+		"SpatialIndex::fatBounds() Failed: entity {} is not indexed.",
+		ent.id
+	);
+	return m_nodes[m_leaves.at(ent.id)].aabb;
+}
+
+void SpatialIndex::query(
+	const OverlapFn& overlaps,
+	std::vector<ECS::EntityHandle>& out) const noexcept
+{
+	if (m_root == NULL_NODE) return;
+
+	std::vector<NodeID> stack { m_root };
+	while (!stack.empty()) {
+		NodeID idx = stack.back();
+		stack.pop_back();
+
+		const Node& node = m_nodes[idx];
+		if (!overlaps(node.aabb)) continue;
+
+		if (node.isLeaf()) {
+			out.push_back(node.ent);
+		}
+		else {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+}
+
+SpatialIndex::NodeID SpatialIndex::allocateNode() noexcept
+{
+	NodeID idx;
+	if (m_free_list != NULL_NODE) {
+		idx = m_free_list;
+		m_free_list = m_nodes[idx].parent;
+	}
+	else {
+		idx = static_cast<NodeID>(m_nodes.size());
+		m_nodes.emplace_back();
+	}
+
+	Node& node = m_nodes[idx];
+	node.ent = ECS::EntityHandle();
+	node.parent = NULL_NODE;
+	node.left = NULL_NODE;
+	node.right = NULL_NODE;
+	node.height = 0;
+	return idx;
+}
+
+void SpatialIndex::freeNode(NodeID node) noexcept
+{
+	// Free nodes are chained through their parent link
+	m_nodes[node].parent = m_free_list;
+	m_nodes[node].height = -1;
+	m_free_list = node;
+}
+
+void SpatialIndex::insertLeaf(NodeID leaf) noexcept
+{
+	if (m_root == NULL_NODE) {
+		m_root = leaf;
+		m_nodes[leaf].parent = NULL_NODE;
+		return;
+	}
+
+	// Descend towards the sibling with the lowest surface area cost
+	AABB leaf_aabb = m_nodes[leaf].aabb;
+	NodeID idx = m_root;
+	while (!m_nodes[idx].isLeaf()) {
+		const Node& node = m_nodes[idx];
+
+		float area = node.aabb.surfaceArea();
+		float combined_area = node.aabb.merge(leaf_aabb).surfaceArea();
+
+		// Cost of making a new parent for this node and the leaf
+		float cost = 2.f * combined_area;
+
+		// Minimum cost of pushing the leaf further down the tree
+		float inheritance_cost = 2.f * (combined_area - area);
+
+		auto descendCost = [&](NodeID child) {
+			const Node& c = m_nodes[child];
+			float merged_area = c.aabb.merge(leaf_aabb).surfaceArea();
+			if (c.isLeaf()) {
+				return merged_area + inheritance_cost;
+			}
+			return (merged_area - c.aabb.surfaceArea()) + inheritance_cost;
+		};
+
+		float cost_left = descendCost(node.left);
+		float cost_right = descendCost(node.right);
+
+		if (cost < cost_left && cost < cost_right) break;
+
+		idx = (cost_left < cost_right) ? node.left : node.right;
+	}
+	NodeID sibling = idx;
+
+	// Create a new parent joining the sibling and the leaf
+	NodeID old_parent = m_nodes[sibling].parent;
+	NodeID new_parent = allocateNode();
+	m_nodes[new_parent].parent = old_parent;
+	m_nodes[new_parent].aabb = m_nodes[sibling].aabb.merge(leaf_aabb);
+	m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+	m_nodes[new_parent].left = sibling;
+	m_nodes[new_parent].right = leaf;
+	m_nodes[sibling].parent = new_parent;
+	m_nodes[leaf].parent = new_parent;
+
+	if (old_parent != NULL_NODE) {
+		if (m_nodes[old_parent].left == sibling) {
+			m_nodes[old_parent].left = new_parent;
+		}
+		else {
+			m_nodes[old_parent].right = new_parent;
+		}
+	}
+	else {
+		m_root = new_parent;
+	}
+
+	refit(m_nodes[leaf].parent);
+}
+
+void SpatialIndex::removeLeaf(NodeID leaf) noexcept
+{
+	if (leaf == m_root) {
+		m_root = NULL_NODE;
+		return;
+	}
+
+	NodeID parent = m_nodes[leaf].parent;
+	NodeID grand_parent = m_nodes[parent].parent;
+	NodeID sibling = (m_nodes[parent].left == leaf) ?
+		m_nodes[parent].right : m_nodes[parent].left;
+
+	// Replace the parent with the sibling
+	if (grand_parent != NULL_NODE) {
+		if (m_nodes[grand_parent].left == parent) {
+			m_nodes[grand_parent].left = sibling;
+		}
+		else {
+			m_nodes[grand_parent].right = sibling;
+		}
+		m_nodes[sibling].parent = grand_parent;
+		freeNode(parent);
+
+		refit(grand_parent);
+	}
+	else {
+		m_root = sibling;
+		m_nodes[sibling].parent = NULL_NODE;
+		freeNode(parent);
+	}
+}
+
+void SpatialIndex::refit(NodeID idx) noexcept
+{
+	// Walk back up the tree fixing heights and bounds
+	while (idx != NULL_NODE) {
+		idx = balance(idx);
+
+		Node& node = m_nodes[idx];
+		const Node& left = m_nodes[node.left];
+		const Node& right = m_nodes[node.right];
+
+		node.height = 1 + std::max(left.height, right.height);
+		node.aabb = left.aabb.merge(right.aabb);
+
+		idx = node.parent;
+	}
+}
+
+SpatialIndex::NodeID SpatialIndex::balance(NodeID idx_a) noexcept
+{
+	Node& a = m_nodes[idx_a];
+	if (a.isLeaf() || a.height < 2) {
+		return idx_a;
+	}
+
+	NodeID idx_b = a.left;
+	NodeID idx_c = a.right;
+	Node& b = m_nodes[idx_b];
+	Node& c = m_nodes[idx_c];
+
+	int balance_factor = c.height - b.height;
+
+	// Rotate C up
+	if (balance_factor > 1) {
+		NodeID idx_f = c.left;
+		NodeID idx_g = c.right;
+		Node& f = m_nodes[idx_f];
+		Node& g = m_nodes[idx_g];
+
+		// Swap A and C
+		c.left = idx_a;
+		c.parent = a.parent;
+		a.parent = idx_c;
+
+		// A's old parent should point to C
+		if (c.parent != NULL_NODE) {
+			if (m_nodes[c.parent].left == idx_a) {
+				m_nodes[c.parent].left = idx_c;
+			}
+			else {
+				m_nodes[c.parent].right = idx_c;
+			}
+		}
+		else {
+			m_root = idx_c;
+		}
+
+		// Keep the taller grandchild under C
+		if (f.height > g.height) {
+			c.right = idx_f;
+			a.right = idx_g;
+			g.parent = idx_a;
+			a.aabb = b.aabb.merge(g.aabb);
+			c.aabb = a.aabb.merge(f.aabb);
+
+			a.height = 1 + std::max(b.height, g.height);
+			c.height = 1 + std::max(a.height, f.height);
+		}
+		else {
+			c.right = idx_g;
+			a.right = idx_f;
+			f.parent = idx_a;
+			a.aabb = b.aabb.merge(f.aabb);
+			c.aabb = a.aabb.merge(g.aabb);
+
+			a.height = 1 + std::max(b.height, f.height);
+			c.height = 1 + std::max(a.height, g.height);
+		}
+
+		return idx_c;
+	}
+
+	// Rotate B up
+	if (balance_factor < -1) {
+		NodeID idx_d = b.left;
+		NodeID idx_e = b.right;
+		Node& d = m_nodes[idx_d];
+		Node& e = m_nodes[idx_e];
+
+		// Swap A and B
+		b.left = idx_a;
+		b.parent = a.parent;
+		a.parent = idx_b;
+
+		// A's old parent should point to B
+		if (b.parent != NULL_NODE) {
+			if (m_nodes[b.parent].left == idx_a) {
+				m_nodes[b.parent].left = idx_b;
+			}
+			else {
+				m_nodes[b.parent].right = idx_b;
+			}
+		}
+		else {
+			m_root = idx_b;
+		}
+
+		// Keep the taller grandchild under B
+		if (d.height > e.height) {
+			b.right = idx_d;
+			a.left = idx_e;
+			e.parent = idx_a;
+			a.aabb = c.aabb.merge(e.aabb);
+			b.aabb = a.aabb.merge(d.aabb);
+
+			a.height = 1 + std::max(c.height, e.height);
+			b.height = 1 + std::max(a.height, d.height);
+		}
+		else {
+			b.right = idx_e;
+			a.left = idx_d;
+			d.parent = idx_a;
+			a.aabb = c.aabb.merge(d.aabb);
+			b.aabb = a.aabb.merge(e.aabb);
+
+			a.height = 1 + std::max(c.height, d.height);
+			b.height = 1 + std::max(a.height, e.height);
+		}
+
+		return idx_b;
+	}
+
+	return idx_a;
+}
+
+};	// end of namespace
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "core/ecs/Registry.h"
+#include "physics/collisions/Colliders.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace APE {
+
+/*
+* Dynamic AABB tree over world-space entity bounds
+* Leaves store fattened bounds so small movements don't touch the tree,
+* and insertions rebalance with tree rotations to keep queries logarithmic.
+*/
+class SpatialIndex {
+public:
+	using NodeID = int32_t;
+	static constexpr NodeID NULL_NODE = -1;
+	static constexpr float DEFAULT_MARGIN = 0.1f;
+
+	struct RayHit {
+		ECS::EntityHandle ent;
+		float t;
+	};
+
+private:
+	struct Node {
+		Physics::Collisions::AABB aabb;
+		ECS::EntityHandle ent;
+		NodeID parent;
+		NodeID left;
+		NodeID right;
+		int height;
+
+		[[nodiscard]] bool isLeaf() const noexcept
+		{
+			return left == NULL_NODE;
+		}
+	};
+
+	std::vector<Node> m_nodes;
+	NodeID m_root;
+	NodeID m_free_list;
+	std::unordered_map<ECS::EntityID, NodeID> m_leaves;
+	float m_margin;
+
+public:
+	SpatialIndex(float margin = DEFAULT_MARGIN) noexcept;
+
+	/*
+	* Modification
+	*/
+	void insert(
+		ECS::EntityHandle ent,
+		const Physics::Collisions::AABB& aabb) noexcept;
+
+	// Returns true if the tree was restructured
+	bool update(
+		ECS::EntityHandle ent,
+		const Physics::Collisions::AABB& aabb) noexcept;
+
+	bool remove(ECS::EntityHandle ent) noexcept;
+
+	void clear() noexcept;
+
+	/*
+	* Queries
+	*/
+	[[nodiscard]] std::vector<ECS::EntityHandle> queryAABB(
+		const Physics::Collisions::AABB& aabb) const noexcept;
+
+	[[nodiscard]] std::vector<ECS::EntityHandle> querySphere(
+		const Physics::Collisions::Sphere& sphere) const noexcept;
+
+	[[nodiscard]] std::vector<ECS::EntityHandle> queryFrustum(
+		const Physics::Collisions::Frustum& frustum) const noexcept;
+
+	// Hits are sorted front to back by distance to their bounds
+	[[nodiscard]] std::vector<RayHit> queryRay(
+		const Physics::Collisions::Ray& ray,
+		float max_t = std::numeric_limits<float>::max()) const noexcept;
+
+	/*
+	* Inspection
+	*/
+	[[nodiscard]] bool contains(ECS::EntityHandle ent) const noexcept;
+
+	[[nodiscard]] size_t size() const noexcept;
+
+	[[nodiscard]] int height() const noexcept;
+
+	[[nodiscard]] std::vector<ECS::EntityHandle> entities() const noexcept;
+
+	[[nodiscard]] const Physics::Collisions::AABB&
+	fatBounds(ECS::EntityHandle ent) const noexcept;
+
+private:
+	using OverlapFn = std::function<bool(const Physics::Collisions::AABB&)>;
+
+	void query(
+		const OverlapFn& overlaps,
+		std::vector<ECS::EntityHandle>& out) const noexcept;
+
+	[[nodiscard]] NodeID allocateNode() noexcept;
+
+	void freeNode(NodeID node) noexcept;
+
+	void insertLeaf(NodeID leaf) noexcept;
+
+	void removeLeaf(NodeID leaf) noexcept;
+
+	void refit(NodeID node) noexcept;
+
+	[[nodiscard]] NodeID balance(NodeID a) noexcept;
+};
+
+};	// end of namespace
@@ -0,0 +1,601 @@
+#include "core/scene/WorldPartition.h"
+#include "core/scene/AssetManager.h"
+#include "core/scene/AssetLoader.h"
+#include "core/scene/Serialize.h"
+#include "util/Logger.h"
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
+namespace cereal {
+
+template <class Archive>
+void serialize(Archive& ar, APE::CellCoord& c)
+{
+	ar(
+		cereal::make_nvp("x", c.x),
+		cereal::make_nvp("z", c.z)
+	);
+}
+
+template <class Archive>
+void serialize(Archive& ar, APE::AssetDependency& dep)
+{
+	ar(
+		cereal::make_nvp("asset_key", dep.key),
+		cereal::make_nvp("asset_class", dep.asset_class)
+	);
+}
+
+template <class Archive>
+void serialize(Archive& ar, APE::WorldPartition::CellInfo& info)
+{
+	ar(
+		cereal::make_nvp("coord", info.coord),
+		cereal::make_nvp("file", info.file),
+		cereal::make_nvp("dependencies", info.dependencies)
+	);
+}
+
+};	// end of namespace
+
+
+namespace APE {
+
+namespace {
+
+using EntityRemap = std::unordered_map<ECS::EntityID, ECS::EntityHandle>;
+
+// Entities under the scene root, parents before children
+std::vector<ECS::EntityHandle> collectSubtree(
+	Scene& scene,
+	ECS::EntityHandle ent) noexcept
+{
+	std::vector<ECS::EntityHandle> res;
+	std::vector<ECS::EntityHandle> stack { ent };
+	while (!stack.empty()) {
+		ECS::EntityHandle curr = stack.back();
+		stack.pop_back();
+
+		if (!scene.registry.hasComponent<HierarchyComponent>(curr)) continue;
+		res.push_back(curr);
+
+		auto& h = scene.registry.getComponent<HierarchyComponent>(curr);
+		for (auto it = h.children.rbegin(); it != h.children.rend(); ++it) {
+			stack.push_back(*it);
+		}
+	}
+	return res;
+}
+
+template <typename Component>
+void copyComponent(
+	Scene& src,
+	Scene& dst,
+	ECS::EntityHandle src_ent,
+	ECS::EntityHandle dst_ent) noexcept
+{
+	if (!src.registry.hasComponent<Component>(src_ent)) return;
+
+	dst.registry.emplaceComponent<Component>(
+		dst_ent,
+		src.registry.getComponent<Component>(src_ent)
+	);
+}
+
+// Copy an entity whose id has already been mapped into dst
+void copyEntity(
+	Scene& src,
+	Scene& dst,
+	ECS::EntityHandle src_ent,
+	const EntityRemap& remap) noexcept
+{
+	ECS::EntityHandle dst_ent = remap.at(src_ent.id);
+
+	copyComponent<TransformComponent>(src, dst, src_ent, dst_ent);
+	copyComponent<Render::MeshComponent>(src, dst, src_ent, dst_ent);
+	copyComponent<Render::MaterialComponent>(src, dst, src_ent, dst_ent);
+	copyComponent<Render::LightComponent>(src, dst, src_ent, dst_ent);
+
+	if (!src.registry.hasComponent<HierarchyComponent>(src_ent)) return;
+
+	// Relink hierarchy, anything outside the copied set is dropped
+	HierarchyComponent h = src.registry.getComponent<HierarchyComponent>(src_ent);
+	auto par_it = remap.find(h.parent.id);
+	h.parent = (par_it != remap.end()) ?
+		par_it->second : dst.registry.tombstone();
+
+	std::vector<ECS::EntityHandle> children;
+	for (auto child : h.children) {
+		auto it = remap.find(child.id);
+		if (it != remap.end()) {
+			children.push_back(it->second);
+		}
+	}
+	h.children = std::move(children);
+
+	dst.registry.emplaceComponent<HierarchyComponent>(dst_ent, h);
+
+	if (h.parent == dst.root) {
+		auto& h_root = dst.registry.getComponent<HierarchyComponent>(dst.root);
+		h_root.children.push_back(dst_ent);
+	}
+}
+
+std::vector<AssetDependency> collectDependencies(Scene& scene) noexcept
+{
+	std::vector<AssetDependency> deps;
+	std::unordered_set<uint32_t> seen;
+
+	auto addDep = [&](AssetId id) {
+		if (!id.isValid() || !seen.insert(id.value).second) return;
+
+		AssetClass asset_class = AssetManager::classOf(id);
+		if (asset_class != AssetClass::None) {
+			deps.push_back({ AssetManager::keyOf(id), asset_class });
+		}
+	};
+
+	for (auto [ent, mesh] : scene.registry.getPool<Render::MeshComponent>()) {
+		addDep(mesh.model_id);
+	}
+	for (auto [ent, mat] : scene.registry.getPool<Render::MaterialComponent>()) {
+		addDep(mat.texture_id);
+	}
+	return deps;
+}
+
+};	// end of namespace
+
+
+WorldPartition::WorldPartition(
+	std::filesystem::path partition_dir,
+	Settings settings,
+	ThreadPool& pool) noexcept
+	: m_dir(partition_dir)
+	, m_cell_size(1.f)
+	, m_settings(settings)
+	, m_pool(pool)
+	, m_cancelled(std::make_shared<std::atomic<bool>>(false))
+{
+	APE_CHECK((m_settings.unload_radius >= m_settings.load_radius),
+		"WorldPartition() Failed: unload radius must not be less than load radius."
+	);
+
+	std::filesystem::path manifest_path = m_dir / MANIFEST_NAME;
+	std::vector<CellInfo> infos;
+	try {
+		std::ifstream is(manifest_path);
+		cereal::JSONInputArchive archive(is);
+		archive(
+			cereal::make_nvp("cell_size", m_cell_size),
+			cereal::make_nvp("cells", infos)
+		);
+	}
+	catch (const std::exception& e) {
+		APE_ERROR("WorldPartition() Failed to read {}: {}",
+			manifest_path.string(),
+			e.what()
+		);
+		return;
+	}
+
+	for (auto& info : infos) {
+		CellCoord coord = info.coord;
+		m_cells[coord].info = std::move(info);
+	}
+	APE_TRACE("WorldPartition opened {} cells.", m_cells.size());
+}
+
+WorldPartition::~WorldPartition() noexcept
+{
+	// Cell jobs hold nothing of ours, so swapping worlds doesn't wait on
+	// them. Queued ones give up, ones already parsing are dropped when done.
+	m_cancelled->store(true, std::memory_order_relaxed);
+}
+
+bool WorldPartition::build(
+	Scene& world,
+	const std::filesystem::path& partition_dir,
+	float cell_size) noexcept
+{
+	APE_CHECK((cell_size > 0.f),
+		"WorldPartition::build() Failed: cell size must be positive."
+	);
+
+	std::error_code ec;
+	std::filesystem::create_directories(partition_dir, ec);
+	if (ec) {
+		APE_ERROR("WorldPartition::build() Failed to create {}: {}",
+			partition_dir.string(),
+			ec.message()
+		);
+		return false;
+	}
+
+	// Cell files don't carry physics state, so streaming an actor with a
+	// rigid body would silently drop the body. Refuse before writing.
+	auto actors = world.registry.getComponent<HierarchyComponent>(world.root).children;
+	for (auto actor : actors) {
+		for (auto ent : collectSubtree(world, actor)) {
+			if (!world.registry.hasComponent<Physics::RigidBodyComponent>(ent)) continue;
+
+			APE_ERROR("WorldPartition::build() Failed: actor {} has a rigid body, which cells can't stream.",
+				world.registry.getComponent<HierarchyComponent>(actor).tag.view()
+			);
+			return false;
+		}
+	}
+
+	// Bucket each actor and its subtree by the cell its origin falls in
+	struct CellBuild {
+		std::unique_ptr<Scene> scene;
+		EntityRemap remap;
+	};
+	std::unordered_map<CellCoord, CellBuild, CellCoordHash> builds;
+
+	for (auto actor : actors) {
+		glm::vec3 pos = glm::vec3(world.getModelMatrix(actor)[3]);
+		CellCoord coord = cellOf(pos, cell_size);
+
+		auto& build = builds[coord];
+		if (!build.scene) {
+			build.scene = std::make_unique<Scene>();
+			build.remap[world.root.id] = build.scene->root;
+		}
+
+		auto subtree = collectSubtree(world, actor);
+		for (auto ent : subtree) {
+			build.remap[ent.id] = build.scene->registry.createEntity();
+		}
+		for (auto ent : subtree) {
+			copyEntity(world, *build.scene, ent, build.remap);
+		}
+	}
+
+	std::vector<CellInfo> infos;
+	for (auto& [coord, build] : builds) {
+		CellInfo info;
+		info.coord = coord;
+		info.file = std::format("cell_{}_{}.json", coord.x, coord.z);
+		info.dependencies = collectDependencies(*build.scene);
+
+		Serialize::saveScene(partition_dir / info.file, *build.scene);
+		infos.push_back(std::move(info));
+	}
+
+	try {
+		std::ofstream os(partition_dir / MANIFEST_NAME);
+		cereal::JSONOutputArchive archive(os);
+		archive(
+			cereal::make_nvp("cell_size", cell_size),
+			cereal::make_nvp("cells", infos)
+		);
+	}
+	catch (const std::exception& e) {
+		APE_ERROR("WorldPartition::build() Failed to write manifest: {}", e.what());
+		return false;
+	}
+
+	APE_INFO("WorldPartition::build() Wrote {} cells to {}.",
+		infos.size(),
+		partition_dir.string()
+	);
+	return true;
+}
+
+void WorldPartition::update(
+	Scene& world,
+	const std::vector<glm::vec3>& focus_points) noexcept
+{
+	auto deadline = Clock::now() +
+		std::chrono::duration_cast<Clock::duration>(m_settings.integrate_budget);
+
+	auto nearestFocus = [&](CellCoord coord) {
+		float dist = std::numeric_limits<float>::max();
+		for (auto& focus : focus_points) {
+			dist = std::min(dist, distanceToCell(focus, coord));
+		}
+		return dist;
+	};
+
+	size_t num_pending = 0;
+	for (auto& [coord, cell] : m_cells) {
+		if (cell.state == CellState::Loading) ++num_pending;
+	}
+
+	for (auto& [coord, cell] : m_cells) {
+		float dist = nearestFocus(coord);
+
+		switch (cell.state) {
+		case CellState::Unloaded:
+			if (dist <= m_settings.load_radius &&
+				num_pending < m_settings.max_pending_loads)
+			{
+				requestLoad(cell, dist);
+				++num_pending;
+			}
+			break;
+
+		case CellState::Loading:
+		{
+			auto status = cell.pending.wait_for(std::chrono::seconds(0));
+			if (status != std::future_status::ready) break;
+
+			cell.staging = cell.pending.get();
+			if (!cell.staging) {
+				fail(cell);
+				break;
+			}
+
+			// Focus moved away while parsing, drop the result
+			if (dist > m_settings.unload_radius) {
+				cell.staging.reset();
+				cell.state = CellState::Unloaded;
+				break;
+			}
+
+			beginIntegrate(world, cell);
+			break;
+		}
+
+		case CellState::Integrating:
+		case CellState::Resident:
+			if (dist > m_settings.unload_radius) {
+				unload(world, cell);
+			}
+			break;
+
+		case CellState::Failed:
+			// Files may be fixed or finish syncing, try again later, or
+			// from scratch once the focus has left
+			if (dist > m_settings.unload_radius) {
+				cell.num_failures = 0;
+				cell.state = CellState::Unloaded;
+			}
+			else if (Clock::now() >= cell.retry_at) {
+				cell.state = CellState::Unloaded;
+			}
+			break;
+		}
+	}
+
+	// Copy loaded cells in until the frame budget runs out. Each call copies
+	// at least one entity so a tiny budget can't stall streaming.
+	for (auto& [coord, cell] : m_cells) {
+		if (cell.state != CellState::Integrating) continue;
+
+		if (integrate(world, cell, deadline)) {
+			cell.num_failures = 0;
+			cell.state = CellState::Resident;
+		}
+		if (Clock::now() >= deadline) break;
+	}
+}
+
+void WorldPartition::unloadAll(Scene& world) noexcept
+{
+	for (auto& [coord, cell] : m_cells) {
+		cell.pending = {};
+		unload(world, cell);
+	}
+}
+
+CellCoord WorldPartition::cellOf(const glm::vec3& pos, float cell_size) noexcept
+{
+	return CellCoord {
+		static_cast<int>(std::floor(pos.x / cell_size)),
+		static_cast<int>(std::floor(pos.z / cell_size))
+	};
+}
+
+CellCoord WorldPartition::cellOf(const glm::vec3& pos) const noexcept
+{
+	return cellOf(pos, m_cell_size);
+}
+
+float WorldPartition::distanceToCell(
+	const glm::vec3& pos,
+	CellCoord coord) const noexcept
+{
+	glm::vec2 cell_min(coord.x * m_cell_size, coord.z * m_cell_size);
+	glm::vec2 cell_max = cell_min + glm::vec2(m_cell_size);
+
+	glm::vec2 p(pos.x, pos.z);
+	glm::vec2 closest = glm::clamp(p, cell_min, cell_max);
+	return glm::length(p - closest);
+}
+
+WorldPartition::CellState WorldPartition::state(CellCoord coord) const noexcept
+{
+	auto it = m_cells.find(coord);
+	if (it == m_cells.end()) {
+		return CellState::Unloaded;
+	}
+	return it->second.state;
+}
+
+const std::vector<AssetDependency>&
+WorldPartition::dependencies(CellCoord coord) const noexcept
+{
+	static const std::vector<AssetDependency> s_empty;
+
+	auto it = m_cells.find(coord);
+	if (it == m_cells.end()) {
+		return s_empty;
+	}
+	return it->second.info.dependencies;
+}
+
+size_t WorldPartition::numCells() const noexcept
+{
+	return m_cells.size();
+}
+
+size_t WorldPartition::numResident() const noexcept
+{
+	return std::count_if(m_cells.begin(), m_cells.end(), [](auto& entry) {
+		return entry.second.state == CellState::Resident;
+	});
+}
+
+float WorldPartition::cellSize() const noexcept
+{
+	return m_cell_size;
+}
+
+const WorldPartition::Settings& WorldPartition::settings() const noexcept
+{
+	return m_settings;
+}
+
+void WorldPartition::setSettings(const Settings& settings) noexcept
+{
+	APE_CHECK((settings.unload_radius >= settings.load_radius),
+		"WorldPartition::setSettings() Failed: unload radius must not be less than load radius."
+	);
+	m_settings = settings;
+}
+
+void WorldPartition::requestLoad(Cell& cell, float distance) noexcept
+{
+	std::filesystem::path cell_path = m_dir / cell.info.file;
+
+	// Cells nearest the focus points get the first free worker
+	cell.pending = m_pool.submit([cell_path, cancelled = m_cancelled]() {
+		if (cancelled->load(std::memory_order_relaxed)) return std::unique_ptr<Scene>();
+		return loadCell(cell_path);
+	}, AssetManager::distancePriority(distance));
+	cell.state = CellState::Loading;
+}
+
+void WorldPartition::fail(Cell& cell) noexcept
+{
+	auto delay = m_settings.retry_delay * std::pow(2.0, std::min(cell.num_failures, 16u));
+	delay = std::min(delay, m_settings.max_retry_delay);
+	++cell.num_failures;
+
+	cell.retry_at = Clock::now() + std::chrono::duration_cast<Clock::duration>(delay);
+	cell.state = CellState::Failed;
+	APE_WARN("WorldPartition: cell {} {} failed to load, retrying in {:.1f}s.",
+		cell.info.coord.x,
+		cell.info.coord.z,
+		delay.count() / 1000.0
+	);
+}
+
+void WorldPartition::beginIntegrate(Scene& world, Cell& cell) noexcept
+{
+	Scene& staging = *cell.staging;
+
+	// Only what hangs off the cell's root, skipping the root itself
+	cell.staging_ents.clear();
+	auto& h_root = staging.registry.getComponent<HierarchyComponent>(staging.root);
+	for (auto actor : h_root.children) {
+		auto subtree = collectSubtree(staging, actor);
+		cell.staging_ents.insert(
+			cell.staging_ents.end(),
+			subtree.begin(),
+			subtree.end()
+		);
+	}
+
+	// Reserve ids up front so hierarchy links resolve in any copy order
+	cell.remap.clear();
+	cell.remap[staging.root.id] = world.root;
+	cell.world_ents.clear();
+	cell.world_ents.reserve(cell.staging_ents.size());
+	for (auto ent : cell.staging_ents) {
+		ECS::EntityHandle world_ent = world.registry.createEntity();
+		cell.remap[ent.id] = world_ent;
+		cell.world_ents.push_back(world_ent);
+	}
+
+	cell.cursor = 0;
+	cell.state = CellState::Integrating;
+}
+
+bool WorldPartition::integrate(
+	Scene& world,
+	Cell& cell,
+	Clock::time_point deadline) noexcept
+{
+	Scene& staging = *cell.staging;
+	while (cell.cursor < cell.staging_ents.size()) {
+		ECS::EntityHandle staging_ent = cell.staging_ents[cell.cursor];
+		copyEntity(staging, world, staging_ent, cell.remap);
+
+		ECS::EntityHandle world_ent = cell.remap.at(staging_ent.id);
+		(void)world.addWorldBounds(world_ent);
+		world.markDirty(world_ent);
+		++cell.cursor;
+
+		if (Clock::now() >= deadline) break;
+	}
+
+	if (cell.cursor < cell.staging_ents.size()) {
+		return false;
+	}
+
+	cell.staging.reset();
+	cell.staging_ents.clear();
+	cell.remap.clear();
+	return true;
+}
+
+void WorldPartition::unload(Scene& world, Cell& cell) noexcept
+{
+	if (cell.world_ents.empty() && !cell.staging) {
+		cell.state = CellState::Unloaded;
+		return;
+	}
+
+	// Detach the cell's actors from the world root before destroying
+	auto& h_root = world.registry.getComponent<HierarchyComponent>(world.root);
+	std::unordered_set<ECS::EntityID> owned;
+	for (auto ent : cell.world_ents) {
+		owned.insert(ent.id);
+	}
+	std::erase_if(h_root.children, [&](ECS::EntityHandle child) {
+		return owned.contains(child.id);
+	});
+
+	for (auto ent : cell.world_ents) {
+		world.destroyEntity(ent);
+	}
+
+	cell.world_ents.clear();
+	cell.staging.reset();
+	cell.staging_ents.clear();
+	cell.remap.clear();
+	cell.cursor = 0;
+	cell.state = CellState::Unloaded;
+}
+
+std::unique_ptr<Scene> WorldPartition::loadCell(const std::filesystem::path& cell_path) noexcept
+{
+	try {
+		// Scene loading resolves the cell's assets as one parallel batch
+		auto cell = std::make_unique<Scene>();
+		Serialize::loadScene(cell_path, *cell);
+		return cell;
+	}
+	catch (const std::exception& e) {
+		APE_ERROR("WorldPartition::loadCell() Failed to load {}: {}",
+			cell_path.string(),
+			e.what()
+		);
+		return nullptr;
+	}
+}
+
+};	// end of namespace
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "core/ecs/Registry.h"
+#include "core/scene/AssetHandle.h"
+#include "core/scene/Scene.h"
+#include "util/ThreadPool.h"
+#include "util/Timing.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace APE {
+
+struct CellCoord {
+	int x;
+	int z;
+
+	bool operator==(const CellCoord& other) const noexcept
+	{
+		return x == other.x && z == other.z;
+	}
+
+	bool operator!=(const CellCoord& other) const noexcept
+	{
+		return !(*this == other);
+	}
+};
+
+struct CellCoordHash {
+	size_t operator()(const CellCoord& c) const noexcept
+	{
+		size_t hx = std::hash<int>()(c.x);
+		size_t hz = std::hash<int>()(c.z);
+		return hx ^ (hz + 0x9e3779b9 + (hx << 6) + (hx >> 2));
+	}
+};
+
+struct AssetDependency {
+	AssetKey key;
+	AssetClass asset_class;
+};
+
+struct PartitionSettings {
+	// Cells closer than this to any focus point are loaded
+	float load_radius = 64.f;
+
+	// Cells are only unloaded once all focus points are past this,
+	// the gap to load_radius stops cells thrashing on a boundary
+	float unload_radius = 96.f;
+
+	// Main thread time per frame spent copying loaded cells in
+	Timing::millis integrate_budget { 2.0 };
+
+	// Cells being parsed in the background at once
+	size_t max_pending_loads = 4;
+
+	// Wait before reloading a cell that failed, doubled on each failure in
+	// a row up to max_retry_delay. Leaving the cell resets it.
+	Timing::millis retry_delay { 1000.0 };
+	Timing::millis max_retry_delay { 30000.0 };
+};
+
+/*
+* Splits a scene into a grid of cells on the XZ plane and streams them
+* around focus points. Each cell is its own scene file with the assets it
+* needs listed in the partition manifest. Cells are parsed on worker threads
+* and copied into the world on the main thread under a time budget.
+*/
+class WorldPartition {
+public:
+	static constexpr const char* MANIFEST_NAME = "partition.json";
+
+	using Settings = PartitionSettings;
+
+	enum class CellState {
+		Unloaded = 0,
+		Loading,
+		Integrating,
+		Resident,
+		Failed,
+	};
+
+	struct CellInfo {
+		CellCoord coord;
+		std::filesystem::path file;
+		std::vector<AssetDependency> dependencies;
+	};
+
+private:
+	struct Cell {
+		CellInfo info;
+		CellState state = CellState::Unloaded;
+
+		// Background parse of the cell file
+		std::future<std::unique_ptr<Scene>> pending;
+
+		// Integration progress
+		std::unique_ptr<Scene> staging;
+		std::vector<ECS::EntityHandle> staging_ents;
+		std::unordered_map<ECS::EntityID, ECS::EntityHandle> remap;
+		size_t cursor = 0;
+
+		// Entities this cell owns in the world
+		std::vector<ECS::EntityHandle> world_ents;
+
+		// Failed cells go back to Unloaded once this passes
+		uint32_t num_failures = 0;
+		std::chrono::steady_clock::time_point retry_at;
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	std::filesystem::path m_dir;
+	float m_cell_size;
+	Settings m_settings;
+	ThreadPool& m_pool;
+	std::unordered_map<CellCoord, Cell, CellCoordHash> m_cells;
+
+	// Set on destruction, cell loads still queued then skip the parse
+	std::shared_ptr<std::atomic<bool>> m_cancelled;
+
+public:
+	WorldPartition(
+		std::filesystem::path partition_dir,
+		Settings settings = {},
+		ThreadPool& pool = ThreadPool::global()) noexcept;
+
+	~WorldPartition() noexcept;
+
+	WorldPartition(const WorldPartition& other) = delete;
+	WorldPartition& operator=(const WorldPartition& other) = delete;
+
+	// Split the root level actors of a scene into cell files plus a manifest.
+	// Fails without writing anything if an actor has a rigid body.
+	static bool build(
+		Scene& world,
+		const std::filesystem::path& partition_dir,
+		float cell_size) noexcept;
+
+	// Stream cells in and out around the focus points
+	void update(
+		Scene& world,
+		const std::vector<glm::vec3>& focus_points) noexcept;
+
+	// Remove every streamed entity from the world, loads in flight are
+	// left to finish on their own and their results dropped
+	void unloadAll(Scene& world) noexcept;
+
+	/*
+	* Inspection
+	*/
+	[[nodiscard]] static CellCoord cellOf(
+		const glm::vec3& pos,
+		float cell_size) noexcept;
+
+	[[nodiscard]] CellCoord cellOf(const glm::vec3& pos) const noexcept;
+
+	// Distance on the XZ plane from a point to the edge of a cell
+	[[nodiscard]] float distanceToCell(
+		const glm::vec3& pos,
+		CellCoord coord) const noexcept;
+
+	[[nodiscard]] CellState state(CellCoord coord) const noexcept;
+
+	[[nodiscard]] const std::vector<AssetDependency>&
+	dependencies(CellCoord coord) const noexcept;
+
+	[[nodiscard]] size_t numCells() const noexcept;
+
+	[[nodiscard]] size_t numResident() const noexcept;
+
+	[[nodiscard]] float cellSize() const noexcept;
+
+	[[nodiscard]] const Settings& settings() const noexcept;
+
+	void setSettings(const Settings& settings) noexcept;
+
+private:
+	void requestLoad(Cell& cell, float distance) noexcept;
+
+	void fail(Cell& cell) noexcept;
+
+	void beginIntegrate(Scene& world, Cell& cell) noexcept;
+
+	// Returns true once every entity in the cell has been copied
+	bool integrate(
+		Scene& world,
+		Cell& cell,
+		Clock::time_point deadline) noexcept;
+
+	void unload(Scene& world, Cell& cell) noexcept;
+
+	[[nodiscard]] static std::unique_ptr<Scene> loadCell(
+		const std::filesystem::path& cell_path) noexcept;
+};
+
+};	// end of namespace
@@ -32,11 +32,12 @@ void EditorLayer::setup() noexcept
 	// auto car = Engine::world().addModel(car_model_handle);
 	// Engine::world().addRigidBody(car, car_model_handle);
 	
+	// The import runs in the background, shapes appear once it is done
 	std::vector<AssetHandle<Render::Model>> models;
-	// models.push_back(ModelLoader::load(CUBE_PATH));
-	// models.push_back(ModelLoader::load(SPHERE_PATH));
-	models.push_back(ModelLoader::load(CONE_PATH));
-	// models.push_back(ModelLoader::load(CYLINDER_PATH));
+	// models.push_back(ModelLoader::loadAsync(CUBE_PATH));
+	// models.push_back(ModelLoader::loadAsync(SPHERE_PATH));
+	models.push_back(ModelLoader::loadAsync(CONE_PATH));
+	// models.push_back(ModelLoader::loadAsync(CYLINDER_PATH));
 
 	// TransformComponent transform {};
 	// auto model_handle = ModelLoader::load(CONE_PATH);
@@ -45,19 +46,23 @@ void EditorLayer::setup() noexcept
 
 	constexpr int NUM_SHAPES = 10;
 	int sqrt = std::sqrt(NUM_SHAPES);
-	if (!models.empty()) {
-		for (int i = 0; i < NUM_SHAPES; ++i) {
-			auto& model_handle = models[i % models.size()];
-
-			int row = i % sqrt;
-			int col = i / sqrt;
-			TransformComponent transform {};
-			transform.position.x = (row - (sqrt / 2.f)) * 5;
-			transform.position.z = (col - (sqrt / 2.f)) * 5;
-
-			auto obj = Engine::world().addModel(model_handle, transform);
-			Engine::world().addRigidBody(obj, model_handle);
-		}
+	for (int i = 0; i < NUM_SHAPES; ++i) {
+		if (models.empty()) break;
+
+		int row = i % sqrt;
+		int col = i / sqrt;
+		TransformComponent transform {};
+		transform.position.x = (row - (sqrt / 2.f)) * 5;
+		transform.position.z = (col - (sqrt / 2.f)) * 5;
+
+		models[i % models.size()].onComplete(
+			[transform](const AssetHandle<Render::Model>& model_handle) {
+				if (!model_handle.isReady()) return;
+
+				auto obj = Engine::world().addModel(model_handle, transform);
+				Engine::world().addRigidBody(obj, model_handle);
+			}
+		);
 	}
 
 
@@ -88,11 +93,11 @@ void EditorLayer::update() noexcept
 
 	// Save
 	if (input.isKeyDown(SDLK_P) && input.isFirstFramePressed(SDLK_P)) {
-		Engine::saveScene("demos/test.json", Engine::world());
+		Engine::saveSceneAsync("demos/test.json");
 	}
 	// Load
 	if (input.isKeyDown(SDLK_L) && input.isFirstFramePressed(SDLK_L)) {
-		Engine::loadScene("demos/test.json", Engine::world());
+		Engine::loadSceneAsync("demos/test.json");
 	}
 
 	// Camera Movement
@@ -146,6 +151,7 @@ void EditorLayer::update() noexcept
 	for (auto [ent, transform, rbd] : view.each()) {
 		transform.position = rbd.get().pos;
 		transform.rotation = rbd.get().orientation;
+		Engine::world().markDirty(ent);
 	}
 }
 
@@ -198,12 +204,28 @@ void EditorLayer::handleMouseButtonEvent(SDL_MouseButtonEvent m_button) noexcept
 		glm::normalize(world_coords - cam->getPosition())
 	);
 
-	// Check for collision with scene models
+	// Broadphase against world bounds, candidates come back front to back
+	auto& world = Engine::world();
+	auto candidates = world.spatial.queryRay(ray);
+
 	float t_best = std::numeric_limits<float>::max();
-	auto view = Engine::world().registry.view<Physics::RigidBodyComponent, TransformComponent>();
-	for (auto [ent, rbd, transform] : view.each()) {
+	glm::vec3 hit_best {};
+	ECS::EntityHandle ent_best {};
+	for (auto [ent, t_bounds] : candidates) {
+		// Remaining candidates can't be closer than the best hit
+		if (t_bounds > t_best) break;
+
+		// Only rigid bodies are pickable
+		if (!world.registry.hasComponent<Physics::RigidBodyComponent>(ent)) {
+			continue;
+		}
+
+		auto [rbd, transform] = world.registry.getComponents<
+			Physics::RigidBodyComponent, TransformComponent>(ent);
+
 		// Transform ray into rbd's model space
-		glm::mat4 inv_model_mat = glm::inverse(transform.getModelMatrix());
+		glm::mat4 model_mat = world.getModelMatrix(ent);
+		glm::mat4 inv_model_mat = glm::inverse(model_mat);
 		Physics::Collisions::Ray ray_local(
 			glm::vec3(inv_model_mat * glm::vec4(ray.pos, 1.f)),
 			glm::normalize(glm::vec3(inv_model_mat * glm::vec4(ray.dir, 0.f)))
@@ -225,18 +247,26 @@ void EditorLayer::handleMouseButtonEvent(SDL_MouseButtonEvent m_button) noexcept
 
 		if (b_collides) {
 			APE_TRACE("HIT");
-			if (t < t_best) {
-				selected_ent = ent;
-				t_best = t;
 
-				// Apply force to selected object
-				float newtons = 1.f;
-				glm::vec3 force = newtons * glm::normalize(ray.dir);
-				glm::vec3 force_pos = ray.eval(t);
-				rbd.get().addForce(force, force_pos);
+			// Compare hits in world space
+			glm::vec3 hit = glm::vec3(model_mat * glm::vec4(ray_local.eval(t), 1.f));
+			float t_world = glm::length(hit - ray.pos);
+			if (t_world < t_best) {
+				selected_ent = ent;
+				ent_best = ent;
+				t_best = t_world;
+				hit_best = hit;
 			}
 		}
 	}
+
+	// Apply force to selected object
+	if (world.spatial.contains(ent_best)) {
+		auto& rbd = world.registry.getComponent<Physics::RigidBodyComponent>(ent_best);
+		float newtons = 1.f;
+		glm::vec3 force = newtons * glm::normalize(ray.dir);
+		rbd.get().addForce(force, hit_best);
+	}
 }
 
 void EditorLayer::drawAABB(
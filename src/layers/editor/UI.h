@@ -41,7 +41,7 @@ static inline void drawDebugPanel(
 				Files::Status status = 
 					Files::openDialog(path);
 				if (status == Files::Status::Sucess) {
-					Engine::loadScene(path, world);
+					Engine::loadSceneAsync(path);
 				}
 			}
 			if (ImGui::MenuItem("Save As")) 
@@ -50,7 +50,7 @@ static inline void drawDebugPanel(
 				Files::Status status = 
 					Files::openDialog(path);
 				if (status == Files::Status::Sucess) {
-					Engine::saveScene(path, world);
+					Engine::saveSceneAsync(path);
 				}
 			}
 
@@ -60,6 +60,21 @@ static inline void drawDebugPanel(
 		ImGui::EndMenuBar();
 	}
 
+	if (Engine::isLoadingScene()) {
+		auto& progress = Engine::sceneLoadProgress();
+		ImGui::Text("Loading scene (%zu assets)", progress.assets_loaded.load());
+		ImGui::ProgressBar(progress.fraction());
+	}
+
+	auto& save_metrics = Engine::sceneSaveMetrics();
+	if (save_metrics.saves_completed > 0) {
+		ImGui::Text("Last save: %zu bytes, snapshot %.2fms, write %.2fms%s",
+			save_metrics.last_bytes_written.load(),
+			save_metrics.last_snapshot_ms.load(),
+			save_metrics.last_write_ms.load(),
+			Engine::isSavingScene() ? " (saving)" : ""
+		);
+	}
 
 	ImGui::Text("Camera");
 	auto cam = Engine::getCamera().lock();
@@ -124,12 +139,12 @@ static inline void drawSceneHierarchyPanel(
 
 	// Draw a button for each entity in the hierarchy
 	// with padding to visualize nesting
-	using EntityWithPad = std::tuple<ECS::EntityHandle, std::string, float>;
+	using EntityWithPad = std::tuple<ECS::EntityHandle, StringId, float>;
 	std::vector<EntityWithPad> draw_list;
 
 	// DFS over world entities
 	std::vector<EntityWithPad> stack;
-	stack.push_back({ world.root, "", 0.f });
+	stack.push_back({ world.root, {}, 0.f });
 	ImVec2 button_sz { 0.f, 0.f };
 	while (!stack.empty()) {
 		auto [ent, x, pad] = stack.back();
@@ -138,36 +153,35 @@ static inline void drawSceneHierarchyPanel(
 		auto& hierarchy = 
 			world.registry.getComponent<HierarchyComponent>(ent);
 
-		// Create a unique tag for each entity, indented past its parent
-		auto padded_tag = std::format(
-			"{}###{}",
-			hierarchy.tag.c_str(),
-			ent.id
-		);
-		ImVec2 pad_sz { ImGui::CalcTextSize(padded_tag.c_str()) };
+		// Size buttons to fit the widest tag
+		ImVec2 tag_sz { ImGui::CalcTextSize(hierarchy.tag.c_str()) };
 		button_sz = { 
-			std::max(button_sz.x, pad_sz.x),
-			std::max(button_sz.y, pad_sz.y) 
+			std::max(button_sz.x, tag_sz.x),
+			std::max(button_sz.y, tag_sz.y) 
 		};
-		draw_list.emplace_back(ent, padded_tag, pad);
+		draw_list.emplace_back(ent, hierarchy.tag, pad);
 
 		// Add padded children
 		float child_pad = pad + 1;
 		for (auto child : hierarchy.children) {
 			if (world.registry.hasComponent<HierarchyComponent>(child)) {
-				stack.push_back({ child, "", child_pad  });
+				stack.push_back({ child, {}, child_pad  });
 			}
 		}
 	}
 
-	// Draw a button to select each entity
-	for (auto [ent, padded_tag, pad] : draw_list) {
+	// Draw a button to select each entity, indented past its parent
+	// Scope each button by its entity id so duplicate tags stay unique
+	for (auto [ent, tag, pad] : draw_list) {
 		ImVec2 cursor_pos = ImGui::GetCursorPos();
 		float cursor_offset = pad * button_sz.x;
 		ImGui::SetCursorPos({ cursor_pos.x + cursor_offset, cursor_pos.y });
-		if (ImGui::Button(padded_tag.c_str(), { button_sz.x, 2*button_sz.y })) {
+
+		ImGui::PushID(static_cast<int>(ent.id));
+		if (ImGui::Button(tag.c_str(), { button_sz.x, 2*button_sz.y })) {
 			selected_ent = ent;
 		}
+		ImGui::PopID();
 	}
 
 	ImGui::End();
@@ -186,9 +200,12 @@ static inline void drawManipulatorPanel(
 			world.registry.getComponent<HierarchyComponent>(ent);
 
 		char buf[128];
-		strncpy(buf, hierarchy.tag.c_str(), sizeof(buf));
-		if (ImGui::InputText("Entity Tag", buf, sizeof(buf))) {
-			hierarchy.tag = buf;
+		strncpy(buf, hierarchy.tag.c_str(), sizeof(buf) - 1);
+		buf[sizeof(buf) - 1] = '\0';
+		// Tags are interned for good, so only take the text once Enter
+		// commits it rather than on every keystroke
+		if (ImGui::InputText("Entity Tag", buf, sizeof(buf), ImGuiInputTextFlags_EnterReturnsTrue)) {
+			hierarchy.tag = StringId(buf);
 		}
 
 		std::string children = 
@@ -224,17 +241,20 @@ static inline void drawManipulatorPanel(
 			&scale[0]
 		);
 		
-		ImGui::InputFloat3("Translate", &translate[0]);
-		ImGui::InputFloat3("Rotate", &rotate[0]);
-		ImGui::InputFloat3("Scale", &scale[0]);
-
-		ImGuizmo::RecomposeMatrixFromComponents(
-			&translate[0],
-			&rotate[0],
-			&scale[0],
-			&matrix[0][0]
-		);
-		transform = TransformComponent::fromMatrix(matrix);
+		bool b_edited = ImGui::InputFloat3("Translate", &translate[0]);
+		b_edited |= ImGui::InputFloat3("Rotate", &rotate[0]);
+		b_edited |= ImGui::InputFloat3("Scale", &scale[0]);
+
+		if (b_edited) {
+			ImGuizmo::RecomposeMatrixFromComponents(
+				&translate[0],
+				&rotate[0],
+				&scale[0],
+				&matrix[0][0]
+			);
+			transform = TransformComponent::fromMatrix(matrix);
+			world.markDirty(ent);
+		}
 	}
 
 	// Material
@@ -243,11 +263,12 @@ static inline void drawManipulatorPanel(
 			std::filesystem::path tex_path;
 			auto status = Files::openDialog(tex_path);
 			if (status == Files::Status::Sucess) {
-				auto tex_handle = ImageLoader::load(tex_path);
+				// Shows the checkerboard until the texture is decoded
+				auto tex_handle = ImageLoader::loadAsync(tex_path);
 				world.registry.replaceComponent<
 					Render::MaterialComponent>(
 						ent,
-						tex_handle
+						tex_handle.id
 					);
 			}
 		}
@@ -281,7 +302,7 @@ static inline void drawGizmo(
 
 		auto view = cam->getViewMatrix();
 		auto proj = cam->getProjectionMatrix(Engine::context()->getAspectRatio());
-		ImGuizmo::Manipulate(
+		bool b_moved = ImGuizmo::Manipulate(
 			glm::value_ptr(view),
 			glm::value_ptr(proj),
 			gizmo_op,
@@ -311,9 +332,10 @@ static inline void drawGizmo(
 			!vec_equal(new_transform.scale, transform.scale) &&
 			(!vec_equal(new_transform.position, transform.position) ||
 			!quat_equal(new_transform.rotation, transform.rotation));
-		if (!b_degenerate)
+		if (b_moved && !b_degenerate)
 		{
 			transform = new_transform;
+			world.markDirty(ent);
 		}
 	}
 }
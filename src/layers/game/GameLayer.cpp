@@ -17,20 +17,34 @@ void GameLayer::update() noexcept
 void GameLayer::draw() noexcept
 {
 	auto& world = Engine::world();
-
-	auto view = world.registry.view<
-		Render::MeshComponent,
-		Render::MaterialComponent,
-		TransformComponent,
-		HierarchyComponent>();
-
-	for (auto [ent, mesh, material, transform, hierarchy] : view.each()) {
-		glm::mat4 model_mat = world.getModelMatrix(ent);
+	auto cam = Engine::getCamera().lock();
+
+	// Only draw meshes whose bounds touch the view frustum
+	glm::mat4 view_proj = 
+		cam->getProjectionMatrix(Engine::context()->getAspectRatio()) * 
+		cam->getViewMatrix();
+	auto frustum = Physics::Collisions::Frustum::fromMatrix(view_proj);
+
+	for (auto ent : world.spatial.queryFrustum(frustum)) {
+		if (!world.registry.hasAllComponents<
+			Render::MeshComponent,
+			Render::MaterialComponent,
+			WorldBoundsComponent>(ent))
+		{
+			continue;
+		}
+
+		auto [mesh, material, bounds] = world.registry.getComponents<
+			Render::MeshComponent,
+			Render::MaterialComponent,
+			WorldBoundsComponent>(ent);
+
+		// World matrix was cached when the bounds were refreshed
 		Engine::renderer()->draw(
 			mesh,
 			material,
 			Engine::getCamera(),
-			model_mat
+			bounds.world_mat
 		);
 	}
 }
@@ -16,6 +16,9 @@ struct RigidBody {
 	float inv_mass;
 	float restitution;
 	glm::mat3 moment;
+	// Scaled by mass in inertiaTensorLocal(), a 1x1x1 box unless set from
+	// the shape's mass properties
+	glm::mat3 inertia_per_mass = glm::mat3(1.f / 6.f);
 
 	// Impulses
 	glm::vec3 forces;
@@ -61,19 +64,7 @@ struct RigidBody {
 		float mass = 0;
 		if (inv_mass != 0) mass = 1.f / inv_mass;
 
-		// Hard coded for 1x1x1 box
-		float w = 1;
-		float h = 1;
-		float d = 1;
-		float ix = (1.f / 12) * mass * (h*h + d*d);
-		float iy = (1.f / 12) * mass * (w*w + d*d);
-		float iz = (1.f / 12) * mass * (w*w + h*h);
-		glm::mat3 local_tensor(
-			ix, 0,  0,
-			0,  iy, 0,
-			0,  0,  iz
-		);
-		return local_tensor;
+		return inertia_per_mass * mass;
 	}
 
 	[[nodiscard]] glm::mat3 inertiaTensorWorld() const noexcept
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 
+#include <array>
+
 namespace APE::Physics::Collisions {
 
 enum class ColliderType {
@@ -44,6 +46,83 @@ struct AABB : public Collider {
 	{
 		return (max - min) * 0.5f;
 	}
+
+	[[nodiscard]] float surfaceArea() const noexcept
+	{
+		glm::vec3 d = max - min;
+		return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	[[nodiscard]] bool contains(const AABB& other) const noexcept
+	{
+		return min.x <= other.min.x && min.y <= other.min.y &&
+			min.z <= other.min.z && max.x >= other.max.x &&
+			max.y >= other.max.y && max.z >= other.max.z;
+	}
+
+	[[nodiscard]] AABB merge(const AABB& other) const noexcept
+	{
+		return AABB(glm::min(min, other.min), glm::max(max, other.max));
+	}
+
+	[[nodiscard]] AABB expand(float margin) const noexcept
+	{
+		return AABB(min - glm::vec3(margin), max + glm::vec3(margin));
+	}
+};
+
+struct Sphere {
+	glm::vec3 center;
+	float radius;
+
+	Sphere(const glm::vec3& center = glm::vec3(0), float radius = 0.f) noexcept
+		: center(center)
+		, radius(radius)
+	{
+
+	}
+};
+
+/*
+* View frustum as six inward-facing planes (xyz = normal, w = distance)
+*/
+struct Frustum {
+	enum Side { Left = 0, Right, Bottom, Top, Near, Far, Size };
+
+	std::array<glm::vec4, Side::Size> planes;
+
+	Frustum() noexcept
+		: planes({})
+	{
+
+	}
+
+	// Extract planes from a combined projection * view matrix
+	//
+	[[nodiscard]] static Frustum fromMatrix(const glm::mat4& view_proj) noexcept
+	{
+		auto row = [&](int i) {
+			return glm::vec4(
+				view_proj[0][i],
+				view_proj[1][i],
+				view_proj[2][i],
+				view_proj[3][i]
+			);
+		};
+
+		Frustum f;
+		f.planes[Left] = row(3) + row(0);
+		f.planes[Right] = row(3) - row(0);
+		f.planes[Bottom] = row(3) + row(1);
+		f.planes[Top] = row(3) - row(1);
+		f.planes[Near] = row(3) + row(2);
+		f.planes[Far] = row(3) - row(2);
+
+		for (auto& plane : f.planes) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+		return f;
+	}
 };
 
 struct Ray {
@@ -162,5 +162,51 @@ bool intersects(const AABB& box, const Ray& raycast) noexcept
 	return t >= 0;
 }
 
-};	// end of namespace
+bool overlaps(const AABB& a, const AABB& b) noexcept
+{
+	return (a.min.x <= b.max.x && a.max.x >= b.min.x) &&
+		(a.min.y <= b.max.y && a.max.y >= b.min.y) &&
+		(a.min.z <= b.max.z && a.max.z >= b.min.z);
+}
+
+bool intersects(const AABB& box, const Sphere& sphere) noexcept
+{
+	glm::vec3 closest = glm::clamp(sphere.center, box.min, box.max);
+	return glm::length2(closest - sphere.center) <= 
+		sphere.radius * sphere.radius;
+}
+
+bool intersects(const Frustum& frustum, const AABB& box) noexcept
+{
+	// Test the box corner furthest along each plane normal
+	for (auto& plane : frustum.planes) {
+		glm::vec3 normal(plane);
+		glm::vec3 p_vertex {
+			normal.x >= 0 ? box.max.x : box.min.x,
+			normal.y >= 0 ? box.max.y : box.min.y,
+			normal.z >= 0 ? box.max.z : box.min.z
+		};
+
+		if (glm::dot(normal, p_vertex) + plane.w < 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+AABB transformAABB(const AABB& box, const glm::mat4& transform) noexcept
+{
+	// Arvo's method, the world extents are the local extents
+	// projected onto the absolute value of the rotation/scale basis
+	glm::vec3 center = glm::vec3(transform * glm::vec4(box.center(), 1.f));
 
+	glm::mat3 abs_basis(transform);
+	for (int i = 0; i < 3; ++i) {
+		abs_basis[i] = glm::abs(abs_basis[i]);
+	}
+	glm::vec3 extents = abs_basis * box.extents();
+
+	return AABB(center - extents, center + extents);
+}
+
+};	// end of namespace
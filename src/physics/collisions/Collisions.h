@@ -38,5 +38,13 @@ float getIntersectDist(const AABB& box, const Ray& raycast) noexcept;
 
 bool intersects(const AABB& box, const Ray& raycast) noexcept;
 
+bool overlaps(const AABB& a, const AABB& b) noexcept;
+
+bool intersects(const AABB& box, const Sphere& sphere) noexcept;
+
+bool intersects(const Frustum& frustum, const AABB& box) noexcept;
+
+AABB transformAABB(const AABB& box, const glm::mat4& transform) noexcept;
+
 };	// end of namespace
 
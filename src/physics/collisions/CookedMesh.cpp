@@ -0,0 +1,111 @@
+#include "physics/collisions/CookedMesh.h"
+
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace APE::Physics::Collisions {
+
+namespace {
+
+// Open meshes and planes enclose next to nothing relative to their bounds
+constexpr float MIN_VOLUME_FRACTION = 1e-4f;
+
+[[nodiscard]] glm::mat3 outer(const glm::vec3& a, const glm::vec3& b) noexcept
+{
+	glm::mat3 m(0.f);
+	for (int col = 0; col < 3; ++col) {
+		for (int row = 0; row < 3; ++row) {
+			m[col][row] = a[row] * b[col];
+		}
+	}
+	return m;
+}
+
+// Inertia from the second moment, I = trace(C) * 1 - C
+[[nodiscard]] glm::mat3 inertiaFromCovariance(const glm::mat3& c) noexcept
+{
+	float trace = c[0][0] + c[1][1] + c[2][2];
+	return glm::mat3(trace) - c;
+}
+
+[[nodiscard]] MassProperties boxProperties(const AABB& bounds) noexcept
+{
+	glm::vec3 size = bounds.max - bounds.min;
+	float volume = size.x * size.y * size.z;
+
+	MassProperties props;
+	props.volume = volume;
+	props.center_of_mass = bounds.center();
+	props.inertia = glm::mat3(0.f);
+	props.inertia[0][0] = volume * (size.y * size.y + size.z * size.z) / 12.f;
+	props.inertia[1][1] = volume * (size.x * size.x + size.z * size.z) / 12.f;
+	props.inertia[2][2] = volume * (size.x * size.x + size.y * size.y) / 12.f;
+	props.b_from_bounds = true;
+	return props;
+}
+
+};	// end of namespace
+
+MassProperties massProperties(
+	std::span<const Triangle> triangles,
+	const AABB& bounds) noexcept
+{
+	// Sums over tetrahedra (0, v0, v1, v2), each weighted by its signed
+	// volume, det / 6. The covariance of the canonical tetrahedron is
+	// (1 + identity) / 120, mapped by the matrix of the three corners.
+	double volume = 0.0;
+	glm::dvec3 weighted_center(0.0);
+	glm::mat3 covariance(0.f);
+	for (auto& tri : triangles) {
+		float det = glm::dot(tri.v0, glm::cross(tri.v1, tri.v2));
+		glm::vec3 sum = tri.v0 + tri.v1 + tri.v2;
+
+		volume += det / 6.0;
+		weighted_center += glm::dvec3(sum * (det / 24.f));
+
+		glm::mat3 c = outer(tri.v0, tri.v0) + outer(tri.v1, tri.v1) +
+			outer(tri.v2, tri.v2) + outer(sum, sum);
+		covariance = covariance + c * (det / 120.f);
+	}
+
+	glm::vec3 size = bounds.max - bounds.min;
+	float box_volume = size.x * size.y * size.z;
+	if (!(std::abs(volume) > box_volume * MIN_VOLUME_FRACTION)) {
+		return boxProperties(bounds);
+	}
+
+	// Inward facing triangles give everything a negative sign
+	float sign = volume < 0.0 ? -1.f : 1.f;
+
+	MassProperties props;
+	props.volume = static_cast<float>(std::abs(volume));
+	props.center_of_mass = glm::vec3(weighted_center / volume);
+
+	// Move the second moment from the origin to the center of mass
+	glm::vec3 com = props.center_of_mass;
+	glm::mat3 c_com = covariance * sign - outer(com, com) * props.volume;
+	props.inertia = inertiaFromCovariance(c_com);
+	return props;
+}
+
+CookedMesh cook(std::vector<Triangle> triangles, int bvh_depth) noexcept
+{
+	CookedMesh cooked;
+	if (!triangles.empty()) {
+		glm::vec3 min_bounds(std::numeric_limits<float>::max());
+		glm::vec3 max_bounds(-std::numeric_limits<float>::max());
+		for (auto& tri : triangles) {
+			min_bounds = glm::min(min_bounds, glm::min(tri.v0, glm::min(tri.v1, tri.v2)));
+			max_bounds = glm::max(max_bounds, glm::max(tri.v0, glm::max(tri.v1, tri.v2)));
+		}
+		cooked.bounds = AABB(min_bounds, max_bounds);
+	}
+
+	cooked.mass = massProperties(triangles, cooked.bounds);
+	cooked.bvh = BVH(triangles, bvh_depth);
+	cooked.triangles = std::move(triangles);
+	return cooked;
+}
+
+};	// end of namespace
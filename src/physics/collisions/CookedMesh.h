@@ -0,0 +1,42 @@
+#pragma once
+
+#include "physics/collisions/BVH.h"
+#include "physics/collisions/Colliders.h"
+
+#include <glm/glm.hpp>
+
+#include <span>
+#include <vector>
+
+namespace APE::Physics::Collisions {
+
+// Solid at unit density, in the space the triangles were given in
+struct MassProperties {
+	float volume = 0.f;
+	glm::vec3 center_of_mass = glm::vec3(0.f);
+	// About the center of mass, divide by volume for the tensor per unit mass
+	glm::mat3 inertia = glm::mat3(0.f);
+	// Set when the triangles don't enclose a volume and the bounds stood in
+	bool b_from_bounds = false;
+};
+
+/*
+* Collision data cooked from a mesh
+* Built once per asset and shared read only by every body using it, bodies
+* still get colliders of their own since those are moved every step.
+*/
+struct CookedMesh {
+	std::vector<Triangle> triangles;
+	AABB bounds;
+	BVH bvh;
+	MassProperties mass;
+};
+
+// Signed tetrahedra against the origin, closed meshes with either winding
+[[nodiscard]] MassProperties massProperties(
+	std::span<const Triangle> triangles,
+	const AABB& bounds) noexcept;
+
+[[nodiscard]] CookedMesh cook(std::vector<Triangle> triangles, int bvh_depth = 3) noexcept;
+
+};	// end of namespace
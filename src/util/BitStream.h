@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace APE {
+
+/*
+* Zigzag maps signed values to unsigned so small magnitudes stay small
+*/
+[[nodiscard]] constexpr uint64_t zigzagEncode(int64_t val) noexcept
+{
+	return (static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63);
+}
+
+[[nodiscard]] constexpr int64_t zigzagDecode(uint64_t val) noexcept
+{
+	return static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1);
+}
+
+
+/*
+* Bit granular writer, LSB first within each byte
+*/
+class BitWriter {
+private:
+	std::vector<std::byte> m_bytes;
+	uint64_t m_scratch;
+	uint32_t m_scratch_bits;
+
+public:
+	BitWriter() noexcept
+		: m_scratch(0)
+		, m_scratch_bits(0)
+	{
+
+	}
+
+	void writeBits(uint64_t val, uint32_t num_bits) noexcept
+	{
+		while (num_bits > 0) {
+			uint32_t take = std::min(num_bits, 64 - m_scratch_bits);
+			uint64_t mask = (take == 64) ? ~0ull : ((1ull << take) - 1);
+
+			m_scratch |= (val & mask) << m_scratch_bits;
+			m_scratch_bits += take;
+			val = (take == 64) ? 0 : (val >> take);
+			num_bits -= take;
+
+			while (m_scratch_bits >= 8) {
+				m_bytes.push_back(static_cast<std::byte>(m_scratch & 0xFF));
+				m_scratch >>= 8;
+				m_scratch_bits -= 8;
+			}
+		}
+	}
+
+	void writeBool(bool b) noexcept
+	{
+		writeBits(b ? 1 : 0, 1);
+	}
+
+	// 7 bit groups with a continuation bit
+	void writeVarint(uint64_t val) noexcept
+	{
+		while (val >= 0x80) {
+			writeBits((val & 0x7F) | 0x80, 8);
+			val >>= 7;
+		}
+		writeBits(val, 8);
+	}
+
+	void writeSignedVarint(int64_t val) noexcept
+	{
+		writeVarint(zigzagEncode(val));
+	}
+
+	void writeFloat(float f) noexcept
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &f, sizeof(bits));
+		writeBits(bits, 32);
+	}
+
+	void writeString(std::string_view str) noexcept
+	{
+		writeVarint(str.size());
+		for (char c : str) {
+			writeBits(static_cast<uint8_t>(c), 8);
+		}
+	}
+
+	[[nodiscard]] size_t bitsWritten() const noexcept
+	{
+		return m_bytes.size() * 8 + m_scratch_bits;
+	}
+
+	// Pads the final partial byte with zeros
+	[[nodiscard]] std::vector<std::byte> finish() noexcept
+	{
+		if (m_scratch_bits > 0) {
+			m_bytes.push_back(static_cast<std::byte>(m_scratch & 0xFF));
+			m_scratch = 0;
+			m_scratch_bits = 0;
+		}
+		return std::move(m_bytes);
+	}
+};
+
+
+/*
+* Reader for BitWriter output. Reading past the end yields zeros and
+* sets overflowed(), so callers can check once after parsing.
+*/
+class BitReader {
+private:
+	std::span<const std::byte> m_bytes;
+	size_t m_bit_pos;
+	bool m_overflow;
+
+public:
+	BitReader(std::span<const std::byte> bytes) noexcept
+		: m_bytes(bytes)
+		, m_bit_pos(0)
+		, m_overflow(false)
+	{
+
+	}
+
+	[[nodiscard]] uint64_t readBits(uint32_t num_bits) noexcept
+	{
+		if (m_bit_pos + num_bits > m_bytes.size() * 8) {
+			m_overflow = true;
+			m_bit_pos = m_bytes.size() * 8;
+			return 0;
+		}
+
+		uint64_t val = 0;
+		for (uint32_t written = 0; written < num_bits; ) {
+			size_t byte_idx = m_bit_pos / 8;
+			uint32_t bit_off = m_bit_pos % 8;
+			uint32_t take = std::min(num_bits - written, 8 - bit_off);
+
+			uint64_t bits = static_cast<uint8_t>(m_bytes[byte_idx]) >> bit_off;
+			bits &= (1ull << take) - 1;
+			val |= bits << written;
+
+			written += take;
+			m_bit_pos += take;
+		}
+		return val;
+	}
+
+	[[nodiscard]] bool readBool() noexcept
+	{
+		return readBits(1) != 0;
+	}
+
+	[[nodiscard]] uint64_t readVarint() noexcept
+	{
+		uint64_t val = 0;
+		for (uint32_t shift = 0; shift < 64; shift += 7) {
+			uint64_t group = readBits(8);
+			val |= (group & 0x7F) << shift;
+			if ((group & 0x80) == 0 || m_overflow) break;
+		}
+		return val;
+	}
+
+	[[nodiscard]] int64_t readSignedVarint() noexcept
+	{
+		return zigzagDecode(readVarint());
+	}
+
+	[[nodiscard]] float readFloat() noexcept
+	{
+		uint32_t bits = static_cast<uint32_t>(readBits(32));
+		float f;
+		std::memcpy(&f, &bits, sizeof(f));
+		return f;
+	}
+
+	[[nodiscard]] std::string readString() noexcept
+	{
+		uint64_t size = readVarint();
+		if (size > remainingBits() / 8) {
+			m_overflow = true;
+			return {};
+		}
+
+		std::string str(size, '\0');
+		for (auto& c : str) {
+			c = static_cast<char>(readBits(8));
+		}
+		return str;
+	}
+
+	[[nodiscard]] size_t remainingBits() const noexcept
+	{
+		return m_bytes.size() * 8 - m_bit_pos;
+	}
+
+	[[nodiscard]] bool overflowed() const noexcept
+	{
+		return m_overflow;
+	}
+};
+
+};	// end of namespace
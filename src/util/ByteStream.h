@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace APE {
+
+/*
+* Growable buffer for the engine's binary file formats
+*/
+class ByteWriter {
+private:
+	std::vector<std::byte> m_buf;
+
+public:
+	[[nodiscard]] size_t pos() const noexcept
+	{
+		return m_buf.size();
+	}
+
+	[[nodiscard]] const std::vector<std::byte>& buffer() const noexcept
+	{
+		return m_buf;
+	}
+
+	void writeBytes(const void* data, size_t num_bytes) noexcept
+	{
+		auto* bytes = static_cast<const std::byte*>(data);
+		m_buf.insert(m_buf.end(), bytes, bytes + num_bytes);
+	}
+
+	template <typename T>
+	void write(const T& val) noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		writeBytes(&val, sizeof(T));
+	}
+
+	template <typename T>
+	void writeArray(const std::vector<T>& vals) noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		writeBytes(vals.data(), vals.size() * sizeof(T));
+	}
+
+	void align(size_t alignment) noexcept
+	{
+		size_t padded = (m_buf.size() + alignment - 1) / alignment * alignment;
+		m_buf.resize(padded, std::byte { 0 });
+	}
+
+	template <typename T>
+	void patch(size_t offset, const T& val) noexcept
+	{
+		std::memcpy(m_buf.data() + offset, &val, sizeof(T));
+	}
+};
+
+/*
+* Deduplicated string table, strings are referred to by index
+*/
+class StringTableBuilder {
+private:
+	std::vector<std::string_view> m_strings;
+	std::unordered_map<std::string_view, uint32_t> m_lookup;
+	std::deque<std::string> m_owned;
+
+public:
+	// Views must outlive the builder unless copied in with own(),
+	// owned strings live in a deque so their views stay valid
+	uint32_t add(std::string_view str) noexcept
+	{
+		auto it = m_lookup.find(str);
+		if (it != m_lookup.end()) {
+			return it->second;
+		}
+
+		uint32_t idx = static_cast<uint32_t>(m_strings.size());
+		m_strings.push_back(str);
+		m_lookup.emplace(str, idx);
+		return idx;
+	}
+
+	uint32_t own(std::string str) noexcept
+	{
+		auto it = m_lookup.find(str);
+		if (it != m_lookup.end()) {
+			return it->second;
+		}
+
+		m_owned.push_back(std::move(str));
+		return add(m_owned.back());
+	}
+
+	[[nodiscard]] const std::vector<std::string_view>& strings() const noexcept
+	{
+		return m_strings;
+	}
+};
+
+/*
+* Bounds checked cursor over bytes in place, usually a MappedFile
+*/
+class ByteReader {
+private:
+	const std::byte* m_data;
+	size_t m_size;
+	size_t m_pos;
+
+public:
+	ByteReader(const std::byte* data, size_t size) noexcept
+		: m_data(data)
+		, m_size(size)
+		, m_pos(0)
+	{
+
+	}
+
+	// Pointer to count elements in place, null if out of bounds or misaligned
+	template <typename T>
+	[[nodiscard]] const T* array(size_t count) noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		size_t num_bytes = count * sizeof(T);
+		if (count > m_size || m_pos + num_bytes > m_size) return nullptr;
+
+		const std::byte* ptr = m_data + m_pos;
+		if (reinterpret_cast<uintptr_t>(ptr) % alignof(T) != 0) return nullptr;
+
+		m_pos += num_bytes;
+		return reinterpret_cast<const T*>(ptr);
+	}
+
+	void align(size_t alignment) noexcept
+	{
+		m_pos = (m_pos + alignment - 1) / alignment * alignment;
+	}
+};
+
+};	// end of namespace
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "util/Hash.h"
+#include "util/MappedFile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <system_error>
+
+namespace APE::Hash {
+
+/*
+* Hash of a file's bytes for derived data caches, never 0
+*/
+[[nodiscard]] inline uint64_t contents(std::span<const std::byte> bytes) noexcept
+{
+	// Mix in the size so an empty file doesn't hash to the offset basis
+	uint64_t hash = fnv1a(bytes.data(), bytes.size());
+	hash = fnv1a(&hash, sizeof(hash), bytes.size());
+	return (hash != 0) ? hash : 1;
+}
+
+// 0 if the file can't be read
+[[nodiscard]] inline uint64_t fileContents(const std::filesystem::path& path) noexcept
+{
+	std::error_code ec;
+	if (!std::filesystem::is_regular_file(path, ec)) return 0;
+
+	MappedFile file(path);
+	if (!file.isOpen()) return 0;
+
+	return contents(file.bytes());
+}
+
+// Size and modification time of a file, all 0 if it is missing. Caches
+// record it next to a source's hash and trust the hash while it matches.
+struct FileStamp {
+	uint64_t size = 0;
+	int64_t mtime = 0;
+
+	bool operator==(const FileStamp& other) const noexcept = default;
+};
+
+[[nodiscard]] inline FileStamp fileStamp(const std::filesystem::path& path) noexcept
+{
+	std::error_code ec;
+	auto size = std::filesystem::file_size(path, ec);
+	if (ec) return {};
+	auto mtime = std::filesystem::last_write_time(path, ec);
+	if (ec) return {};
+
+	return FileStamp {
+		.size = static_cast<uint64_t>(size),
+		.mtime = static_cast<int64_t>(mtime.time_since_epoch().count()),
+	};
+}
+
+};	// end of namespace
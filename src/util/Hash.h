@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace APE::Hash {
+
+/*
+* FNV-1a, usable at compile time for tags and file format ids
+*/
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+[[nodiscard]] constexpr uint64_t fnv1a(
+	std::string_view str,
+	uint64_t hash = FNV_OFFSET) noexcept
+{
+	for (char c : str) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+[[nodiscard]] inline uint64_t fnv1a(
+	const void* data,
+	size_t num_bytes,
+	uint64_t hash = FNV_OFFSET) noexcept
+{
+	auto* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < num_bytes; ++i) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+};	// end of namespace
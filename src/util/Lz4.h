@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace APE::Lz4 {
+
+/*
+* LZ4 block format, greedy single probe compressor
+* Trades ratio for a decoder that is little more than memcpy, which is what
+* matters for data packed once and read on every launch. Blocks are
+* compatible with LZ4_decompress_safe.
+*/
+namespace detail {
+
+constexpr size_t MIN_MATCH = 4;
+// The format ends every block on at least this many literals
+constexpr size_t LAST_LITERALS = 5;
+// and the last match starts at least this far from the end
+constexpr size_t MATCH_FIND_LIMIT = 12;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 16;
+constexpr uint32_t NO_POS = 0xFFFFFFFF;
+
+[[nodiscard]] inline uint32_t read32(const std::byte* ptr) noexcept
+{
+	uint32_t val;
+	std::memcpy(&val, ptr, sizeof(val));
+	return val;
+}
+
+[[nodiscard]] inline uint32_t hash(uint32_t seq) noexcept
+{
+	return (seq * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Lengths past the token's 4 bits continue in bytes of 255
+inline void writeLength(std::vector<std::byte>& out, size_t length) noexcept
+{
+	for (; length >= 255; length -= 255) out.push_back(std::byte { 255 });
+	out.push_back(static_cast<std::byte>(length));
+}
+
+[[nodiscard]] inline bool readLength(
+	std::span<const std::byte> in,
+	size_t& pos,
+	size_t& length) noexcept
+{
+	uint8_t byte;
+	do {
+		if (pos >= in.size()) return false;
+		byte = static_cast<uint8_t>(in[pos++]);
+		length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+inline void writeSequence(
+	std::vector<std::byte>& out,
+	const std::byte* literals,
+	size_t num_literals,
+	size_t offset,
+	size_t match_length) noexcept
+{
+	size_t match_code = match_length - MIN_MATCH;
+	uint8_t token = static_cast<uint8_t>(
+		(std::min<size_t>(num_literals, 15) << 4) | std::min<size_t>(match_code, 15)
+	);
+	out.push_back(static_cast<std::byte>(token));
+	if (num_literals >= 15) writeLength(out, num_literals - 15);
+	out.insert(out.end(), literals, literals + num_literals);
+
+	out.push_back(static_cast<std::byte>(offset & 0xFF));
+	out.push_back(static_cast<std::byte>(offset >> 8));
+	if (match_code >= 15) writeLength(out, match_code - 15);
+}
+
+};	// end of namespace
+
+[[nodiscard]] inline std::vector<std::byte> compress(std::span<const std::byte> in) noexcept
+{
+	using namespace detail;
+
+	std::vector<std::byte> out;
+	out.reserve(in.size() + in.size() / 255 + 16);
+
+	const std::byte* src = in.data();
+	size_t size = in.size();
+	size_t anchor = 0;
+
+	if (size > MATCH_FIND_LIMIT) {
+		std::vector<uint32_t> table(size_t(1) << HASH_BITS, NO_POS);
+		size_t match_limit = size - LAST_LITERALS;
+
+		size_t pos = 0;
+		while (pos < size - MATCH_FIND_LIMIT) {
+			uint32_t seq = read32(src + pos);
+			uint32_t& slot = table[hash(seq)];
+			size_t candidate = slot;
+			slot = static_cast<uint32_t>(pos);
+
+			if (candidate == NO_POS ||
+				pos - candidate > MAX_OFFSET ||
+				read32(src + candidate) != seq)
+			{
+				++pos;
+				continue;
+			}
+
+			size_t length = MIN_MATCH;
+			while (pos + length < match_limit && src[candidate + length] == src[pos + length]) {
+				++length;
+			}
+
+			writeSequence(out, src + anchor, pos - anchor, pos - candidate, length);
+			pos += length;
+			anchor = pos;
+		}
+	}
+
+	// Trailing literals, a token with no match
+	size_t num_literals = size - anchor;
+	out.push_back(static_cast<std::byte>(std::min<size_t>(num_literals, 15) << 4));
+	if (num_literals >= 15) writeLength(out, num_literals - 15);
+	out.insert(out.end(), src + anchor, src + size);
+	return out;
+}
+
+// False if the block is corrupt or doesn't decode to exactly out.size() bytes
+[[nodiscard]] inline bool decompress(
+	std::span<const std::byte> in,
+	std::span<std::byte> out) noexcept
+{
+	using namespace detail;
+
+	size_t ip = 0;
+	size_t op = 0;
+	while (ip < in.size()) {
+		uint8_t token = static_cast<uint8_t>(in[ip++]);
+
+		size_t num_literals = token >> 4;
+		if (num_literals == 15 && !readLength(in, ip, num_literals)) return false;
+		if (num_literals > in.size() - ip || num_literals > out.size() - op) return false;
+
+		std::memcpy(out.data() + op, in.data() + ip, num_literals);
+		ip += num_literals;
+		op += num_literals;
+
+		// The last sequence has no match
+		if (ip == in.size()) break;
+
+		if (in.size() - ip < 2) return false;
+		size_t offset = static_cast<size_t>(in[ip]) | (static_cast<size_t>(in[ip + 1]) << 8);
+		ip += 2;
+		if (offset == 0 || offset > op) return false;
+
+		size_t length = token & 15;
+		if (length == 15 && !readLength(in, ip, length)) return false;
+		length += MIN_MATCH;
+		if (length > out.size() - op) return false;
+
+		// Matches may overlap their own output, copy forwards byte by byte
+		std::byte* dst = out.data() + op;
+		const std::byte* match = dst - offset;
+		for (size_t i = 0; i < length; ++i) dst[i] = match[i];
+		op += length;
+	}
+	return op == out.size();
+}
+
+};	// end of namespace
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "util/Logger.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace APE {
+
+/*
+* Read-only memory mapping of a whole file
+* The OS pages data in on demand, so nothing is copied until it's touched.
+*/
+class MappedFile {
+private:
+	const std::byte* m_data;
+	size_t m_size;
+
+#ifdef _WIN32
+	HANDLE m_file;
+	HANDLE m_mapping;
+#else
+	int m_fd;
+#endif
+
+public:
+	MappedFile() noexcept
+		: m_data(nullptr)
+		, m_size(0)
+#ifdef _WIN32
+		, m_file(INVALID_HANDLE_VALUE)
+		, m_mapping(nullptr)
+#else
+		, m_fd(-1)
+#endif
+	{
+
+	}
+
+	MappedFile(const std::filesystem::path& path) noexcept
+		: MappedFile()
+	{
+		open(path);
+	}
+
+	~MappedFile() noexcept
+	{
+		close();
+	}
+
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile& operator=(const MappedFile& other) = delete;
+
+	MappedFile(MappedFile&& other) noexcept
+		: MappedFile()
+	{
+		swap(other);
+	}
+
+	MappedFile& operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other) {
+			close();
+			swap(other);
+		}
+		return *this;
+	}
+
+	bool open(const std::filesystem::path& path) noexcept
+	{
+		close();
+
+#ifdef _WIN32
+		m_file = CreateFileW(
+			path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+		);
+		if (m_file == INVALID_HANDLE_VALUE) {
+			APE_ERROR("MappedFile::open() Failed to open {}.", path.string());
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_file, &size)) {
+			close();
+			return false;
+		}
+		m_size = static_cast<size_t>(size.QuadPart);
+		if (m_size == 0) return true;
+
+		m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping == nullptr) {
+			APE_ERROR("MappedFile::open() Failed to map {}.", path.string());
+			close();
+			return false;
+		}
+		m_data = static_cast<const std::byte*>(
+			MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)
+		);
+#else
+		m_fd = ::open(path.c_str(), O_RDONLY);
+		if (m_fd < 0) {
+			APE_ERROR("MappedFile::open() Failed to open {}.", path.string());
+			return false;
+		}
+
+		struct stat st;
+		if (fstat(m_fd, &st) != 0) {
+			close();
+			return false;
+		}
+		m_size = static_cast<size_t>(st.st_size);
+		if (m_size == 0) return true;
+
+		void* addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+		if (addr == MAP_FAILED) {
+			APE_ERROR("MappedFile::open() Failed to map {}.", path.string());
+			close();
+			return false;
+		}
+		m_data = static_cast<const std::byte*>(addr);
+
+		// Loaders read front to back
+		madvise(addr, m_size, MADV_SEQUENTIAL);
+#endif
+
+		if (m_data == nullptr) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void close() noexcept
+	{
+#ifdef _WIN32
+		if (m_data) UnmapViewOfFile(m_data);
+		if (m_mapping) CloseHandle(m_mapping);
+		if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+		m_mapping = nullptr;
+		m_file = INVALID_HANDLE_VALUE;
+#else
+		if (m_data) munmap(const_cast<std::byte*>(m_data), m_size);
+		if (m_fd >= 0) ::close(m_fd);
+		m_fd = -1;
+#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	[[nodiscard]] bool isOpen() const noexcept
+	{
+#ifdef _WIN32
+		return m_file != INVALID_HANDLE_VALUE;
+#else
+		return m_fd >= 0;
+#endif
+	}
+
+	[[nodiscard]] const std::byte* data() const noexcept
+	{
+		return m_data;
+	}
+
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_size;
+	}
+
+	[[nodiscard]] std::span<const std::byte> bytes() const noexcept
+	{
+		return { m_data, m_size };
+	}
+
+private:
+	void swap(MappedFile& other) noexcept
+	{
+		std::swap(m_data, other.m_data);
+		std::swap(m_size, other.m_size);
+#ifdef _WIN32
+		std::swap(m_file, other.m_file);
+		std::swap(m_mapping, other.m_mapping);
+#else
+		std::swap(m_fd, other.m_fd);
+#endif
+	}
+};
+
+};	// end of namespace
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace APE {
+
+/*
+* Global interning table backing StringId
+* Strings are copied once into arena blocks and never freed, so the views
+* handed out stay valid for the life of the process.
+*/
+class StringTable {
+public:
+	using Index = uint32_t;
+
+	// Index 0 is reserved for the empty string
+	static constexpr Index EMPTY = 0;
+
+private:
+	static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+	std::vector<std::unique_ptr<char[]>> m_blocks;
+	size_t m_block_used;
+	size_t m_block_capacity;
+
+	std::vector<std::string_view> m_strings;
+	std::unordered_map<std::string_view, Index> m_lookup;
+	mutable std::shared_mutex m_mutex;
+
+	StringTable() noexcept
+		: m_block_used(0)
+		, m_block_capacity(0)
+	{
+		m_strings.emplace_back("");
+		m_lookup.emplace(m_strings.back(), EMPTY);
+	}
+
+public:
+	StringTable(const StringTable& other) = delete;
+	StringTable& operator=(const StringTable& other) = delete;
+
+	[[nodiscard]] static StringTable& instance() noexcept
+	{
+		static StringTable s_table;
+		return s_table;
+	}
+
+	[[nodiscard]] Index intern(std::string_view str) noexcept
+	{
+		if (str.empty()) return EMPTY;
+
+		// Fast path, string has already been interned
+		{
+			std::shared_lock lock(m_mutex);
+			auto it = m_lookup.find(str);
+			if (it != m_lookup.end()) {
+				return it->second;
+			}
+		}
+
+		std::unique_lock lock(m_mutex);
+
+		// Another thread may have interned the string while unlocked
+		auto it = m_lookup.find(str);
+		if (it != m_lookup.end()) {
+			return it->second;
+		}
+
+		std::string_view stored = store(str);
+		Index idx = static_cast<Index>(m_strings.size());
+		m_strings.push_back(stored);
+		m_lookup.emplace(stored, idx);
+		return idx;
+	}
+
+	[[nodiscard]] std::string_view resolve(Index idx) const noexcept
+	{
+		std::shared_lock lock(m_mutex);
+		if (idx >= m_strings.size()) {
+			return m_strings[EMPTY];
+		}
+		return m_strings[idx];
+	}
+
+	[[nodiscard]] size_t size() const noexcept
+	{
+		std::shared_lock lock(m_mutex);
+		return m_strings.size();
+	}
+
+private:
+	// Copy string into the arena with a null terminator for C APIs
+	[[nodiscard]] std::string_view store(std::string_view str) noexcept
+	{
+		size_t num_bytes = str.size() + 1;
+		if (m_block_used + num_bytes > m_block_capacity) {
+			size_t block_size = std::max(BLOCK_SIZE, num_bytes);
+			m_blocks.emplace_back(std::make_unique<char[]>(block_size));
+			m_block_used = 0;
+			m_block_capacity = block_size;
+		}
+
+		char* dst = m_blocks.back().get() + m_block_used;
+		std::memcpy(dst, str.data(), str.size());
+		dst[str.size()] = '\0';
+		m_block_used += num_bytes;
+
+		return std::string_view(dst, str.size());
+	}
+};
+
+/*
+* Handle to an interned string
+* Cheap to copy, compare and hash. Resolve to text only when needed.
+*/
+struct StringId {
+	StringTable::Index idx;
+
+	StringId() noexcept
+		: idx(StringTable::EMPTY)
+	{ }
+
+	StringId(std::string_view str) noexcept
+		: idx(StringTable::instance().intern(str))
+	{ }
+
+	StringId(const char* str) noexcept
+		: StringId(std::string_view(str))
+	{ }
+
+	StringId(const std::string& str) noexcept
+		: StringId(std::string_view(str))
+	{ }
+
+	[[nodiscard]] std::string_view view() const noexcept
+	{
+		return StringTable::instance().resolve(idx);
+	}
+
+	// Arena strings are null terminated
+	[[nodiscard]] const char* c_str() const noexcept
+	{
+		return view().data();
+	}
+
+	[[nodiscard]] std::string str() const
+	{
+		return std::string(view());
+	}
+
+	[[nodiscard]] bool empty() const noexcept
+	{
+		return idx == StringTable::EMPTY;
+	}
+
+	bool operator==(const StringId& other) const noexcept
+	{
+		return idx == other.idx;
+	}
+
+	bool operator!=(const StringId& other) const noexcept
+	{
+		return idx != other.idx;
+	}
+};
+
+};	// end of namespace
+
+
+template <>
+struct std::hash<APE::StringId> {
+	size_t operator()(const APE::StringId& id) const noexcept
+	{
+		return std::hash<APE::StringTable::Index>()(id.idx);
+	}
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace APE {
+
+/*
+* Fixed size pool of worker threads draining a shared job queue
+* Higher priority jobs run first, equal priorities run in submission order.
+*/
+class ThreadPool {
+private:
+	struct Job {
+		int priority;
+		uint64_t seq;
+		std::function<void()> run;
+	};
+
+	// Heap ordering, the top is the highest priority, oldest job
+	struct JobOrder {
+		bool operator()(const Job& a, const Job& b) const noexcept
+		{
+			if (a.priority != b.priority) return a.priority < b.priority;
+			return a.seq > b.seq;
+		}
+	};
+
+	std::vector<std::thread> m_workers;
+	std::vector<Job> m_jobs;
+	uint64_t m_next_seq;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_stop;
+
+public:
+	ThreadPool(size_t num_threads = defaultThreadCount()) noexcept
+		: m_next_seq(0)
+		, m_stop(false)
+	{
+		num_threads = std::max<size_t>(num_threads, 1);
+		for (size_t i = 0; i < num_threads; ++i) {
+			m_workers.emplace_back([this]() { workerLoop(); });
+		}
+	}
+
+	~ThreadPool() noexcept
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stop = true;
+		}
+		m_cv.notify_all();
+
+		// Workers finish queued jobs before exiting
+		for (auto& worker : m_workers) {
+			worker.join();
+		}
+	}
+
+	ThreadPool(const ThreadPool& other) = delete;
+	ThreadPool& operator=(const ThreadPool& other) = delete;
+
+	// Shared pool for engine background work
+	[[nodiscard]] static ThreadPool& global() noexcept
+	{
+		static ThreadPool s_pool;
+		return s_pool;
+	}
+
+	[[nodiscard]] static size_t defaultThreadCount() noexcept
+	{
+		// Leave a core for the main thread
+		size_t num_cores = std::thread::hardware_concurrency();
+		return (num_cores > 1) ? num_cores - 1 : 1;
+	}
+
+	template <typename F>
+	[[nodiscard]] auto submit(F&& f, int priority = 0) -> std::future<std::invoke_result_t<F>>
+	{
+		using Result = std::invoke_result_t<F>;
+
+		auto task = std::make_shared<std::packaged_task<Result()>>(
+			std::forward<F>(f)
+		);
+		std::future<Result> res = task->get_future();
+		{
+			std::lock_guard lock(m_mutex);
+			m_jobs.push_back(Job {
+				.priority = priority,
+				.seq = m_next_seq++,
+				.run = [task]() { (*task)(); },
+			});
+			std::push_heap(m_jobs.begin(), m_jobs.end(), JobOrder {});
+		}
+		m_cv.notify_one();
+		return res;
+	}
+
+	// Runs fn(i) for every i in [0, count) and blocks until all are done.
+	// The caller works through indices too, so this is safe to call from a
+	// job already running on this pool.
+	template <typename F>
+	void parallelFor(size_t count, F&& fn) noexcept
+	{
+		if (count == 0) return;
+
+		struct Shared {
+			std::atomic<size_t> next = 0;
+			std::atomic<size_t> done = 0;
+			std::mutex mutex;
+			std::condition_variable cv;
+		};
+		auto shared = std::make_shared<Shared>();
+
+		// Helpers that start after every index is claimed never touch fn
+		auto* fn_ptr = &fn;
+		auto drain = [shared, fn_ptr, count]() {
+			for (size_t i = shared->next++; i < count; i = shared->next++) {
+				(*fn_ptr)(i);
+				if (++shared->done == count) {
+					std::lock_guard lock(shared->mutex);
+					shared->cv.notify_all();
+				}
+			}
+		};
+
+		size_t num_helpers = std::min(size(), count - 1);
+		for (size_t i = 0; i < num_helpers; ++i) {
+			(void)submit(drain);
+		}
+
+		drain();
+		std::unique_lock lock(shared->mutex);
+		shared->cv.wait(lock, [&]() { return shared->done == count; });
+	}
+
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_workers.size();
+	}
+
+private:
+	void workerLoop() noexcept
+	{
+		while (true) {
+			std::function<void()> job;
+			{
+				std::unique_lock lock(m_mutex);
+				m_cv.wait(lock, [this]() {
+					return m_stop || !m_jobs.empty();
+				});
+
+				if (m_stop && m_jobs.empty()) return;
+
+				std::pop_heap(m_jobs.begin(), m_jobs.end(), JobOrder {});
+				job = std::move(m_jobs.back().run);
+				m_jobs.pop_back();
+			}
+			job();
+		}
+	}
+};
+
+};	// end of namespace
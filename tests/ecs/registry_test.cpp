@@ -698,3 +698,33 @@ TEST_F(RegistryTest, ModifyComponentFromViewEach)
 		<< "Entity e1 should have Position x-coord of 5.";
 }
 
+
+
+/*
+ * Snapshots
+*/
+TEST_F(RegistryTest, CopyFromOnlyCopiesListedPools)
+{
+	auto e1 = r.createEntity();
+	auto e2 = r.createEntity();
+	r.emplaceComponent<PosComp>(e1, 1, 2, 3);
+	r.emplaceComponent<NameComp>(e1, "first", "last");
+	r.emplaceComponent<PosComp>(e2, 4, 5, 6);
+
+	Registry snapshot;
+	snapshot.copyFrom<PosComp>(r);
+
+	EXPECT_EQ(snapshot.numEntities(), 2)
+		<< "Snapshot should have every entity.";
+	EXPECT_EQ(snapshot.getComponent<PosComp>(e2), (PosComp { 4, 5, 6 }))
+		<< "Snapshot should copy listed pools.";
+	EXPECT_FALSE(snapshot.hasComponent<NameComp>(e1))
+		<< "Snapshot should not copy unlisted pools.";
+
+	r.getComponent<PosComp>(e1).x = 10;
+	r.destroyEntity(e2);
+	EXPECT_EQ(snapshot.getComponent<PosComp>(e1).x, 1)
+		<< "Snapshot should not see later changes.";
+	EXPECT_TRUE(snapshot.isValid(e2))
+		<< "Snapshot should keep destroyed entities.";
+}
@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+
+#include "core/io/AsyncFile.h"
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace APE;
+
+class AsyncFileTest : public testing::Test {
+protected:
+	std::filesystem::path dir;
+
+	void SetUp() override
+	{
+		dir = std::filesystem::temp_directory_path() / "async_file_test";
+		std::filesystem::create_directories(dir);
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove_all(dir);
+	}
+
+	std::filesystem::path writeFile(const std::string& name, const std::string& text)
+	{
+		std::filesystem::path path = dir / name;
+		std::ofstream os(path, std::ios::binary | std::ios::trunc);
+		os << text;
+		return path;
+	}
+
+	// Both backends, io_uring falls back where the kernel has none
+	[[nodiscard]] static std::vector<std::unique_ptr<IO::Service>> services()
+	{
+		std::vector<std::unique_ptr<IO::Service>> result;
+		result.push_back(std::make_unique<IO::Service>(IO::Service::Backend::IoUring));
+		result.push_back(std::make_unique<IO::Service>(IO::Service::Backend::ThreadPool));
+		return result;
+	}
+
+	[[nodiscard]] static std::string text(const std::vector<std::byte>& bytes)
+	{
+		return std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	}
+};
+
+namespace {
+
+IO::Task<IO::ReadResult> readOne(IO::Service& service, std::filesystem::path path)
+{
+	co_return co_await service.readFile(std::move(path));
+}
+
+IO::Task<std::vector<IO::ReadResult>> readMany(IO::Service& service, std::vector<std::filesystem::path> paths)
+{
+	co_return co_await service.readFiles(std::move(paths));
+}
+
+// Awaits another task, then reads into the caller's memory
+IO::Task<size_t> readNested(IO::Service& service, std::filesystem::path path, std::span<std::byte> target)
+{
+	auto whole = co_await readOne(service, path);
+	auto part = co_await service.readInto(path, target, 2, 0);
+	co_return whole.bytes.size() + part.num_bytes;
+}
+
+};	// end of namespace
+
+TEST_F(AsyncFileTest, ReadsWholeFiles)
+{
+	std::string big(3 * 1024 * 1024 + 17, 'x');
+	for (size_t i = 0; i < big.size(); i += 4099) big[i] = static_cast<char>('a' + i % 26);
+
+	auto small_path = writeFile("small.txt", "hello");
+	auto big_path = writeFile("big.bin", big);
+	auto empty_path = writeFile("empty.txt", "");
+
+	for (auto& service : services()) {
+		auto small = readOne(*service, small_path).get();
+		EXPECT_TRUE(small);
+		EXPECT_EQ(text(small.bytes), "hello");
+		EXPECT_EQ(small.num_bytes, 5u);
+
+		auto large = readOne(*service, big_path).get();
+		EXPECT_TRUE(large);
+		EXPECT_EQ(text(large.bytes), big);
+
+		auto empty = readOne(*service, empty_path).get();
+		EXPECT_TRUE(empty);
+		EXPECT_TRUE(empty.bytes.empty());
+
+		auto missing = readOne(*service, dir / "missing.txt").get();
+		EXPECT_FALSE(missing);
+		EXPECT_EQ(missing.error, ENOENT);
+	}
+}
+
+TEST_F(AsyncFileTest, BatchesKeepPathOrder)
+{
+	// More reads than the ring has entries
+	std::vector<std::filesystem::path> paths;
+	for (int i = 0; i < 600; ++i) {
+		paths.push_back(writeFile(std::to_string(i) + ".txt", std::string(i % 50 + 1, 'a' + i % 26)));
+	}
+	paths.insert(paths.begin() + 10, dir / "missing.txt");
+
+	for (auto& service : services()) {
+		auto results = readMany(*service, paths).get();
+		ASSERT_EQ(results.size(), paths.size());
+
+		EXPECT_FALSE(results[10]);
+		results.erase(results.begin() + 10);
+		for (int i = 0; i < 600; ++i) {
+			ASSERT_TRUE(results[i]) << i;
+			EXPECT_EQ(text(results[i].bytes), std::string(i % 50 + 1, 'a' + i % 26));
+		}
+
+		EXPECT_TRUE(readMany(*service, {}).get().empty());
+	}
+}
+
+TEST_F(AsyncFileTest, ReadsIntoRegisteredBuffers)
+{
+	auto path = writeFile("data.txt", "0123456789");
+
+	for (auto& service : services()) {
+		std::vector<std::byte> buffer(4);
+		std::span<std::byte> registered = buffer;
+		EXPECT_TRUE(service->registerBuffers({ &registered, 1 }));
+
+		// 10 bytes whole, then 4 from offset 2
+		EXPECT_EQ(readNested(*service, path, buffer).get(), 14u);
+		EXPECT_EQ(text(buffer), "2345");
+
+		// Reads stop at the end of the file
+		std::vector<std::byte> tail(8);
+		auto result = [&]() -> IO::Task<IO::ReadResult> {
+			co_return co_await service->readInto(path, tail, 7);
+		}().get();
+		EXPECT_TRUE(result);
+		EXPECT_EQ(result.num_bytes, 3u);
+		EXPECT_EQ(text(tail).substr(0, 3), "789");
+
+		EXPECT_TRUE(service->registerBuffers({}));
+	}
+}
@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+
+#include "core/render/Model.h"
+#include "physics/collisions/CookedMesh.h"
+
+#include <array>
+#include <thread>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Physics::Collisions;
+
+namespace {
+
+// Box from min to max, outward counter clockwise winding
+std::vector<Triangle> box(const glm::vec3& min, const glm::vec3& max)
+{
+	std::array<glm::vec3, 8> c;
+	for (int i = 0; i < 8; ++i) {
+		c[i] = glm::vec3(
+			(i & 1) ? max.x : min.x,
+			(i & 2) ? max.y : min.y,
+			(i & 4) ? max.z : min.z
+		);
+	}
+
+	std::array<std::array<int, 4>, 6> faces = {{
+		{ 0, 2, 3, 1 },	// -z
+		{ 4, 5, 7, 6 },	// +z
+		{ 0, 1, 5, 4 },	// -y
+		{ 2, 6, 7, 3 },	// +y
+		{ 0, 4, 6, 2 },	// -x
+		{ 1, 3, 7, 5 },	// +x
+	}};
+
+	std::vector<Triangle> tris;
+	for (auto& f : faces) {
+		tris.emplace_back(c[f[0]], c[f[1]], c[f[2]]);
+		tris.emplace_back(c[f[0]], c[f[2]], c[f[3]]);
+	}
+	return tris;
+}
+
+};	// end of namespace
+
+TEST(CookedMeshTest, BoxMassProperties)
+{
+	auto cooked = cook(box(glm::vec3(1.f, 2.f, 3.f), glm::vec3(3.f, 3.f, 4.f)));
+
+	EXPECT_FALSE(cooked.mass.b_from_bounds);
+	EXPECT_NEAR(cooked.mass.volume, 2.f, 1e-5f);
+	EXPECT_NEAR(cooked.mass.center_of_mass.x, 2.f, 1e-5f);
+	EXPECT_NEAR(cooked.mass.center_of_mass.y, 2.5f, 1e-5f);
+	EXPECT_NEAR(cooked.mass.center_of_mass.z, 3.5f, 1e-5f);
+
+	// Solid box, m / 12 * (b^2 + c^2) with m = 2
+	EXPECT_NEAR(cooked.mass.inertia[0][0], 2.f / 12.f * (1.f + 1.f), 1e-4f);
+	EXPECT_NEAR(cooked.mass.inertia[1][1], 2.f / 12.f * (4.f + 1.f), 1e-4f);
+	EXPECT_NEAR(cooked.mass.inertia[2][2], 2.f / 12.f * (4.f + 1.f), 1e-4f);
+	EXPECT_NEAR(cooked.mass.inertia[0][1], 0.f, 1e-4f);
+	EXPECT_NEAR(cooked.mass.inertia[1][2], 0.f, 1e-4f);
+
+	EXPECT_EQ(cooked.bounds.min, glm::vec3(1.f, 2.f, 3.f));
+	EXPECT_EQ(cooked.bounds.max, glm::vec3(3.f, 3.f, 4.f));
+	EXPECT_EQ(cooked.triangles.size(), 12u);
+
+	// The BVH is built over the same triangles
+	EXPECT_EQ(cooked.bvh.root.aabb.min, cooked.bounds.min);
+	EXPECT_EQ(cooked.bvh.root.aabb.max, cooked.bounds.max);
+	EXPECT_GE(cooked.bvh.root.getTriangleCount(), 12);
+}
+
+TEST(CookedMeshTest, WindingDoesNotMatter)
+{
+	auto tris = box(glm::vec3(-1.f), glm::vec3(1.f));
+	auto outward = massProperties(tris, AABB(glm::vec3(-1.f), glm::vec3(1.f)));
+
+	for (auto& tri : tris) std::swap(tri.v1, tri.v2);
+	auto inward = massProperties(tris, AABB(glm::vec3(-1.f), glm::vec3(1.f)));
+
+	EXPECT_NEAR(inward.volume, outward.volume, 1e-5f);
+	EXPECT_NEAR(inward.inertia[0][0], outward.inertia[0][0], 1e-5f);
+	EXPECT_NEAR(outward.inertia[0][0], 8.f / 12.f * 8.f, 1e-4f);
+}
+
+TEST(CookedMeshTest, OpenMeshesUseBounds)
+{
+	auto tris = box(glm::vec3(0.f), glm::vec3(2.f, 1.f, 1.f));
+	tris.resize(2);
+
+	auto props = massProperties(tris, AABB(glm::vec3(0.f), glm::vec3(2.f, 1.f, 1.f)));
+	EXPECT_TRUE(props.b_from_bounds);
+	EXPECT_NEAR(props.volume, 2.f, 1e-6f);
+	EXPECT_EQ(props.center_of_mass, glm::vec3(1.f, 0.5f, 0.5f));
+}
+
+TEST(CookedMeshTest, ModelCooksOnceForEveryCaller)
+{
+	std::vector<Render::TextureVertex> vertices;
+	std::vector<Uint32> indices;
+	for (auto& tri : box(glm::vec3(0.f), glm::vec3(1.f))) {
+		for (auto& v : { tri.v0, tri.v1, tri.v2 }) {
+			indices.push_back(static_cast<Uint32>(vertices.size()));
+			vertices.push_back({ .pos = v, .normal = glm::vec3(0.f), .uv = glm::vec2(0.f) });
+		}
+	}
+
+	Render::Model model;
+	TransformComponent transform(glm::vec3(10.f, 0.f, 0.f));
+	model.meshes.emplace_back(vertices, indices, transform, AssetHandle<Render::Image>());
+	model.computeBounds();
+
+	std::array<const CookedMesh*, 4> seen {};
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < seen.size(); ++i) {
+		threads.emplace_back([&, i]() { seen[i] = &model.collision(); });
+	}
+	for (auto& thread : threads) thread.join();
+
+	for (auto* cooked : seen) EXPECT_EQ(cooked, seen[0]);
+
+	// Mesh transforms are applied, like Model::bounds
+	EXPECT_NEAR(seen[0]->mass.center_of_mass.x, 10.5f, 1e-5f);
+	EXPECT_EQ(seen[0]->bounds.min.x, model.bounds.min.x);
+}
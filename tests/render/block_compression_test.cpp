@@ -0,0 +1,139 @@
+#include "gtest/gtest.h"
+
+#include "core/render/BlockCompression.h"
+#include "core/render/TextureCooker.h"
+
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+namespace {
+
+constexpr Uint32 SIZE = 128;
+
+// Smooth gradients with a little noise, roughly what albedo looks like
+std::vector<std::byte> albedo(bool b_alpha)
+{
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<int> noise(-6, 6);
+	auto channel = [&](int val) {
+		return static_cast<std::byte>(std::clamp(val + noise(rng), 0, 255));
+	};
+
+	std::vector<std::byte> pixels(SIZE * SIZE * 4);
+	for (Uint32 y = 0; y < SIZE; ++y) {
+		for (Uint32 x = 0; x < SIZE; ++x) {
+			std::byte* texel = pixels.data() + (y * SIZE + x) * 4;
+			texel[0] = channel(static_cast<int>(x * 2));
+			texel[1] = channel(static_cast<int>(y * 2));
+			texel[2] = channel(static_cast<int>(255 - x - y));
+			texel[3] = b_alpha ? channel(static_cast<int>((x + y) % 256)) : std::byte { 0xFF };
+		}
+	}
+	return pixels;
+}
+
+double roundTripPsnr(TextureFormat format, const std::vector<std::byte>& pixels, Uint32 num_channels)
+{
+	auto blocks = BC::compress(format, pixels.data(), SIZE, SIZE);
+	EXPECT_EQ(blocks.size(), levelSizeBytes(format, SIZE, SIZE));
+
+	auto decoded = BC::decompress(format, blocks.data(), SIZE, SIZE);
+	return BC::psnr(pixels.data(), decoded.data(), SIZE * SIZE, num_channels);
+}
+
+};	// end of namespace
+
+TEST(BlockCompressionTest, MeetsQualityThresholds)
+{
+	auto opaque = albedo(false);
+	auto blended = albedo(true);
+
+	double bc1 = roundTripPsnr(TextureFormat::BC1_RGBA, opaque, 3);
+	double bc3 = roundTripPsnr(TextureFormat::BC3_RGBA, blended, 4);
+	double bc5 = roundTripPsnr(TextureFormat::BC5_RG, opaque, 2);
+	double bc7 = roundTripPsnr(TextureFormat::BC7_RGBA, blended, 4);
+
+	EXPECT_GT(bc1, 32.0);
+	EXPECT_GT(bc3, 32.0);
+	EXPECT_GT(bc5, 36.0);
+	EXPECT_GT(bc7, 34.0);
+	EXPECT_GE(roundTripPsnr(TextureFormat::BC7_RGBA, opaque, 3), bc1);
+}
+
+TEST(BlockCompressionTest, UniformBlocksAreExact)
+{
+	uint8_t rgba[BC::BLOCK_TEXELS * 4];
+	for (Uint32 i = 0; i < BC::BLOCK_TEXELS; ++i) {
+		rgba[i * 4 + 0] = 255;
+		rgba[i * 4 + 1] = 0;
+		rgba[i * 4 + 2] = 255;
+		rgba[i * 4 + 3] = 128;
+	}
+
+	for (auto format : { TextureFormat::BC3_RGBA, TextureFormat::BC5_RG }) {
+		uint8_t block[16] = {};
+		uint8_t decoded[BC::BLOCK_TEXELS * 4];
+		if (format == TextureFormat::BC3_RGBA) BC::encodeBC3(rgba, block);
+		else BC::encodeBC5(rgba, block);
+		BC::decodeBlock(format, block, decoded);
+
+		Uint32 channels = (format == TextureFormat::BC5_RG) ? 2 : 4;
+		for (Uint32 i = 0; i < BC::BLOCK_TEXELS; ++i) {
+			for (Uint32 c = 0; c < channels; ++c) {
+				EXPECT_EQ(decoded[i * 4 + c], rgba[i * 4 + c]);
+			}
+		}
+	}
+}
+
+TEST(BlockCompressionTest, SimdIndicesMatchScalar)
+{
+	std::mt19937 rng(11);
+	std::uniform_int_distribution<int> byte(0, 255);
+
+	for (int iter = 0; iter < 256; ++iter) {
+		uint8_t rgba[BC::BLOCK_TEXELS * 4];
+		uint8_t palette[4][4];
+		for (auto& val : rgba) val = static_cast<uint8_t>(byte(rng));
+		for (auto& color : palette) {
+			for (auto& val : color) val = static_cast<uint8_t>(byte(rng));
+		}
+
+		// Duplicate entries exercise the tie break
+		if (iter % 4 == 0) std::memcpy(palette[3], palette[1], 4);
+
+		uint8_t scalar[16], simd[16];
+		BC::detail::colorIndicesScalar(rgba, palette, scalar);
+		BC::detail::colorIndicesSimd(rgba, palette, simd);
+		ASSERT_EQ(std::memcmp(scalar, simd, sizeof(scalar)), 0);
+	}
+}
+
+TEST(BlockCompressionTest, ParallelMatchesSerial)
+{
+	auto pixels = albedo(true);
+	ThreadPool pool(4);
+	ThreadPool serial(1);
+
+	auto a = BC::compress(TextureFormat::BC3_RGBA, pixels.data(), SIZE, SIZE, pool);
+	auto b = BC::compress(TextureFormat::BC3_RGBA, pixels.data(), SIZE, SIZE, serial);
+	EXPECT_EQ(a, b);
+}
+
+TEST(BlockCompressionTest, CookerChoosesFormat)
+{
+	auto opaque = albedo(false);
+	auto blended = albedo(true);
+
+	EXPECT_EQ(TextureCooker::chooseFormat(Image("albedo.png", SIZE, SIZE, opaque.data())), TextureFormat::BC1_RGBA);
+	EXPECT_EQ(TextureCooker::chooseFormat(Image("albedo.png", SIZE, SIZE, blended.data())), TextureFormat::BC3_RGBA);
+	EXPECT_EQ(TextureCooker::chooseFormat(Image("Hull_Normal.png", SIZE, SIZE, opaque.data())), TextureFormat::BC5_RG);
+
+	// Level 0 has to be made of whole blocks
+	EXPECT_EQ(TextureCooker::chooseFormat(Image("albedo.png", SIZE - 2, SIZE, opaque.data())), TextureFormat::RGBA8);
+}
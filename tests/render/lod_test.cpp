@@ -0,0 +1,210 @@
+#include "gtest/gtest.h"
+
+#include "core/render/Lod.h"
+
+#include <array>
+#include <cmath>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+namespace {
+
+struct Grid {
+	std::vector<TextureVertex> vertices;
+	std::vector<Uint32> indices;
+};
+
+// Welded heightfield in the xz plane facing +y, flat for amplitude 0
+Grid heightfield(Uint32 cells, float amplitude)
+{
+	Grid grid;
+	for (Uint32 z = 0; z <= cells; ++z) {
+		for (Uint32 x = 0; x <= cells; ++x) {
+			float height = amplitude * std::sin(x * 0.4f) * std::cos(z * 0.3f);
+			grid.vertices.push_back({
+				.pos = glm::vec3(float(x), height, float(z)),
+				.normal = glm::vec3(0.f, 1.f, 0.f),
+				.uv = glm::vec2(0.f),
+			});
+		}
+	}
+	for (Uint32 z = 0; z < cells; ++z) {
+		for (Uint32 x = 0; x < cells; ++x) {
+			Uint32 a = z * (cells + 1) + x;
+			Uint32 b = a + cells + 1;
+			grid.indices.insert(grid.indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+		}
+	}
+	return grid;
+}
+
+// Every triangle with vertices of its own, normals facing out of the face
+Grid flatShaded(const Grid& welded)
+{
+	Grid grid;
+	for (size_t t = 0; t < welded.indices.size(); t += 3) {
+		glm::vec3 p0 = welded.vertices[welded.indices[t]].pos;
+		glm::vec3 p1 = welded.vertices[welded.indices[t + 1]].pos;
+		glm::vec3 p2 = welded.vertices[welded.indices[t + 2]].pos;
+		glm::vec3 normal = glm::normalize(glm::cross(p1 - p0, p2 - p0));
+		for (size_t k = 0; k < 3; ++k) {
+			auto vertex = welded.vertices[welded.indices[t + k]];
+			vertex.normal = normal;
+			grid.indices.push_back(static_cast<Uint32>(grid.vertices.size()));
+			grid.vertices.push_back(vertex);
+		}
+	}
+	return grid;
+}
+
+glm::vec3 faceNormal(const Grid& grid, const std::vector<Uint32>& indices, size_t t)
+{
+	glm::vec3 p0 = grid.vertices[indices[t]].pos;
+	glm::vec3 p1 = grid.vertices[indices[t + 1]].pos;
+	glm::vec3 p2 = grid.vertices[indices[t + 2]].pos;
+	return glm::cross(p1 - p0, p2 - p0);
+}
+
+};	// end of namespace
+
+TEST(LodTest, FlatGridReachesTargetWithoutError)
+{
+	auto grid = heightfield(32, 0.f);
+	size_t target = grid.indices.size() / 4;
+
+	float error = -1.f;
+	auto simplified = Lod::simplify(grid.vertices, grid.indices, target, 0.01f, &error);
+
+	EXPECT_LE(simplified.size(), target + target / 10);
+	EXPECT_EQ(simplified.size() % 3, 0u);
+	EXPECT_NEAR(error, 0.f, 1e-4f);
+
+	for (size_t t = 0; t < simplified.size(); t += 3) {
+		ASSERT_LT(simplified[t], grid.vertices.size());
+		ASSERT_NE(simplified[t], simplified[t + 1]);
+		ASSERT_NE(simplified[t + 1], simplified[t + 2]);
+		ASSERT_NE(simplified[t], simplified[t + 2]);
+		ASSERT_GT(faceNormal(grid, simplified, t).y, 0.f);
+	}
+}
+
+TEST(LodTest, BordersAreKept)
+{
+	auto grid = heightfield(16, 0.f);
+	auto simplified = Lod::simplify(grid.vertices, grid.indices, 0, 1.f);
+
+	std::set<Uint32> used(simplified.begin(), simplified.end());
+	for (Uint32 i = 0; i <= 16; ++i) {
+		EXPECT_TRUE(used.contains(i));
+		EXPECT_TRUE(used.contains(16 * 17 + i));
+		EXPECT_TRUE(used.contains(i * 17));
+		EXPECT_TRUE(used.contains(i * 17 + 16));
+	}
+}
+
+TEST(LodTest, ErrorBoundStopsSimplification)
+{
+	auto grid = heightfield(32, 2.f);
+
+	float loose_error = 0.f;
+	auto loose = Lod::simplify(grid.vertices, grid.indices, 0, 10.f, &loose_error);
+	float tight_error = 0.f;
+	auto tight = Lod::simplify(grid.vertices, grid.indices, 0, 0.05f, &tight_error);
+
+	EXPECT_LT(loose.size(), tight.size());
+	EXPECT_LT(tight.size(), grid.indices.size());
+	EXPECT_LE(tight_error, 0.05f);
+	EXPECT_GT(loose_error, tight_error);
+}
+
+TEST(LodTest, ChainLevelsShrinkAndErrorsGrow)
+{
+	auto grid = heightfield(48, 1.f);
+	auto chain = Lod::generate(grid.vertices, grid.indices, 34.f, Lod::Settings { .max_error = 0.1f });
+
+	ASSERT_GE(chain.lods.size(), 2u);
+	size_t previous = grid.indices.size();
+	float previous_error = 0.f;
+	Uint32 offset = 0;
+	for (auto& lod : chain.lods) {
+		EXPECT_EQ(lod.index_offset, offset);
+		EXPECT_LT(lod.index_count, previous);
+		EXPECT_GE(lod.error, previous_error);
+		EXPECT_LE(lod.error, 0.1f);
+		offset += lod.index_count;
+		previous = lod.index_count;
+		previous_error = lod.error;
+	}
+	EXPECT_EQ(chain.indices.size(), offset);
+}
+
+TEST(LodTest, FlatShadedMeshesGetLods)
+{
+	auto grid = flatShaded(heightfield(32, 1.f));
+	auto chain = Lod::generate(grid.vertices, grid.indices, 23.f, Lod::Settings { .max_error = 0.1f });
+	ASSERT_GE(chain.lods.size(), 1u);
+
+	// Seams stay closed: only the grid's outline is walked by one triangle
+	auto& lod = chain.lods[0];
+	EXPECT_LT(lod.index_count, grid.indices.size());
+	std::map<std::array<float, 6>, int> edge_uses;
+	for (Uint32 t = lod.index_offset; t < lod.index_offset + lod.index_count; t += 3) {
+		for (Uint32 k = 0; k < 3; ++k) {
+			glm::vec3 a = grid.vertices[chain.indices[t + k]].pos;
+			glm::vec3 b = grid.vertices[chain.indices[t + (k + 1) % 3]].pos;
+			std::array<float, 6> key = { a.x, a.y, a.z, b.x, b.y, b.z };
+			if (std::tie(b.x, b.y, b.z) < std::tie(a.x, a.y, a.z)) key = { b.x, b.y, b.z, a.x, a.y, a.z };
+			++edge_uses[key];
+		}
+	}
+	size_t num_border_edges = 0;
+	for (auto& [edge, uses] : edge_uses) {
+		EXPECT_LE(uses, 2);
+		if (uses == 1) ++num_border_edges;
+	}
+	EXPECT_EQ(num_border_edges, 4u * 32u);
+}
+
+TEST(LodTest, SelectionUsesHysteresis)
+{
+	std::vector<MeshLod> lods = {
+		{ .index_offset = 0, .index_count = 300, .error = 0.01f },
+		{ .index_offset = 300, .index_count = 90, .error = 0.04f },
+	};
+	Lod::Selection selection { .pixel_error = 1.f, .hysteresis = 0.25f };
+
+	// Close up the full mesh is needed
+	EXPECT_EQ(Lod::select(lods, 500.f, 2, selection), 0u);
+
+	// Level 1 fits at 100 px but only with margin below 75 px
+	EXPECT_EQ(Lod::select(lods, 90.f, 0, selection), 0u);
+	EXPECT_EQ(Lod::select(lods, 70.f, 0, selection), 1u);
+	EXPECT_EQ(Lod::select(lods, 90.f, 1, selection), 1u);
+	EXPECT_EQ(Lod::select(lods, 110.f, 1, selection), 0u);
+
+	// Far away the coarsest level is reached in one step
+	EXPECT_EQ(Lod::select(lods, 10.f, 0, selection), 2u);
+	EXPECT_EQ(Lod::select({}, 10.f, 3, selection), 0u);
+}
+
+TEST(LodTest, ProjectedRadiusFallsWithDistance)
+{
+	float scale = Lod::projectionScale(90.f, 1000.f);
+	EXPECT_NEAR(scale, 500.f, 1e-2f);
+
+	Physics::Collisions::Sphere sphere(glm::vec3(0.f, 0.f, -10.f), 1.f);
+	EXPECT_NEAR(Lod::projectedRadius(sphere, glm::vec3(0.f), scale), 50.f, 1e-3f);
+	EXPECT_GT(Lod::projectedRadius(sphere, glm::vec3(0.f, 0.f, -10.5f), scale), 1e6f);
+
+	glm::mat4 model = glm::mat4(1.f);
+	model[0][0] = 2.f;
+	model[3] = glm::vec4(1.f, 2.f, 3.f, 1.f);
+	auto world = Lod::worldSphere(Physics::Collisions::Sphere(glm::vec3(0.f), 1.f), model);
+	EXPECT_FLOAT_EQ(world.radius, 2.f);
+	EXPECT_FLOAT_EQ(world.center.z, 3.f);
+}
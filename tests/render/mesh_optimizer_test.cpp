@@ -0,0 +1,194 @@
+#include "gtest/gtest.h"
+
+#include "core/render/MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+namespace {
+
+struct Grid {
+	std::vector<TextureVertex> vertices;
+	std::vector<Uint32> indices;
+};
+
+// Two triangles per cell, every triangle with its own three vertices and
+// the triangles shuffled, like an unwelded import
+Grid unweldedGrid(Uint32 cells, unsigned seed)
+{
+	auto vertex = [&](Uint32 x, Uint32 y) {
+		return TextureVertex {
+			.pos = glm::vec3(float(x), float(y), 0.f),
+			.normal = glm::vec3(0.f, 0.f, 1.f),
+			.uv = glm::vec2(float(x) / cells, float(y) / cells),
+		};
+	};
+
+	std::vector<std::array<TextureVertex, 3>> tris;
+	for (Uint32 y = 0; y < cells; ++y) {
+		for (Uint32 x = 0; x < cells; ++x) {
+			tris.push_back({ vertex(x, y), vertex(x + 1, y), vertex(x + 1, y + 1) });
+			tris.push_back({ vertex(x, y), vertex(x + 1, y + 1), vertex(x, y + 1) });
+		}
+	}
+	std::mt19937 rng(seed);
+	std::shuffle(tris.begin(), tris.end(), rng);
+
+	Grid grid;
+	for (auto& tri : tris) {
+		for (auto& v : tri) {
+			grid.indices.push_back(static_cast<Uint32>(grid.vertices.size()));
+			grid.vertices.push_back(v);
+		}
+	}
+	return grid;
+}
+
+// Triangles as position triples, rotated to start at the smallest corner
+// so winding is kept but the starting vertex doesn't matter
+std::vector<std::array<float, 9>> triangleSet(const Grid& grid)
+{
+	std::vector<std::array<float, 9>> tris;
+	for (size_t t = 0; t < grid.indices.size(); t += 3) {
+		std::array<glm::vec3, 3> p;
+		for (size_t k = 0; k < 3; ++k) p[k] = grid.vertices[grid.indices[t + k]].pos;
+
+		auto less = [](const glm::vec3& a, const glm::vec3& b) {
+			return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+		};
+		size_t first = std::min_element(p.begin(), p.end(), less) - p.begin();
+		std::array<float, 9> key;
+		for (size_t k = 0; k < 3; ++k) {
+			auto& v = p[(first + k) % 3];
+			key[k * 3] = v.x;
+			key[k * 3 + 1] = v.y;
+			key[k * 3 + 2] = v.z;
+		}
+		tris.push_back(key);
+	}
+	std::sort(tris.begin(), tris.end());
+	return tris;
+}
+
+};	// end of namespace
+
+TEST(MeshOptimizerTest, WeldMergesIdenticalVertices)
+{
+	auto grid = unweldedGrid(8, 1);
+	auto before = triangleSet(grid);
+
+	size_t num_unique = MeshOpt::weld(grid.vertices, grid.indices);
+	EXPECT_EQ(num_unique, 9u * 9u);
+	EXPECT_EQ(grid.vertices.size(), num_unique);
+	EXPECT_EQ(triangleSet(grid), before);
+}
+
+TEST(MeshOptimizerTest, VertexCacheOrderLowersAcmr)
+{
+	auto grid = unweldedGrid(32, 2);
+	(void)MeshOpt::weld(grid.vertices, grid.indices);
+	auto before = triangleSet(grid);
+	auto shuffled = MeshOpt::analyze(grid.indices, grid.vertices.size());
+
+	MeshOpt::optimizeVertexCache(grid.indices, grid.vertices.size());
+	auto ordered = MeshOpt::analyze(grid.indices, grid.vertices.size());
+
+	EXPECT_LT(ordered.acmr, 0.8f);
+	EXPECT_LT(ordered.acmr, shuffled.acmr * 0.6f);
+	EXPECT_LT(ordered.atvr, shuffled.atvr);
+	EXPECT_EQ(triangleSet(grid), before);
+}
+
+TEST(MeshOptimizerTest, OverdrawOrderStaysNearCacheOrder)
+{
+	auto grid = unweldedGrid(32, 3);
+	(void)MeshOpt::weld(grid.vertices, grid.indices);
+	MeshOpt::optimizeVertexCache(grid.indices, grid.vertices.size());
+	auto before = triangleSet(grid);
+	auto cached = MeshOpt::analyze(grid.indices, grid.vertices.size());
+
+	MeshOpt::optimizeOverdraw(grid.indices, grid.vertices, 1.05f);
+	auto sorted = MeshOpt::analyze(grid.indices, grid.vertices.size());
+
+	// Cold starts at cluster boundaries cost a little
+	EXPECT_LT(sorted.acmr, cached.acmr * 1.25f);
+	EXPECT_EQ(triangleSet(grid), before);
+}
+
+TEST(MeshOptimizerTest, VertexFetchOrdersByFirstUse)
+{
+	auto grid = unweldedGrid(4, 4);
+	(void)MeshOpt::weld(grid.vertices, grid.indices);
+
+	// An unreferenced vertex is dropped
+	grid.vertices.push_back(TextureVertex {});
+	auto before = triangleSet(grid);
+
+	size_t num_vertices = MeshOpt::optimizeVertexFetch(grid.vertices, grid.indices);
+	EXPECT_EQ(num_vertices, 25u);
+
+	Uint32 next = 0;
+	for (Uint32 index : grid.indices) {
+		ASSERT_LE(index, next);
+		if (index == next) ++next;
+	}
+	EXPECT_EQ(next, num_vertices);
+	EXPECT_EQ(triangleSet(grid), before);
+}
+
+TEST(MeshOptimizerTest, PassesCanBeDisabled)
+{
+	auto grid = unweldedGrid(4, 5);
+	auto original = grid;
+
+	MeshOpt::Settings none {
+		.b_weld = false,
+		.b_vertex_cache = false,
+		.b_overdraw = false,
+		.b_vertex_fetch = false,
+	};
+	auto report = MeshOpt::optimize(grid.vertices, grid.indices, none);
+	EXPECT_EQ(grid.indices, original.indices);
+	EXPECT_EQ(grid.vertices.size(), original.vertices.size());
+	EXPECT_EQ(report.before.acmr, report.after.acmr);
+
+	report = MeshOpt::optimize(grid.vertices, grid.indices);
+	EXPECT_EQ(report.vertices_before, original.vertices.size());
+	EXPECT_EQ(report.vertices_after, 25u);
+	EXPECT_EQ(report.before.acmr, 3.f);
+	EXPECT_LT(report.after.acmr, 1.f);
+	EXPECT_EQ(triangleSet(grid), triangleSet(original));
+}
+
+TEST(MeshOptimizerTest, SplitKeepsPartsUnderLimit)
+{
+	auto grid = unweldedGrid(16, 6);
+	(void)MeshOpt::weld(grid.vertices, grid.indices);
+	MeshOpt::optimizeVertexCache(grid.indices, grid.vertices.size());
+	auto before = triangleSet(grid);
+
+	auto parts = MeshOpt::split(grid.vertices, grid.indices, 64);
+	EXPECT_GT(parts.size(), 1u);
+
+	Grid joined;
+	for (auto& part : parts) {
+		EXPECT_LE(part.vertices.size(), 64u);
+		for (Uint32 index : part.indices) {
+			ASSERT_LT(index, part.vertices.size());
+			joined.indices.push_back(static_cast<Uint32>(joined.vertices.size()) + index);
+		}
+		joined.vertices.insert(joined.vertices.end(), part.vertices.begin(), part.vertices.end());
+	}
+	EXPECT_EQ(triangleSet(joined), before);
+
+	// A mesh under the limit comes back whole
+	parts = MeshOpt::split(grid.vertices, grid.indices, grid.vertices.size());
+	ASSERT_EQ(parts.size(), 1u);
+	EXPECT_EQ(parts[0].indices.size(), grid.indices.size());
+}
@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+
+#include "core/render/MipGenerator.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+namespace {
+
+std::vector<std::byte> randomPixels(Uint32 width, Uint32 height, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::vector<std::byte> pixels(size_t(width) * height * 4);
+	for (auto& val : pixels) val = static_cast<std::byte>(byte(rng));
+	return pixels;
+}
+
+int channel(const Image::MipLevel& level, Uint32 x, Uint32 y, Uint32 c)
+{
+	return static_cast<int>(level.data[(size_t(y) * level.width + x) * 4 + c]);
+}
+
+};	// end of namespace
+
+TEST(MipGeneratorTest, ChainIsAlignedDownToOneTexel)
+{
+	auto pixels = randomPixels(37, 10, 1);
+	auto chain = Mip::generate(37, 10, pixels.data(), Mip::Settings {}, 16);
+
+	ASSERT_EQ(chain.levels.size(), 6u);
+	EXPECT_EQ(chain.levels[1].width, 18u);
+	EXPECT_EQ(chain.levels[1].height, 5u);
+	EXPECT_EQ(chain.levels.back().width, 1u);
+	EXPECT_EQ(chain.levels.back().height, 1u);
+	for (auto& level : chain.levels) {
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(level.data) % 16, 0u);
+	}
+	EXPECT_EQ(std::memcmp(chain.levels[0].data, pixels.data(), pixels.size()), 0);
+}
+
+TEST(MipGeneratorTest, SrgbAveragesInLinearLight)
+{
+	// Black and white columns, the linear midpoint is 188 in sRGB rather than 128
+	std::vector<std::byte> pixels(2 * 2 * 4, std::byte { 0xFF });
+	pixels[0] = pixels[1] = pixels[2] = std::byte { 0 };
+	pixels[8] = pixels[9] = pixels[10] = std::byte { 0 };
+
+	Mip::Settings srgb { .filter = Mip::Filter::Box, .b_srgb = true, .b_normal_map = false };
+	auto chain = Mip::generate(2, 2, pixels.data(), srgb);
+	EXPECT_EQ(channel(chain.levels[1], 0, 0, 0), 188);
+	EXPECT_EQ(channel(chain.levels[1], 0, 0, 3), 255);
+
+	Mip::Settings linear { .filter = Mip::Filter::Box, .b_srgb = false, .b_normal_map = false };
+	chain = Mip::generate(2, 2, pixels.data(), linear);
+	EXPECT_EQ(channel(chain.levels[1], 0, 0, 0), 128);
+}
+
+TEST(MipGeneratorTest, NormalsAreRenormalized)
+{
+	// Normals tilted 45 degrees either way about y average to +z at unit length
+	auto encode = [](float n) { return static_cast<std::byte>(std::lround((n * 0.5f + 0.5f) * 255.f)); };
+	float d = std::sqrt(0.5f);
+	std::vector<std::byte> pixels;
+	for (int i = 0; i < 4; ++i) {
+		float x = (i % 2) ? d : -d;
+		pixels.insert(pixels.end(), { encode(x), encode(0.f), encode(d), std::byte { 0xFF } });
+	}
+
+	auto settings = Mip::settingsFor("hull_Normal.png", Mip::Filter::Kaiser);
+	ASSERT_TRUE(settings.b_normal_map);
+	ASSERT_FALSE(settings.b_srgb);
+
+	auto chain = Mip::generate(2, 2, pixels.data(), settings);
+	auto& level = chain.levels[1];
+	EXPECT_NEAR(channel(level, 0, 0, 0), 128, 1);
+	EXPECT_NEAR(channel(level, 0, 0, 1), 128, 1);
+	EXPECT_EQ(channel(level, 0, 0, 2), 255);
+}
+
+TEST(MipGeneratorTest, KaiserKeepsFlatColorsFlat)
+{
+	std::vector<std::byte> pixels(16 * 8 * 4);
+	for (size_t i = 0; i < pixels.size(); ++i) {
+		pixels[i] = static_cast<std::byte>(60 + 40 * (i % 4));
+	}
+
+	for (bool b_srgb : { false, true }) {
+		Mip::Settings settings { .filter = Mip::Filter::Kaiser, .b_srgb = b_srgb, .b_normal_map = false };
+		auto chain = Mip::generate(16, 8, pixels.data(), settings);
+		for (auto& level : chain.levels) {
+			for (Uint32 i = 0; i < level.size_bytes; ++i) {
+				ASSERT_EQ(static_cast<int>(level.data[i]), 60 + 40 * (i % 4));
+			}
+		}
+	}
+}
+
+TEST(MipGeneratorTest, SimdBoxMatchesScalar)
+{
+	for (auto [w, h] : { std::pair { 64u, 64u }, { 37u, 9u }, { 2u, 7u }, { 1u, 1u } }) {
+		auto pixels = randomPixels(w, h, w * 31 + h);
+		Image::MipLevel src { w, h, w * h * 4, pixels.data() };
+		Uint32 dst_w = std::max(w / 2, 1u);
+		Uint32 dst_h = std::max(h / 2, 1u);
+
+		std::vector<std::byte> scalar(size_t(dst_w) * dst_h * 4);
+		std::vector<std::byte> simd(scalar.size());
+		Mip::detail::boxScalar(src, scalar.data(), dst_w, dst_h);
+		Mip::detail::boxSimd(src, simd.data(), dst_w, dst_h);
+		EXPECT_EQ(scalar, simd);
+	}
+}
+
+TEST(MipGeneratorTest, SimdFilterMatchesScalar)
+{
+	// What Image::setPixels picks for albedo and normal maps, plus linear Kaiser
+	std::vector<Mip::Settings> variants = {
+		Mip::settingsFor("hull_albedo.png", Mip::Filter::Box),
+		Mip::settingsFor("hull_albedo.png", Mip::Filter::Kaiser),
+		Mip::settingsFor("hull_normal.png", Mip::Filter::Box),
+		Mip::settingsFor("hull_normal.png", Mip::Filter::Kaiser),
+		{ .filter = Mip::Filter::Kaiser, .b_srgb = false, .b_normal_map = false },
+	};
+
+	for (auto [w, h] : { std::pair { 64u, 64u }, { 37u, 9u }, { 2u, 7u }, { 1u, 1u } }) {
+		auto pixels = randomPixels(w, h, w * 17 + h);
+		Image::MipLevel src { w, h, w * h * 4, pixels.data() };
+		Uint32 dst_w = std::max(w / 2, 1u);
+		Uint32 dst_h = std::max(h / 2, 1u);
+
+		for (auto& settings : variants) {
+			std::vector<std::byte> scalar(size_t(dst_w) * dst_h * 4);
+			std::vector<std::byte> simd(scalar.size());
+			Mip::detail::filterScalar(src, scalar.data(), dst_w, dst_h, settings);
+			Mip::detail::filterSimd(src, simd.data(), dst_w, dst_h, settings);
+
+			// A fused multiply add may round differently on either side
+			for (size_t i = 0; i < scalar.size(); ++i) {
+				ASSERT_NEAR(static_cast<int>(scalar[i]), static_cast<int>(simd[i]), 1) << i;
+			}
+		}
+	}
+}
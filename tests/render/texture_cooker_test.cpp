@@ -0,0 +1,154 @@
+#include "gtest/gtest.h"
+
+#include "core/render/Image.h"
+#include "core/render/TextureCooker.h"
+#include "util/FileHash.h"
+#include "util/MappedFile.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+class TextureCookerTest : public testing::Test {
+protected:
+	std::filesystem::path dir;
+	std::filesystem::path source;
+
+	void SetUp() override
+	{
+		dir = std::filesystem::temp_directory_path() / "texture_cooker_test";
+		std::filesystem::create_directories(dir);
+		TextureCooker::setDirectory(dir / "cache");
+
+		source = dir / "tex.png";
+		std::ofstream os(source, std::ios::binary | std::ios::trunc);
+		os << "not really a png";
+	}
+
+	void TearDown() override
+	{
+		TextureCooker::setDirectory("cache/textures");
+		std::filesystem::remove_all(dir);
+	}
+
+	// 4x2 RGBA, every channel of texel i set to i * 10
+	static std::vector<std::byte> gradient()
+	{
+		std::vector<std::byte> pixels(4 * 2 * 4);
+		for (size_t i = 0; i < pixels.size(); ++i) {
+			pixels[i] = static_cast<std::byte>((i / 4) * 10);
+		}
+		return pixels;
+	}
+};
+
+TEST_F(TextureCookerTest, BuildsBoxFilteredMipChain)
+{
+	auto pixels = gradient();
+	Image image(source, 4, 2, pixels.data());
+
+	auto& levels = image.getMipLevels();
+	ASSERT_EQ(levels.size(), 3u);
+	EXPECT_EQ(levels[1].width, 2u);
+	EXPECT_EQ(levels[1].height, 1u);
+	EXPECT_EQ(levels[2].width, 1u);
+	EXPECT_EQ(levels[2].height, 1u);
+
+	// Alpha is averaged as stored, texels 0, 1, 4, 5 average to 25
+	EXPECT_EQ(static_cast<int>(levels[1].data[3]), 25);
+	// Texels 2, 3, 6, 7 average to 45
+	EXPECT_EQ(static_cast<int>(levels[1].data[7]), 45);
+	EXPECT_EQ(static_cast<int>(levels[2].data[3]), 35);
+}
+
+TEST_F(TextureCookerTest, CookedFileRoundTrips)
+{
+	auto pixels = gradient();
+	Image image(source, 4, 2, pixels.data());
+
+	auto cooked_path = TextureCooker::cookedPath(source);
+	ASSERT_TRUE(TextureCooker::save(cooked_path, image, 1234));
+
+	MappedFile file(cooked_path);
+	TextureFormat format;
+	auto levels = TextureCooker::readLevels(file, 1234, format);
+	ASSERT_EQ(levels.size(), 3u);
+	EXPECT_EQ(format, TextureFormat::RGBA8);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(levels[0].data) % TextureCooker::LEVEL_ALIGN, 0u);
+	EXPECT_EQ(std::memcmp(levels[0].data, pixels.data(), pixels.size()), 0);
+
+	EXPECT_TRUE(TextureCooker::readLevels(file, 999, format).empty());
+}
+
+TEST_F(TextureCookerTest, LoadMapsCookedFileWithoutDecoding)
+{
+	auto pixels = gradient();
+	Image cooked(source, 4, 2, pixels.data());
+	ASSERT_TRUE(TextureCooker::save(
+		TextureCooker::cookedPath(source),
+		cooked,
+		Hash::fileContents(source)
+	));
+
+	// The source isn't a decodable image, so this only works off the cooked file
+	Image loaded(source);
+	EXPECT_EQ(loaded.getWidth(), 4u);
+	EXPECT_EQ(loaded.getHeight(), 2u);
+	ASSERT_EQ(loaded.getMipLevels().size(), 3u);
+	EXPECT_EQ(std::memcmp(loaded.getPixels(), pixels.data(), pixels.size()), 0);
+}
+
+TEST_F(TextureCookerTest, UnchangedSourcesSkipHashing)
+{
+	auto pixels = gradient();
+	Image cooked(source, 4, 2, pixels.data());
+	auto cooked_path = TextureCooker::cookedPath(source);
+
+	// Not the source's real hash, so only the stamp can match it
+	ASSERT_TRUE(TextureCooker::save(cooked_path, cooked, 1234));
+	EXPECT_EQ(TextureCooker::stampedHash(cooked_path, TextureCooker::stamp(source)), 1234u);
+
+	Image loaded(source);
+	EXPECT_EQ(loaded.getWidth(), 4u);
+	EXPECT_EQ(loaded.getHeight(), 2u);
+
+	// An edited source is hashed again, which the cooked file doesn't match
+	{
+		std::ofstream os(source, std::ios::binary | std::ios::app);
+		os << " edited";
+	}
+	EXPECT_EQ(TextureCooker::stampedHash(cooked_path, TextureCooker::stamp(source)), 0u);
+	EXPECT_EQ(TextureCooker::stampedHash(cooked_path, TextureCooker::stamp(dir / "missing.png")), 0u);
+}
+
+TEST_F(TextureCookerTest, OtherSettingsRecook)
+{
+	auto pixels = gradient();
+	Image cooked(source, 4, 2, pixels.data());
+	auto cooked_path = TextureCooker::cookedPath(source);
+	ASSERT_TRUE(TextureCooker::save(cooked_path, cooked, 1234));
+
+	auto defaults = TextureCooker::settings();
+	auto kaiser = defaults;
+	kaiser.mip_filter = Mip::Filter::Kaiser;
+	auto bc7 = defaults;
+	bc7.b_prefer_bc7 = true;
+
+	MappedFile file(cooked_path);
+	TextureFormat format;
+	EXPECT_FALSE(TextureCooker::readLevels(file, 1234, format).empty());
+	for (auto& other : { kaiser, bc7 }) {
+		EXPECT_TRUE(TextureCooker::readLevels(file, 1234, format, TextureCooker::settingsHash(other)).empty());
+		EXPECT_EQ(TextureCooker::stampedHash(cooked_path, TextureCooker::stamp(source), other), 0u);
+	}
+
+	// Changed settings apply to the next load
+	TextureCooker::setSettings(kaiser);
+	EXPECT_TRUE(TextureCooker::readLevels(file, 1234, format).empty());
+	TextureCooker::setSettings(defaults);
+	EXPECT_FALSE(TextureCooker::readLevels(file, 1234, format).empty());
+}
@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+
+#include "core/render/Mesh.h"
+#include "core/render/VertexQuantization.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Render;
+
+TEST(VertexQuantizationTest, CompactVertexIsHalfTheSize)
+{
+	EXPECT_EQ(sizeof(CompactVertex), 16u);
+	EXPECT_EQ(sizeof(CompactVertex) * 2, sizeof(TextureVertex));
+	EXPECT_EQ(sizeof(PositionVertex), 12u);
+}
+
+TEST(VertexQuantizationTest, HalfRoundTrip)
+{
+	// Exactly representable values survive
+	for (float value : { 0.f, 1.f, -2.f, 0.5f, 0.25f, 1024.f, 65504.f, 6.103515625e-05f }) {
+		EXPECT_EQ(VertexQuant::fromHalf(VertexQuant::toHalf(value)), value);
+	}
+	EXPECT_EQ(VertexQuant::toHalf(1.f), 0x3C00);
+	EXPECT_EQ(VertexQuant::toHalf(-2.f), 0xC000);
+
+	// Subnormals, overflow and ties to even
+	EXPECT_EQ(VertexQuant::toHalf(std::ldexp(1.f, -24)), 0x0001);
+	EXPECT_EQ(VertexQuant::toHalf(1e6f), 0x7C00);
+	EXPECT_EQ(VertexQuant::toHalf(1.f + std::ldexp(1.f, -11)), 0x3C00);
+	EXPECT_EQ(VertexQuant::toHalf(1.f + 3.f * std::ldexp(1.f, -11)), 0x3C02);
+	EXPECT_TRUE(std::isnan(VertexQuant::fromHalf(
+		VertexQuant::toHalf(std::numeric_limits<float>::quiet_NaN())
+	)));
+
+	// UVs in [0, 1] keep 11 bits
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> dist(0.f, 1.f);
+	for (int i = 0; i < 1000; ++i) {
+		float uv = dist(rng);
+		EXPECT_NEAR(VertexQuant::fromHalf(VertexQuant::toHalf(uv)), uv, std::ldexp(1.f, -12));
+	}
+}
+
+TEST(VertexQuantizationTest, OctahedralNormalsStayClose)
+{
+	std::mt19937 rng(11);
+	std::normal_distribution<float> dist;
+
+	// Sine of the angle, a cosine this close to 1 is lost in float
+	float worst = 0.f;
+	for (int i = 0; i < 10000; ++i) {
+		glm::vec3 n = glm::normalize(glm::vec3(dist(rng), dist(rng), dist(rng)));
+		glm::vec3 decoded = VertexQuant::octDecode(VertexQuant::octEncode(n));
+		worst = std::max(worst, glm::length(glm::cross(n, decoded)));
+	}
+	// Under a hundredth of a degree
+	EXPECT_LT(worst, glm::radians(0.01f));
+
+	// The poles and the folded edges
+	for (glm::vec3 n : { glm::vec3(0, 0, 1), glm::vec3(0, 0, -1), glm::vec3(1, 0, 0), glm::vec3(0, -1, 0) }) {
+		glm::vec3 decoded = VertexQuant::octDecode(VertexQuant::octEncode(n));
+		EXPECT_NEAR(glm::dot(n, decoded), 1.f, 1e-6f);
+	}
+
+	// Meshes without normals import zeros
+	glm::vec3 up = VertexQuant::octDecode(VertexQuant::octEncode(glm::vec3(0.f)));
+	EXPECT_EQ(up, glm::vec3(0, 0, 1));
+}
+
+TEST(VertexQuantizationTest, PositionsQuantizeWithinBounds)
+{
+	Physics::Collisions::AABB bounds(glm::vec3(-10.f, 2.f, 5.f), glm::vec3(30.f, 2.f, 9.f));
+	auto quantization = VertexQuant::fromBounds(bounds);
+
+	// The flat axis doesn't divide by zero
+	EXPECT_EQ(quantization.extent.y, 1.f);
+
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	glm::vec3 step = bounds.extents() / 32767.f;
+	for (int i = 0; i < 1000; ++i) {
+		TextureVertex vertex {
+			.pos = bounds.min + (bounds.max - bounds.min) * glm::vec3(unit(rng), unit(rng), unit(rng)),
+			.normal = glm::vec3(0, 1, 0),
+			.uv = glm::vec2(unit(rng), unit(rng)),
+		};
+		auto decoded = VertexQuant::decompress(VertexQuant::compress(vertex, quantization), quantization);
+
+		EXPECT_NEAR(decoded.pos.x, vertex.pos.x, step.x);
+		EXPECT_EQ(decoded.pos.y, vertex.pos.y);
+		EXPECT_NEAR(decoded.pos.z, vertex.pos.z, step.z);
+		EXPECT_NEAR(decoded.normal.y, 1.f, 1e-6f);
+		EXPECT_NEAR(decoded.uv.x, vertex.uv.x, 1e-3f);
+	}
+
+	// Corners hit the ends of the range exactly
+	auto corner = VertexQuant::compress(TextureVertex { .pos = bounds.max }, quantization);
+	EXPECT_EQ(corner.pos[0], 32767);
+	EXPECT_EQ(corner.pos[2], 32767);
+}
+
+TEST(VertexQuantizationTest, MeshBuildsRequestedStreams)
+{
+	using TestMesh = Mesh<TextureVertex, Uint32>;
+
+	std::vector<TextureVertex> vertices = {
+		{ .pos = glm::vec3(0, 0, 0), .normal = glm::vec3(0, 0, 1), .uv = glm::vec2(0, 0) },
+		{ .pos = glm::vec3(4, 0, 0), .normal = glm::vec3(0, 0, 1), .uv = glm::vec2(1, 0) },
+		{ .pos = glm::vec3(0, 2, 0), .normal = glm::vec3(0, 0, 1), .uv = glm::vec2(0, 1) },
+	};
+	TestMesh mesh(vertices, { 0, 1, 2 }, TransformComponent(), AssetHandle<Image>());
+	auto full = mesh.triangles();
+
+	mesh.buildStreams({ .b_compact = true, .b_position_stream = true });
+	ASSERT_EQ(mesh.compact_vertices.size(), 3u);
+	ASSERT_EQ(mesh.positions.size(), 3u);
+	EXPECT_EQ(mesh.quantization.center, glm::vec3(2, 1, 0));
+
+	// Triangles now come from the position stream and match exactly
+	mesh.vertices[1].pos = glm::vec3(100.f);
+	EXPECT_EQ(mesh.triangles(), full);
+
+	mesh.buildStreams({});
+	EXPECT_TRUE(mesh.compact_vertices.empty());
+	EXPECT_TRUE(mesh.positions.empty());
+}
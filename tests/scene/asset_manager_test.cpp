@@ -0,0 +1,345 @@
+#include "gtest/gtest.h"
+
+#include "core/ecs/Registry.h"
+#include "core/scene/AssetManager.h"
+#include "util/ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace APE;
+
+TEST(AssetManagerTest, FindOrLoadReturnsCachedAsset)
+{
+	AssetKey key { "asset_manager_test/cached" };
+	int num_loads = 0;
+	auto make = [&]() {
+		++num_loads;
+		return std::make_unique<int>(7);
+	};
+
+	auto first = AssetManager::findOrLoad<int>(key, AssetClass::None, make);
+	auto second = AssetManager::findOrLoad<int>(key, AssetClass::None, make);
+
+	EXPECT_EQ(num_loads, 1);
+	EXPECT_EQ(first.data, second.data);
+	EXPECT_EQ(*second.data, 7);
+}
+
+TEST(AssetManagerTest, ConcurrentFindOrLoadImportsOnce)
+{
+	AssetKey key { "asset_manager_test/concurrent" };
+	std::atomic<int> num_loads = 0;
+	auto make = [&]() {
+		++num_loads;
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		return std::make_unique<int>(42);
+	};
+
+	ThreadPool pool(4);
+	std::vector<std::future<AssetHandle<int>>> handles;
+	for (int i = 0; i < 8; ++i) {
+		handles.push_back(pool.submit([&]() {
+			return AssetManager::findOrLoad<int>(key, AssetClass::None, make);
+		}));
+	}
+
+	std::shared_ptr<int> data;
+	for (auto& handle : handles) {
+		auto h = handle.get();
+		ASSERT_NE(h.data, nullptr);
+		if (!data) data = h.data;
+		EXPECT_EQ(h.data, data);
+	}
+	EXPECT_EQ(num_loads.load(), 1);
+	EXPECT_EQ(*data, 42);
+}
+
+TEST(AssetManagerTest, LoadAsyncServesPlaceholderUntilReady)
+{
+	ThreadPool pool(1);
+	AssetKey key { "asset_manager_test/async" };
+	auto placeholder = std::make_shared<int>(-1);
+
+	std::promise<void> release;
+	std::shared_future<void> gate = release.get_future().share();
+	auto make = [gate]() {
+		gate.wait();
+		return std::make_unique<int>(9);
+	};
+
+	auto handle = AssetManager::loadAsync<int>(key, AssetClass::None, make, placeholder, 0, pool);
+	auto again = AssetManager::loadAsync<int>(key, AssetClass::None, make, placeholder, 0, pool);
+	EXPECT_EQ(handle.status(), AssetStatus::Loading);
+	EXPECT_EQ(*handle.get(), -1);
+	EXPECT_EQ(handle.load_state, again.load_state);
+
+	int callback_value = 0;
+	handle.onComplete([&](const AssetHandle<int>& loaded) {
+		callback_value = *loaded.get();
+	});
+
+	release.set_value();
+	EXPECT_TRUE(handle.wait());
+	EXPECT_EQ(*handle.get(), 9);
+	EXPECT_EQ(*again.get(), 9);
+
+	// Callbacks wait for the main thread
+	EXPECT_EQ(callback_value, 0);
+	AssetManager::dispatchCallbacks();
+	EXPECT_EQ(callback_value, 9);
+
+	// Later requests resolve straight from the cache
+	auto cached = AssetManager::loadAsync<int>(key, AssetClass::None, make, placeholder, 0, pool);
+	EXPECT_TRUE(cached.isReady());
+	EXPECT_EQ(cached.load_state, nullptr);
+}
+
+TEST(AssetManagerTest, LoadAsyncReportsFailure)
+{
+	ThreadPool pool(1);
+	AssetKey key { "asset_manager_test/async_failed" };
+
+	auto handle = AssetManager::loadAsync<int>(
+		key,
+		AssetClass::None,
+		[]() { return std::unique_ptr<int>(); },
+		std::make_shared<int>(-1),
+		0,
+		pool
+	);
+
+	EXPECT_FALSE(handle.wait());
+	EXPECT_EQ(handle.status(), AssetStatus::Failed);
+	EXPECT_EQ(*handle.get(), -1);
+
+	bool b_called = false;
+	handle.onComplete([&](const AssetHandle<int>& loaded) {
+		b_called = true;
+		EXPECT_EQ(loaded.get(), nullptr);
+	});
+	EXPECT_TRUE(b_called);
+}
+
+namespace {
+
+struct SizedAsset {
+	size_t bytes;
+
+	[[nodiscard]] size_t cpuBytes() const noexcept
+	{
+		return bytes;
+	}
+};
+
+};	// end of namespace
+
+TEST(AssetManagerTest, EvictsLeastRecentlyUsedOverBudget)
+{
+	constexpr AssetClass CLASS = AssetClass::None;
+
+	// Whatever other tests left unreferenced goes first
+	AssetManager::setBudget(CLASS, 0);
+	auto before = AssetManager::getStats(CLASS);
+	AssetManager::setBudget(CLASS, before.resident_bytes + 250);
+
+	int num_loads = 0;
+	auto load = [&](const AssetKey& key) {
+		return AssetManager::findOrLoad<SizedAsset>(key, CLASS, [&]() {
+			++num_loads;
+			return std::make_unique<SizedAsset>(SizedAsset { 100 });
+		});
+	};
+
+	AssetKey a { "asset_manager_test/lru_a" };
+	AssetKey b { "asset_manager_test/lru_b" };
+	AssetKey c { "asset_manager_test/lru_c" };
+	(void)load(a);
+	(void)load(b);
+	(void)load(a);
+	auto held = load(c);
+	EXPECT_EQ(AssetManager::trim(), 1u);
+
+	// b was used least recently and nothing else references it
+	EXPECT_TRUE(AssetManager::contains(a));
+	EXPECT_FALSE(AssetManager::contains(b));
+	EXPECT_TRUE(AssetManager::contains(c));
+
+	auto stats = AssetManager::getStats(CLASS);
+	EXPECT_EQ(stats.resident_bytes, before.resident_bytes + 200);
+	EXPECT_EQ(stats.misses - before.misses, 3u);
+	EXPECT_EQ(stats.hits - before.hits, 1u);
+	EXPECT_EQ(stats.evictions - before.evictions, 1u);
+
+	// Asking again reloads it through the same key
+	auto reloaded = load(b);
+	EXPECT_EQ(num_loads, 4);
+	EXPECT_EQ(reloaded.data->bytes, 100u);
+
+	AssetManager::setBudget(CLASS, std::numeric_limits<size_t>::max());
+}
+
+TEST(AssetManagerTest, ReferencedAssetsAreNeverEvicted)
+{
+	constexpr AssetClass CLASS = AssetClass::None;
+	AssetKey key { "asset_manager_test/referenced" };
+
+	auto handle = AssetManager::findOrLoad<SizedAsset>(key, CLASS, []() {
+		return std::make_unique<SizedAsset>(SizedAsset { 64 });
+	});
+	AssetManager::setBudget(CLASS, 0);
+	EXPECT_TRUE(AssetManager::contains(key));
+
+	handle = {};
+	EXPECT_GE(AssetManager::trim(), 1u);
+	EXPECT_FALSE(AssetManager::contains(key));
+
+	AssetManager::setBudget(CLASS, std::numeric_limits<size_t>::max());
+}
+
+TEST(AssetManagerTest, LiveIdsPinAssetsOverBudget)
+{
+	constexpr AssetClass CLASS = AssetClass::None;
+	auto load = [](const AssetKey& key) {
+		return AssetManager::findOrLoad<SizedAsset>(key, CLASS, []() {
+			return std::make_unique<SizedAsset>(SizedAsset { 100 });
+		}).id;
+	};
+
+	AssetId drawn = load({ "asset_manager_test/live_drawn" });
+	AssetId copied = load({ "asset_manager_test/live_copied" });
+	AssetId unused = load({ "asset_manager_test/live_unused" });
+
+	// Components hold ids only, like a scene's meshes and materials
+	ECS::Registry registry;
+	auto ent = registry.createEntity();
+	registry.emplaceComponent<LiveAssetId>(ent, drawn);
+	std::vector<LiveAssetId> ids { copied };
+	ids.push_back(ids.front());
+	ids.erase(ids.begin());
+	EXPECT_EQ(AssetManager::numRefs(drawn), 1u);
+	EXPECT_EQ(AssetManager::numRefs(copied), 1u);
+
+	// The working set is over any budget, only the unused asset goes
+	AssetManager::setBudget(CLASS, 0);
+	EXPECT_TRUE(AssetManager::isResident(drawn));
+	EXPECT_TRUE(AssetManager::isResident(copied));
+	EXPECT_FALSE(AssetManager::isResident(unused));
+	EXPECT_FALSE(AssetManager::release(drawn));
+
+	registry.destroyEntity(ent);
+	ids.clear();
+	EXPECT_EQ(AssetManager::numRefs(drawn), 0u);
+	EXPECT_GE(AssetManager::trim(), 2u);
+	EXPECT_FALSE(AssetManager::isResident(drawn));
+	EXPECT_FALSE(AssetManager::isResident(copied));
+
+	AssetManager::setBudget(CLASS, std::numeric_limits<size_t>::max());
+}
+
+TEST(AssetManagerTest, LiveIdsCountAcrossThreads)
+{
+	constexpr AssetClass CLASS = AssetClass::None;
+	AssetKey key { "asset_manager_test/live_threads" };
+	AssetId id = AssetManager::findOrLoad<SizedAsset>(key, CLASS, []() {
+		return std::make_unique<SizedAsset>(SizedAsset { 8 });
+	}).id;
+
+	// Component copies on several threads at once, like snapshots and
+	// cell loads next to the main thread
+	LiveAssetId held = id;
+	ThreadPool pool(4);
+	pool.parallelFor(64, [&](size_t) {
+		std::vector<LiveAssetId> copies(100, held);
+		copies.clear();
+	});
+	EXPECT_EQ(AssetManager::numRefs(id), 1u);
+	EXPECT_FALSE(AssetManager::release(id));
+
+	held = LiveAssetId();
+	EXPECT_TRUE(AssetManager::release(id));
+
+	// A stale ID doesn't pin whatever reuses its slot
+	LiveAssetId stale = id;
+	AssetId other = AssetManager::registerKey<SizedAsset>(key, CLASS);
+	EXPECT_EQ(other.index(), id.index());
+	EXPECT_EQ(AssetManager::numRefs(other), 0u);
+	EXPECT_TRUE(AssetManager::release(other));
+}
+
+TEST(AssetManagerTest, FindAllResolvesEveryId)
+{
+	auto number = AssetManager::findOrLoad<int>(AssetKey { "asset_manager_test/find_all_int" }, AssetClass::None, []() {
+		return std::make_unique<int>(3);
+	});
+	auto sized = AssetManager::findOrLoad<SizedAsset>(AssetKey { "asset_manager_test/find_all_sized" }, AssetClass::None, []() {
+		return std::make_unique<SizedAsset>(SizedAsset { 4 });
+	});
+
+	auto [found_number, found_sized] = AssetManager::findAll<int, SizedAsset>(number.id, sized.id);
+	EXPECT_EQ(found_number, number.data.get());
+	EXPECT_EQ(found_sized, sized.data.get());
+
+	auto [missing, still_found] = AssetManager::findAll<int, SizedAsset>(AssetId(), sized.id);
+	EXPECT_EQ(missing, nullptr);
+	EXPECT_EQ(still_found, sized.data.get());
+}
+
+TEST(AssetManagerTest, IdsStayValidAcrossEviction)
+{
+	constexpr AssetClass CLASS = AssetClass::None;
+	AssetKey key { "asset_manager_test/stable_id" };
+	auto load = [&]() {
+		return AssetManager::findOrLoad<SizedAsset>(key, CLASS, []() {
+			return std::make_unique<SizedAsset>(SizedAsset { 32 });
+		});
+	};
+
+	AssetId id = load().id;
+	ASSERT_TRUE(id.isValid());
+	EXPECT_EQ(AssetManager::registerKey<SizedAsset>(key, CLASS), id);
+	ASSERT_NE(AssetManager::find<SizedAsset>(id), nullptr);
+	EXPECT_EQ(AssetManager::find<SizedAsset>(id)->bytes, 32u);
+
+	AssetManager::setBudget(CLASS, 0);
+	EXPECT_FALSE(AssetManager::isResident(id));
+	EXPECT_EQ(AssetManager::find<SizedAsset>(id), nullptr);
+	EXPECT_EQ(AssetManager::keyOf(id), key);
+	AssetManager::setBudget(CLASS, std::numeric_limits<size_t>::max());
+
+	// Reloading fills the same slot
+	auto reloaded = load();
+	EXPECT_EQ(reloaded.id, id);
+	EXPECT_EQ(AssetManager::find<SizedAsset>(id), reloaded.data.get());
+}
+
+TEST(AssetManagerTest, ReleasedIdsGoStale)
+{
+	constexpr AssetClass CLASS = AssetClass::None;
+	AssetKey key { "asset_manager_test/released" };
+
+	auto handle = AssetManager::findOrLoad<SizedAsset>(key, CLASS, []() {
+		return std::make_unique<SizedAsset>(SizedAsset { 16 });
+	});
+	AssetId id = handle.id;
+	EXPECT_FALSE(AssetManager::release(id));
+
+	handle = {};
+	EXPECT_TRUE(AssetManager::release(id));
+	EXPECT_FALSE(AssetManager::contains(key));
+	EXPECT_EQ(AssetManager::find<SizedAsset>(id), nullptr);
+	EXPECT_EQ(AssetManager::keyOf(id), AssetKey());
+	EXPECT_FALSE(AssetManager::release(id));
+
+	// The freed slot is reused under a new generation, the old ID stays stale
+	AssetId other = AssetManager::registerKey<SizedAsset>(AssetKey { "asset_manager_test/reused" }, CLASS);
+	EXPECT_EQ(other.index(), id.index());
+	EXPECT_NE(other.generation(), id.generation());
+	EXPECT_EQ(AssetManager::keyOf(id), AssetKey());
+	EXPECT_FALSE(AssetManager::isResident(AssetId()));
+}
@@ -0,0 +1,179 @@
+#include "gtest/gtest.h"
+
+#include "core/scene/AssetPack.h"
+#include "core/scene/ModelCache.h"
+#include "util/FileHash.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace APE;
+
+class AssetPackTest : public testing::Test {
+protected:
+	std::filesystem::path dir;
+	std::filesystem::path pack_path;
+	std::vector<std::filesystem::path> files;
+
+	void SetUp() override
+	{
+		dir = std::filesystem::temp_directory_path() / "asset_pack_test";
+		std::filesystem::remove_all(dir);
+		pack_path = dir / "test.apepack";
+
+		std::string model;
+		for (int i = 0; i < 500; ++i) model += "v 0.000000 1.000000 -1.000000\n";
+
+		files = {
+			writeFile("res/shaders/Basic.vert.spv", "\x03\x02\x23\x07 not really spirv"),
+			writeFile("res/models/box/box.obj", model),
+			writeFile("res/models/box/box.mtl", "newmtl box\n"),
+			writeFile("res/models/box.gltf", "{}"),
+			writeFile("res/empty.txt", ""),
+		};
+	}
+
+	void TearDown() override
+	{
+		AssetPack::unmountAll();
+		std::filesystem::remove_all(dir);
+	}
+
+	std::filesystem::path writeFile(const std::filesystem::path& rel, std::string_view text)
+	{
+		std::filesystem::path path = dir / rel;
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream os(path, std::ios::binary | std::ios::trunc);
+		os.write(text.data(), text.size());
+		return path;
+	}
+
+	[[nodiscard]] static std::string text(std::span<const std::byte> bytes)
+	{
+		return std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	}
+};
+
+TEST_F(AssetPackTest, EntriesAreFoundAndAligned)
+{
+	ASSERT_TRUE(AssetPack::write(pack_path, files));
+
+	AssetPack pack;
+	ASSERT_TRUE(pack.open(pack_path));
+	ASSERT_EQ(pack.entries().size(), files.size());
+
+	for (auto& path : files) {
+		auto* entry = pack.find(path);
+		ASSERT_NE(entry, nullptr) << path;
+		EXPECT_EQ(entry->offset % AssetPack::PAGE_SIZE, 0u);
+		EXPECT_EQ(entry->flags, 0u);
+		EXPECT_EQ(entry->size, std::filesystem::file_size(path));
+		EXPECT_EQ(entry->content_hash, Hash::fileContents(path));
+		EXPECT_EQ(pack.path(*entry), AssetPack::key(path));
+	}
+
+	// Other spellings of the same path
+	auto spirv = dir / "res/shaders/Basic.vert.spv";
+	EXPECT_EQ(pack.find(dir / "res/models/../shaders/./Basic.vert.spv"), pack.find(spirv));
+	EXPECT_EQ(pack.find(dir / "res/shaders/Missing.spv"), nullptr);
+
+	// The manifest is in name order
+	auto paths = pack.paths();
+	ASSERT_EQ(paths.size(), files.size());
+	EXPECT_TRUE(std::is_sorted(paths.begin(), paths.end()));
+}
+
+TEST_F(AssetPackTest, StoredFilesReadInPlace)
+{
+	ASSERT_TRUE(AssetPack::write(pack_path, files));
+	ASSERT_TRUE(AssetPack::mount(pack_path));
+
+	auto shader = AssetPack::resolve(dir / "res/shaders/Basic.vert.spv");
+	ASSERT_TRUE(shader);
+	EXPECT_TRUE(shader.decoded.empty());
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(shader.bytes().data()) % AssetPack::PAGE_SIZE, 0u);
+	EXPECT_EQ(text(shader.bytes()), std::string("\x03\x02\x23\x07 not really spirv"));
+
+	auto empty = AssetPack::resolve(dir / "res/empty.txt");
+	ASSERT_TRUE(empty);
+	EXPECT_TRUE(empty.bytes().empty());
+
+	EXPECT_FALSE(AssetPack::resolve(dir / "res/missing.png"));
+	EXPECT_EQ(AssetPack::contentHash(dir / "res/missing.png"), 0u);
+
+	// Derived data caches see the packed hash
+	auto model_path = dir / "res/models/box/box.obj";
+	EXPECT_EQ(ModelCache::contentHash(model_path), Hash::fileContents(model_path));
+}
+
+TEST_F(AssetPackTest, CompressedFilesDecode)
+{
+	ASSERT_TRUE(AssetPack::write(pack_path, files, { .b_compress = true }));
+
+	AssetPack pack;
+	ASSERT_TRUE(pack.open(pack_path));
+
+	// Text shrinks, the tiny files wouldn't save anything
+	auto model_path = dir / "res/models/box/box.obj";
+	auto* model = pack.find(model_path);
+	ASSERT_NE(model, nullptr);
+	EXPECT_EQ(model->flags, AssetPack::FLAG_LZ4);
+	EXPECT_LT(model->stored_size, model->size / 10);
+	EXPECT_EQ(pack.find(dir / "res/models/box.gltf")->flags, 0u);
+
+	ASSERT_TRUE(AssetPack::mount(pack_path));
+	auto file = AssetPack::resolve(model_path);
+	ASSERT_TRUE(file);
+	EXPECT_EQ(file.bytes().size(), model->size);
+	EXPECT_EQ(Hash::contents(file.bytes()), Hash::fileContents(model_path));
+}
+
+TEST_F(AssetPackTest, ListsDirectories)
+{
+	ASSERT_TRUE(AssetPack::write(pack_path, files));
+
+	AssetPack pack;
+	ASSERT_TRUE(pack.open(pack_path));
+
+	EXPECT_EQ(pack.list(dir / "res"), (std::vector<std::string> { "empty.txt", "models/", "shaders/" }));
+	EXPECT_EQ(pack.list(dir / "res/models/"), (std::vector<std::string> { "box.gltf", "box/" }));
+	EXPECT_EQ(pack.list(dir / "res/models/box"), (std::vector<std::string> { "box.mtl", "box.obj" }));
+	EXPECT_TRUE(pack.list(dir / "res/textures").empty());
+}
+
+TEST_F(AssetPackTest, LaterMountsShadowEarlierOnes)
+{
+	auto shader_path = dir / "res/shaders/Basic.vert.spv";
+	ASSERT_TRUE(AssetPack::write(pack_path, files));
+
+	auto patch_path = dir / "patch.apepack";
+	writeFile("res/shaders/Basic.vert.spv", "patched");
+	ASSERT_TRUE(AssetPack::write(patch_path, std::vector { shader_path }));
+
+	ASSERT_TRUE(AssetPack::mount(pack_path));
+	ASSERT_TRUE(AssetPack::mount(patch_path));
+
+	auto shader = AssetPack::resolve(shader_path);
+	EXPECT_EQ(text(shader.bytes()), "patched");
+	EXPECT_TRUE(AssetPack::resolve(dir / "res/models/box.gltf"));
+
+	// Resolved files keep their archive mapped
+	AssetPack::unmountAll();
+	EXPECT_FALSE(AssetPack::resolve(shader_path));
+	EXPECT_EQ(text(shader.bytes()), "patched");
+}
+
+TEST_F(AssetPackTest, RejectsCorruptPacks)
+{
+	ASSERT_TRUE(AssetPack::write(pack_path, files));
+	std::filesystem::resize_file(pack_path, std::filesystem::file_size(pack_path) - 1);
+
+	AssetPack pack;
+	EXPECT_FALSE(pack.open(pack_path));
+	EXPECT_FALSE(pack.isOpen());
+	EXPECT_FALSE(AssetPack::mount(pack_path));
+	EXPECT_FALSE(AssetPack::mount(dir / "missing.apepack"));
+}
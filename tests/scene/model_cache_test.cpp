@@ -0,0 +1,148 @@
+#include "gtest/gtest.h"
+
+#include "core/scene/ModelCache.h"
+#include "core/scene/ImageLoader.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace APE;
+
+class ModelCacheTest : public testing::Test {
+protected:
+	std::filesystem::path dir;
+	std::filesystem::path source;
+	std::filesystem::path cache_path;
+
+	void SetUp() override
+	{
+		dir = std::filesystem::temp_directory_path() / "model_cache_test";
+		std::filesystem::create_directories(dir);
+		ModelCache::setDirectory(dir / "cache");
+
+		source = dir / "tri.obj";
+		writeSource("v 0 0 0\n");
+		cache_path = ModelCache::cachePath(source);
+	}
+
+	void TearDown() override
+	{
+		ModelCache::setDirectory("cache/models");
+		std::filesystem::remove_all(dir);
+	}
+
+	void writeSource(const char* text)
+	{
+		std::ofstream os(source, std::ios::trunc);
+		os << text;
+	}
+
+	Render::Model makeModel()
+	{
+		Render::Model model(source);
+		std::vector<Render::Model::VertexType> vertices = {
+			{ .pos = { 0.f, 0.f, 0.f }, .normal = { 0.f, 0.f, 1.f }, .uv = { 0.f, 0.f } },
+			{ .pos = { 1.f, 0.f, 0.f }, .normal = { 0.f, 0.f, 1.f }, .uv = { 1.f, 0.f } },
+			{ .pos = { 0.f, 2.f, 0.f }, .normal = { 0.f, 0.f, 1.f }, .uv = { 0.f, 1.f } },
+		};
+		TransformComponent transform(glm::vec3(3.f, 0.f, 0.f));
+		model.meshes.emplace_back(vertices, std::vector<Uint32> { 0, 1, 2 }, transform, ImageLoader::defaultImage());
+		model.meshes[0].lod_indices = { 2, 0, 1 };
+		model.meshes[0].lods = { { .index_offset = 0, .index_count = 3, .error = 0.25f } };
+		model.computeBounds();
+		return model;
+	}
+};
+
+TEST_F(ModelCacheTest, RoundTripSkipsImport)
+{
+	uint64_t hash = ModelCache::contentHash(source);
+	ASSERT_NE(hash, 0u);
+	ASSERT_TRUE(ModelCache::save(cache_path, makeModel(), hash));
+
+	auto model = ModelCache::load(cache_path, source, hash);
+	ASSERT_NE(model, nullptr);
+	ASSERT_EQ(model->meshes.size(), 1u);
+
+	auto& mesh = model->meshes[0];
+	ASSERT_EQ(mesh.vertices.size(), 3u);
+	EXPECT_EQ(mesh.vertices[2].pos.y, 2.f);
+	EXPECT_EQ(mesh.vertices[1].uv.x, 1.f);
+	EXPECT_EQ(mesh.indices, (std::vector<Uint32> { 0, 1, 2 }));
+	EXPECT_EQ(mesh.lod_indices, (std::vector<Uint32> { 2, 0, 1 }));
+	ASSERT_EQ(mesh.lods.size(), 1u);
+	EXPECT_EQ(mesh.lods[0].index_count, 3u);
+	EXPECT_EQ(mesh.lods[0].error, 0.25f);
+	EXPECT_EQ(mesh.lodRange(1), std::make_pair(3u, 3u));
+	EXPECT_EQ(mesh.transform.position.x, 3.f);
+	EXPECT_EQ(mesh.bounds.max.y, 2.f);
+	EXPECT_EQ(mesh.texture_handle.key, ImageLoader::defaultImage().key);
+	EXPECT_EQ(model->bounds.min.x, 3.f);
+}
+
+TEST_F(ModelCacheTest, IndexWidthRoundTrips)
+{
+	uint64_t hash = ModelCache::contentHash(source);
+	auto model = makeModel();
+	ASSERT_TRUE(ModelCache::save(cache_path, model, hash));
+	auto wide_size = std::filesystem::file_size(cache_path);
+
+	model.meshes[0].index_size = sizeof(Uint16);
+	ASSERT_TRUE(ModelCache::save(cache_path, model, hash));
+	EXPECT_LT(std::filesystem::file_size(cache_path), wide_size);
+
+	auto loaded = ModelCache::load(cache_path, source, hash);
+	ASSERT_NE(loaded, nullptr);
+	auto& mesh = loaded->meshes[0];
+	EXPECT_EQ(mesh.index_size, sizeof(Uint16));
+	EXPECT_EQ(mesh.indices, (std::vector<Uint32> { 0, 1, 2 }));
+	EXPECT_EQ(mesh.lod_indices, (std::vector<Uint32> { 2, 0, 1 }));
+}
+
+TEST_F(ModelCacheTest, EditedSourceIsStale)
+{
+	uint64_t hash = ModelCache::contentHash(source);
+	ASSERT_TRUE(ModelCache::save(cache_path, makeModel(), hash));
+
+	writeSource("v 0 0 1\n");
+	uint64_t edited = ModelCache::contentHash(source);
+	EXPECT_NE(edited, hash);
+	EXPECT_EQ(ModelCache::load(cache_path, source, edited), nullptr);
+}
+
+TEST_F(ModelCacheTest, UnchangedSourcesSkipHashing)
+{
+	// Not the source's real hash, so only the stamp can match it
+	ASSERT_TRUE(ModelCache::save(cache_path, makeModel(), 99, 1234));
+	EXPECT_EQ(ModelCache::stampedHash(cache_path, Hash::fileStamp(source)), 1234u);
+	EXPECT_EQ(ModelCache::contentHash(source, cache_path), 1234u);
+	EXPECT_NE(ModelCache::contentHash(source), 1234u);
+
+	// An edited source is hashed again
+	{
+		std::ofstream os(source, std::ios::app);
+		os << "v 1 0 0\n";
+	}
+	EXPECT_EQ(ModelCache::stampedHash(cache_path, Hash::fileStamp(source)), 0u);
+	EXPECT_EQ(ModelCache::contentHash(source, cache_path), ModelCache::contentHash(source));
+
+	// Without a source hash, the cache isn't stamped
+	ASSERT_TRUE(ModelCache::save(cache_path, makeModel(), 99));
+	EXPECT_EQ(ModelCache::stampedHash(cache_path, Hash::fileStamp(source)), 0u);
+}
+
+TEST_F(ModelCacheTest, RejectsTruncatedCache)
+{
+	uint64_t hash = ModelCache::contentHash(source);
+	ASSERT_TRUE(ModelCache::save(cache_path, makeModel(), hash));
+
+	auto size = std::filesystem::file_size(cache_path);
+	std::filesystem::resize_file(cache_path, size / 2);
+	EXPECT_EQ(ModelCache::load(cache_path, source, hash), nullptr);
+}
+
+TEST_F(ModelCacheTest, MissingSourceHasNoHash)
+{
+	EXPECT_EQ(ModelCache::contentHash(dir / "missing.obj"), 0u);
+	EXPECT_NE(ModelCache::cachePath(dir / "a" / "m.obj"), ModelCache::cachePath(dir / "b" / "m.obj"));
+}
@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+
+#include "core/scene/AssetManager.h"
+#include "core/scene/ImageLoader.h"
+#include "core/scene/ModelLoader.h"
+#include "util/ThreadPool.h"
+
+#include <future>
+#include <memory>
+#include <vector>
+
+using namespace APE;
+
+namespace {
+
+// A scene whose only content is one 2x2 texture, owned by the scene
+std::unique_ptr<aiScene> embeddedScene()
+{
+	auto scene = std::make_unique<aiScene>();
+	auto* ai_tex = new aiTexture();
+	ai_tex->mWidth = 2;
+	ai_tex->mHeight = 2;
+	ai_tex->pcData = new aiTexel[4];
+	for (int i = 0; i < 4; ++i) {
+		ai_tex->pcData[i] = { 0, 0, 255, 255 };
+	}
+	scene->mNumTextures = 1;
+	scene->mTextures = new aiTexture*[1] { ai_tex };
+	return scene;
+}
+
+};	// end of namespace
+
+TEST(ModelLoaderTest, SharedEmbeddedTexturesDecodeOnce)
+{
+	auto scene = embeddedScene();
+	std::filesystem::path model_path = "model_loader_test/shared.fbx";
+	aiString ref(std::string("*0"));
+	uint64_t misses = AssetManager::getStats(AssetClass::Texture).misses;
+
+	// Two materials, converted side by side as importModel does
+	ThreadPool pool(2);
+	std::vector<std::future<AssetHandle<Render::Image>>> textures;
+	for (int i = 0; i < 2; ++i) {
+		textures.push_back(pool.submit([&]() {
+			return ModelLoader::loadEmbeddedTexture(scene.get(), ref, model_path);
+		}));
+	}
+
+	auto first = textures[0].get();
+	auto second = textures[1].get();
+	ASSERT_NE(first.data, nullptr);
+	EXPECT_EQ(first.data, second.data);
+	EXPECT_EQ(first.data->getWidth(), 2u);
+	EXPECT_EQ(AssetManager::getStats(AssetClass::Texture).misses, misses + 1);
+}
+
+TEST(ModelLoaderTest, MissingEmbeddedTexturesFallBack)
+{
+	auto scene = embeddedScene();
+	aiString ref(std::string("*3"));
+
+	auto texture = ModelLoader::loadEmbeddedTexture(scene.get(), ref, "model_loader_test/missing.fbx");
+	EXPECT_EQ(texture.data, ImageLoader::defaultImage().data);
+}
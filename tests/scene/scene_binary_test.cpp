@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+
+#include "core/scene/SceneBinary.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace APE;
+
+class SceneBinaryTest : public testing::Test {
+protected:
+	std::filesystem::path path;
+
+	void SetUp() override
+	{
+		path = std::filesystem::temp_directory_path() / "scene_binary_test.apescene";
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove(path);
+	}
+
+	static ECS::EntityHandle addChild(Scene& world, const char* tag)
+	{
+		ECS::EntityHandle ent = world.registry.createEntity();
+		world.registry.emplaceComponent<HierarchyComponent>(ent, tag);
+		world.setParent(ent, world.root);
+		return ent;
+	}
+};
+
+TEST_F(SceneBinaryTest, RoundTripPreservesHierarchyAndPools)
+{
+	Scene world;
+	auto a = addChild(world, "a");
+	auto b = addChild(world, "b");
+	world.registry.emplaceComponent<TransformComponent>(a, glm::vec3(1.f, 2.f, 3.f));
+	world.registry.emplaceComponent<TransformComponent>(b, glm::vec3(-4.f, 0.f, 4.f));
+	world.registry.emplaceComponent<Render::LightComponent>(b, Render::LightType::Point, 2.f);
+	ASSERT_TRUE(SceneBinary::save(path, world));
+
+	Scene loaded;
+	SceneLoadProgress progress;
+	ASSERT_TRUE(SceneBinary::load(path, loaded, &progress));
+	EXPECT_EQ(progress.pools_done.load(), progress.pools_total.load());
+	EXPECT_EQ(loaded.registry.numEntities(), world.registry.numEntities());
+
+	auto& root = loaded.registry.getComponent<HierarchyComponent>(loaded.root);
+	EXPECT_EQ(root.tag, StringId("Root Node"));
+	ASSERT_EQ(root.children.size(), 2u);
+
+	auto& h_a = loaded.registry.getComponent<HierarchyComponent>(root.children[0]);
+	auto& h_b = loaded.registry.getComponent<HierarchyComponent>(root.children[1]);
+	EXPECT_EQ(h_a.tag, StringId("a"));
+	EXPECT_EQ(h_b.tag, StringId("b"));
+	EXPECT_EQ(h_a.parent, loaded.root);
+
+	auto& t_b = loaded.registry.getComponent<TransformComponent>(root.children[1]);
+	EXPECT_EQ(t_b.position, glm::vec3(-4.f, 0.f, 4.f));
+
+	auto& light = loaded.registry.getComponent<Render::LightComponent>(root.children[1]);
+	EXPECT_EQ(light.type, Render::LightType::Point);
+	EXPECT_FLOAT_EQ(light.intensity, 2.f);
+	EXPECT_FALSE(loaded.registry.hasComponent<Render::LightComponent>(root.children[0]));
+}
+
+TEST_F(SceneBinaryTest, RejectsTruncatedFile)
+{
+	Scene world;
+	addChild(world, "a");
+	ASSERT_TRUE(SceneBinary::save(path, world));
+
+	auto size = std::filesystem::file_size(path);
+	std::filesystem::resize_file(path, size / 2);
+
+	Scene loaded;
+	SceneLoadProgress progress;
+	EXPECT_FALSE(SceneBinary::load(path, loaded, &progress));
+	EXPECT_EQ(progress.stage.load(), SceneLoadProgress::Stage::Failed);
+}
+
+TEST_F(SceneBinaryTest, RejectsNonBinaryFile)
+{
+	std::ofstream(path) << "{ \"not\": \"binary\" }";
+
+	Scene loaded;
+	EXPECT_FALSE(SceneBinary::load(path, loaded));
+}
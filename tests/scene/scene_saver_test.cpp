@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+
+#include "core/scene/SceneBinary.h"
+#include "core/scene/SceneSaver.h"
+
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+using namespace APE;
+
+class SceneSaverTest : public testing::Test {
+protected:
+	ThreadPool pool { 1 };
+	Scene world;
+	std::filesystem::path path;
+
+	void SetUp() override
+	{
+		path = std::filesystem::temp_directory_path() / "scene_saver_test.apescene";
+
+		auto ent = world.registry.createEntity();
+		world.registry.emplaceComponent<HierarchyComponent>(ent, "child");
+		world.registry.emplaceComponent<TransformComponent>(ent, glm::vec3(1.f));
+		world.setParent(ent, world.root);
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove(path);
+	}
+};
+
+TEST_F(SceneSaverTest, RequestedSaveWritesAtUpdate)
+{
+	SceneSaver saver(pool);
+	saver.requestSave(path);
+	EXPECT_FALSE(saver.isSaving());
+
+	saver.update(world);
+	saver.wait();
+
+	EXPECT_TRUE(std::filesystem::exists(path));
+	EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+	auto& metrics = saver.metrics();
+	EXPECT_EQ(metrics.saves_completed.load(), 1u);
+	EXPECT_EQ(metrics.last_bytes_written.load(), std::filesystem::file_size(path));
+
+	Scene loaded;
+	ASSERT_TRUE(SceneBinary::load(path, loaded));
+	EXPECT_EQ(loaded.registry.numEntities(), world.registry.numEntities());
+}
+
+TEST_F(SceneSaverTest, SnapshotIgnoresLaterChanges)
+{
+	SceneSaver saver(pool);
+	saver.requestSave(path);
+	saver.update(world);
+
+	// Mutating after the frame boundary must not reach the file
+	auto ent = world.registry.createEntity();
+	world.registry.emplaceComponent<HierarchyComponent>(ent, "late");
+	world.setParent(ent, world.root);
+	saver.wait();
+
+	Scene loaded;
+	ASSERT_TRUE(SceneBinary::load(path, loaded));
+	EXPECT_EQ(loaded.registry.numEntities(), world.registry.numEntities() - 1);
+}
+
+TEST_F(SceneSaverTest, AutosaveRunsOnInterval)
+{
+	SceneSaver saver(pool);
+	saver.setAutosave(path, Timing::seconds(0.01));
+
+	saver.update(world);
+	saver.wait();
+	EXPECT_EQ(saver.metrics().saves_completed.load(), 0u);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	saver.update(world);
+	saver.wait();
+	EXPECT_EQ(saver.metrics().saves_completed.load(), 1u);
+	EXPECT_TRUE(std::filesystem::exists(path));
+}
@@ -0,0 +1,102 @@
+#include "gtest/gtest.h"
+
+#include "core/scene/Serialize.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace APE;
+
+TEST(SerializeContextTest, SaveCompactsEntityIds)
+{
+	ECS::Registry r;
+	std::vector<ECS::EntityHandle> ents;
+	for (int i = 0; i < 4; ++i) {
+		ents.push_back(r.createEntity());
+	}
+	r.destroyEntity(ents[1]);
+
+	SceneSaveContext ctx(r);
+	std::vector<ECS::EntityID> compacted;
+	for (auto ent : r.entities()) {
+		compacted.push_back(ctx.compact(ent));
+	}
+	std::sort(compacted.begin(), compacted.end());
+	EXPECT_EQ(compacted, (std::vector<ECS::EntityID> { 0, 1, 2 }));
+
+	EXPECT_EQ(ctx.compact(ECS::EntityHandle()), ECS::EntityHandle().id);
+}
+
+TEST(SerializeContextTest, LoadRemapsThroughDenseTable)
+{
+	ECS::Registry r;
+	SceneLoadContext ctx;
+	std::vector<ECS::EntityHandle> saved { { 0 }, { 2 }, { 1 } };
+	ctx.mapEntities(r, saved);
+
+	EXPECT_EQ(r.numEntities(), 3u);
+	auto a = ctx.remap({ 0 });
+	auto b = ctx.remap({ 1 });
+	auto c = ctx.remap({ 2 });
+	EXPECT_NE(a, b);
+	EXPECT_NE(b, c);
+	EXPECT_NE(a, c);
+	EXPECT_EQ(ctx.remap(ECS::EntityHandle()), ECS::EntityHandle());
+}
+
+TEST(SerializeContextTest, LoadRejectsUnknownIds)
+{
+	ECS::Registry r;
+	SceneLoadContext ctx;
+	ctx.mapEntities(r, { { 0 }, { 2 } });
+
+	EXPECT_THROW((void)ctx.remap({ 1 }), cereal::Exception);
+	EXPECT_THROW((void)ctx.remap({ 3 }), cereal::Exception);
+
+	SceneLoadContext duplicates;
+	EXPECT_THROW(duplicates.mapEntities(r, { { 0 }, { 1 }, { 0 } }), cereal::Exception);
+	EXPECT_THROW(duplicates.mapEntities(r, { { 1'000'000 }, { 1'000'000 } }), cereal::Exception);
+}
+
+TEST(SerializeContextTest, LoadRemapsSparseIds)
+{
+	ECS::Registry r;
+	SceneLoadContext ctx;
+	ctx.mapEntities(r, { { 1'000'000 }, { 7 } });
+
+	auto a = ctx.remap({ 1'000'000 });
+	auto b = ctx.remap({ 7 });
+	EXPECT_TRUE(r.isValid(a));
+	EXPECT_TRUE(r.isValid(b));
+	EXPECT_NE(a, b);
+	EXPECT_EQ(ctx.remap(ECS::EntityHandle()), ECS::EntityHandle());
+	EXPECT_THROW((void)ctx.remap({ 0 }), cereal::Exception);
+}
+
+TEST(SerializeContextTest, ConcurrentLoadsShareNoState)
+{
+	constexpr size_t NUM_LOADS = 4;
+	std::vector<ECS::Registry> registries(NUM_LOADS);
+	std::vector<SceneLoadContext> contexts(NUM_LOADS);
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < NUM_LOADS; ++i) {
+		threads.emplace_back([&, i]() {
+			std::vector<ECS::EntityHandle> saved;
+			for (ECS::EntityID id = 0; id < 100; ++id) {
+				saved.push_back({ id });
+			}
+			contexts[i].mapEntities(registries[i], saved);
+		});
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	for (size_t i = 0; i < NUM_LOADS; ++i) {
+		for (ECS::EntityID id = 0; id < 100; ++id) {
+			EXPECT_TRUE(registries[i].isValid(contexts[i].remap({ id })));
+		}
+	}
+}
@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+
+#include "core/scene/SnapshotDelta.h"
+
+#include <limits>
+
+using namespace APE;
+
+class SnapshotDeltaTest : public testing::Test {
+protected:
+	ECS::Registry sender;
+	ECS::Registry receiver;
+	DeltaEncoder encoder;
+	DeltaDecoder decoder;
+
+	ECS::EntityHandle parent;
+	ECS::EntityHandle child;
+
+	void SetUp() override
+	{
+		parent = sender.createEntity();
+		sender.emplaceComponent<HierarchyComponent>(parent, "parent");
+		sender.emplaceComponent<TransformComponent>(parent, glm::vec3(1.f, 2.f, 3.f));
+
+		child = sender.createEntity();
+		sender.emplaceComponent<HierarchyComponent>(child, "child");
+		sender.emplaceComponent<TransformComponent>(child, glm::vec3(-4.f, 0.5f, 8.f));
+		sender.emplaceComponent<Render::LightComponent>(child, Render::LightType::Point, 3.f);
+
+		sender.getComponent<HierarchyComponent>(child).parent = parent;
+		sender.getComponent<HierarchyComponent>(parent).children.push_back(child);
+	}
+
+	bool sync()
+	{
+		auto packet = encoder.encode(sender);
+		return decoder.apply(packet, receiver);
+	}
+
+	glm::vec3 receivedPosition(ECS::EntityHandle ent)
+	{
+		auto local = decoder.localEntity(ent.id);
+		return receiver.getComponent<TransformComponent>(local).position;
+	}
+};
+
+TEST_F(SnapshotDeltaTest, KeyframeMirrorsRegistry)
+{
+	ASSERT_TRUE(sync());
+	EXPECT_EQ(receiver.numEntities(), 2u);
+
+	auto local_parent = decoder.localEntity(parent.id);
+	auto local_child = decoder.localEntity(child.id);
+	ASSERT_TRUE(receiver.isValid(local_parent));
+	ASSERT_TRUE(receiver.isValid(local_child));
+
+	auto& h = receiver.getComponent<HierarchyComponent>(local_child);
+	EXPECT_EQ(h.tag, StringId("child"));
+	EXPECT_EQ(h.parent, local_parent);
+	EXPECT_EQ(receiver.getComponent<HierarchyComponent>(local_parent).children,
+		std::vector<ECS::EntityHandle> { local_child });
+
+	glm::vec3 pos = receivedPosition(child);
+	EXPECT_NEAR(pos.x, -4.f, 1e-3f);
+	EXPECT_NEAR(pos.y, 0.5f, 1e-3f);
+	EXPECT_NEAR(pos.z, 8.f, 1e-3f);
+
+	auto& light = receiver.getComponent<Render::LightComponent>(local_child);
+	EXPECT_EQ(light.type, Render::LightType::Point);
+	EXPECT_FLOAT_EQ(light.intensity, 3.f);
+}
+
+TEST_F(SnapshotDeltaTest, DeltasOnlyCarryChanges)
+{
+	auto keyframe = encoder.encode(sender);
+	ASSERT_TRUE(decoder.apply(keyframe, receiver));
+
+	auto idle = encoder.encode(sender);
+	ASSERT_TRUE(decoder.apply(idle, receiver));
+	EXPECT_LT(idle.size(), 8u);
+
+	sender.getComponent<TransformComponent>(child).position.x += 0.25f;
+	auto moved = encoder.encode(sender);
+	ASSERT_TRUE(decoder.apply(moved, receiver));
+	EXPECT_LT(moved.size(), keyframe.size());
+	EXPECT_NEAR(receivedPosition(child).x, -3.75f, 1e-3f);
+}
+
+TEST_F(SnapshotDeltaTest, RemovalsAndDestroysReplicate)
+{
+	ASSERT_TRUE(sync());
+
+	sender.removeComponent<Render::LightComponent>(child);
+	ASSERT_TRUE(sync());
+	EXPECT_FALSE(receiver.hasComponent<Render::LightComponent>(decoder.localEntity(child.id)));
+
+	sender.destroyEntity(child);
+	sender.getComponent<HierarchyComponent>(parent).children.clear();
+	ASSERT_TRUE(sync());
+	EXPECT_EQ(receiver.numEntities(), 1u);
+	EXPECT_EQ(decoder.localEntity(child.id), ECS::EntityHandle());
+}
+
+TEST_F(SnapshotDeltaTest, GapsWaitForKeyframe)
+{
+	ASSERT_TRUE(sync());
+
+	(void)encoder.encode(sender);
+	sender.getComponent<TransformComponent>(parent).position.y = 10.f;
+	EXPECT_FALSE(sync());
+	EXPECT_FALSE(decoder.isSynced());
+
+	encoder.forceKeyframe();
+	ASSERT_TRUE(sync());
+	EXPECT_EQ(receiver.numEntities(), 2u);
+	EXPECT_NEAR(receivedPosition(parent).y, 10.f, 1e-3f);
+}
+
+TEST_F(SnapshotDeltaTest, FarPositionsSaturate)
+{
+	auto& t = sender.getComponent<TransformComponent>(child);
+	t.position = glm::vec3(1e12f, -1e12f, std::numeric_limits<float>::quiet_NaN());
+	ASSERT_TRUE(sync());
+
+	constexpr float LIMIT = std::numeric_limits<int32_t>::max() / 1024.f;
+	glm::vec3 pos = receivedPosition(child);
+	EXPECT_FLOAT_EQ(pos.x, LIMIT);
+	EXPECT_FLOAT_EQ(pos.y, -LIMIT);
+	EXPECT_EQ(pos.z, 0.f);
+}
+
+TEST_F(SnapshotDeltaTest, TruncatedPacketIsRejected)
+{
+	auto packet = encoder.encode(sender);
+	packet.resize(packet.size() / 2);
+	EXPECT_FALSE(decoder.apply(packet, receiver));
+	EXPECT_FALSE(decoder.isSynced());
+}
@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+
+#include "core/scene/SpatialIndex.h"
+#include "physics/collisions/Collisions.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace APE;
+using namespace APE::Physics::Collisions;
+
+static AABB unitBoxAt(glm::vec3 center)
+{
+	return AABB(center - glm::vec3(0.5f), center + glm::vec3(0.5f));
+}
+
+static bool containsEnt(
+	const std::vector<ECS::EntityHandle>& ents,
+	ECS::EntityHandle ent)
+{
+	return std::find(ents.begin(), ents.end(), ent) != ents.end();
+}
+
+class SpatialIndexTest : public testing::Test {
+protected:
+	SpatialIndex index;
+
+	// Row of boxes spaced along the x axis
+	void fillRow(int count)
+	{
+		for (int idx = 0; idx < count; ++idx) {
+			index.insert(
+				ECS::EntityHandle(idx),
+				unitBoxAt(glm::vec3(3.f * idx, 0.f, 0.f))
+			);
+		}
+	}
+};
+
+TEST_F(SpatialIndexTest, InsertAndRemove)
+{
+	fillRow(16);
+	EXPECT_EQ(index.size(), 16);
+	EXPECT_TRUE(index.contains(ECS::EntityHandle(5)));
+
+	EXPECT_TRUE(index.remove(ECS::EntityHandle(5)));
+	EXPECT_FALSE(index.remove(ECS::EntityHandle(5)));
+	EXPECT_FALSE(index.contains(ECS::EntityHandle(5)));
+	EXPECT_EQ(index.size(), 15);
+
+	index.clear();
+	EXPECT_EQ(index.size(), 0);
+	EXPECT_EQ(index.height(), 0);
+}
+
+TEST_F(SpatialIndexTest, StaysBalanced)
+{
+	fillRow(1024);
+
+	// Sorted insertion degenerates without rotations
+	EXPECT_LE(index.height(), 20);
+}
+
+TEST_F(SpatialIndexTest, QueryAABB)
+{
+	fillRow(64);
+
+	auto res = index.queryAABB(AABB(glm::vec3(5.f, -1.f, -1.f), glm::vec3(10.f, 1.f, 1.f)));
+	ASSERT_EQ(res.size(), 2);
+	EXPECT_TRUE(containsEnt(res, ECS::EntityHandle(2)));
+	EXPECT_TRUE(containsEnt(res, ECS::EntityHandle(3)));
+}
+
+TEST_F(SpatialIndexTest, QuerySphere)
+{
+	fillRow(64);
+
+	auto res = index.querySphere(Sphere { glm::vec3(30.f, 0.f, 0.f), 1.f });
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0], ECS::EntityHandle(10));
+}
+
+TEST_F(SpatialIndexTest, QueryRaySortedFrontToBack)
+{
+	fillRow(64);
+
+	Ray ray(glm::vec3(200.f, 0.f, 0.f), glm::vec3(-1.f, 0.f, 0.f));
+	auto hits = index.queryRay(ray);
+	ASSERT_EQ(hits.size(), 64);
+	EXPECT_EQ(hits.front().ent, ECS::EntityHandle(63));
+	EXPECT_EQ(hits.back().ent, ECS::EntityHandle(0));
+
+	auto near_hits = index.queryRay(ray, 12.f);
+	EXPECT_EQ(near_hits.size(), 1);
+}
+
+TEST_F(SpatialIndexTest, UpdateWithinMarginKeepsTree)
+{
+	fillRow(8);
+
+	ECS::EntityHandle ent(3);
+	glm::vec3 center(9.f, 0.f, 0.f);
+	EXPECT_FALSE(index.update(ent, unitBoxAt(center + glm::vec3(0.05f))));
+	EXPECT_TRUE(index.update(ent, unitBoxAt(center + glm::vec3(50.f))));
+
+	auto res = index.queryAABB(unitBoxAt(center + glm::vec3(50.f)));
+	ASSERT_EQ(res.size(), 1);
+	EXPECT_EQ(res[0], ent);
+}
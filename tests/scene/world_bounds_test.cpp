@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+
+#include "core/components/Object.h"
+#include "core/scene/Scene.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace APE;
+using namespace APE::Physics::Collisions;
+
+constexpr float EPSILON = 1e-4f;
+
+static void expectNear(glm::vec3 a, glm::vec3 b)
+{
+	EXPECT_NEAR(a.x, b.x, EPSILON);
+	EXPECT_NEAR(a.y, b.y, EPSILON);
+	EXPECT_NEAR(a.z, b.z, EPSILON);
+}
+
+TEST(WorldBoundsTest, RefreshOnlyWhenMatrixChanges)
+{
+	WorldBoundsComponent bounds(AABB(glm::vec3(-1.f), glm::vec3(1.f)));
+
+	glm::mat4 mat = glm::translate(glm::mat4(1.f), glm::vec3(5.f, 0.f, 0.f));
+	EXPECT_TRUE(bounds.refresh(mat));
+	EXPECT_FALSE(bounds.refresh(mat));
+
+	bounds.invalidate();
+	EXPECT_TRUE(bounds.refresh(mat));
+
+	expectNear(bounds.world.min, glm::vec3(4.f, -1.f, -1.f));
+	expectNear(bounds.world.max, glm::vec3(6.f, 1.f, 1.f));
+}
+
+TEST(WorldBoundsTest, RotatedBoundsEncloseCorners)
+{
+	WorldBoundsComponent bounds(
+		AABB(glm::vec3(-1.f, -2.f, -3.f), glm::vec3(1.f, 2.f, 3.f)),
+		Sphere(glm::vec3(0.f), 4.f)
+	);
+
+	glm::mat4 mat = glm::rotate(glm::mat4(1.f), glm::radians(90.f), glm::vec3(0.f, 0.f, 1.f));
+	mat = glm::scale(mat, glm::vec3(2.f));
+	bounds.refresh(mat);
+
+	// 90 degrees about z swaps the x and y extents
+	expectNear(bounds.world.min, glm::vec3(-4.f, -2.f, -6.f));
+	expectNear(bounds.world.max, glm::vec3(4.f, 2.f, 6.f));
+	EXPECT_NEAR(bounds.world_sphere.radius, 8.f, EPSILON);
+}
+
+TEST(WorldBoundsTest, OnlyMarkedSubtreesRefresh)
+{
+	Scene world;
+	auto addBox = [&](ECS::EntityHandle parent, glm::vec3 pos) {
+		auto ent = world.registry.createEntity();
+		world.registry.emplaceComponent<HierarchyComponent>(ent);
+		world.registry.emplaceComponent<TransformComponent>(ent, pos);
+		world.registry.emplaceComponent<WorldBoundsComponent>(
+			ent, AABB(glm::vec3(-1.f), glm::vec3(1.f)));
+		world.setParent(ent, parent);
+		return ent;
+	};
+
+	auto parent = addBox(world.root, glm::vec3(10.f, 0.f, 0.f));
+	auto child = addBox(parent, glm::vec3(0.f, 5.f, 0.f));
+	world.updateSpatialIndex();
+	expectNear(world.registry.getComponent<WorldBoundsComponent>(child).world.min,
+		glm::vec3(9.f, 4.f, -1.f));
+
+	// Unmarked writes wait for markDirty()
+	world.registry.getComponent<TransformComponent>(parent).position = glm::vec3(20.f, 0.f, 0.f);
+	world.updateSpatialIndex();
+	expectNear(world.registry.getComponent<WorldBoundsComponent>(child).world.min,
+		glm::vec3(9.f, 4.f, -1.f));
+
+	world.markDirty(parent);
+	world.updateSpatialIndex();
+	expectNear(world.registry.getComponent<WorldBoundsComponent>(child).world.min,
+		glm::vec3(19.f, 4.f, -1.f));
+	auto hits = world.spatial.queryAABB(AABB(glm::vec3(18.f, 3.f, -2.f), glm::vec3(20.f, 6.f, 2.f)));
+	EXPECT_EQ(hits, std::vector<ECS::EntityHandle> { child });
+
+	// Reparenting marks the moved subtree
+	world.setParent(child, world.root);
+	world.updateSpatialIndex();
+	expectNear(world.registry.getComponent<WorldBoundsComponent>(child).world.min,
+		glm::vec3(-1.f, 4.f, -1.f));
+
+	world.destroyEntity(child);
+	world.updateSpatialIndex();
+	EXPECT_FALSE(world.spatial.contains(child));
+}
@@ -0,0 +1,175 @@
+#include "gtest/gtest.h"
+
+#include "core/scene/WorldPartition.h"
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <thread>
+
+using namespace APE;
+
+class WorldPartitionTest : public testing::Test {
+protected:
+	ThreadPool pool { 1 };
+	Scene world;
+	std::filesystem::path dir;
+
+	void SetUp() override
+	{
+		dir = std::filesystem::temp_directory_path() / "world_partition_test";
+		std::filesystem::remove_all(dir);
+
+		// One actor, so one cell at the origin
+		auto ent = world.registry.createEntity();
+		world.registry.emplaceComponent<HierarchyComponent>(ent, "actor");
+		world.registry.emplaceComponent<TransformComponent>(ent, glm::vec3(5.f, 0.f, 5.f));
+		world.setParent(ent, world.root);
+		ASSERT_TRUE(WorldPartition::build(world, dir, 10.f));
+		std::filesystem::remove(dir / "cell_0_0.json");
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove_all(dir);
+	}
+
+	// Update until the cell's load has finished one way or another
+	void settle(WorldPartition& partition, const glm::vec3& focus)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		do {
+			partition.update(world, { focus });
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		} while (partition.state({ 0, 0 }) == WorldPartition::CellState::Loading &&
+			std::chrono::steady_clock::now() < deadline);
+	}
+};
+
+TEST_F(WorldPartitionTest, FailedCellsRetry)
+{
+	PartitionSettings settings;
+	settings.retry_delay = Timing::millis(0.0);
+	settings.max_retry_delay = Timing::millis(0.0);
+	WorldPartition partition(dir, settings, pool);
+	ASSERT_EQ(partition.numCells(), 1u);
+
+	glm::vec3 focus(5.f, 0.f, 5.f);
+	settle(partition, focus);
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Failed);
+
+	// The file turns up, the next attempt picks it up
+	ASSERT_TRUE(WorldPartition::build(world, dir, 10.f));
+
+	partition.update(world, { focus });
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Unloaded);
+	settle(partition, focus);
+	partition.update(world, { focus });
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Resident);
+}
+
+TEST_F(WorldPartitionTest, FailedCellsResetWhenLeft)
+{
+	PartitionSettings settings;
+	settings.retry_delay = Timing::millis(60000.0);
+	settings.max_retry_delay = Timing::millis(60000.0);
+	WorldPartition partition(dir, settings, pool);
+
+	glm::vec3 focus(5.f, 0.f, 5.f);
+	settle(partition, focus);
+	ASSERT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Failed);
+
+	// Still backing off while the focus stays close
+	partition.update(world, { focus });
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Failed);
+
+	partition.update(world, { glm::vec3(1000.f, 0.f, 0.f) });
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Unloaded);
+}
+
+TEST_F(WorldPartitionTest, UnloadWaitsForUnloadRadius)
+{
+	ASSERT_TRUE(WorldPartition::build(world, dir, 10.f));
+	PartitionSettings settings;
+	settings.load_radius = 20.f;
+	settings.unload_radius = 40.f;
+	WorldPartition partition(dir, settings, pool);
+
+	// Focus points past the load radius don't pull the cell in
+	settle(partition, glm::vec3(35.f, 0.f, 5.f));
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Unloaded);
+
+	settle(partition, glm::vec3(25.f, 0.f, 5.f));
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Resident);
+
+	// Between the two radii the cell stays
+	partition.update(world, { glm::vec3(35.f, 0.f, 5.f) });
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Resident);
+	partition.update(world, { glm::vec3(45.f, 0.f, 5.f) });
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Resident);
+
+	partition.update(world, { glm::vec3(55.f, 0.f, 5.f) });
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Unloaded);
+
+	// Nor does coming back between them load it again
+	partition.update(world, { glm::vec3(35.f, 0.f, 5.f) });
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Unloaded);
+}
+
+TEST_F(WorldPartitionTest, IntegrationKeepsToBudget)
+{
+	// Four actors in the one cell
+	for (int i = 0; i < 3; ++i) {
+		auto ent = world.registry.createEntity();
+		world.registry.emplaceComponent<HierarchyComponent>(ent, "actor");
+		world.registry.emplaceComponent<TransformComponent>(ent, glm::vec3(1.f + i, 0.f, 1.f));
+		world.setParent(ent, world.root);
+	}
+	ASSERT_TRUE(WorldPartition::build(world, dir, 10.f));
+
+	// With no time to spare each update copies a single entity
+	PartitionSettings settings;
+	settings.integrate_budget = Timing::millis(0.0);
+	WorldPartition partition(dir, settings, pool);
+
+	glm::vec3 focus(5.f, 0.f, 5.f);
+	settle(partition, focus);
+	size_t num_updates = 1;
+	while (partition.state({ 0, 0 }) == WorldPartition::CellState::Integrating && num_updates < 10) {
+		partition.update(world, { focus });
+		++num_updates;
+	}
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Resident);
+	EXPECT_EQ(num_updates, 4u);
+
+	// A budget to spare brings the whole cell in on the update that loads it
+	partition.unloadAll(world);
+	settings.integrate_budget = Timing::millis(1000.0);
+	partition.setSettings(settings);
+	settle(partition, focus);
+	EXPECT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Resident);
+}
+
+TEST_F(WorldPartitionTest, TeardownDoesntWaitForLoads)
+{
+	ASSERT_TRUE(WorldPartition::build(world, dir, 10.f));
+
+	// Hold the only worker so the cell's load stays queued
+	std::promise<void> started;
+	std::promise<void> gate;
+	auto blocker = pool.submit([&started, release = gate.get_future()]() {
+		started.set_value();
+		release.wait();
+	});
+	started.get_future().wait();
+
+	{
+		WorldPartition partition(dir, {}, pool);
+		partition.update(world, { glm::vec3(5.f, 0.f, 5.f) });
+		ASSERT_EQ(partition.state({ 0, 0 }), WorldPartition::CellState::Loading);
+	}
+
+	// Reached with the worker still held, the queued load then gives up
+	gate.set_value();
+	blocker.get();
+}
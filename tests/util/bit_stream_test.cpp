@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+
+#include "util/BitStream.h"
+
+#include <cstdint>
+#include <limits>
+
+using namespace APE;
+
+TEST(BitStreamTest, ZigzagKeepsSmallMagnitudesSmall)
+{
+	EXPECT_EQ(zigzagEncode(0), 0u);
+	EXPECT_EQ(zigzagEncode(-1), 1u);
+	EXPECT_EQ(zigzagEncode(1), 2u);
+	EXPECT_EQ(zigzagEncode(-2), 3u);
+
+	for (int64_t v : { int64_t(0), int64_t(-5), int64_t(123456789),
+		std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max() })
+	{
+		EXPECT_EQ(zigzagDecode(zigzagEncode(v)), v);
+	}
+}
+
+TEST(BitStreamTest, MixedFieldsRoundTrip)
+{
+	BitWriter out;
+	out.writeBool(true);
+	out.writeBits(5, 3);
+	out.writeVarint(300);
+	out.writeSignedVarint(-70000);
+	out.writeFloat(3.25f);
+	out.writeString("tag");
+	out.writeVarint(std::numeric_limits<uint64_t>::max());
+	auto bytes = out.finish();
+
+	BitReader in(bytes);
+	EXPECT_TRUE(in.readBool());
+	EXPECT_EQ(in.readBits(3), 5u);
+	EXPECT_EQ(in.readVarint(), 300u);
+	EXPECT_EQ(in.readSignedVarint(), -70000);
+	EXPECT_EQ(in.readFloat(), 3.25f);
+	EXPECT_EQ(in.readString(), "tag");
+	EXPECT_EQ(in.readVarint(), std::numeric_limits<uint64_t>::max());
+	EXPECT_FALSE(in.overflowed());
+}
+
+TEST(BitStreamTest, ReadingPastEndOverflows)
+{
+	BitWriter out;
+	out.writeBits(1, 4);
+	auto bytes = out.finish();
+	ASSERT_EQ(bytes.size(), 1u);
+
+	BitReader in(bytes);
+	(void)in.readBits(8);
+	EXPECT_FALSE(in.overflowed());
+	EXPECT_EQ(in.readBits(1), 0u);
+	EXPECT_TRUE(in.overflowed());
+}
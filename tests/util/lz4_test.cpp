@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+
+#include "util/Lz4.h"
+
+#include <cstddef>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace APE;
+
+namespace {
+
+[[nodiscard]] std::vector<std::byte> roundTrip(const std::vector<std::byte>& in)
+{
+	auto packed = Lz4::compress(in);
+	std::vector<std::byte> out(in.size());
+	EXPECT_TRUE(Lz4::decompress(packed, out));
+	return out;
+}
+
+[[nodiscard]] std::vector<std::byte> bytesOf(std::string_view str)
+{
+	auto* data = reinterpret_cast<const std::byte*>(str.data());
+	return { data, data + str.size() };
+}
+
+};	// end of namespace
+
+TEST(Lz4Test, RoundTripsEdgeSizes)
+{
+	for (size_t size : { 0, 1, 5, 12, 13, 16, 255, 270, 65536, 70000 }) {
+		std::vector<std::byte> in(size);
+		for (size_t i = 0; i < size; ++i) in[i] = static_cast<std::byte>(i * 7 / 3);
+		EXPECT_EQ(roundTrip(in), in) << size;
+	}
+}
+
+TEST(Lz4Test, RepetitiveDataShrinks)
+{
+	std::vector<std::byte> in;
+	for (int i = 0; i < 2000; ++i) {
+		auto line = bytesOf("v 0.000000 1.000000 -1.000000\n");
+		in.insert(in.end(), line.begin(), line.end());
+	}
+
+	auto packed = Lz4::compress(in);
+	EXPECT_LT(packed.size(), in.size() / 20);
+	EXPECT_EQ(roundTrip(in), in);
+
+	// Runs overlap their own output
+	std::vector<std::byte> run(100000, std::byte { 'a' });
+	EXPECT_LT(Lz4::compress(run).size(), 500u);
+	EXPECT_EQ(roundTrip(run), run);
+}
+
+TEST(Lz4Test, RandomDataRoundTrips)
+{
+	std::mt19937 rng(5);
+	std::vector<std::byte> in(200000);
+	for (auto& byte : in) byte = static_cast<std::byte>(rng() % 4);
+	EXPECT_EQ(roundTrip(in), in);
+}
+
+TEST(Lz4Test, RejectsCorruptBlocks)
+{
+	auto in = bytesOf("abcdabcdabcdabcdabcdabcdabcdabcdabcdabcd");
+	auto packed = Lz4::compress(in);
+
+	// Wrong size either way
+	std::vector<std::byte> small(in.size() - 1);
+	std::vector<std::byte> large(in.size() + 1);
+	EXPECT_FALSE(Lz4::decompress(packed, small));
+	EXPECT_FALSE(Lz4::decompress(packed, large));
+
+	// Truncated
+	std::vector<std::byte> out(in.size());
+	EXPECT_FALSE(Lz4::decompress(std::span(packed).first(packed.size() / 2), out));
+
+	// A match reaching back before the start of the output
+	std::vector<std::byte> bad = { std::byte { 0x10 }, std::byte { 'a' }, std::byte { 2 }, std::byte { 0 } };
+	std::vector<std::byte> bad_out(5);
+	EXPECT_FALSE(Lz4::decompress(bad, bad_out));
+}
@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+
+#include "util/StringId.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace APE;
+
+TEST(StringIdTest, EmptyByDefault)
+{
+	StringId id;
+	EXPECT_TRUE(id.empty()) << "Default StringId should be empty.";
+	EXPECT_EQ(id.view(), "") << "Empty StringId should resolve to \"\".";
+	EXPECT_EQ(id, StringId("")) << "Interning \"\" should give the empty id.";
+}
+
+TEST(StringIdTest, InternDeduplicates)
+{
+	StringId a("Mesh 0");
+	StringId b(std::string("Mesh 0"));
+	StringId c("Mesh 1");
+
+	EXPECT_EQ(a, b) << "Equal strings should intern to the same id.";
+	EXPECT_NE(a, c) << "Different strings should intern to different ids.";
+	EXPECT_EQ(a.c_str(), b.c_str()) << "Equal ids should share storage.";
+}
+
+TEST(StringIdTest, ResolvesToText)
+{
+	StringId id("Root Node");
+	EXPECT_EQ(id.view(), "Root Node");
+	EXPECT_EQ(id.str(), std::string("Root Node"));
+	EXPECT_EQ(id.c_str()[id.view().size()], '\0')
+		<< "Interned strings should be null terminated.";
+}
+
+TEST(StringIdTest, StableAcrossGrowth)
+{
+	StringId first("stable string");
+	const char* first_ptr = first.c_str();
+
+	// Force the arena to allocate several new blocks
+	for (int i = 0; i < 20000; ++i) {
+		StringId tmp("filler string " + std::to_string(i));
+	}
+
+	EXPECT_EQ(first.c_str(), first_ptr)
+		<< "Interned strings must not move when the table grows.";
+	EXPECT_EQ(first.view(), "stable string");
+}
+
+TEST(StringIdTest, LongStrings)
+{
+	std::string long_str(256 * 1024, 'x');
+	StringId id(long_str);
+	EXPECT_EQ(id.view(), long_str)
+		<< "Strings larger than an arena block should still intern.";
+}
+
+TEST(StringIdTest, ConcurrentIntern)
+{
+	constexpr int NUM_THREADS = 8;
+	constexpr int NUM_TAGS = 1000;
+
+	std::vector<std::vector<StringId>> results(NUM_THREADS);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < NUM_THREADS; ++t) {
+		threads.emplace_back([&, t] {
+			for (int i = 0; i < NUM_TAGS; ++i) {
+				results[t].emplace_back("Concurrent " + std::to_string(i));
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	for (int t = 1; t < NUM_THREADS; ++t) {
+		EXPECT_EQ(results[t], results[0])
+			<< "All threads should agree on interned ids.";
+	}
+}
@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+
+#include "util/ThreadPool.h"
+
+#include <atomic>
+#include <future>
+#include <string>
+#include <vector>
+
+using namespace APE;
+
+TEST(ThreadPoolTest, ReturnsResults)
+{
+	ThreadPool pool(4);
+
+	std::vector<std::future<int>> results;
+	for (int i = 0; i < 64; ++i) {
+		results.push_back(pool.submit([i]() { return i * i; }));
+	}
+
+	for (int i = 0; i < 64; ++i) {
+		EXPECT_EQ(results[i].get(), i * i);
+	}
+}
+
+TEST(ThreadPoolTest, RunsVoidJobs)
+{
+	std::atomic<int> counter = 0;
+	{
+		ThreadPool pool(3);
+		for (int i = 0; i < 100; ++i) {
+			(void)pool.submit([&counter]() { ++counter; });
+		}
+	}
+
+	// Destructor drains the queue before joining
+	EXPECT_EQ(counter.load(), 100);
+}
+
+TEST(ThreadPoolTest, PropagatesExceptions)
+{
+	ThreadPool pool(1);
+
+	auto res = pool.submit([]() -> std::string {
+		throw std::runtime_error("job failed");
+	});
+	EXPECT_THROW(res.get(), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, ClampsToOneThread)
+{
+	ThreadPool pool(0);
+	EXPECT_EQ(pool.size(), 1);
+	EXPECT_EQ(pool.submit([]() { return 7; }).get(), 7);
+}
+
+TEST(ThreadPoolTest, RunsHigherPriorityFirst)
+{
+	ThreadPool pool(1);
+
+	// Hold the only worker so the rest queue up behind it
+	std::promise<void> release;
+	auto blocker = pool.submit([gate = release.get_future()]() mutable { gate.wait(); });
+
+	std::vector<int> order;
+	std::vector<std::future<void>> jobs;
+	for (int priority : { 0, 5, -3, 5, 1 }) {
+		jobs.push_back(pool.submit([&order, priority]() { order.push_back(priority); }, priority));
+	}
+
+	release.set_value();
+	for (auto& job : jobs) {
+		job.get();
+	}
+	EXPECT_EQ(order, (std::vector<int> { 5, 5, 1, 0, -3 }));
+}
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce)
+{
+	ThreadPool pool(3);
+
+	std::vector<std::atomic<int>> visits(1000);
+	pool.parallelFor(visits.size(), [&](size_t i) { ++visits[i]; });
+	for (auto& count : visits) {
+		EXPECT_EQ(count.load(), 1);
+	}
+
+	// Nested use from inside a job must not deadlock a single worker
+	ThreadPool single(1);
+	std::atomic<int> sum = 0;
+	single.submit([&]() {
+		single.parallelFor(10, [&](size_t i) { sum += static_cast<int>(i); });
+	}).get();
+	EXPECT_EQ(sum.load(), 45);
+}
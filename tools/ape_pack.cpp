@@ -0,0 +1,67 @@
+#include "core/scene/AssetPack.h"
+#include "util/Logger.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+/*
+* Packs asset files into one archive for shipping
+*
+*	ape_pack [--compress] <out.apepack> <file or directory>...
+*
+* Paths are stored as given, so run it from the directory the engine runs
+* in, e.g. `ape_pack res.apepack res`.
+*/
+int main(int argc, char** argv)
+{
+	APE::PackSettings settings;
+	std::filesystem::path pack_path;
+	std::vector<std::filesystem::path> inputs;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if (arg == "--compress") {
+			settings.b_compress = true;
+		}
+		else if (pack_path.empty()) {
+			pack_path = arg;
+		}
+		else {
+			inputs.emplace_back(arg);
+		}
+	}
+
+	if (pack_path.empty() || inputs.empty()) {
+		APE_ERROR("Usage: ape_pack [--compress] <out{}> <file or directory>...",
+			APE::AssetPack::EXTENSION
+		);
+		return 1;
+	}
+
+	std::error_code ec;
+	std::vector<std::filesystem::path> files;
+	for (auto& input : inputs) {
+		if (std::filesystem::is_regular_file(input, ec)) {
+			files.push_back(input);
+			continue;
+		}
+		if (!std::filesystem::is_directory(input, ec)) {
+			APE_ERROR("ape_pack: {} does not exist.", input.string());
+			return 1;
+		}
+
+		for (auto& dir_entry : std::filesystem::recursive_directory_iterator(input, ec)) {
+			if (!dir_entry.is_regular_file(ec)) continue;
+
+			// Never pack an earlier archive into the new one
+			auto& path = dir_entry.path();
+			if (path.extension() == APE::AssetPack::EXTENSION || path.extension() == ".tmp") continue;
+			files.push_back(path);
+		}
+	}
+
+	return APE::AssetPack::write(pack_path, files, settings) ? 0 : 1;
+}